@@ -0,0 +1,179 @@
+/**
+ * M-Boma availability calendar benchmark
+ *
+ * Fills an EntityStore with synthetic houses and a year of bookings (no
+ * database needed) and times "which houses of town T are free from D1 to
+ * D2" two ways: through the per-house AvailabilityCalendar, and by
+ * checking every booking for an overlap, which is what a query on the
+ * bookings table without an interval structure does. Both answers are
+ * compared.
+ *
+ * Usage:
+ *   availability_bench [--houses N] [--bookings B] [--queries Q]
+ *
+ *   --houses N     Houses in the store, spread over 50 towns (default 100000)
+ *   --bookings B   Bookings spread over one year (default 1000000)
+ *   --queries Q    Town and date-window queries (default 200)
+ */
+
+#include "EntityStore.h"
+#include "Utils.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+    const int TOWNS = 50;
+    const long long DAY = 24LL * 3600;
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Small LCG so runs are repeatable
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    std::string formatDay(long long day) {
+        // Day number counted from 2025-01-01
+        static const int MONTH_DAYS[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        int year = 2025;
+        int month = 0;
+        while (day >= MONTH_DAYS[month] + (month == 1 && year % 4 == 0 ? 1 : 0)) {
+            day -= MONTH_DAYS[month] + (month == 1 && year % 4 == 0 ? 1 : 0);
+            if (++month == 12) {
+                month = 0;
+                ++year;
+            }
+        }
+        char text[48];
+        std::snprintf(text, sizeof(text), "%04d-%02d-%02d 12:00:00", year, month + 1, static_cast<int>(day) + 1);
+        return text;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t houseCount = 100000;
+    size_t bookingCount = 1000000;
+    int queries = 200;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--houses") == 0 && i + 1 < argc) {
+            houseCount = static_cast<size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--bookings") == 0 && i + 1 < argc) {
+            bookingCount = static_cast<size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+            queries = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--houses N] [--bookings B] [--queries Q]\n";
+            return 1;
+        }
+    }
+    if (houseCount < 1) {
+        houseCount = 1;
+    }
+    if (queries < 1) {
+        queries = 1;
+    }
+
+    unsigned int state = 12345;
+    std::vector<House> houses;
+    houses.reserve(houseCount);
+    for (size_t row = 0; row < houseCount; ++row) {
+        char id[16];
+        std::snprintf(id, sizeof(id), "A%07u", static_cast<unsigned int>(row));
+        double rent = 5000.0 + (nextRandom(state) % 95000);
+        houses.push_back(House(id, "Bungalow", rent * 2, rent, 100 + static_cast<int>(row % TOWNS),
+                               "Bench Estate", "https://maps.google.com/?q=Bench"));
+    }
+
+    EntityStore store;
+    store.setHouses(std::move(houses));
+
+    // Bookings of one to six weeks starting anywhere in the year
+    std::vector<Booking> bookings;
+    bookings.reserve(bookingCount);
+    for (size_t i = 0; i < bookingCount; ++i) {
+        const House& house = store.house(nextRandom(state) % store.houseCount());
+        long long startDay = nextRandom(state) % 365;
+        long long endDay = startDay + 7 * (1 + nextRandom(state) % 6);
+        bookings.push_back(Booking(static_cast<int>(i + 1), 1, house.getId(), formatDay(startDay), formatDay(endDay), true));
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < bookings.size(); ++i) {
+        store.scheduleBooking(bookings[i]);
+    }
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << bookings.size() << " bookings of " << store.houseCount() << " houses scheduled in "
+              << secondsSince(start) * 1000 << " ms\n";
+
+    // The scan parses the dates up front, so only the overlap tests are timed
+    std::vector<long long> starts(bookings.size());
+    std::vector<long long> ends(bookings.size());
+    for (size_t i = 0; i < bookings.size(); ++i) {
+        parseDateTime(bookings[i].getBookingDate(), starts[i]);
+        parseDateTime(bookings[i].getExpiryDate(), ends[i]);
+    }
+
+    std::vector<int> towns;
+    std::vector<long long> windowStarts;
+    for (int q = 0; q < queries; ++q) {
+        long long day;
+        parseDateTime(formatDay(nextRandom(state) % 365), day);
+        towns.push_back(100 + static_cast<int>(nextRandom(state) % TOWNS));
+        windowStarts.push_back(day);
+    }
+    const long long WINDOW = Booking::GRACE_PERIOD_DAYS * DAY;
+
+    size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    std::vector<std::vector<size_t> > calendarAnswers(queries);
+    for (int q = 0; q < queries; ++q) {
+        HouseCatalog::Filter filter;
+        filter.townId = towns[q];
+        calendarAnswers[q] = store.housesFree(windowStarts[q], windowStarts[q] + WINDOW, filter);
+        found += calendarAnswers[q].size();
+    }
+    double calendarSeconds = secondsSince(start);
+
+    // Scan: collect the booked houses of the town, then list the rest
+    int scanned = queries < 20 ? queries : 20;
+    start = std::chrono::steady_clock::now();
+    for (int q = 0; q < scanned; ++q) {
+        long long from = windowStarts[q];
+        long long to = from + WINDOW;
+        std::unordered_set<std::string> booked;
+        for (size_t i = 0; i < bookings.size(); ++i) {
+            if (starts[i] < to && ends[i] > from) {
+                booked.insert(bookings[i].getHouseId());
+            }
+        }
+
+        std::vector<size_t> expected;
+        EntityStore::SlotRange range = store.housesInTown(towns[q]);
+        for (size_t slot = range.first; slot < range.second; ++slot) {
+            if (booked.count(store.house(slot).getId()) == 0) {
+                expected.push_back(slot);
+            }
+        }
+        if (expected != calendarAnswers[q]) {
+            std::cerr << "Calendar and scan results differ for query " << q << "\n";
+            return 1;
+        }
+    }
+    double scanSeconds = secondsSince(start);
+
+    std::cout << "free houses per query: " << static_cast<double>(found) / queries << "\n";
+    std::cout << "calendar: " << calendarSeconds * 1000 / queries << " ms per query\n";
+    std::cout << "scan:     " << scanSeconds * 1000 / scanned << " ms per query\n";
+    return 0;
+}
@@ -0,0 +1,197 @@
+/**
+ * M-Boma catalog loader benchmark
+ *
+ * Compares the text-protocol house loader (DBConnector::loadAllHouses) with
+ * the binary-protocol columnar loader (DBConnector::loadHouseCatalog).
+ *
+ * Usage:
+ *   catalog_loader_bench [--rows N] [--seed] [--cleanup] [--runs R]
+ *
+ *   --rows N    Number of houses the benchmark expects (default 1000000)
+ *   --seed      Insert synthetic houses until the table holds N rows
+ *   --cleanup   Delete the synthetic houses afterwards
+ *   --runs R    Timed runs per loader; the best run is reported (default 3)
+ */
+
+#include "DBConnector.h"
+#include "DBConfig.h"
+#include "HouseCatalog.h"
+#include <mysql/mysql.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    const char* SEED_ADDRESS_PREFIX = "Bench Estate";
+    const char* SEED_TYPES[] = { "Bungalow", "Mansionette", "Appartments & Flats", "Bedsitters", "Singles" };
+    const int SEED_TOWNS[] = { 100, 200, 300 };
+    const int SEED_BATCH_ROWS = 1000;
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    MYSQL* openRawConnection() {
+        MYSQL* mysql = mysql_init(nullptr);
+        if (!mysql_real_connect(mysql, DBConfig::DB_HOST.c_str(), DBConfig::DB_USER.c_str(),
+                                DBConfig::DB_PASS.c_str(), DBConfig::DB_NAME.c_str(), 0, nullptr, 0)) {
+            std::cerr << "Connection failed: " << mysql_error(mysql) << "\n";
+            mysql_close(mysql);
+            return nullptr;
+        }
+        return mysql;
+    }
+
+    long long countHouses(MYSQL* mysql) {
+        if (mysql_query(mysql, "SELECT COUNT(*) FROM houses")) {
+            return -1;
+        }
+        MYSQL_RES* result = mysql_store_result(mysql);
+        MYSQL_ROW row = result ? mysql_fetch_row(result) : nullptr;
+        long long count = (row && row[0]) ? std::atoll(row[0]) : -1;
+        if (result) {
+            mysql_free_result(result);
+        }
+        return count;
+    }
+
+    // Four-character base-36 house ID for a sequence number
+    std::string seedId(long long sequence) {
+        const char* digits = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        char id[5];
+        for (int i = 3; i >= 0; --i) {
+            id[i] = digits[sequence % 36];
+            sequence /= 36;
+        }
+        id[4] = '\0';
+        return id;
+    }
+
+    bool seedHouses(MYSQL* mysql, long long targetRows) {
+        long long existing = countHouses(mysql);
+        long long sequence = 0;
+        const long long idSpace = 36LL * 36 * 36 * 36;
+
+        mysql_autocommit(mysql, 0);
+        while (existing >= 0 && existing < targetRows && sequence < idSpace) {
+            std::ostringstream sql;
+            sql << "INSERT IGNORE INTO houses(town_id, house_id, house_type, house_address, map_link, "
+                   "deposit_fee, monthly_rent, is_available, is_booked, booked_until) VALUES ";
+            for (int i = 0; i < SEED_BATCH_ROWS && sequence < idSpace; ++i, ++sequence) {
+                std::string id = seedId(sequence);
+                int town = SEED_TOWNS[sequence % 3];
+                double rent = 3000 + (sequence * 7919) % 200000;
+                bool booked = sequence % 5 == 0;
+                sql << (i ? "," : "") << "(" << town << ",'" << id << "','"
+                    << SEED_TYPES[sequence % 5] << "','" << SEED_ADDRESS_PREFIX << ", House #" << id
+                    << "','https://maps.google.com/?q=" << town << "'," << rent * 2 << "," << rent
+                    << ",1," << (booked ? 1 : 0) << "," << (booked ? "'2026-12-31 12:00:00'" : "NULL") << ")";
+            }
+            if (mysql_query(mysql, sql.str().c_str())) {
+                std::cerr << "Seeding failed: " << mysql_error(mysql) << "\n";
+                mysql_rollback(mysql);
+                return false;
+            }
+            existing += mysql_affected_rows(mysql);
+            if (sequence % 100000 == 0) {
+                mysql_commit(mysql);
+            }
+        }
+        mysql_commit(mysql);
+        mysql_autocommit(mysql, 1);
+        return existing >= targetRows;
+    }
+
+    void cleanupHouses(MYSQL* mysql) {
+        std::string sql = std::string("DELETE FROM houses WHERE house_address LIKE '") +
+                          SEED_ADDRESS_PREFIX + "%'";
+        if (mysql_query(mysql, sql.c_str())) {
+            std::cerr << "Cleanup failed: " << mysql_error(mysql) << "\n";
+        } else {
+            std::cout << "Removed " << mysql_affected_rows(mysql) << " synthetic houses\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long long rows = 1000000;
+    int runs = 3;
+    bool seed = false;
+    bool cleanup = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rows") == 0 && i + 1 < argc) {
+            rows = std::atoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            seed = true;
+        } else if (std::strcmp(argv[i], "--cleanup") == 0) {
+            cleanup = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--rows N] [--seed] [--cleanup] [--runs R]\n";
+            return 1;
+        }
+    }
+
+    MYSQL* raw = openRawConnection();
+    if (!raw) {
+        return 1;
+    }
+
+    if (seed) {
+        std::cout << "Seeding houses up to " << rows << " rows...\n";
+        if (!seedHouses(raw, rows)) {
+            mysql_close(raw);
+            return 1;
+        }
+    }
+    std::cout << "houses table rows: " << countHouses(raw) << "\n";
+
+    DBConnector db;
+    if (!db.connect(DBConfig::DB_HOST, DBConfig::DB_USER, DBConfig::DB_PASS, DBConfig::DB_NAME)) {
+        mysql_close(raw);
+        return 1;
+    }
+
+    double bestText = 0.0;
+    double bestBinary = 0.0;
+    size_t textRows = 0;
+    size_t binaryRows = 0;
+
+    for (int run = 0; run < runs; ++run) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::vector<House> houses = db.loadAllHouses();
+        double elapsed = secondsSince(start);
+        textRows = houses.size();
+        if (run == 0 || elapsed < bestText) bestText = elapsed;
+
+        HouseCatalog catalog;
+        start = std::chrono::steady_clock::now();
+        db.loadHouseCatalog(catalog);
+        elapsed = secondsSince(start);
+        binaryRows = catalog.size();
+        if (run == 0 || elapsed < bestBinary) bestBinary = elapsed;
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "text loader    (loadAllHouses):    " << textRows << " rows in " << bestText << " s ("
+              << (bestText > 0 ? textRows / bestText : 0) << " rows/s)\n";
+    std::cout << "binary loader  (loadHouseCatalog): " << binaryRows << " rows in " << bestBinary << " s ("
+              << (bestBinary > 0 ? binaryRows / bestBinary : 0) << " rows/s)\n";
+    if (bestBinary > 0) {
+        std::cout << "speedup: " << bestText / bestBinary << "x\n";
+    }
+
+    db.disconnect();
+    if (cleanup) {
+        cleanupHouses(raw);
+    }
+    mysql_close(raw);
+    return 0;
+}
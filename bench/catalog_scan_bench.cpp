@@ -0,0 +1,183 @@
+/**
+ * M-Boma catalog scan benchmark
+ *
+ * Fills a HouseCatalog with synthetic listings (no database needed) and
+ * times HouseCatalog::select with the scalar and AVX2 kernels, optionally
+ * against a plain loop over House objects. Rows are grouped by town as in
+ * EntityStore, so the town-range scan the console search uses is timed too.
+ *
+ * Usage:
+ *   catalog_scan_bench [--rows N] [--runs R] [--objects]
+ *
+ *   --rows N    Listings in the catalog (default 10000000)
+ *   --runs R    Timed runs per kernel; the best run is reported (default 5)
+ *   --objects   Also time a scan over a vector of House objects (needs a lot of memory)
+ */
+
+#include "HouseCatalog.h"
+#include "House.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+    const char* TYPES[] = { "Bungalow", "Mansionette", "Appartments & Flats", "Bedsitters", "Singles" };
+    const int TYPE_COUNT = sizeof(TYPES) / sizeof(TYPES[0]);
+    const int TOWNS[] = { 100, 101, 102, 103, 104, 200, 201, 202, 300, 301, 401 };
+    const int TOWN_COUNT = sizeof(TOWNS) / sizeof(TOWNS[0]);
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Small LCG so runs are repeatable without <random> overhead per row
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    House makeHouse(size_t row, int town, unsigned int& state) {
+        char id[16];
+        std::snprintf(id, sizeof(id), "S%06u", static_cast<unsigned int>(row % 1000000));
+        const char* type = TYPES[nextRandom(state) % TYPE_COUNT];
+        double rent = 5000.0 + (nextRandom(state) % 495000);
+
+        House house(id, type, rent * 2, rent, town, "Bench Estate", "https://maps.google.com/?q=Bench");
+        house.setAvailability(nextRandom(state) % 10 != 0);
+        return house;
+    }
+
+    bool matches(const House& house, const HouseCatalog::Filter& filter) {
+        return (filter.type.empty() || house.getType().find(filter.type) != std::string::npos) &&
+               (filter.minRent <= 0 || house.getMonthlyRent() >= filter.minRent) &&
+               (filter.maxRent <= 0 || house.getMonthlyRent() <= filter.maxRent) &&
+               (filter.townId <= 0 || house.getLocationId() == filter.townId) &&
+               (!filter.availableOnly || house.getAvailability());
+    }
+
+    double bestSelect(const HouseCatalog& catalog, const HouseCatalog::Filter& filter, size_t begin, size_t end,
+                      bool useSimd, int runs, size_t& count, HouseCatalog::Bitmap& selection) {
+        double best = -1;
+        for (int run = 0; run < runs; ++run) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            count = catalog.select(filter, selection, begin, end, useSimd);
+            double seconds = secondsSince(start);
+            if (best < 0 || seconds < best) {
+                best = seconds;
+            }
+        }
+        return best;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = 10000000;
+    int runs = 5;
+    bool objects = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rows") == 0 && i + 1 < argc) {
+            rows = static_cast<size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--objects") == 0) {
+            objects = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--rows N] [--runs R] [--objects]\n";
+            return 1;
+        }
+    }
+    if (runs < 1) {
+        runs = 1;
+    }
+
+    std::cout << "Generating " << rows << " listings...\n";
+    HouseCatalog catalog;
+    catalog.reserve(rows, 48);
+    std::vector<House> houses;
+    if (objects) {
+        houses.reserve(rows);
+    }
+    unsigned int state = 12345;
+    size_t townBegin = 0;
+    size_t townEnd = 0;
+    for (size_t row = 0; row < rows; ++row) {
+        // Equal contiguous blocks per town; the first town is the one searched
+        size_t townIndex = row * TOWN_COUNT / rows;
+        if (townIndex == 0) {
+            townEnd = row + 1;
+        }
+        House house = makeHouse(row, TOWNS[townIndex], state);
+        catalog.append(house);
+        if (objects) {
+            houses.push_back(house);
+        }
+    }
+
+    // A typical search: one type, a rent band, one town, listed houses only
+    HouseCatalog::Filter filter;
+    filter.type = "Bungalow";
+    filter.minRent = 50000;
+    filter.maxRent = 250000;
+    filter.townId = 100;
+    filter.availableOnly = true;
+
+    HouseCatalog::Bitmap scalarSelection;
+    HouseCatalog::Bitmap simdSelection;
+    size_t scalarCount = 0;
+    size_t simdCount = 0;
+    bool simd = HouseCatalog::simdAvailable();
+
+    std::cout << std::fixed << std::setprecision(2);
+    const char* scopes[] = { "full scan ", "town range" };
+    size_t begins[] = { 0, townBegin };
+    size_t ends[] = { rows, townEnd };
+    for (int scope = 0; scope < 2; ++scope) {
+        double scalarSeconds = bestSelect(catalog, filter, begins[scope], ends[scope], false, runs,
+                                          scalarCount, scalarSelection);
+        std::cout << scopes[scope] << "  scalar: " << std::setw(8) << scalarSeconds * 1000 << " ms, "
+                  << scalarCount << " matches\n";
+
+        if (!simd) {
+            std::cout << scopes[scope] << "  AVX2:   not supported on this CPU\n";
+            continue;
+        }
+        double simdSeconds = bestSelect(catalog, filter, begins[scope], ends[scope], true, runs,
+                                        simdCount, simdSelection);
+        std::cout << scopes[scope] << "  AVX2:   " << std::setw(8) << simdSeconds * 1000 << " ms, "
+                  << simdCount << " matches\n";
+        if (simdSelection != scalarSelection) {
+            std::cerr << "AVX2 and scalar selections differ\n";
+            return 1;
+        }
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<House> results = catalog.materialize(scalarSelection);
+    std::cout << "materialize:           " << secondsSince(start) * 1000 << " ms, " << results.size() << " houses\n";
+
+    if (objects) {
+        double best = -1;
+        size_t count = 0;
+        for (int run = 0; run < runs; ++run) {
+            start = std::chrono::steady_clock::now();
+            count = 0;
+            for (size_t i = 0; i < houses.size(); ++i) {
+                if (matches(houses[i], filter)) {
+                    ++count;
+                }
+            }
+            double seconds = secondsSince(start);
+            if (best < 0 || seconds < best) {
+                best = seconds;
+            }
+        }
+        std::cout << "House objects:         " << best * 1000 << " ms, " << count << " matches\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * M-Boma booking expiry benchmark
+ *
+ * Schedules synthetic booking expiries, spread over the next 30 days,
+ * into the TimerWheel used by ExpiryService (no database needed). It
+ * then advances the wheel one second at a time through the whole period,
+ * as the sweeper does, and checks that every booking fires exactly once,
+ * never early. The baseline is a scan of every expiry time for each
+ * tick, which is what a sweep without a wheel or an index does.
+ *
+ * Usage:
+ *   expiry_bench [--bookings N] [--days D]
+ *
+ *   --bookings N   Outstanding bookings (default 5000000)
+ *   --days D       Period the expiries are spread over (default 30)
+ */
+
+#include "TimerWheel.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+namespace {
+    const long long START = 1767225600LL;     // 2026-01-01 00:00:00
+    const long long DAY = 24LL * 3600;
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Small LCG so runs are repeatable
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t bookings = 5000000;
+    int days = 30;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bookings") == 0 && i + 1 < argc) {
+            bookings = static_cast<size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--days") == 0 && i + 1 < argc) {
+            days = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--bookings N] [--days D]\n";
+            return 1;
+        }
+    }
+    if (days < 1) {
+        days = 1;
+    }
+    const long long end = START + days * DAY;
+
+    std::vector<long long> expiries(bookings);
+    unsigned int state = 12345;
+    for (size_t i = 0; i < bookings; ++i) {
+        long long offset = (static_cast<long long>(nextRandom(state)) << 8 | (nextRandom(state) & 0xFF)) % (days * DAY);
+        expiries[i] = START + offset;
+    }
+
+    TimerWheel wheel(START);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < bookings; ++i) {
+        wheel.schedule(static_cast<int>(i), expiries[i]);
+    }
+    double scheduleSeconds = secondsSince(start);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << bookings << " bookings scheduled in " << scheduleSeconds * 1000 << " ms ("
+              << scheduleSeconds * 1e9 / bookings << " ns each)\n";
+
+    // One advance per second of the period, as the sweeper ticks
+    std::vector<char> seen(bookings, 0);
+    std::vector<TimerWheel::Timer> fired;
+    size_t firedCount = 0;
+    double slowestTick = 0;
+    start = std::chrono::steady_clock::now();
+    for (long long now = START; now <= end; ++now) {
+        std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+        fired.clear();
+        wheel.advance(now, fired);
+        double tickSeconds = secondsSince(tickStart);
+        if (tickSeconds > slowestTick) {
+            slowestTick = tickSeconds;
+        }
+
+        for (size_t i = 0; i < fired.size(); ++i) {
+            int id = fired[i].id;
+            if (seen[id] || expiries[id] > now) {
+                std::cerr << "Booking " << id << " fired " << (seen[id] ? "twice" : "early") << "\n";
+                return 1;
+            }
+            seen[id] = 1;
+        }
+        firedCount += fired.size();
+    }
+    double advanceSeconds = secondsSince(start);
+    long long ticks = end - START + 1;
+
+    if (firedCount != bookings || wheel.size() != 0) {
+        std::cerr << "Only " << firedCount << " of " << bookings << " bookings fired\n";
+        return 1;
+    }
+    std::cout << ticks << " ticks in " << advanceSeconds * 1000 << " ms: "
+              << advanceSeconds * 1e6 / ticks << " us per tick on average, "
+              << slowestTick * 1e6 << " us for the slowest\n";
+
+    // A few ticks of the scan are enough to see its cost
+    const int SCAN_TICKS = 10;
+    size_t due = 0;
+    start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < SCAN_TICKS; ++tick) {
+        long long now = START + tick * DAY;
+        for (size_t i = 0; i < bookings; ++i) {
+            if (expiries[i] <= now) {
+                ++due;
+            }
+        }
+    }
+    double scanSeconds = secondsSince(start);
+    std::cout << "scan of every expiry: " << scanSeconds * 1e6 / SCAN_TICKS << " us per tick ("
+              << due << " due over " << SCAN_TICKS << " samples)\n";
+    return 0;
+}
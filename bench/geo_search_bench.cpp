@@ -0,0 +1,231 @@
+/**
+ * M-Boma nearby search benchmark
+ *
+ * Fills an EntityStore with synthetic located listings (no database
+ * needed), most of them clustered around a few cities, and times radius
+ * and nearest-k searches through the grid index against a scan of every
+ * house. Each indexed result is checked against the scan.
+ *
+ * Usage:
+ *   geo_search_bench [--rows N] [--queries Q] [--k K]
+ *
+ *   --rows N      Listings in the store (default 1000000)
+ *   --queries Q   Searches per kind (default 1000)
+ *   --k K         Houses wanted by nearest searches (default 10)
+ */
+
+#include "EntityStore.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+    struct City {
+        double lat;
+        double lon;
+        double spreadDegrees;
+    };
+    const City CITIES[] = {
+        { -1.2921, 36.8219, 0.15 },   // Nairobi
+        { -4.0435, 39.6682, 0.08 },   // Mombasa
+        { -0.0917, 34.7680, 0.06 },   // Kisumu
+        { -0.3031, 36.0800, 0.06 },   // Nakuru
+        { 0.5143, 35.2698, 0.05 },    // Eldoret
+    };
+    const int CITY_COUNT = sizeof(CITIES) / sizeof(CITIES[0]);
+    const char* TYPES[] = { "Bungalow", "Mansionette", "Appartments & Flats", "Bedsitters", "Singles" };
+    const int TYPE_COUNT = sizeof(TYPES) / sizeof(TYPES[0]);
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Small LCG so runs are repeatable
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    double uniform(unsigned int& state) {
+        return (nextRandom(state) & 0xFFFFFF) / 16777216.0;
+    }
+
+    // A point near a city (sum of uniforms, roughly bell-shaped) or anywhere in the country
+    void randomPoint(unsigned int& state, double& lat, double& lon) {
+        if (nextRandom(state) % 10 < 8) {
+            const City& city = CITIES[nextRandom(state) % CITY_COUNT];
+            lat = city.lat + (uniform(state) + uniform(state) + uniform(state) - 1.5) * city.spreadDegrees;
+            lon = city.lon + (uniform(state) + uniform(state) + uniform(state) - 1.5) * city.spreadDegrees;
+        } else {
+            lat = -4.6 + uniform(state) * 9.5;
+            lon = 34.0 + uniform(state) * 7.8;
+        }
+    }
+
+    // Reference answer: every house, sorted by distance (ties by slot, as the index does)
+    void scan(const EntityStore& store, double lat, double lon, double radiusKm, size_t k,
+              const HouseCatalog::Filter& filter, std::vector<GeoIndex::Hit>& hits) {
+        hits.clear();
+        for (size_t slot = 0; slot < store.houseCount(); ++slot) {
+            const House& house = store.house(slot);
+            if (!house.hasCoordinates() || !EntityStore::matches(house, filter)) {
+                continue;
+            }
+            GeoIndex::Hit hit;
+            hit.slot = slot;
+            hit.distanceKm = GeoIndex::distanceKm(lat, lon, house.getLatitude(), house.getLongitude());
+            if (radiusKm < 0 || hit.distanceKm <= radiusKm) {
+                hits.push_back(hit);
+            }
+        }
+        std::sort(hits.begin(), hits.end(), [](const GeoIndex::Hit& a, const GeoIndex::Hit& b) {
+            return a.distanceKm < b.distanceKm || (a.distanceKm == b.distanceKm && a.slot < b.slot);
+        });
+        if (k > 0 && hits.size() > k) {
+            hits.resize(k);
+        }
+    }
+
+    bool sameHits(const std::vector<GeoIndex::Hit>& a, const std::vector<GeoIndex::Hit>& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].slot != b[i].slot) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = 1000000;
+    int queries = 1000;
+    size_t k = 10;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rows") == 0 && i + 1 < argc) {
+            rows = static_cast<size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+            queries = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--k") == 0 && i + 1 < argc) {
+            k = static_cast<size_t>(std::atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--rows N] [--queries Q] [--k K]\n";
+            return 1;
+        }
+    }
+    if (queries < 1) {
+        queries = 1;
+    }
+
+    std::cout << "Generating " << rows << " located listings...\n";
+    std::vector<House> houses;
+    houses.reserve(rows);
+    unsigned int state = 12345;
+    for (size_t row = 0; row < rows; ++row) {
+        char id[16];
+        std::snprintf(id, sizeof(id), "G%07u", static_cast<unsigned int>(row));
+        double rent = 5000.0 + (nextRandom(state) % 495000);
+        House house(id, TYPES[nextRandom(state) % TYPE_COUNT], rent * 2, rent, 100 + row % 11,
+                    "Bench Estate", "https://maps.google.com/?q=Bench");
+        house.setAvailability(nextRandom(state) % 10 != 0);
+
+        double lat;
+        double lon;
+        randomPoint(state, lat, lon);
+        house.setCoordinates(lat, lon);
+        houses.push_back(house);
+    }
+
+    EntityStore store;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    store.setHouses(std::move(houses));
+    std::cout << "setHouses (indexes included): " << std::fixed << std::setprecision(2)
+              << secondsSince(start) * 1000 << " ms\n\n";
+
+    std::vector<double> lats;
+    std::vector<double> lons;
+    for (int q = 0; q < queries; ++q) {
+        double lat;
+        double lon;
+        randomPoint(state, lat, lon);
+        lats.push_back(lat);
+        lons.push_back(lon);
+    }
+
+    HouseCatalog::Filter any;
+    HouseCatalog::Filter bungalows;
+    bungalows.type = "Bungalow";
+    bungalows.maxRent = 100000;
+    bungalows.availableOnly = true;
+
+    struct Search {
+        const char* name;
+        double radiusKm;          // < 0 for a nearest-k search
+        const HouseCatalog::Filter* filter;
+    };
+    const Search searches[] = {
+        { "within 1 km", 1.0, &any },
+        { "within 5 km", 5.0, &any },
+        { "within 5 km, bungalows <= 100k", 5.0, &bungalows },
+        { "nearest k", -1.0, &any },
+        { "nearest k, bungalows <= 100k", -1.0, &bungalows },
+    };
+    const int SEARCH_COUNT = sizeof(searches) / sizeof(searches[0]);
+
+    // The scan is slow, so only a few queries are checked and timed with it
+    int scanned = std::min(queries, 20);
+
+    std::cout << std::left << std::setw(34) << "search" << std::right << std::setw(12) << "avg hits"
+              << std::setw(14) << "grid us" << std::setw(14) << "scan us" << "\n";
+    std::vector<GeoIndex::Hit> hits;
+    std::vector<GeoIndex::Hit> expected;
+    for (int s = 0; s < SEARCH_COUNT; ++s) {
+        const Search& search = searches[s];
+        size_t total = 0;
+        start = std::chrono::steady_clock::now();
+        for (int q = 0; q < queries; ++q) {
+            if (search.radiusKm >= 0) {
+                store.housesWithin(lats[q], lons[q], search.radiusKm, *search.filter, hits);
+            } else {
+                store.nearestHouses(lats[q], lons[q], k, *search.filter, hits);
+            }
+            total += hits.size();
+        }
+        double gridSeconds = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int q = 0; q < scanned; ++q) {
+            scan(store, lats[q], lons[q], search.radiusKm, search.radiusKm >= 0 ? 0 : k, *search.filter, expected);
+        }
+        double scanSeconds = secondsSince(start);
+
+        for (int q = 0; q < scanned; ++q) {
+            if (search.radiusKm >= 0) {
+                store.housesWithin(lats[q], lons[q], search.radiusKm, *search.filter, hits);
+            } else {
+                store.nearestHouses(lats[q], lons[q], k, *search.filter, hits);
+            }
+            scan(store, lats[q], lons[q], search.radiusKm, search.radiusKm >= 0 ? 0 : k, *search.filter, expected);
+            if (!sameHits(hits, expected)) {
+                std::cerr << "Grid and scan results differ for '" << search.name << "' query " << q << "\n";
+                return 1;
+            }
+        }
+
+        std::cout << std::left << std::setw(34) << search.name << std::right
+                  << std::setw(12) << static_cast<double>(total) / queries
+                  << std::setw(14) << gridSeconds * 1e6 / queries
+                  << std::setw(14) << scanSeconds * 1e6 / scanned << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * M-Boma location autocomplete benchmark
+ *
+ * Fills an EntityStore with synthetic counties and towns (no database
+ * needed) and times EntityStore::completeLocation for typed prefixes of
+ * one to four letters, as a type-ahead would issue them.
+ *
+ * Usage:
+ *   location_complete_bench [--towns N] [--lookups L] [--limit K]
+ *
+ *   --towns N     Towns in the store, spread over 47 counties (default 5000)
+ *   --lookups L   Prefix lookups to time (default 200000)
+ *   --limit K     Most completions per lookup (default 10)
+ */
+
+#include "EntityStore.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+    const char* SYLLABLES[] = { "ka", "ki", "ma", "mu", "na", "ny", "ri", "to", "wa", "ba", "nge", "bu",
+                                "la", "mo", "si", "ta", "ru", "ko", "go", "ji" };
+    const int SYLLABLE_COUNT = sizeof(SYLLABLES) / sizeof(SYLLABLES[0]);
+    const char* SUFFIXES[] = { "", "", "", " Town", " CBD", " East", " West", " Market" };
+    const int SUFFIX_COUNT = sizeof(SUFFIXES) / sizeof(SUFFIXES[0]);
+    const int COUNTIES = 47;
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Small LCG so runs are repeatable
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    std::string makeName(unsigned int& state) {
+        std::string name;
+        int syllables = 2 + nextRandom(state) % 3;
+        for (int i = 0; i < syllables; ++i) {
+            name += SYLLABLES[nextRandom(state) % SYLLABLE_COUNT];
+        }
+        name[0] = static_cast<char>(name[0] - 'a' + 'A');
+        return name;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int towns = 5000;
+    int lookups = 200000;
+    size_t limit = 10;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--towns") == 0 && i + 1 < argc) {
+            towns = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--lookups") == 0 && i + 1 < argc) {
+            lookups = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+            limit = static_cast<size_t>(std::atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--towns N] [--lookups L] [--limit K]\n";
+            return 1;
+        }
+    }
+    if (lookups < 1) {
+        lookups = 1;
+    }
+
+    unsigned int state = 12345;
+    std::vector<Location> locations;
+    for (int county = 1; county <= COUNTIES; ++county) {
+        locations.push_back(Location(county, makeName(state), "county"));
+    }
+    for (int town = 0; town < towns; ++town) {
+        std::string name = makeName(state) + SUFFIXES[nextRandom(state) % SUFFIX_COUNT];
+        locations.push_back(Location(1000 + town, name, "town", 1 + town % COUNTIES));
+    }
+
+    EntityStore store;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    store.setLocations(locations);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << COUNTIES << " counties, " << towns << " towns indexed in " << secondsSince(start) * 1000 << " ms\n";
+
+    // Prefixes cut from real names, so most lookups have matches
+    std::vector<std::string> prefixes;
+    for (int i = 0; i < 1024; ++i) {
+        std::string name = locations[nextRandom(state) % locations.size()].getName();
+        prefixes.push_back(name.substr(0, 1 + nextRandom(state) % 4));
+    }
+
+    for (int scope = 0; scope < 2; ++scope) {
+        size_t results = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; ++i) {
+            const std::string& prefix = prefixes[i % prefixes.size()];
+            if (scope == 0) {
+                results += store.completeLocation(prefix, "town", -1, limit).size();
+            } else {
+                results += store.completeLocation(prefix, "town", 1 + i % COUNTIES, limit).size();
+            }
+        }
+        double seconds = secondsSince(start);
+        std::cout << (scope == 0 ? "all towns:      " : "one county:     ") << seconds * 1e6 / lookups
+                  << " us per lookup, " << static_cast<double>(results) / lookups << " completions on average\n";
+    }
+
+    return 0;
+}
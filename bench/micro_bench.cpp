@@ -0,0 +1,489 @@
+/**
+ * M-Boma hot path microbenchmarks
+ *
+ * Times the small operations every screen and request goes through, with
+ * no database: rows are synthetic char arrays in the MYSQL_ROW layout and
+ * searches run against an EntityStore filled with synthetic listings.
+ *
+ * Per catalog size:
+ *   decode_house_row, decode_search_row, decode_user_row   RowDecoder
+ *   find_house_hit, find_house_miss                        EntityStore::findHouse
+ *   search_type, search_address, search_rent, search_town  the in-memory
+ *       branches of MBomaHousingSystem::findHouses (trigram, rent index,
+ *       town range scan), including building the result houses
+ * Once (size 0), as they do not depend on the catalog:
+ *   hash_password, verify_password, current_datetime, receipt_number,
+ *   format_receipt (Payment::formatReceipt into a string stream)
+ *
+ * Each case is run in batches until a batch takes at least 10 ms; the
+ * median of --runs batches is reported in ns per operation.
+ *
+ * --json writes one flat JSON object per case and line:
+ *   {"bench":"find_house_hit","size":10000,"ops":...,"ns_per_op":...,"min_ns_per_op":...}
+ * --baseline reads such a file from an earlier build and prints the change
+ * of each case; the exit status is 3 if any case got slower than --threshold.
+ *
+ * Usage:
+ *   micro_bench [--sizes N,N,...] [--runs R] [--filter TEXT] [--json FILE]
+ *               [--baseline FILE] [--threshold PCT]
+ *
+ *   --sizes N,...     Catalog sizes (default 1000,10000,100000)
+ *   --runs R          Timed batches per case (default 5)
+ *   --filter TEXT     Only cases whose name contains TEXT
+ *   --json FILE       Write the results as JSON lines
+ *   --baseline FILE   Compare with the JSON lines of an earlier run
+ *   --threshold PCT   Slowdown counted as a regression (default 10)
+ */
+
+#include "EntityStore.h"
+#include "House.h"
+#include "Json.h"
+#include "Payment.h"
+#include "RowDecoder.h"
+#include "User.h"
+#include "Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    const char* TYPES[] = { "Bungalow", "Mansionette", "Appartments & Flats", "Bedsitters", "Singles" };
+    const int TYPE_COUNT = sizeof(TYPES) / sizeof(TYPES[0]);
+    const char* STREETS[] = { "Ngong Road", "Kenyatta Avenue", "Moi Avenue", "Thika Road", "Jogoo Road",
+                              "Waiyaki Way", "Lenana Road", "Argwings Kodhek Road" };
+    const int STREET_COUNT = sizeof(STREETS) / sizeof(STREETS[0]);
+    const int TOWNS[] = { 100, 101, 102, 103, 104, 200, 201, 202, 300, 301, 401 };
+    const int TOWN_COUNT = sizeof(TOWNS) / sizeof(TOWNS[0]);
+
+    const size_t PROBES = 4096;               // Precomputed random row indexes, a power of two
+    const double MIN_BATCH_SECONDS = 0.01;
+
+    // Results are folded in here so the compiler cannot drop the work
+    volatile size_t sink = 0;
+
+    struct Result {
+        std::string name;
+        size_t size;
+        unsigned long long ops;
+        double nsPerOp;
+        double minNsPerOp;
+    };
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Small LCG so runs are repeatable without <random> overhead per row
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    /**
+     * @brief Time op(i) for i = 0, 1, ... and record ns per call
+     */
+    template <typename Op>
+    void measure(const std::string& name, size_t size, int runs, Op op, std::vector<Result>& results) {
+        unsigned long long batch = 1;
+        while (true) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (unsigned long long i = 0; i < batch; ++i) {
+                sink += op(i);
+            }
+            if (secondsSince(start) >= MIN_BATCH_SECONDS || batch >= (1ULL << 40)) {
+                break;
+            }
+            batch *= 2;
+        }
+
+        std::vector<double> samples;
+        for (int run = 0; run < runs; ++run) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (unsigned long long i = 0; i < batch; ++i) {
+                sink += op(i);
+            }
+            samples.push_back(secondsSince(start) * 1e9 / batch);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        Result result = { name, size, batch * runs, samples[samples.size() / 2], samples[0] };
+        results.push_back(result);
+        std::cout << std::left << std::setw(20) << name << std::right << std::setw(10) << size
+                  << std::fixed << std::setprecision(1) << std::setw(14) << result.nsPerOp
+                  << std::setw(14) << result.minNsPerOp << "\n";
+    }
+
+    bool wanted(const std::string& filter, const char* name) {
+        return filter.empty() || std::strstr(name, filter.c_str()) != nullptr;
+    }
+
+    House makeHouse(size_t row, unsigned int& state) {
+        char id[16];
+        std::snprintf(id, sizeof(id), "M%07u", static_cast<unsigned int>(row));
+        char address[96];
+        std::snprintf(address, sizeof(address), "Plot %u, %s", nextRandom(state) % 10000,
+                      STREETS[nextRandom(state) % STREET_COUNT]);
+        double rent = 5000.0 + (nextRandom(state) % 495000);
+
+        House house(id, TYPES[nextRandom(state) % TYPE_COUNT], rent * 2, rent,
+                    TOWNS[nextRandom(state) % TOWN_COUNT], address, "https://maps.google.com/?q=-1.2921,36.8219");
+        house.setAvailability(nextRandom(state) % 10 != 0);
+        return house;
+    }
+
+    /**
+     * @brief Text rows as mysql_fetch_row returns them; row pointers point into one arena
+     */
+    class RowSet {
+    private:
+        std::vector<std::string> cells;
+        std::vector<char*> pointers;
+        size_t columns;
+
+    public:
+        explicit RowSet(size_t columns) : columns(columns) {}
+
+        void add(const std::vector<std::string>& row) {
+            cells.insert(cells.end(), row.begin(), row.end());
+        }
+
+        // Call once every row is added
+        void seal() {
+            pointers.resize(cells.size());
+            for (size_t i = 0; i < cells.size(); ++i) {
+                pointers[i] = cells[i] == "\\N" ? nullptr : &cells[i][0];
+            }
+        }
+
+        MYSQL_ROW row(size_t index) {
+            return &pointers[index * columns];
+        }
+
+        size_t size() const {
+            return columns ? cells.size() / columns : 0;
+        }
+    };
+
+    std::string number(double value) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.2f", value);
+        return buffer;
+    }
+
+    void benchCatalog(size_t size, int runs, const std::string& filterText, std::vector<Result>& results) {
+        unsigned int state = 12345;
+        std::vector<House> houses;
+        houses.reserve(size);
+        for (size_t row = 0; row < size; ++row) {
+            houses.push_back(makeHouse(row, state));
+        }
+
+        std::vector<size_t> probes(PROBES);
+        for (size_t i = 0; i < PROBES; ++i) {
+            probes[i] = nextRandom(state) % size;
+        }
+        const size_t mask = PROBES - 1;
+
+        // Row decoding, in the column order of the houses, search and user_info queries
+        if (wanted(filterText, "decode_house_row")) {
+            RowSet rows(12);
+            for (size_t i = 0; i < size; ++i) {
+                const House& house = houses[i];
+                rows.add({ house.getId(), house.getType(), std::to_string(house.getLocationId()), house.getAddress(),
+                           house.getMapLink(), number(house.getDepositFee()), number(house.getMonthlyRent()),
+                           house.getAvailability() ? "1" : "0", i % 4 == 0 ? "1" : "0",
+                           i % 4 == 0 ? "2026-01-01 12:00:00" : "\\N", "-1.292100", "36.821900" });
+            }
+            rows.seal();
+            measure("decode_house_row", size, runs, [&](unsigned long long i) {
+                return decodeHouseRow(rows.row(probes[i & mask])).getId().size();
+            }, results);
+        }
+        if (wanted(filterText, "decode_search_row")) {
+            RowSet rows(7);
+            for (size_t i = 0; i < size; ++i) {
+                const House& house = houses[i];
+                rows.add({ house.getId(), house.getType(), number(house.getDepositFee()), number(house.getMonthlyRent()),
+                           std::to_string(house.getLocationId()), house.getAddress(), house.getMapLink() });
+            }
+            rows.seal();
+            measure("decode_search_row", size, runs, [&](unsigned long long i) {
+                return decodeSearchRow(rows.row(probes[i & mask])).getId().size();
+            }, results);
+        }
+        if (wanted(filterText, "decode_user_row")) {
+            RowSet rows(5);
+            std::string hash = hashPassword("mboma123");
+            for (size_t i = 0; i < size; ++i) {
+                rows.add({ std::to_string(i + 1), "Wanjiku Kamau", "0712345678",
+                           "user" + std::to_string(i + 1) + "@mboma.ke", hash });
+            }
+            rows.seal();
+            measure("decode_user_row", size, runs, [&](unsigned long long i) {
+                return decodeUserRow(rows.row(probes[i & mask])).getEmail().size();
+            }, results);
+        }
+
+        std::vector<std::string> hitIds(PROBES);
+        std::vector<std::string> missIds(PROBES);
+        for (size_t i = 0; i < PROBES; ++i) {
+            hitIds[i] = houses[probes[i]].getId();
+            missIds[i] = "X" + hitIds[i].substr(1);
+        }
+        EntityStore store;
+        store.setHouses(std::move(houses));
+
+        if (wanted(filterText, "find_house_hit")) {
+            measure("find_house_hit", size, runs, [&](unsigned long long i) {
+                return store.findHouse(hitIds[i & mask]) != nullptr;
+            }, results);
+        }
+        if (wanted(filterText, "find_house_miss")) {
+            measure("find_house_miss", size, runs, [&](unsigned long long i) {
+                return store.findHouse(missIds[i & mask]) != nullptr;
+            }, results);
+        }
+
+        // The findHouses branches: type or address text through the trigram indexes
+        if (wanted(filterText, "search_type")) {
+            measure("search_type", size, runs, [&](unsigned long long i) {
+                std::vector<size_t> slots;
+                store.matchText(TYPES[i % TYPE_COUNT], "", slots);
+                std::vector<House> found;
+                for (size_t s = 0; s < slots.size(); ++s) {
+                    const House& house = store.house(slots[s]);
+                    if (EntityStore::isOpen(house) && house.getLocationId() == TOWNS[i % TOWN_COUNT]) {
+                        found.push_back(house);
+                    }
+                }
+                return found.size();
+            }, results);
+        }
+        if (wanted(filterText, "search_address")) {
+            measure("search_address", size, runs, [&](unsigned long long i) {
+                std::vector<size_t> slots;
+                store.matchText("", STREETS[i % STREET_COUNT], slots);
+                std::vector<House> found;
+                for (size_t s = 0; s < slots.size(); ++s) {
+                    const House& house = store.house(slots[s]);
+                    if (EntityStore::isOpen(house) && house.getLocationId() == TOWNS[i % TOWN_COUNT]) {
+                        found.push_back(house);
+                    }
+                }
+                return found.size();
+            }, results);
+        }
+
+        // Rent band in one town through the rent index, cheapest first
+        if (wanted(filterText, "search_rent")) {
+            measure("search_rent", size, runs, [&](unsigned long long i) {
+                double minRent = 20000.0 + (i % 16) * 10000.0;
+                PriceIndex::Range range = store.byRent().range(TOWNS[i % TOWN_COUNT], minRent, minRent + 20000.0);
+                std::vector<House> found;
+                for (PriceIndex::Iterator it = range.first; it != range.second; ++it) {
+                    const House* house = store.findHouse(it->second);
+                    if (house) {
+                        found.push_back(*house);
+                    }
+                }
+                return found.size();
+            }, results);
+        }
+
+        // No text and no rent: a catalog scan over one town's rows
+        if (wanted(filterText, "search_town")) {
+            measure("search_town", size, runs, [&](unsigned long long i) {
+                HouseCatalog::Filter filter;
+                filter.townId = TOWNS[i % TOWN_COUNT];
+                filter.availableOnly = true;
+                filter.unbookedOnly = true;
+                EntityStore::SlotRange rows = store.housesInTown(filter.townId);
+                HouseCatalog::Bitmap selection;
+                store.houseCatalog().select(filter, selection, rows.first, rows.second);
+                return store.houseCatalog().materialize(selection).size();
+            }, results);
+        }
+    }
+
+    void benchUtilities(int runs, const std::string& filterText, std::vector<Result>& results) {
+        std::string hash = hashPassword("mboma123");
+
+        if (wanted(filterText, "hash_password")) {
+            measure("hash_password", 0, runs, [](unsigned long long) {
+                return hashPassword("mboma123").size();
+            }, results);
+        }
+        if (wanted(filterText, "verify_password")) {
+            measure("verify_password", 0, runs, [&hash](unsigned long long) {
+                return static_cast<size_t>(verifyPassword("mboma123", hash));
+            }, results);
+        }
+        if (wanted(filterText, "current_datetime")) {
+            measure("current_datetime", 0, runs, [](unsigned long long) {
+                return getCurrentDateTime().size();
+            }, results);
+        }
+        if (wanted(filterText, "receipt_number")) {
+            measure("receipt_number", 0, runs, [](unsigned long long) {
+                return generateReceiptNumber().size();
+            }, results);
+        }
+        if (wanted(filterText, "format_receipt")) {
+            User user("Wanjiku Kamau", "0712345678", "wanjiku@example.com", "mboma123");
+            House house("RB01", "Bungalow", 120000, 60000, 100, "Plot 12, Ngong Road, Nairobi",
+                        "https://maps.google.com/?q=-1.2921,36.8219");
+            Payment payment(1, 1, 120000, "M-Pesa");
+            std::ostringstream out;
+            measure("format_receipt", 0, runs, [&](unsigned long long) {
+                out.str("");
+                payment.formatReceipt(out, user, house);
+                return static_cast<size_t>(out.tellp());
+            }, results);
+        }
+    }
+
+    bool writeJson(const std::string& path, const std::vector<Result>& results) {
+        std::ofstream out(path.c_str(), std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        for (size_t i = 0; i < results.size(); ++i) {
+            JsonWriter json;
+            json.beginObject()
+                .key("bench").value(results[i].name)
+                .key("size").value(static_cast<unsigned long long>(results[i].size))
+                .key("ops").value(results[i].ops)
+                .key("ns_per_op").value(results[i].nsPerOp, 1)
+                .key("min_ns_per_op").value(results[i].minNsPerOp, 1)
+                .endObject();
+            out << json.str() << "\n";
+        }
+        out.close();
+        return !out.fail();
+    }
+
+    /**
+     * @brief Print the change of each case against an earlier run
+     * @return Number of cases slower by more than the threshold, -1 if the file cannot be read
+     */
+    int compareBaseline(const std::string& path, const std::vector<Result>& results, double thresholdPercent) {
+        std::ifstream in(path.c_str());
+        if (!in.is_open()) {
+            return -1;
+        }
+        std::map<std::pair<std::string, size_t>, double> baseline;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::map<std::string, std::string> fields;
+            std::string error;
+            if (parseJsonObject(line, fields, error) && fields.count("bench") && fields.count("ns_per_op")) {
+                size_t size = static_cast<size_t>(std::strtoull(fields["size"].c_str(), nullptr, 10));
+                baseline[std::make_pair(fields["bench"], size)] = std::strtod(fields["ns_per_op"].c_str(), nullptr);
+            }
+        }
+
+        int regressions = 0;
+        std::cout << "\nAgainst " << path << ":\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::map<std::pair<std::string, size_t>, double>::const_iterator it =
+                baseline.find(std::make_pair(results[i].name, results[i].size));
+            std::cout << std::left << std::setw(20) << results[i].name << std::right << std::setw(10) << results[i].size;
+            if (it == baseline.end() || it->second <= 0) {
+                std::cout << std::setw(14) << "new" << "\n";
+                continue;
+            }
+            double change = (results[i].nsPerOp - it->second) * 100.0 / it->second;
+            std::cout << std::fixed << std::setprecision(1) << std::setw(13) << std::showpos << change << "%"
+                      << std::noshowpos;
+            if (change > thresholdPercent) {
+                std::cout << "  REGRESSION";
+                ++regressions;
+            }
+            std::cout << "\n";
+        }
+        return regressions;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes;
+    int runs = 5;
+    std::string filterText;
+    std::string jsonPath;
+    std::string baselinePath;
+    double thresholdPercent = 10.0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                size_t size = static_cast<size_t>(std::atoll(item.c_str()));
+                if (size > 0) {
+                    sizes.push_back(size);
+                }
+            }
+        } else if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filterText = argv[++i];
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            thresholdPercent = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--sizes N,N,...] [--runs R] [--filter TEXT] [--json FILE]\n"
+                      << "       [--baseline FILE] [--threshold PCT]\n";
+            return 1;
+        }
+    }
+    if (sizes.empty()) {
+        sizes.push_back(1000);
+        sizes.push_back(10000);
+        sizes.push_back(100000);
+    }
+    if (runs < 1) {
+        runs = 1;
+    }
+
+    std::vector<Result> results;
+    std::cout << std::left << std::setw(20) << "case" << std::right << std::setw(10) << "size"
+              << std::setw(14) << "ns/op" << std::setw(14) << "min ns/op" << "\n";
+    benchUtilities(runs, filterText, results);
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchCatalog(sizes[i], runs, filterText, results);
+    }
+
+    if (!jsonPath.empty()) {
+        if (!writeJson(jsonPath, results)) {
+            std::cerr << "Cannot write " << jsonPath << "\n";
+            return 1;
+        }
+        std::cout << "Wrote " << results.size() << " results to " << jsonPath << "\n";
+    }
+    if (!baselinePath.empty()) {
+        int regressions = compareBaseline(baselinePath, results, thresholdPercent);
+        if (regressions < 0) {
+            std::cerr << "Cannot read " << baselinePath << "\n";
+            return 1;
+        }
+        if (regressions > 0) {
+            std::cout << regressions << " cases slower than the baseline by more than "
+                      << thresholdPercent << "%\n";
+            return 3;
+        }
+    }
+    return 0;
+}
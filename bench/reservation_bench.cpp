@@ -0,0 +1,207 @@
+/**
+ * M-Boma concurrent reservation benchmark
+ *
+ * Many threads race to book a few popular houses (no database needed).
+ * Each attempt holds a house, "commits" it, confirms the hold and later
+ * frees the house again, as an expiry would. Every confirmed booking is
+ * checked for exclusivity: no two threads may own a house at once. The
+ * same workload is then run against a table guarded by one global mutex,
+ * which is what the unsynchronized check-then-book path would need.
+ *
+ * Usage:
+ *   reservation_bench [--threads T] [--houses H] [--hot K] [--attempts A]
+ *
+ *   --threads T    Racing sessions (default 8)
+ *   --houses H     Houses in the table (default 100000)
+ *   --hot K        Popular houses that get nine in ten attempts (default 16)
+ *   --attempts A   Booking attempts per thread (default 1000000)
+ */
+
+#include "ReservationTable.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Small LCG so runs are repeatable
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    // Baseline: the same operations under one lock
+    class LockedTable {
+        std::mutex mutex;
+        std::unordered_map<std::string, int> states;   // 0 free, 1 held, 2 booked
+
+    public:
+        void add(const std::string& houseId) { states[houseId] = 0; }
+
+        bool hold(const std::string& houseId) {
+            std::lock_guard<std::mutex> lock(mutex);
+            int& state = states[houseId];
+            if (state != 0) {
+                return false;
+            }
+            state = 1;
+            return true;
+        }
+
+        void confirm(const std::string& houseId) {
+            std::lock_guard<std::mutex> lock(mutex);
+            states[houseId] = 2;
+        }
+
+        void markFree(const std::string& houseId) {
+            std::lock_guard<std::mutex> lock(mutex);
+            states[houseId] = 0;
+        }
+    };
+
+    struct Result {
+        double seconds;
+        unsigned long long bookings;
+        bool exclusive;
+    };
+
+    // Runs the attempts; owners[h] must go -1 -> thread -> -1 around every booking
+    template <typename Hold, typename Confirm, typename Free>
+    Result race(int threads, int attempts, const std::vector<std::string>& ids, size_t hot,
+                Hold hold, Confirm confirm, Free markFree) {
+        std::vector<std::atomic<int> > owners(ids.size());
+        for (size_t i = 0; i < owners.size(); ++i) {
+            owners[i] = -1;
+        }
+        std::atomic<unsigned long long> bookings(0);
+        std::atomic<bool> exclusive(true);
+
+        std::vector<std::thread> workers;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.push_back(std::thread([&, t]() {
+                unsigned int state = 1000 + t;
+                unsigned long long won = 0;
+                for (int i = 0; i < attempts; ++i) {
+                    size_t house = nextRandom(state) % 10 < 9 ? nextRandom(state) % hot
+                                                              : nextRandom(state) % ids.size();
+                    if (!hold(ids[house])) {
+                        continue;
+                    }
+                    int expected = -1;
+                    if (!owners[house].compare_exchange_strong(expected, t)) {
+                        exclusive = false;
+                    }
+                    confirm(ids[house]);
+                    ++won;
+
+                    // Give the house back straight away, as if the booking expired
+                    expected = t;
+                    if (!owners[house].compare_exchange_strong(expected, -1)) {
+                        exclusive = false;
+                    }
+                    markFree(ids[house]);
+                }
+                bookings += won;
+            }));
+        }
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i].join();
+        }
+
+        Result result;
+        result.seconds = secondsSince(start);
+        result.bookings = bookings;
+        result.exclusive = exclusive;
+        return result;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int threads = 8;
+    size_t houses = 100000;
+    size_t hot = 16;
+    int attempts = 1000000;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--houses") == 0 && i + 1 < argc) {
+            houses = static_cast<size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--hot") == 0 && i + 1 < argc) {
+            hot = static_cast<size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--attempts") == 0 && i + 1 < argc) {
+            attempts = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--threads T] [--houses H] [--hot K] [--attempts A]\n";
+            return 1;
+        }
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (houses < 1) {
+        houses = 1;
+    }
+    if (hot < 1 || hot > houses) {
+        hot = houses;
+    }
+
+    std::vector<std::string> ids;
+    ReservationTable table;
+    LockedTable locked;
+    for (size_t i = 0; i < houses; ++i) {
+        char id[16];
+        std::snprintf(id, sizeof(id), "R%07u", static_cast<unsigned int>(i));
+        ids.push_back(id);
+        table.add(id, false);
+        locked.add(id);
+    }
+
+    std::cout << threads << " threads, " << attempts << " attempts each, " << hot << " hot houses of " << houses << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+
+    // Token by house: only the thread holding a house touches its entry
+    std::vector<ReservationTable::Token> tokens(houses, 0);
+    Result lockFree = race(threads, attempts, ids, hot,
+        [&](const std::string& id) {
+            ReservationTable::Token token = table.hold(id, 60);
+            if (token) {
+                tokens[std::atoi(id.c_str() + 1)] = token;
+            }
+            return token != 0;
+        },
+        [&](const std::string& id) { table.confirm(id, tokens[std::atoi(id.c_str() + 1)]); },
+        [&](const std::string& id) { table.markFree(id); });
+
+    Result global = race(threads, attempts, ids, hot,
+        [&](const std::string& id) { return locked.hold(id); },
+        [&](const std::string& id) { locked.confirm(id); },
+        [&](const std::string& id) { locked.markFree(id); });
+
+    const Result* results[] = { &lockFree, &global };
+    const char* names[] = { "compare-and-swap", "global mutex" };
+    for (int r = 0; r < 2; ++r) {
+        if (!results[r]->exclusive) {
+            std::cerr << names[r] << ": two sessions owned the same house\n";
+            return 1;
+        }
+        std::cout << std::left << std::setw(18) << names[r] << std::right
+                  << std::setw(12) << results[r]->bookings << " bookings, "
+                  << std::setw(8) << threads * static_cast<double>(attempts) / results[r]->seconds / 1e6
+                  << " M attempts/s\n";
+    }
+    return 0;
+}
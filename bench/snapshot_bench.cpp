@@ -0,0 +1,258 @@
+/**
+ * M-Boma snapshot catalog benchmark
+ *
+ * Reader threads look up houses and scan towns while one writer books and
+ * frees houses and now and then reloads the whole catalog (no database
+ * needed). Readers check every snapshot they pin: its version never goes
+ * back, it holds every house, a town's houses belong to that town and a
+ * looked-up house has the ID asked for. The same workload is then run
+ * against one vector guarded by a mutex, as EntityStore would need if it
+ * were shared as it is.
+ *
+ * Usage:
+ *   snapshot_bench [--readers R] [--houses H] [--towns T] [--seconds S] [--reload-every N]
+ *
+ *   --readers R       Reader threads (default 4)
+ *   --houses H        Houses in the catalog (default 100000)
+ *   --towns T         Towns the houses are spread over (default 500)
+ *   --seconds S       Length of each run (default 3)
+ *   --reload-every N  Full reload after every N house updates (default 1000)
+ */
+
+#include "SnapshotCatalog.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    // Small LCG so runs are repeatable
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    std::string houseId(size_t i) {
+        char id[16];
+        std::snprintf(id, sizeof(id), "S%07u", static_cast<unsigned int>(i));
+        return id;
+    }
+
+    // Baseline: the houses grouped by town, every access under one lock
+    class LockedCatalog {
+        std::mutex mutex;
+        std::vector<House> houses;
+        std::unordered_map<std::string, size_t> slots;
+        size_t perTown;
+
+    public:
+        LockedCatalog(const std::vector<House>& all, size_t townSize) : houses(all), perTown(townSize) {
+            for (size_t i = 0; i < houses.size(); ++i) {
+                slots[houses[i].getId()] = i;
+            }
+        }
+
+        size_t scanTown(int townId) {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t open = 0;
+            size_t first = (townId - 1) * perTown;
+            for (size_t i = first; i < first + perTown && i < houses.size(); ++i) {
+                open += houses[i].getBookingStatus() ? 0 : 1;
+            }
+            return open;
+        }
+
+        bool lookup(const std::string& id) {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::unordered_map<std::string, size_t>::const_iterator slot = slots.find(id);
+            return slot != slots.end() && houses[slot->second].getId() == id;
+        }
+
+        void put(size_t slot, const House& house) {
+            std::lock_guard<std::mutex> lock(mutex);
+            houses[slot] = house;
+        }
+
+        void reload(const std::vector<House>& all) {
+            std::lock_guard<std::mutex> lock(mutex);
+            houses = all;
+        }
+    };
+
+    struct Result {
+        unsigned long long reads;
+        unsigned long long writes;
+        bool consistent;
+    };
+
+    // Runs readers against one writer for a fixed time
+    template <typename Read, typename Write>
+    Result race(int readers, double seconds, Read read, Write write) {
+        std::atomic<bool> stop(false);
+        std::atomic<unsigned long long> reads(0);
+        std::atomic<bool> consistent(true);
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < readers; ++t) {
+            workers.push_back(std::thread([&, t]() {
+                unsigned int state = 2000 + t;
+                unsigned long long done = 0;
+                unsigned long long lastVersion = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    if (!read(state, lastVersion)) {
+                        consistent = false;
+                    }
+                    ++done;
+                }
+                reads += done;
+            }));
+        }
+
+        unsigned long long writes = 0;
+        unsigned int state = 1;
+        std::chrono::steady_clock::time_point end =
+            std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<long long>(seconds * 1e6));
+        while (std::chrono::steady_clock::now() < end) {
+            write(state, writes);
+            ++writes;
+        }
+        stop = true;
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i].join();
+        }
+
+        Result result;
+        result.reads = reads;
+        result.writes = writes;
+        result.consistent = consistent;
+        return result;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int readers = 4;
+    size_t houses = 100000;
+    int towns = 500;
+    double seconds = 3.0;
+    unsigned long long reloadEvery = 1000;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--readers") == 0 && i + 1 < argc) {
+            readers = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--houses") == 0 && i + 1 < argc) {
+            houses = static_cast<size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--towns") == 0 && i + 1 < argc) {
+            towns = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--reload-every") == 0 && i + 1 < argc) {
+            reloadEvery = static_cast<unsigned long long>(std::atoll(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--readers R] [--houses H] [--towns T] [--seconds S] [--reload-every N]\n";
+            return 1;
+        }
+    }
+    if (readers < 1) {
+        readers = 1;
+    }
+    if (towns < 1) {
+        towns = 1;
+    }
+    if (houses < static_cast<size_t>(towns)) {
+        houses = towns;
+    }
+    if (reloadEvery < 1) {
+        reloadEvery = 1;
+    }
+
+    // Town N holds houses (N - 1) * perTown onwards
+    size_t perTown = (houses + towns - 1) / towns;
+    std::vector<House> all;
+    all.reserve(houses);
+    for (size_t i = 0; i < houses; ++i) {
+        all.push_back(House(houseId(i), "Bedsitter", 5000.0, 8000.0, static_cast<int>(i / perTown) + 1,
+                            "Plot " + std::to_string(i), ""));
+    }
+    towns = static_cast<int>((houses + perTown - 1) / perTown);
+
+    std::cout << readers << " readers, 1 writer, " << houses << " houses in " << towns << " towns, reload every "
+              << reloadEvery << " updates\n";
+    std::cout << std::fixed << std::setprecision(2);
+
+    SnapshotCatalog catalog;
+    catalog.publish(all);
+    Result snapshots = race(readers, seconds,
+        [&](unsigned int& state, unsigned long long& lastVersion) {
+            SnapshotCatalog::ReadGuard snapshot = catalog.read();
+            bool ok = snapshot->version() >= lastVersion && snapshot->houseCount() == houses;
+            lastVersion = snapshot->version();
+
+            int townId = static_cast<int>(nextRandom(state) % towns) + 1;
+            const std::vector<House>& town = snapshot->town(townId);
+            size_t open = 0;
+            for (size_t i = 0; i < town.size(); ++i) {
+                open += town[i].getBookingStatus() ? 0 : 1;
+            }
+            ok = ok && !town.empty() && town.front().getLocationId() == townId && town.back().getLocationId() == townId;
+
+            size_t slot = nextRandom(state) % houses;
+            std::string id = houseId(slot);
+            const House* house = snapshot->findHouse(id);
+            return ok && open <= town.size() && house && house->getId() == id;
+        },
+        [&](unsigned int& state, unsigned long long writes) {
+            if ((writes + 1) % reloadEvery == 0) {
+                catalog.publish(all);
+                return;
+            }
+            House house = all[nextRandom(state) % houses];
+            if (nextRandom(state) % 2) {
+                house.book("2030-01-01");
+            }
+            catalog.putHouse(house);
+        });
+    size_t pending = catalog.retiredCount();
+
+    LockedCatalog locked(all, perTown);
+    Result global = race(readers, seconds,
+        [&](unsigned int& state, unsigned long long&) {
+            int townId = static_cast<int>(nextRandom(state) % towns) + 1;
+            locked.scanTown(townId);
+            return locked.lookup(houseId(nextRandom(state) % houses));
+        },
+        [&](unsigned int& state, unsigned long long writes) {
+            if ((writes + 1) % reloadEvery == 0) {
+                locked.reload(all);
+                return;
+            }
+            size_t slot = nextRandom(state) % houses;
+            House house = all[slot];
+            if (nextRandom(state) % 2) {
+                house.book("2030-01-01");
+            }
+            locked.put(slot, house);
+        });
+
+    const Result* results[] = { &snapshots, &global };
+    const char* names[] = { "snapshots", "global mutex" };
+    for (int r = 0; r < 2; ++r) {
+        if (!results[r]->consistent) {
+            std::cerr << names[r] << ": a reader saw an inconsistent catalog\n";
+            return 1;
+        }
+        std::cout << std::left << std::setw(14) << names[r] << std::right
+                  << std::setw(10) << results[r]->reads / seconds / 1e3 << " k reads/s, "
+                  << std::setw(10) << results[r]->writes / seconds / 1e3 << " k updates/s\n";
+    }
+    std::cout << "Versions published: " << catalog.version() << ", still retired after the run: " << pending << "\n";
+    return 0;
+}
@@ -0,0 +1,190 @@
+/**
+ * M-Boma text search benchmark
+ *
+ * Fills an EntityStore with synthetic listings (no database needed) and
+ * times substring search over house types and addresses two ways: a
+ * case-insensitive scan of every house, which is what LIKE '%text%' does,
+ * and EntityStore::matchText, which intersects trigram posting lists and
+ * checks only the candidates. With --mysql the same searches are also run
+ * through DBConnector::searchHouses against the configured database.
+ *
+ * Usage:
+ *   text_search_bench [--rows N] [--runs R] [--mysql]
+ *
+ *   --rows N    Listings in the store (default 1000000)
+ *   --runs R    Timed runs per search; the best run is reported (default 5)
+ *   --mysql     Also time the LIKE queries on the database's houses table
+ */
+
+#include "EntityStore.h"
+#include "DBConnector.h"
+#include "DBConfig.h"
+#include "Utils.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+    const char* TYPES[] = { "Bungalow", "Mansionette", "Appartments & Flats", "Bedsitters", "Singles" };
+    const int TYPE_COUNT = sizeof(TYPES) / sizeof(TYPES[0]);
+    const char* STREETS[] = { "Ngong Road", "Kenyatta Avenue", "Moi Avenue", "Thika Road", "Waiyaki Way",
+                              "Kimathi Street", "Argwings Kodhek Road", "Lenana Road", "Oloitokitok Road",
+                              "Muthaiga Road", "Riverside Drive", "Jogoo Road", "Mombasa Road", "Likoni Road",
+                              "Nyali Road", "Oginga Odinga Street", "Kisumu-Kakamega Road", "Kenyatta Highway" };
+    const int STREET_COUNT = sizeof(STREETS) / sizeof(STREETS[0]);
+    const char* AREAS[] = { "Kilimani", "Westlands", "Karen", "Lavington", "Kileleshwa", "Parklands",
+                            "South B", "Embakasi", "Nyali", "Bamburi", "Milimani", "Kondele", "Langata" };
+    const int AREA_COUNT = sizeof(AREAS) / sizeof(AREAS[0]);
+    const int TOWNS[] = { 100, 101, 102, 103, 104, 200, 201, 202, 300, 301, 401 };
+    const int TOWN_COUNT = sizeof(TOWNS) / sizeof(TOWNS[0]);
+
+    // From most to least selective
+    struct Query {
+        const char* type;
+        const char* address;
+    };
+    const Query QUERIES[] = {
+        { "", "Plot 4321," },
+        { "", "Lenana Road, Karen" },
+        { "bungalow", "riverside" },
+        { "", "kondele" },
+        { "Mansion", "" },
+        { "", "Road" },
+    };
+    const int QUERY_COUNT = sizeof(QUERIES) / sizeof(QUERIES[0]);
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Small LCG so runs are repeatable without <random> overhead per row
+    unsigned int nextRandom(unsigned int& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    House makeHouse(size_t row, unsigned int& state) {
+        char id[16];
+        std::snprintf(id, sizeof(id), "T%07u", static_cast<unsigned int>(row));
+        char address[96];
+        std::snprintf(address, sizeof(address), "Plot %u, %s, %s",
+                      nextRandom(state) % 10000, STREETS[nextRandom(state) % STREET_COUNT],
+                      AREAS[nextRandom(state) % AREA_COUNT]);
+        double rent = 5000.0 + (nextRandom(state) % 495000);
+
+        return House(id, TYPES[nextRandom(state) % TYPE_COUNT], rent * 2, rent,
+                     TOWNS[nextRandom(state) % TOWN_COUNT], address, "https://maps.google.com/?q=Bench");
+    }
+
+    template <typename Search>
+    double best(int runs, Search search) {
+        double bestSeconds = -1;
+        for (int run = 0; run < runs; ++run) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            search();
+            double seconds = secondsSince(start);
+            if (bestSeconds < 0 || seconds < bestSeconds) {
+                bestSeconds = seconds;
+            }
+        }
+        return bestSeconds;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = 1000000;
+    int runs = 5;
+    bool mysql = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rows") == 0 && i + 1 < argc) {
+            rows = static_cast<size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--mysql") == 0) {
+            mysql = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--rows N] [--runs R] [--mysql]\n";
+            return 1;
+        }
+    }
+    if (runs < 1) {
+        runs = 1;
+    }
+
+    std::cout << "Generating " << rows << " listings...\n";
+    std::vector<House> houses;
+    houses.reserve(rows);
+    unsigned int state = 12345;
+    for (size_t row = 0; row < rows; ++row) {
+        houses.push_back(makeHouse(row, state));
+    }
+
+    EntityStore store;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    store.setHouses(std::move(houses));
+    std::cout << "setHouses (indexes included): " << std::fixed << std::setprecision(2)
+              << secondsSince(start) * 1000 << " ms\n\n";
+
+    std::cout << std::left << std::setw(34) << "search" << std::right << std::setw(10) << "matches"
+              << std::setw(12) << "scan ms" << std::setw(12) << "trigram ms" << "\n";
+
+    std::vector<size_t> slots;
+    for (int q = 0; q < QUERY_COUNT; ++q) {
+        std::string type = QUERIES[q].type;
+        std::string address = QUERIES[q].address;
+
+        // The LIKE plan: test every row
+        size_t scanned = 0;
+        double scanSeconds = best(runs, [&]() {
+            scanned = 0;
+            for (size_t slot = 0; slot < store.houseCount(); ++slot) {
+                const House& house = store.house(slot);
+                if (containsIgnoreCase(house.getType(), type) && containsIgnoreCase(house.getAddress(), address)) {
+                    ++scanned;
+                }
+            }
+        });
+
+        double indexSeconds = best(runs, [&]() {
+            store.matchText(type, address, slots);
+        });
+        if (slots.size() != scanned) {
+            std::cerr << "Trigram and scan results differ for '" << type << "' / '" << address << "'\n";
+            return 1;
+        }
+
+        std::string label = "type '" + type + "' address '" + address + "'";
+        std::cout << std::left << std::setw(34) << label << std::right << std::setw(10) << scanned
+                  << std::setw(12) << scanSeconds * 1000 << std::setw(12) << indexSeconds * 1000 << "\n";
+    }
+
+    if (mysql) {
+        DBConnector db;
+        if (!db.connect(DBConfig::DB_HOST, DBConfig::DB_USER, DBConfig::DB_PASS, DBConfig::DB_NAME)) {
+            std::cerr << "Connection failed: " << db.getLastError() << "\n";
+            return 1;
+        }
+
+        std::cout << "\nDatabase LIKE search (houses table as loaded):\n";
+        for (int q = 0; q < QUERY_COUNT; ++q) {
+            std::string type = QUERIES[q].type;
+            std::string address = QUERIES[q].address;
+            size_t count = 0;
+            double seconds = best(runs, [&]() {
+                count = db.searchHouses(type, 0.0, -1.0, -1, address).size();
+            });
+            std::string label = "type '" + type + "' address '" + address + "'";
+            std::cout << std::left << std::setw(34) << label << std::right << std::setw(10) << count
+                      << std::setw(12) << seconds * 1000 << "\n";
+        }
+        db.disconnect();
+    }
+
+    return 0;
+}
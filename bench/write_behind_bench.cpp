@@ -0,0 +1,231 @@
+/**
+ * M-Boma write-behind benchmark
+ *
+ * Records payments from several threads, first with the synchronous
+ * DBConnector::recordPayment (one transaction per payment) and then
+ * through the group-commit WriteBehindQueue, and reports payments and
+ * commits per second for both.
+ *
+ * A booking can be paid only once, so every payment pays its own
+ * synthetic booking. They are created for the run on one existing house
+ * and removed afterwards together with their payments.
+ *
+ * Usage:
+ *   write_behind_bench [--threads T] [--payments N] [--batch B] [--linger MS]
+ *
+ *   --threads T    Concurrent writer threads (default 8)
+ *   --payments N   Payments per thread and mode (default 500)
+ *   --batch B      Write-behind batch size (default DBConfig::WRITE_BEHIND_MAX_BATCH)
+ *   --linger MS    Write-behind linger time (default DBConfig::WRITE_BEHIND_LINGER_MS)
+ */
+
+#include "DBConnector.h"
+#include "DBConfig.h"
+#include "WriteBehindQueue.h"
+#include <mysql/mysql.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    const char* BENCH_EMAIL = "write-behind@bench.local";
+    const char* BENCH_METHOD = "Bench";
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    MYSQL* openRawConnection() {
+        MYSQL* mysql = mysql_init(nullptr);
+        if (!mysql_real_connect(mysql, DBConfig::DB_HOST.c_str(), DBConfig::DB_USER.c_str(),
+                                DBConfig::DB_PASS.c_str(), DBConfig::DB_NAME.c_str(), 0, nullptr, 0)) {
+            std::cerr << "Connection failed: " << mysql_error(mysql) << "\n";
+            mysql_close(mysql);
+            return nullptr;
+        }
+        return mysql;
+    }
+
+    bool run(MYSQL* mysql, const std::string& sql) {
+        if (mysql_query(mysql, sql.c_str())) {
+            std::cerr << "Query failed: " << mysql_error(mysql) << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Removes the bench booking, its payments and the bench user
+    void cleanup(MYSQL* mysql) {
+        std::string user = std::string("(SELECT user_id FROM user_info WHERE email = '") + BENCH_EMAIL + "')";
+        run(mysql, "DELETE FROM payments WHERE booking_id IN "
+                   "(SELECT booking_id FROM bookings WHERE user_id IN " + user + ")");
+        run(mysql, "DELETE FROM bookings WHERE user_id IN " + user);
+        run(mysql, std::string("DELETE FROM user_info WHERE email = '") + BENCH_EMAIL + "'");
+    }
+
+    // Creates a bench user and count unpaid bookings on an existing house;
+    // returns the user ID, or -1
+    int createBenchBookings(MYSQL* mysql, long long count, std::vector<int>& bookingIds) {
+        const long long CHUNK = 1000;    // Rows per INSERT
+
+        cleanup(mysql);
+        if (!run(mysql, std::string("INSERT INTO user_info (first_name, second_name, email, phone_number, password) "
+                                    "VALUES ('Bench', 'Writer', '") + BENCH_EMAIL + "', '0700000000', '')")) {
+            return -1;
+        }
+        std::string userId = std::to_string(mysql_insert_id(mysql));
+
+        if (!run(mysql, "SELECT house_id, town_id FROM houses LIMIT 1")) {
+            return -1;
+        }
+        MYSQL_RES* result = mysql_store_result(mysql);
+        MYSQL_ROW row = result ? mysql_fetch_row(result) : nullptr;
+        if (!row) {
+            std::cerr << "The houses table is empty\n";
+            if (result) mysql_free_result(result);
+            return -1;
+        }
+        std::string values = "(" + userId + ", '" + row[0] + "', " + row[1] +
+                             ", NOW(), NOW() + INTERVAL 30 DAY, 0)";
+        mysql_free_result(result);
+
+        for (long long done = 0; done < count; done += CHUNK) {
+            std::string sql = "INSERT INTO bookings (user_id, house_id, town_id, booking_date, expiry_date, is_paid) VALUES ";
+            for (long long i = done; i < count && i < done + CHUNK; ++i) {
+                sql += (i == done ? "" : ", ") + values;
+            }
+            if (!run(mysql, sql)) {
+                return -1;
+            }
+        }
+
+        if (!run(mysql, "SELECT booking_id FROM bookings WHERE user_id = " + userId + " ORDER BY booking_id")) {
+            return -1;
+        }
+        result = mysql_store_result(mysql);
+        while (result && (row = mysql_fetch_row(result))) {
+            bookingIds.push_back(std::atoi(row[0]));
+        }
+        if (result) mysql_free_result(result);
+        return static_cast<long long>(bookingIds.size()) == count ? std::atoi(userId.c_str()) : -1;
+    }
+
+    // Runs body(thread) on every thread and returns the wall time in seconds
+    template <typename Body>
+    double timeThreads(int threads, Body body) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.push_back(std::thread(body, t));
+        }
+        for (size_t t = 0; t < workers.size(); ++t) {
+            workers[t].join();
+        }
+        return secondsSince(start);
+    }
+
+    void report(const char* mode, long long payments, long long failed, unsigned long long commits, double seconds) {
+        std::cout << std::left << std::setw(14) << mode << std::right
+                  << payments << " payments (" << failed << " failed) in " << seconds << " s: "
+                  << (seconds > 0 ? payments / seconds : 0) << " payments/s, "
+                  << commits << " commits, " << (seconds > 0 ? commits / seconds : 0) << " commits/s\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int threads = 8;
+    int perThread = 500;
+    size_t batch = DBConfig::WRITE_BEHIND_MAX_BATCH;
+    int linger = DBConfig::WRITE_BEHIND_LINGER_MS;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--payments") == 0 && i + 1 < argc) {
+            perThread = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch = static_cast<size_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--linger") == 0 && i + 1 < argc) {
+            linger = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--threads T] [--payments N] [--batch B] [--linger MS]\n";
+            return 1;
+        }
+    }
+
+    MYSQL* raw = openRawConnection();
+    if (!raw) {
+        return 1;
+    }
+
+    const long long total = static_cast<long long>(threads) * perThread;
+    std::vector<int> bookingIds;    // The synchronous run pays the first half, write-behind the second
+    int userId = createBenchBookings(raw, 2 * total, bookingIds);
+    if (userId < 0) {
+        cleanup(raw);
+        mysql_close(raw);
+        return 1;
+    }
+
+    DBConnector db;
+    if (!db.connect(DBConfig::DB_HOST, DBConfig::DB_USER, DBConfig::DB_PASS, DBConfig::DB_NAME)) {
+        cleanup(raw);
+        mysql_close(raw);
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << threads << " threads x " << perThread << " payments, batch " << batch
+              << ", linger " << linger << " ms\n";
+
+    // Synchronous: every payment claims its booking and is inserted in its own transaction
+    std::vector<long long> syncFailures(threads, 0);
+    double syncSeconds = timeThreads(threads, [&](int t) {
+        for (int i = 0; i < perThread; ++i) {
+            if (db.recordPayment(userId, bookingIds[t * perThread + i], 1.0, BENCH_METHOD).empty()) {
+                ++syncFailures[t];
+            }
+        }
+    });
+    long long syncFailed = 0;
+    for (int t = 0; t < threads; ++t) syncFailed += syncFailures[t];
+    report("synchronous", total, syncFailed, total - syncFailed, syncSeconds);
+
+    // Write-behind: threads enqueue everything, then wait for their receipts
+    WriteBehindQueue queue(&db, batch, linger);
+    queue.start();
+    std::vector<long long> asyncFailures(threads, 0);
+    double asyncSeconds = timeThreads(threads, [&](int t) {
+        std::vector<std::future<std::string> > receipts;
+        receipts.reserve(perThread);
+        for (int i = 0; i < perThread; ++i) {
+            receipts.push_back(queue.enqueuePayment(userId, bookingIds[total + t * perThread + i], 1.0, BENCH_METHOD));
+        }
+        for (size_t i = 0; i < receipts.size(); ++i) {
+            if (receipts[i].get().empty()) {
+                ++asyncFailures[t];
+            }
+        }
+    });
+    queue.shutdown();
+    long long asyncFailed = 0;
+    for (int t = 0; t < threads; ++t) asyncFailed += asyncFailures[t];
+    WriteBehindQueue::Stats stats = queue.getStats();
+    report("write-behind", total, asyncFailed, stats.commits, asyncSeconds);
+    std::cout << "largest batch: " << stats.largestBatch << ", failed batches: " << stats.failedBatches << "\n";
+
+    if (asyncSeconds > 0 && syncSeconds > 0) {
+        std::cout << "throughput speedup: " << std::setprecision(2) << syncSeconds / asyncSeconds << "x\n";
+    }
+
+    db.disconnect();
+    cleanup(raw);
+    mysql_close(raw);
+    return 0;
+}
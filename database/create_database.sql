@@ -35,7 +35,7 @@ CREATE TABLE town(
 -- Create houses table
 CREATE TABLE houses(
   town_id INT,
-  house_id VARCHAR(4),  -- Changed from INT to VARCHAR(4)
+  house_id VARCHAR(15),  -- Changed from INT to VARCHAR(15)
   house_type VARCHAR(50),
   house_address VARCHAR(100),
   map_link VARCHAR(100),
@@ -44,14 +44,18 @@ CREATE TABLE houses(
   is_available BOOLEAN DEFAULT TRUE,
   is_booked BOOLEAN DEFAULT FALSE,
   booked_until DATETIME,
+  latitude DECIMAL(9,6) NULL,  -- WGS 84 degrees; NULL if not yet located
+  longitude DECIMAL(9,6) NULL,
+  updated_at TIMESTAMP(6) NOT NULL DEFAULT CURRENT_TIMESTAMP(6) ON UPDATE CURRENT_TIMESTAMP(6),  -- Change tracking for delta sync
   PRIMARY KEY(house_id),  -- Changed to single-column primary key
   FOREIGN KEY (town_id) REFERENCES town(town_id),
-  INDEX (town_id)  -- Add index for foreign key reference
+  INDEX (town_id),  -- Add index for foreign key reference
+  INDEX (updated_at)
 );
 
 -- Create rental_cost table
 CREATE TABLE rental_cost (
-  house_id VARCHAR(4),  -- Changed from INT to VARCHAR(4)
+  house_id VARCHAR(15),  -- Changed from INT to VARCHAR(15)
   town_id INT,
   house_cartegory VARCHAR(60),
   deposit INT,
@@ -63,7 +67,7 @@ CREATE TABLE rental_cost (
 
 -- Create payment_details table
 CREATE TABLE payment_details(
-  house_id VARCHAR(4),  -- Changed from INT to VARCHAR(4)
+  house_id VARCHAR(15),  -- Changed from INT to VARCHAR(15)
   town_id INT,
   house_type VARCHAR(50),
   bank_acount VARCHAR(20),
@@ -89,15 +93,20 @@ CREATE TABLE user_info(
 CREATE TABLE bookings(
   booking_id INT AUTO_INCREMENT,
   user_id INT,
-  house_id VARCHAR(4),  -- Changed from INT to VARCHAR(4)
+  house_id VARCHAR(15),  -- Changed from INT to VARCHAR(15)
   town_id INT,
   booking_date DATETIME,
   expiry_date DATETIME,
   is_paid BOOLEAN DEFAULT FALSE,
+  status VARCHAR(10) NOT NULL DEFAULT 'active',  -- 'expired' once the expiry sweeper has released the house
+  updated_at TIMESTAMP(6) NOT NULL DEFAULT CURRENT_TIMESTAMP(6) ON UPDATE CURRENT_TIMESTAMP(6),  -- Change tracking for delta sync
   PRIMARY KEY(booking_id),
   FOREIGN KEY (user_id) REFERENCES user_info(user_id),
   FOREIGN KEY (house_id) REFERENCES houses(house_id),
-  FOREIGN KEY (town_id) REFERENCES town(town_id)
+  FOREIGN KEY (town_id) REFERENCES town(town_id),
+  INDEX (updated_at),
+  INDEX (expiry_date),  -- Current bookings for the availability calendar
+  INDEX (status, expiry_date)  -- Bookings still to be expired
 );
 
 -- Create payments table
@@ -112,6 +121,51 @@ CREATE TABLE payments(
   FOREIGN KEY (booking_id) REFERENCES bookings(booking_id)
 );
 
+-- Book a house in one round trip
+-- The house row is claimed with a conditional UPDATE, so two sessions can
+-- never book the same house. Returns a single row:
+--   status       0 = booked, 1 = house already booked or unlisted,
+--                2 = house not found, 3 = database error
+--   booking_id   New booking ID, or -1
+--   booking_date Booking date (status 0)
+--   expiry_date  Booking expiry (status 0), or when the house becomes free (status 1)
+DROP PROCEDURE IF EXISTS book_house;
+DELIMITER //
+CREATE PROCEDURE book_house(IN p_user_id INT, IN p_house_id VARCHAR(15), IN p_town_id INT)
+BEGIN
+  DECLARE v_booking_date DATETIME DEFAULT NOW();
+  DECLARE v_expiry_date DATETIME DEFAULT NOW() + INTERVAL 30 DAY;
+  DECLARE v_booked_until DATETIME DEFAULT NULL;
+  DECLARE v_found INT DEFAULT 0;
+
+  DECLARE EXIT HANDLER FOR SQLEXCEPTION
+  BEGIN
+    ROLLBACK;
+    SELECT 3 AS status, -1 AS booking_id, NULL AS booking_date, NULL AS expiry_date;
+  END;
+
+  START TRANSACTION;
+
+  UPDATE houses SET is_booked = 1, booked_until = v_expiry_date
+  WHERE house_id = p_house_id AND town_id = p_town_id
+    AND is_available = 1 AND is_booked = 0;
+
+  IF ROW_COUNT() = 1 THEN
+    INSERT INTO bookings (user_id, house_id, town_id, booking_date, expiry_date, is_paid)
+    VALUES (p_user_id, p_house_id, p_town_id, v_booking_date, v_expiry_date, 0);
+    COMMIT;
+    SELECT 0 AS status, LAST_INSERT_ID() AS booking_id,
+           v_booking_date AS booking_date, v_expiry_date AS expiry_date;
+  ELSE
+    ROLLBACK;
+    SELECT COUNT(*), MAX(booked_until) INTO v_found, v_booked_until
+    FROM houses WHERE house_id = p_house_id AND town_id = p_town_id;
+    SELECT IF(v_found = 0, 2, 1) AS status, -1 AS booking_id,
+           NULL AS booking_date, v_booked_until AS expiry_date;
+  END IF;
+END //
+DELIMITER ;
+
 -- Insert sample data from original SQL file
 -- Counties
 INSERT INTO county VALUES(1, 'Nairobi');
@@ -236,6 +290,28 @@ VALUES(301, 'ML01', 'Townhouse', 'Milimani Estate, House #303', 'https://maps.go
 INSERT INTO houses(town_id, house_id, house_type, house_address, map_link, deposit_fee, monthly_rent) 
 VALUES(401, 'BH01', 'Duplex', 'Bahati Heights, House #404', 'https://maps.google.com/?q=Bahati,Nakuru', 50000, 25000);
 
+-- Approximate coordinates of the sample houses
+UPDATE houses SET latitude = -1.218600, longitude = 36.811700 WHERE house_id = 'RB01';
+UPDATE houses SET latitude = -1.215900, longitude = 36.815400 WHERE house_id = 'RM01';
+UPDATE houses SET latitude = -1.205700, longitude = 36.786000 WHERE house_id = 'UB01';
+UPDATE houses SET latitude = -1.201800, longitude = 36.781900 WHERE house_id = 'UA01';
+UPDATE houses SET latitude = -1.208200, longitude = 36.778300 WHERE house_id = 'UE01';
+UPDATE houses SET latitude = -1.203400, longitude = 36.789500 WHERE house_id = 'US01';
+UPDATE houses SET latitude = -1.180000, longitude = 36.926000 WHERE house_id = 'KB01';
+UPDATE houses SET latitude = -1.183600, longitude = 36.921300 WHERE house_id = 'KA01';
+UPDATE houses SET latitude = -1.178200, longitude = 36.930800 WHERE house_id = 'KE01';
+UPDATE houses SET latitude = -1.176500, longitude = 36.924100 WHERE house_id = 'KS01';
+UPDATE houses SET latitude = -1.319000, longitude = 36.707300 WHERE house_id = 'K001';
+UPDATE houses SET latitude = -1.325400, longitude = 36.712800 WHERE house_id = 'K002';
+UPDATE houses SET latitude = -1.473000, longitude = 36.960200 WHERE house_id = 'KT01';
+UPDATE houses SET latitude = -1.476800, longitude = 36.955100 WHERE house_id = 'KT02';
+UPDATE houses SET latitude = -1.220300, longitude = 36.818900 WHERE house_id = 'RD01';
+UPDATE houses SET latitude = -1.267600, longitude = 36.807700 WHERE house_id = 'WL01';
+UPDATE houses SET latitude = -4.021600, longitude = 39.720600 WHERE house_id = 'NY01';
+UPDATE houses SET latitude = -3.990000, longitude = 39.729500 WHERE house_id = 'BM01';
+UPDATE houses SET latitude = -0.096900, longitude = 34.766200 WHERE house_id = 'ML01';
+UPDATE houses SET latitude = -0.151600, longitude = 36.152100 WHERE house_id = 'BH01';
+
 -- Add a test user
 INSERT INTO user_info (first_name, second_name, email, phone_number, password)
 VALUES ('Test', 'User', 'test@example.com', '0712345678', 'password');
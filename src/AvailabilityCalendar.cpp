@@ -0,0 +1,129 @@
+#include "include/AvailabilityCalendar.h"
+#include <algorithm>
+
+namespace {
+    const std::vector<AvailabilityCalendar::Interval> NO_INTERVALS;
+
+    bool startsBefore(const AvailabilityCalendar::Interval& interval, long long time) {
+        return interval.start < time;
+    }
+}
+
+AvailabilityCalendar::AvailabilityCalendar() : intervalCount(0) {}
+
+void AvailabilityCalendar::refreshMaxEnd(HouseIntervals& house, size_t from) {
+    house.maxEnd.resize(house.intervals.size());
+    for (size_t i = from; i < house.intervals.size(); ++i) {
+        long long previous = i == 0 ? house.intervals[i].end : house.maxEnd[i - 1];
+        house.maxEnd[i] = std::max(previous, house.intervals[i].end);
+    }
+}
+
+void AvailabilityCalendar::clear() {
+    houses.clear();
+    intervalCount = 0;
+}
+
+void AvailabilityCalendar::add(const std::string& houseId, long long start, long long end, int bookingId) {
+    remove(houseId, bookingId);
+    if (end <= start) {
+        return;
+    }
+
+    HouseIntervals& house = houses[houseId];
+    Interval interval;
+    interval.start = start;
+    interval.end = end;
+    interval.bookingId = bookingId;
+
+    // After intervals with the same start, so equal starts keep insertion order
+    std::vector<Interval>::iterator position =
+        std::lower_bound(house.intervals.begin(), house.intervals.end(), start + 1, startsBefore);
+    size_t index = position - house.intervals.begin();
+    house.intervals.insert(position, interval);
+    refreshMaxEnd(house, index);
+    ++intervalCount;
+}
+
+bool AvailabilityCalendar::remove(const std::string& houseId, int bookingId) {
+    std::unordered_map<std::string, HouseIntervals>::iterator it = houses.find(houseId);
+    if (it == houses.end()) {
+        return false;
+    }
+
+    std::vector<Interval>& intervals = it->second.intervals;
+    for (size_t i = 0; i < intervals.size(); ++i) {
+        if (intervals[i].bookingId == bookingId) {
+            intervals.erase(intervals.begin() + i);
+            --intervalCount;
+            if (intervals.empty()) {
+                houses.erase(it);
+            } else {
+                refreshMaxEnd(it->second, i);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t AvailabilityCalendar::pruneBefore(long long time) {
+    size_t dropped = 0;
+    for (std::unordered_map<std::string, HouseIntervals>::iterator it = houses.begin(); it != houses.end(); ) {
+        std::vector<Interval>& intervals = it->second.intervals;
+        size_t kept = 0;
+        for (size_t i = 0; i < intervals.size(); ++i) {
+            if (intervals[i].end > time) {
+                intervals[kept++] = intervals[i];
+            }
+        }
+        dropped += intervals.size() - kept;
+        intervals.resize(kept);
+
+        if (intervals.empty()) {
+            it = houses.erase(it);
+        } else {
+            refreshMaxEnd(it->second, 0);
+            ++it;
+        }
+    }
+    intervalCount -= dropped;
+    return dropped;
+}
+
+bool AvailabilityCalendar::isFree(const std::string& houseId, long long start, long long end) const {
+    std::unordered_map<std::string, HouseIntervals>::const_iterator it = houses.find(houseId);
+    if (it == houses.end() || end <= start) {
+        return true;
+    }
+
+    // Intervals starting before the window ends; one overlaps if any of them ends after it starts
+    const HouseIntervals& house = it->second;
+    size_t before = std::lower_bound(house.intervals.begin(), house.intervals.end(), end, startsBefore) -
+                    house.intervals.begin();
+    return before == 0 || house.maxEnd[before - 1] <= start;
+}
+
+long long AvailabilityCalendar::nextFree(const std::string& houseId, long long from, long long length) const {
+    std::unordered_map<std::string, HouseIntervals>::const_iterator it = houses.find(houseId);
+    if (it == houses.end()) {
+        return from;
+    }
+
+    // Jump past the latest-ending overlapping booking until the window is clear
+    const HouseIntervals& house = it->second;
+    long long start = from;
+    while (true) {
+        size_t before = std::lower_bound(house.intervals.begin(), house.intervals.end(), start + length,
+                                         startsBefore) - house.intervals.begin();
+        if (before == 0 || house.maxEnd[before - 1] <= start) {
+            return start;
+        }
+        start = house.maxEnd[before - 1];
+    }
+}
+
+const std::vector<AvailabilityCalendar::Interval>& AvailabilityCalendar::bookingsOf(const std::string& houseId) const {
+    std::unordered_map<std::string, HouseIntervals>::const_iterator it = houses.find(houseId);
+    return it == houses.end() ? NO_INTERVALS : it->second.intervals;
+}
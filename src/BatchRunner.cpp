@@ -0,0 +1,290 @@
+#include "include/BatchRunner.h"
+#include "include/MBomaHousingSystem.h"
+#include "include/Json.h"
+#include "include/Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+
+namespace {
+    std::string field(const std::map<std::string, std::string>& fields, const char* name) {
+        std::map<std::string, std::string>::const_iterator it = fields.find(name);
+        return it == fields.end() ? "" : it->second;
+    }
+
+    bool parseNumber(const std::string& text, double& value) {
+        char* end = nullptr;
+        value = std::strtod(text.c_str(), &end);
+        return !text.empty() && end && *end == '\0';
+    }
+
+    bool parseInt(const std::string& text, int& value) {
+        if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        value = std::atoi(text.c_str());
+        return true;
+    }
+
+    bool fail(JsonWriter& json, const std::string& message) {
+        json.key("error").value(message);
+        return false;
+    }
+
+    bool isCommand(const std::string& name) {
+        return name == "register" || name == "login" || name == "logout" || name == "search" ||
+               name == "book" || name == "pay" || name == "bookings";
+    }
+
+    // Latency at a percentile of sorted samples
+    double percentile(const std::vector<double>& sorted, double fraction) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+}
+
+BatchRunner::BatchRunner(MBomaHousingSystem& system) : system(system), rejectedLines(0) {}
+
+bool BatchRunner::run(std::istream& in, std::ostream& out) {
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+
+        JsonWriter json;
+        json.beginObject().key("line").value(static_cast<unsigned long long>(lineNumber));
+
+        Fields fields;
+        std::string error;
+        if (!parseJsonObject(line, fields, error)) {
+            ++rejectedLines;
+            json.key("ok").value(false).key("error").value(error).endObject();
+            out << json.str() << '\n';
+            continue;
+        }
+        Fields::const_iterator id = fields.find("id");
+        if (id != fields.end()) {
+            json.key("id").value(id->second);
+        }
+        std::string command = field(fields, "cmd");
+        json.key("cmd").value(command);
+
+        if (!isCommand(command)) {
+            ++rejectedLines;
+            json.key("ok").value(false).key("error").value("unknown command \"" + command + "\"").endObject();
+            out << json.str() << '\n';
+            continue;
+        }
+
+        // Patches first, as the menu applies them before each screen
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        system.applyPending();
+        bool ok = execute(command, fields, json);
+        double latencyUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+        CommandStats& commandStats = stats[command];
+        commandStats.latenciesUs.push_back(latencyUs);
+        if (!ok) {
+            ++commandStats.failed;
+        }
+
+        json.key("ok").value(ok).key("latency_us").value(latencyUs, 1).endObject();
+        out << json.str() << '\n';
+    }
+    out.flush();
+    return rejectedLines == 0;
+}
+
+bool BatchRunner::execute(const std::string& command, const Fields& fields, JsonWriter& json) {
+    if (command == "register") {
+        return doRegister(fields, json);
+    } else if (command == "login") {
+        return doLogin(fields, json);
+    } else if (command == "logout") {
+        system.logout();
+        return true;
+    } else if (command == "search") {
+        return doSearch(fields, json);
+    } else if (command == "book") {
+        return doBook(fields, json);
+    } else if (command == "pay") {
+        return doPay(fields, json);
+    } else if (command == "bookings") {
+        return doBookings(json);
+    }
+    return false;
+}
+
+bool BatchRunner::doRegister(const Fields& fields, JsonWriter& json) {
+    std::string name = field(fields, "name");
+    std::string email = field(fields, "email");
+    std::string password = field(fields, "password");
+    if (name.empty() || email.find('@') == std::string::npos || password.empty()) {
+        return fail(json, "name, email and password are required");
+    }
+    User user(name, field(fields, "phone"), email, password);
+    if (!system.registerAccount(user)) {
+        return fail(json, "failed to save user: " + system.getLastError());
+    }
+    json.key("user_id").value(user.getId());
+    return true;
+}
+
+bool BatchRunner::doLogin(const Fields& fields, JsonWriter& json) {
+    if (!system.login(field(fields, "email"), field(fields, "password"))) {
+        return fail(json, "invalid email or password");
+    }
+    json.key("user_id").value(system.getCurrentUserId());
+    return true;
+}
+
+bool BatchRunner::doSearch(const Fields& fields, JsonWriter& json) {
+    MBomaHousingSystem::HouseQuery query;
+    query.type = field(fields, "type");
+    query.address = field(fields, "address");
+    if (fields.count("min_rent") && !parseNumber(field(fields, "min_rent"), query.minRent)) {
+        return fail(json, "min_rent must be a number");
+    }
+    if (fields.count("max_rent") && !parseNumber(field(fields, "max_rent"), query.maxRent)) {
+        return fail(json, "max_rent must be a number");
+    }
+    if (fields.count("town") && !parseInt(field(fields, "town"), query.townId)) {
+        return fail(json, "town must be a town ID");
+    }
+    if (fields.count("move_in") && !parseDateTime(field(fields, "move_in"), query.moveIn)) {
+        return fail(json, "move_in must be a date (YYYY-MM-DD)");
+    }
+
+    std::vector<House> houses = system.findHouses(query);
+    json.key("count").value(static_cast<unsigned long long>(houses.size()))
+        .key("house_ids").beginArray();
+    for (size_t i = 0; i < houses.size(); ++i) {
+        json.value(houses[i].getId());
+    }
+    json.endArray();
+    return true;
+}
+
+bool BatchRunner::doBook(const Fields& fields, JsonWriter& json) {
+    if (!system.getCurrentUserId()) {
+        return fail(json, "log in first");
+    }
+    std::string houseId = field(fields, "house_id");
+    Booking booking(0, system.getCurrentUserId(), houseId);
+    switch (system.bookHouse(houseId, booking)) {
+        case MBomaHousingSystem::BOOKING_NO_SUCH_HOUSE:
+            return fail(json, "no such house");
+        case MBomaHousingSystem::BOOKING_ALREADY_BOOKED:
+            return fail(json, "already booked");
+        case MBomaHousingSystem::BOOKING_HELD:
+            return fail(json, "being booked by another session");
+        case MBomaHousingSystem::BOOKING_TAKEN:
+            return fail(json, "booked by another session");
+        case MBomaHousingSystem::BOOKING_NOT_SAVED:
+            return fail(json, "could not save the booking");
+        case MBomaHousingSystem::BOOKING_SAVED:
+            json.key("saved").value(true);
+            break;
+    }
+    json.key("booking_id").value(booking.getId())
+        .key("house_id").value(houseId)
+        .key("booking_date").value(booking.getBookingDate())
+        .key("expiry_date").value(booking.getExpiryDate());
+    return true;
+}
+
+bool BatchRunner::doPay(const Fields& fields, JsonWriter& json) {
+    if (!system.getCurrentUserId()) {
+        return fail(json, "log in first");
+    }
+    int bookingId = 0;
+    if (!parseInt(field(fields, "booking_id"), bookingId)) {
+        return fail(json, "booking_id is required");
+    }
+    std::string method = field(fields, "method");
+    if (method.empty() || equalsIgnoreCase(method, "mpesa") || equalsIgnoreCase(method, "M-Pesa")) {
+        method = "M-Pesa";
+    } else if (equalsIgnoreCase(method, "bank") || equalsIgnoreCase(method, "Bank Transfer")) {
+        method = "Bank Transfer";
+    } else {
+        return fail(json, "method must be \"M-Pesa\" or \"Bank Transfer\"");
+    }
+
+    std::string receiptNumber;
+    double amount = 0.0;
+    switch (system.payBooking(bookingId, method, receiptNumber, amount)) {
+        case MBomaHousingSystem::PAYMENT_NO_SUCH_BOOKING:
+            return fail(json, "no such booking");
+        case MBomaHousingSystem::PAYMENT_ALREADY_PAID:
+            return fail(json, "already paid");
+        case MBomaHousingSystem::PAYMENT_HOUSE_NOT_LISTED:
+            return fail(json, "the booked house is no longer listed");
+        case MBomaHousingSystem::PAYMENT_NOT_SAVED:
+            return fail(json, "could not save the payment");
+        case MBomaHousingSystem::PAYMENT_SAVED:
+            json.key("saved").value(true);
+            break;
+    }
+    json.key("receipt_number").value(receiptNumber)
+        .key("amount").value(amount)
+        .key("method").value(method);
+    return true;
+}
+
+bool BatchRunner::doBookings(JsonWriter& json) {
+    if (!system.getCurrentUserId()) {
+        return fail(json, "log in first");
+    }
+    std::vector<Booking> bookings = system.myBookings();
+    json.key("bookings").beginArray();
+    for (size_t i = 0; i < bookings.size(); ++i) {
+        const Booking& booking = bookings[i];
+        json.beginObject()
+            .key("id").value(booking.getId())
+            .key("house_id").value(booking.getHouseId())
+            .key("booking_date").value(booking.getBookingDate())
+            .key("expiry_date").value(booking.getExpiryDate())
+            .key("paid").value(booking.getPaymentStatus())
+            .endObject();
+    }
+    json.endArray();
+    return true;
+}
+
+void BatchRunner::printSummary(std::ostream& out, double elapsedSeconds) const {
+    size_t total = 0;
+    out << std::left << std::setw(10) << "command" << std::right
+        << std::setw(8) << "count" << std::setw(8) << "failed"
+        << std::setw(12) << "mean us" << std::setw(12) << "p50 us"
+        << std::setw(12) << "p99 us" << std::setw(12) << "max us" << "\n";
+    for (std::map<std::string, CommandStats>::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+        std::vector<double> sorted = it->second.latenciesUs;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            sum += sorted[i];
+        }
+        total += sorted.size();
+        out << std::left << std::setw(10) << it->first << std::right
+            << std::setw(8) << sorted.size() << std::setw(8) << it->second.failed
+            << std::fixed << std::setprecision(1)
+            << std::setw(12) << (sorted.empty() ? 0.0 : sum / sorted.size())
+            << std::setw(12) << percentile(sorted, 0.50)
+            << std::setw(12) << percentile(sorted, 0.99)
+            << std::setw(12) << (sorted.empty() ? 0.0 : sorted.back()) << "\n";
+    }
+    out << total << " commands in " << std::fixed << std::setprecision(3) << elapsedSeconds << " s ("
+        << std::setprecision(0) << (elapsedSeconds > 0 ? total / elapsedSeconds : 0.0) << "/s)";
+    if (rejectedLines) {
+        out << ", " << rejectedLines << " invalid lines";
+    }
+    out << "\n";
+}
@@ -10,9 +10,9 @@ Booking::Booking(int id, int userId, const std::string& houseId)
     
     bookingDate = getCurrentDateTime();
     
-    // Calculate expiry date (30 days from now)
+    // Calculate expiry date (GRACE_PERIOD_DAYS from now)
     auto now = std::chrono::system_clock::now();
-    auto expiry = now + std::chrono::hours(24 * 30);
+    auto expiry = now + std::chrono::hours(24 * GRACE_PERIOD_DAYS);
     std::time_t expiry_time = std::chrono::system_clock::to_time_t(expiry);
     
     std::stringstream ss;
@@ -20,6 +20,11 @@ Booking::Booking(int id, int userId, const std::string& houseId)
     expiryDate = ss.str();
 }
 
+Booking::Booking(int id, int userId, const std::string& houseId,
+                 const std::string& bookingDate, const std::string& expiryDate, bool isPaid)
+    : id(id), userId(userId), houseId(houseId), 
+      bookingDate(bookingDate), expiryDate(expiryDate), isPaid(isPaid) {}
+
 int Booking::getId() const {
     return id;
 }
@@ -0,0 +1,352 @@
+#include "include/ConnectionPool.h"
+#include "include/DBConfig.h"
+#include "include/Metrics.h"
+#include <algorithm>
+
+namespace {
+    std::once_flag libraryInitFlag;
+
+    // Per-thread client state; the library needs it on every thread that
+    // talks to MySQL, and it is released when the thread exits
+    struct MySQLThreadScope {
+        MySQLThreadScope() { mysql_thread_init(); }
+        ~MySQLThreadScope() { mysql_thread_end(); }
+    };
+
+    void ensureThreadInit() {
+        static thread_local MySQLThreadScope scope;
+        (void)scope;
+    }
+
+    // Summed over every pool in the process
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    MetricsGauge* const openGauge = metrics.gauge(
+        "mboma_db_pool_connections", "Open database connections");
+    MetricsGauge* const inUseGauge = metrics.gauge(
+        "mboma_db_pool_connections_in_use", "Database connections checked out of the pool");
+    MetricsHistogram* const acquireLatency = metrics.histogram(
+        "mboma_db_pool_acquire_seconds", "Time to check a connection out of the pool");
+    MetricsCounter* const acquireTimeouts = metrics.counter(
+        "mboma_db_pool_timeouts_total", "Checkouts that timed out with every connection busy");
+    MetricsCounter* const reconnectCount = metrics.counter(
+        "mboma_db_pool_reconnects_total", "Broken or stale connections replaced");
+
+    unsigned long long elapsedMicros(std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - since).count();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Handle
+// ---------------------------------------------------------------------------
+
+ConnectionPool::Handle::Handle() : pool(nullptr), connection(nullptr) {}
+
+ConnectionPool::Handle::Handle(ConnectionPool* pool, Connection* connection)
+    : pool(pool), connection(connection) {}
+
+ConnectionPool::Handle::Handle(Handle&& other)
+    : pool(other.pool), connection(other.connection) {
+    other.pool = nullptr;
+    other.connection = nullptr;
+}
+
+ConnectionPool::Handle& ConnectionPool::Handle::operator=(Handle&& other) {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        connection = other.connection;
+        other.pool = nullptr;
+        other.connection = nullptr;
+    }
+    return *this;
+}
+
+ConnectionPool::Handle::~Handle() {
+    release();
+}
+
+ConnectionPool::Handle::operator bool() const {
+    return connection != nullptr;
+}
+
+MYSQL* ConnectionPool::Handle::mysql() const {
+    return connection ? connection->mysql : nullptr;
+}
+
+StatementCache* ConnectionPool::Handle::statements() const {
+    return connection ? connection->statements : nullptr;
+}
+
+void ConnectionPool::Handle::markBroken() {
+    if (connection) {
+        connection->broken = true;
+    }
+}
+
+void ConnectionPool::Handle::release() {
+    if (pool && connection) {
+        pool->giveBack(connection);
+    }
+    pool = nullptr;
+    connection = nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// ConnectionPool
+// ---------------------------------------------------------------------------
+
+ConnectionPool::ConnectionPool(const std::string& host, const std::string& user,
+                               const std::string& password, const std::string& db,
+                               size_t minSize, size_t maxSize)
+    : host(host), user(user), password(password), database(db),
+      minSize(std::max<size_t>(1, minSize)), maxSize(std::max(minSize, maxSize)),
+      opening(0), shuttingDown(false), stats() {
+    // mysql_library_init is not thread-safe and must run before any thread
+    // calls mysql_init
+    std::call_once(libraryInitFlag, []() { mysql_library_init(0, nullptr, nullptr); });
+}
+
+ConnectionPool::~ConnectionPool() {
+    shutdown();
+}
+
+ConnectionPool::Connection* ConnectionPool::openConnection() {
+    ensureThreadInit();
+
+    MYSQL* mysql = mysql_init(nullptr);
+    if (!mysql) {
+        std::lock_guard<std::mutex> lock(mutex);
+        lastError = "MySQL initialization failed";
+        return nullptr;
+    }
+
+    if (!mysql_real_connect(mysql, host.c_str(), user.c_str(), password.c_str(),
+                            database.c_str(), 0, nullptr, CLIENT_MULTI_RESULTS)) {  // CALL book_house
+        std::lock_guard<std::mutex> lock(mutex);
+        lastError = mysql_error(mysql);
+        mysql_close(mysql);
+        return nullptr;
+    }
+
+    Connection* connection = new Connection();
+    connection->mysql = mysql;
+    connection->statements = new StatementCache(mysql);
+    connection->lastUsed = std::chrono::steady_clock::now();
+    connection->broken = false;
+    openGauge->add(1);
+    return connection;
+}
+
+void ConnectionPool::closeConnection(Connection* connection) {
+    // Statements must be closed while their connection is still open
+    delete connection->statements;
+    mysql_close(connection->mysql);
+    delete connection;
+    openGauge->add(-1);
+}
+
+bool ConnectionPool::start() {
+    Connection* first = openConnection();
+    if (!first) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shuttingDown = false;
+        all.push_back(first);
+        idle.push_back(first);
+    }
+    available.notify_one();
+
+    // Bring the pool up to its minimum size without delaying startup
+    if (minSize > 1 && !warmer.joinable()) {
+        warmer = std::thread(&ConnectionPool::warmUp, this);
+    }
+    return true;
+}
+
+void ConnectionPool::warmUp() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!shuttingDown && all.size() + opening < minSize) {
+        ++opening;
+        lock.unlock();
+        Connection* connection = openConnection();
+        lock.lock();
+        --opening;
+
+        if (!connection) {
+            // Leave the remaining connections to be opened on demand
+            break;
+        }
+
+        if (shuttingDown) {
+            closeConnection(connection);
+            break;
+        }
+
+        all.push_back(connection);
+        idle.push_back(connection);
+        available.notify_one();
+    }
+}
+
+void ConnectionPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shuttingDown = true;
+    }
+    available.notify_all();
+
+    if (warmer.joinable()) {
+        warmer.join();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (size_t i = 0; i < idle.size(); ++i) {
+        all.erase(std::remove(all.begin(), all.end(), idle[i]), all.end());
+        closeConnection(idle[i]);
+    }
+    idle.clear();
+
+    // Checked-out connections are closed by giveBack as their handles go;
+    // the pool must outlive them, so wait for the last one
+    available.wait(lock, [this] { return all.empty() && opening == 0; });
+}
+
+bool ConnectionPool::checkHealth(Connection* connection) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    bool stale = now - connection->lastUsed >
+                 std::chrono::milliseconds(DBConfig::POOL_PING_AFTER_IDLE_MS);
+
+    if (!connection->broken && (!stale || mysql_ping(connection->mysql) == 0)) {
+        return true;
+    }
+
+    // Replace the session in place; cached statements died with it
+    Connection* fresh = openConnection();
+    if (!fresh) {
+        return false;
+    }
+
+    delete connection->statements;
+    mysql_close(connection->mysql);
+    connection->mysql = fresh->mysql;
+    connection->statements = fresh->statements;
+    connection->broken = false;
+    delete fresh;
+    openGauge->add(-1);    // The old session; fresh was counted when opened
+    reconnectCount->add();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++stats.reconnects;
+    return true;
+}
+
+ConnectionPool::Handle ConnectionPool::acquire(int timeoutMs) {
+    ensureThreadInit();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point deadline = start + std::chrono::milliseconds(timeoutMs);
+    bool waited = false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!shuttingDown) {
+        Connection* connection = nullptr;
+
+        if (!idle.empty()) {
+            connection = idle.back();
+            idle.pop_back();
+            lock.unlock();
+
+            if (!checkHealth(connection)) {
+                closeConnection(connection);
+                lock.lock();
+                all.erase(std::remove(all.begin(), all.end(), connection), all.end());
+                available.notify_all();    // shutdown may be waiting for it
+                continue;
+            }
+            lock.lock();
+        } else if (all.size() + opening < maxSize) {
+            ++opening;
+            lock.unlock();
+            connection = openConnection();
+            lock.lock();
+            --opening;
+            if (shuttingDown) {
+                available.notify_all();
+            }
+
+            if (connection) {
+                all.push_back(connection);
+            } else if (all.empty()) {
+                // Nothing to wait for if the server cannot be reached at all
+                break;
+            }
+        }
+
+        if (connection) {
+            unsigned long long waitMicros = elapsedMicros(start);
+            ++stats.acquisitions;
+            if (waited) {
+                ++stats.waits;
+                stats.totalWaitMicros += waitMicros;
+                stats.maxWaitMicros = std::max(stats.maxWaitMicros, waitMicros);
+            }
+            acquireLatency->record(static_cast<long long>(waitMicros));
+            inUseGauge->add(1);
+            return Handle(this, connection);
+        }
+
+        waited = true;
+        if (available.wait_until(lock, deadline) == std::cv_status::timeout && idle.empty()) {
+            ++stats.timeouts;
+            stats.totalWaitMicros += elapsedMicros(start);
+            acquireTimeouts->add();
+            lastError = "Timed out waiting for a database connection";
+            return Handle();
+        }
+    }
+
+    if (shuttingDown) {
+        lastError = "Connection pool is shut down";
+    }
+    return Handle();
+}
+
+void ConnectionPool::giveBack(Connection* connection) {
+    connection->lastUsed = std::chrono::steady_clock::now();
+    inUseGauge->add(-1);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (shuttingDown) {
+        lock.unlock();
+        closeConnection(connection);
+
+        // Notify under the lock: once shutdown sees all empty the pool may be freed
+        lock.lock();
+        all.erase(std::remove(all.begin(), all.end(), connection), all.end());
+        available.notify_all();
+        return;
+    }
+
+    // Broken connections are kept and repaired by checkHealth on next use
+    idle.push_back(connection);
+    lock.unlock();
+    available.notify_one();
+}
+
+ConnectionPool::Stats ConnectionPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats snapshot = stats;
+    snapshot.openConnections = all.size();
+    snapshot.idleConnections = idle.size();
+    return snapshot;
+}
+
+std::string ConnectionPool::getLastError() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastError;
+}
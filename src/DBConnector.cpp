@@ -1,44 +1,376 @@
 #include "include/DBConnector.h"
 #include "include/DBConfig.h"
 #include "include/Utils.h"
+#include "include/RowDecoder.h"
+#include "include/Metrics.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <map>       // For std::map
 #include <sstream>   // For std::stringstream
+#include <algorithm>
 #include <iomanip>   // For std::put_time
+#include <iterator>  // For std::back_inserter
+#include <cstdlib>
+#include <cstring>
+#include <mysql/errmsg.h>
+#include <mysql/mysqld_error.h>
 
-DBConnector::DBConnector() : conn(nullptr), connected(false) {
-    conn = mysql_init(nullptr);
-    if (!conn) {
-        std::cerr << "MySQL initialization failed" << std::endl;
+namespace {
+    // Statement shapes, kept as std::string so cache lookups do not allocate
+    const std::string SQL_REGISTER_USER =
+        "INSERT INTO user_info (first_name, second_name, email, phone_number, password) "
+        "VALUES (?, '', ?, ?, ?)";
+    // email uses the default case-insensitive collation, so these compare
+    // without LOWER() and can use the UNIQUE index on email
+    const std::string SQL_AUTHENTICATE_USER =
+        "SELECT password FROM user_info WHERE email = ?";
+    const std::string SQL_LOAD_USER_BY_EMAIL =
+        "SELECT user_id, first_name, phone_number, email, password FROM user_info WHERE email = ?";
+    const std::string SQL_LOAD_TOWNS =
+        "SELECT town_id, town_name FROM town WHERE county_id = ? ORDER BY town_id";
+    const std::string SQL_LOAD_HOUSES =
+        "SELECT h.house_id, h.house_type, h.town_id, "
+        "h.house_address, h.map_link, h.deposit_fee, h.monthly_rent, "
+        "h.is_available, h.is_booked, h.booked_until, h.latitude, h.longitude "
+        "FROM houses h WHERE h.town_id = ? ORDER BY h.house_id";
+    const std::string SQL_HOUSES_CHANGED_SINCE =
+        "SELECT h.house_id, h.house_type, h.town_id, "
+        "h.house_address, h.map_link, h.deposit_fee, h.monthly_rent, "
+        "h.is_available, h.is_booked, h.booked_until, h.latitude, h.longitude "
+        "FROM houses h WHERE h.updated_at >= ?";
+    const std::string SQL_PAYMENT_DETAILS =
+        "SELECT bank_acount, m_pesa_till_no, owner_contacts "
+        "FROM payment_details WHERE house_id = ? AND town_id = ?";
+    const std::string SQL_LOAD_BOOKINGS =
+        "SELECT booking_id, user_id, house_id, booking_date, expiry_date, is_paid FROM bookings";
+    const std::string SQL_LOAD_USER_BOOKINGS =
+        "SELECT booking_id, user_id, house_id, booking_date, expiry_date, is_paid FROM bookings "
+        "WHERE user_id = ?";
+    // Uses the expiry_date index; expired bookings cannot block a future date
+    const std::string SQL_LOAD_CURRENT_BOOKINGS =
+        "SELECT booking_id, user_id, house_id, booking_date, expiry_date, is_paid FROM bookings "
+        "WHERE expiry_date > NOW()";
+    // Covered by the (status, expiry_date) index
+    const std::string SQL_PENDING_EXPIRIES =
+        "SELECT booking_id, expiry_date FROM bookings WHERE status = 'active'";
+    const std::string SQL_BOOKINGS_CHANGED_SINCE =
+        "SELECT booking_id, user_id, house_id, booking_date, expiry_date, is_paid FROM bookings "
+        "WHERE updated_at >= ?";
+    const std::string SQL_USER_BOOKINGS_CHANGED_SINCE =
+        "SELECT booking_id, user_id, house_id, booking_date, expiry_date, is_paid FROM bookings "
+        "WHERE updated_at >= ? AND user_id = ?";
+    // Server clock, so change marks do not depend on the client's clock
+    const std::string SQL_CHANGE_MARK =
+        "SELECT DATE_FORMAT(NOW(6) - INTERVAL ? SECOND, '%Y-%m-%d %H:%i:%s.%f')";
+    // Claims the house and inserts the booking in one transaction; see
+    // database/create_database.sql for the result row
+    const std::string SQL_BOOK_HOUSE =
+        "CALL book_house(?, ?, ?)";
+    const std::string SQL_INSERT_PAYMENT =
+        "INSERT INTO payments (booking_id, amount, payment_date, payment_method, receipt_number) "
+        "VALUES (?, ?, ?, ?, ?)";
+    // Changes exactly one row only for the owner's unpaid booking
+    const std::string SQL_CLAIM_BOOKING_PAYMENT =
+        "UPDATE bookings SET is_paid = 1 WHERE booking_id = ? AND user_id = ? AND is_paid = 0";
+    const std::string SQL_BOOKING_PAYMENT_STATE =
+        "SELECT b.house_id, h.deposit_fee FROM bookings b "
+        "LEFT JOIN houses h ON h.house_id = b.house_id WHERE b.booking_id = ? AND b.user_id = ?";
+
+    const std::string SQL_HOUSE_ROW_ESTIMATE =
+        "SELECT TABLE_ROWS FROM information_schema.TABLES "
+        "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'houses'";
+    // Adding 0E0 turns the DECIMAL columns into DOUBLE on the server, so they
+    // are sent as 8-byte binary values instead of decimal strings
+    const std::string SQL_HOUSE_CATALOG =
+        "SELECT house_id, house_type, town_id, house_address, map_link, "
+        "deposit_fee + 0E0, monthly_rent + 0E0, is_available, is_booked, booked_until "
+        "FROM houses ORDER BY town_id, house_id";
+
+    // Optional search filters; each combination is its own statement shape
+    enum SearchFilter {
+        SEARCH_BY_TYPE = 1,
+        SEARCH_BY_MIN_RENT = 2,
+        SEARCH_BY_MAX_RENT = 4,
+        SEARCH_BY_TOWN = 8,
+        SEARCH_BY_ADDRESS = 16,
+        SEARCH_SHAPE_COUNT = 32
+    };
+
+    // Columns as in SQL_LOAD_HOUSES
+    House readHouse(PreparedStatement* stmt) {
+        House house(stmt->getString(0), stmt->getString(1), 
+                    stmt->getDouble(5), stmt->getDouble(6), 
+                    stmt->getInt(2), stmt->getString(3), stmt->getString(4));
+        house.setAvailability(stmt->isNull(7) || stmt->getInt(7) == 1);
+        
+        std::string bookedUntil = stmt->getString(9);
+        if (stmt->getInt(8) == 1 && !bookedUntil.empty()) {
+            house.book(bookedUntil);
+        }
+        if (!stmt->isNull(10) && !stmt->isNull(11)) {
+            house.setCoordinates(stmt->getDouble(10), stmt->getDouble(11));
+        }
+        return house;
+    }
+
+    std::vector<std::string> buildSearchShapes() {
+        std::vector<std::string> shapes;
+        for (int mask = 0; mask < SEARCH_SHAPE_COUNT; ++mask) {
+            std::string sql =
+                "SELECT h.house_id, h.house_type, rc.deposit, rc.monthly_rent, h.town_id, "
+                "CONCAT(t.town_name, ' Area, House #', h.house_id) as address, "
+                "CONCAT('https://maps.google.com/?q=', t.town_name) as map_link "
+                "FROM houses h "
+                "JOIN rental_cost rc ON h.house_id = rc.house_id AND h.town_id = rc.town_id "
+                "JOIN town t ON h.town_id = t.town_id "
+                "WHERE h.is_available = 1 AND h.is_booked = 0";    // Open for booking, as book_house requires
+            if (mask & SEARCH_BY_TYPE) {
+                sql += " AND h.house_type LIKE CONCAT('%', ?, '%')";
+            }
+            if (mask & SEARCH_BY_MIN_RENT) {
+                sql += " AND rc.monthly_rent >= ?";
+            }
+            if (mask & SEARCH_BY_MAX_RENT) {
+                sql += " AND rc.monthly_rent <= ?";
+            }
+            if (mask & SEARCH_BY_TOWN) {
+                sql += " AND h.town_id = ?";
+            }
+            if (mask & SEARCH_BY_ADDRESS) {
+                sql += " AND h.house_address LIKE CONCAT('%', ?, '%')";
+            }
+            shapes.push_back(sql);
+        }
+        return shapes;
+    }
+
+    // Batch statements have one shape per batch size, so the statement cache
+    // holds at most WRITE_BEHIND_MAX_BATCH shapes of each
+    std::string repeatPlaceholders(const std::string& group, size_t count) {
+        std::string list;
+        for (size_t i = 0; i < count; ++i) {
+            if (i) list += ", ";
+            list += group;
+        }
+        return list;
+    }
+
+    std::string lockHousesSql(size_t count) {
+        return "SELECT house_id, town_id, is_available, is_booked, booked_until, "
+               "NOW(), NOW() + INTERVAL 30 DAY "
+               "FROM houses WHERE house_id IN (" + repeatPlaceholders("?", count) + ") FOR UPDATE";
+    }
+
+    std::string claimHousesSql(size_t count) {
+        return "UPDATE houses SET is_booked = 1, booked_until = ? "
+               "WHERE house_id IN (" + repeatPlaceholders("?", count) + ")";
+    }
+
+    std::string insertBookingsSql(size_t count) {
+        return "INSERT INTO bookings (user_id, house_id, town_id, booking_date, expiry_date, is_paid) "
+               "VALUES " + repeatPlaceholders("(?, ?, ?, ?, ?, 0)", count);
+    }
+
+    // The claimed houses stay locked until commit, so the only bookings for
+    // them at or after the first new ID are the ones just inserted
+    std::string newBookingIdsSql(size_t count) {
+        return "SELECT booking_id, house_id FROM bookings "
+               "WHERE booking_id >= ? AND house_id IN (" + repeatPlaceholders("?", count) + ")";
     }
+
+    std::string insertPaymentsSql(size_t count) {
+        return "INSERT INTO payments (booking_id, amount, payment_date, payment_method, receipt_number) "
+               "VALUES " + repeatPlaceholders("(?, ?, ?, ?, ?)", count);
+    }
+
+    std::string lockUnpaidBookingsSql(size_t count) {
+        return "SELECT booking_id, user_id FROM bookings "
+               "WHERE booking_id IN (" + repeatPlaceholders("?", count) + ") AND is_paid = 0 FOR UPDATE";
+    }
+
+    // Bookings already locked by lockUnpaidBookingsSql, so every one is changed
+    std::string claimBookingPaymentsSql(size_t count) {
+        return "UPDATE bookings SET is_paid = 1 "
+               "WHERE booking_id IN (" + repeatPlaceholders("?", count) + ") AND is_paid = 0";
+    }
+
+    // Locks every active booking of the batch; the last column says whether it is due
+    std::string lockExpiredBookingsSql(size_t count) {
+        return "SELECT booking_id, house_id, expiry_date, expiry_date <= NOW() FROM bookings "
+               "WHERE booking_id IN (" + repeatPlaceholders("?", count) + ") "
+               "AND status = 'active' FOR UPDATE";
+    }
+
+    std::string markBookingsExpiredSql(size_t count) {
+        return "UPDATE bookings SET status = 'expired' "
+               "WHERE booking_id IN (" + repeatPlaceholders("?", count) + ") "
+               "AND status = 'active' AND expiry_date <= NOW()";
+    }
+
+    std::string lockReleasableHousesSql(size_t count) {
+        return "SELECT house_id FROM houses "
+               "WHERE house_id IN (" + repeatPlaceholders("?", count) + ") "
+               "AND is_booked = 1 AND booked_until <= NOW() FOR UPDATE";
+    }
+
+    std::string releaseHousesSql(size_t count) {
+        return "UPDATE houses SET is_booked = 0, booked_until = NULL "
+               "WHERE house_id IN (" + repeatPlaceholders("?", count) + ")";
+    }
+
+    const std::string& searchHousesSql(int mask) {
+        static const std::vector<std::string> shapes = buildSearchShapes();
+        return shapes[mask];
+    }
+
+    // Metrics are registered once here and recorded without locking
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+
+    MetricsHistogram* loadHistogram(const std::string& loader) {
+        return metrics.histogram("mboma_db_load_seconds", "Time to run a loader, including reading its rows",
+                                 "loader=\"" + loader + "\"");
+    }
+
+    MetricsHistogram* const queryLatency = metrics.histogram(
+        "mboma_db_query_seconds", "Time to execute a statement on the server", "kind=\"text\"");
+    MetricsHistogram* const statementLatency = metrics.histogram(
+        "mboma_db_query_seconds", "Time to execute a statement on the server", "kind=\"prepared\"");
+    MetricsCounter* const queryErrors = metrics.counter(
+        "mboma_db_query_errors_total", "Statements the server rejected or failed", "kind=\"text\"");
+    MetricsCounter* const statementErrors = metrics.counter(
+        "mboma_db_query_errors_total", "Statements the server rejected or failed", "kind=\"prepared\"");
+    MetricsCounter* const errorCount = metrics.counter(
+        "mboma_db_errors_total", "Errors reported by the database connector");
+
+    MetricsHistogram* const loadUserLatency = loadHistogram("user_by_email");
+    MetricsHistogram* const loadCountiesLatency = loadHistogram("counties");
+    MetricsHistogram* const loadTownsLatency = loadHistogram("towns");
+    MetricsHistogram* const loadAllTownsLatency = loadHistogram("all_towns");
+    MetricsHistogram* const loadHousesLatency = loadHistogram("houses");
+    MetricsHistogram* const loadAllHousesLatency = loadHistogram("all_houses");
+    MetricsHistogram* const loadCatalogLatency = loadHistogram("house_catalog");
+    MetricsHistogram* const changeMarkLatency = loadHistogram("change_mark");
+    MetricsHistogram* const housesChangedLatency = loadHistogram("houses_changed");
+    MetricsHistogram* const bookingsChangedLatency = loadHistogram("bookings_changed");
+    MetricsHistogram* const paymentDetailsLatency = loadHistogram("payment_details");
+    MetricsHistogram* const searchLatency = loadHistogram("search");
+    MetricsHistogram* const loadBookingsLatency = loadHistogram("bookings");
+    MetricsHistogram* const currentBookingsLatency = loadHistogram("current_bookings");
+    MetricsHistogram* const loadUsersLatency = loadHistogram("users");
+    MetricsHistogram* const pendingExpiriesLatency = loadHistogram("pending_expiries");
+
+    MetricsHistogram* const bookingLatency = metrics.histogram(
+        "mboma_db_booking_seconds", "Time to book houses, per transaction", "mode=\"single\"");
+    MetricsHistogram* const bookingBatchLatency = metrics.histogram(
+        "mboma_db_booking_seconds", "Time to book houses, per transaction", "mode=\"batch\"");
+    MetricsHistogram* const paymentLatency = metrics.histogram(
+        "mboma_db_payment_seconds", "Time to record payments, per transaction", "mode=\"single\"");
+    MetricsHistogram* const paymentBatchLatency = metrics.histogram(
+        "mboma_db_payment_seconds", "Time to record payments, per transaction", "mode=\"batch\"");
+
+    // Indexed by DBConnector::BookingStatus
+    MetricsCounter* const bookingOutcomes[] = {
+        metrics.counter("mboma_db_bookings_total", "Booking attempts by outcome", "result=\"created\""),
+        metrics.counter("mboma_db_bookings_total", "Booking attempts by outcome", "result=\"house_taken\""),
+        metrics.counter("mboma_db_bookings_total", "Booking attempts by outcome", "result=\"house_not_found\""),
+        metrics.counter("mboma_db_bookings_total", "Booking attempts by outcome", "result=\"failed\"")
+    };
+    MetricsCounter* const paymentsRecorded = metrics.counter(
+        "mboma_db_payments_total", "Payments by outcome", "result=\"recorded\"");
+    MetricsCounter* const paymentsFailed = metrics.counter(
+        "mboma_db_payments_total", "Payments by outcome", "result=\"failed\"");
+    MetricsCounter* const paymentsRejected = metrics.counter(
+        "mboma_db_payments_total", "Payments by outcome", "result=\"rejected\"");
+
+    // Count booking and payment outcomes as the function returns, whichever return it takes
+    struct BookingTally {
+        const DBConnector::BookingResult* single;
+        const std::vector<DBConnector::BookingResult>* batch;
+
+        ~BookingTally() {
+            if (single) {
+                bookingOutcomes[single->status]->add();
+            }
+            for (size_t i = 0; batch && i < batch->size(); ++i) {
+                bookingOutcomes[(*batch)[i].status]->add();
+            }
+        }
+    };
+
+    struct PaymentTally {
+        const std::vector<std::string>* batch;    // Receipts, empty where not recorded; nullptr for one payment
+        bool recorded;                            // The one payment
+        size_t rejected;                          // Not recorded because the claim changed nothing
+
+        ~PaymentTally() {
+            if (!batch) {
+                (recorded ? paymentsRecorded : rejected ? paymentsRejected : paymentsFailed)->add();
+                return;
+            }
+            size_t recordedCount = 0;
+            for (size_t i = 0; i < batch->size(); ++i) {
+                recordedCount += (*batch)[i].empty() ? 0 : 1;
+            }
+            paymentsRecorded->add(recordedCount);
+            paymentsRejected->add(rejected);
+            paymentsFailed->add(batch->size() - recordedCount - rejected);
+        }
+    };
 }
 
+DBConnector::DBConnector() : pool(nullptr), connected(false), unloggedErrors(0) {}
+
 DBConnector::~DBConnector() {
     disconnect();
 }
 
 void DBConnector::setError(const std::string& error) {
-    lastError = error;
-    std::cerr << "DB Error: " << error << std::endl;
+    errorCount->add();
+
+    // Under an error storm every thread would queue on stderr; print one
+    // error per interval, outside the lock, and count the rest
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    unsigned long long skipped = 0;
+    bool print = false;
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        lastError = error;
+        if (now >= nextErrorLog) {
+            print = true;
+            skipped = unloggedErrors;
+            unloggedErrors = 0;
+            nextErrorLog = now + std::chrono::milliseconds(DBConfig::ERROR_LOG_INTERVAL_MS);
+        } else {
+            ++unloggedErrors;
+        }
+    }
+
+    if (print) {
+        std::ostringstream line;
+        line << "DB Error: " << error;
+        if (skipped > 0) {
+            line << " (" << skipped << " more not shown)";
+        }
+        line << '\n';
+        std::cerr << line.str();
+    }
 }
 
 std::string DBConnector::getLastError() const {
+    std::lock_guard<std::mutex> lock(errorMutex);
     return lastError;
 }
 
 bool DBConnector::connect(const std::string& host, const std::string& user, 
                          const std::string& password, const std::string& db) {
-    if (!conn) {
-        setError("MySQL initialization failed");
-        return false;
-    }
+    disconnect();
+    pool = new ConnectionPool(host, user, password, db, 
+                              DBConfig::POOL_MIN_SIZE, DBConfig::POOL_MAX_SIZE);
     
     // Try to connect with retry logic
     for (int attempt = 0; attempt < DBConfig::CONNECTION_RETRY_ATTEMPTS; ++attempt) {
-        if (mysql_real_connect(conn, host.c_str(), user.c_str(), 
-                             password.c_str(), db.c_str(), 0, nullptr, 0)) {
+        if (pool->start()) {
             connected = true;
             return true;
         }
@@ -46,7 +378,7 @@ bool DBConnector::connect(const std::string& host, const std::string& user,
         // If not the last attempt, wait and retry
         if (attempt < DBConfig::CONNECTION_RETRY_ATTEMPTS - 1) {
             std::string errorMsg = "Connection attempt " + std::to_string(attempt + 1) + 
-                                  " failed: " + mysql_error(conn) + 
+                                  " failed: " + pool->getLastError() + 
                                   ". Retrying in " + 
                                   std::to_string(DBConfig::CONNECTION_RETRY_DELAY_MS / 1000.0) + 
                                   " seconds...";
@@ -59,111 +391,212 @@ bool DBConnector::connect(const std::string& host, const std::string& user,
         }
     }
     
-    setError("Failed to connect to MySQL: " + std::string(mysql_error(conn)));
+    setError("Failed to connect to MySQL: " + pool->getLastError());
+    delete pool;
+    pool = nullptr;
     return false;
 }
 
 void DBConnector::disconnect() {
-    if (conn) {
-        mysql_close(conn);
-        conn = nullptr;
-    }
     connected = false;
+    if (pool) {
+        pool->shutdown();
+        delete pool;
+        pool = nullptr;
+    }
 }
 
 bool DBConnector::isConnected() const {
     return connected;
 }
 
-bool DBConnector::executeQuery(const std::string& query) {
-    if (!connected) {
+ConnectionPool::Stats DBConnector::getPoolStats() const {
+    if (!pool) {
+        ConnectionPool::Stats empty = ConnectionPool::Stats();
+        return empty;
+    }
+    return pool->getStats();
+}
+
+ConnectionPool::Handle DBConnector::acquire() {
+    if (!connected || !pool) {
         setError("Not connected to database");
-        return false;
+        return ConnectionPool::Handle();
     }
     
-    if (mysql_query(conn, query.c_str())) {
-        setError("MySQL query error: " + std::string(mysql_error(conn)));
+    ConnectionPool::Handle handle = pool->acquire(DBConfig::POOL_ACQUIRE_TIMEOUT_MS);
+    if (!handle) {
+        setError("No database connection available: " + pool->getLastError());
+    }
+    return handle;
+}
+
+bool DBConnector::executeQuery(ConnectionPool::Handle& handle, const std::string& query) {
+    MetricsTimer timer(queryLatency);
+    if (mysql_query(handle.mysql(), query.c_str())) {
+        queryErrors->add();
+        unsigned int errorCode = mysql_errno(handle.mysql());
+        setError("MySQL query error: " + std::string(mysql_error(handle.mysql())));
+        if (errorCode == CR_SERVER_GONE_ERROR || errorCode == CR_SERVER_LOST) {
+            handle.markBroken();
+        }
         return false;
     }
     
     return true;
 }
 
-bool DBConnector::registerUser(const User& user) {
-    // Escape strings to prevent SQL injection
-    char* escapedName = new char[user.getName().length() * 2 + 1];
-    char* escapedEmail = new char[user.getEmail().length() * 2 + 1];
-    char* escapedPhone = new char[user.getPhone().length() * 2 + 1];
-    char* escapedPassword = new char[user.getPassword().length() * 2 + 1];
-    
-    mysql_real_escape_string(conn, escapedName, user.getName().c_str(), user.getName().length());
-    mysql_real_escape_string(conn, escapedEmail, user.getEmail().c_str(), user.getEmail().length());
-    mysql_real_escape_string(conn, escapedPhone, user.getPhone().c_str(), user.getPhone().length());
-    mysql_real_escape_string(conn, escapedPassword, user.getPassword().c_str(), user.getPassword().length());
+PreparedStatement* DBConnector::prepare(ConnectionPool::Handle& handle, const std::string& sql) {
+    PreparedStatement* stmt = handle.statements()->get(sql);
+    if (!stmt) {
+        setError(handle.statements()->getLastError());
+    }
+    return stmt;
+}
+
+bool DBConnector::executeStatement(ConnectionPool::Handle& handle, PreparedStatement* stmt) {
+    MetricsTimer timer(statementLatency);
+    if (stmt->execute()) {
+        return true;
+    }
+    statementErrors->add();
     
-    // Create the query with escaped values
-    std::string query = "INSERT INTO user_info (first_name, second_name, email, phone_number, password) VALUES ('" + 
-                       std::string(escapedName) + "', '', '" + 
-                       std::string(escapedEmail) + "', '" + 
-                       std::string(escapedPhone) + "', '" + 
-                       std::string(escapedPassword) + "')";
+    unsigned int errorCode = stmt->getErrno();
+    setError("MySQL statement error: " + stmt->getError());
     
-    // Free allocated memory
-    delete[] escapedName;
-    delete[] escapedEmail;
-    delete[] escapedPhone;
-    delete[] escapedPassword;
+    // Statement handles do not survive a lost connection; the pool
+    // reconnects and the statements are re-prepared lazily
+    if (errorCode == CR_SERVER_GONE_ERROR || errorCode == CR_SERVER_LOST) {
+        handle.markBroken();
+    }
+    return false;
+}
+
+bool DBConnector::endTransaction(ConnectionPool::Handle& handle, bool success) {
+    if (success && executeQuery(handle, "COMMIT")) {
+        return true;
+    }
     
-    return executeQuery(query);
+    if (mysql_query(handle.mysql(), "ROLLBACK")) {
+        handle.markBroken();
+    }
+    return false;
 }
 
-bool DBConnector::authenticateUser(const std::string& email, const std::string& password) {
-    // Escape email to prevent SQL injection
-    char* escapedEmail = new char[email.length() * 2 + 1];
-    mysql_real_escape_string(conn, escapedEmail, email.c_str(), email.length());
+bool DBConnector::registerUser(User& user, bool* emailTaken) {
+    if (emailTaken) {
+        *emailTaken = false;
+    }
     
-    // Create query with escaped email - using LOWER function for case-insensitive comparison
-    std::string query = "SELECT password FROM user_info WHERE LOWER(email) = LOWER('" + std::string(escapedEmail) + "')";
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return false;
+    }
+    
+    // Values are sent as bound parameters, so no escaping is needed
+    PreparedStatement* stmt = prepare(handle, SQL_REGISTER_USER);
+    if (!stmt) {
+        return false;
+    }
     
-    // Free allocated memory
-    delete[] escapedEmail;
+    stmt->bindString(0, user.getName());
+    stmt->bindString(1, user.getEmail());
+    stmt->bindString(2, user.getPhone());
+    stmt->bindString(3, user.getPassword());
     
-    if (!executeQuery(query)) {
+    if (!executeStatement(handle, stmt)) {
+        if (emailTaken) {
+            *emailTaken = stmt->getErrno() == ER_DUP_ENTRY;
+        }
         return false;
     }
     
-    MYSQL_RES* result = mysql_store_result(conn);
-    if (!result) {
-        std::cerr << "Failed to get result: " << mysql_error(conn) << std::endl;
+    user.setId(static_cast<int>(stmt->insertId()));
+    return true;
+}
+
+bool DBConnector::authenticateUser(const std::string& email, const std::string& password) {
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return false;
+    }
+    
+    // Case-insensitive through the column collation
+    PreparedStatement* stmt = prepare(handle, SQL_AUTHENTICATE_USER);
+    if (!stmt) {
+        return false;
+    }
+    
+    stmt->bindString(0, email);
+    if (!executeStatement(handle, stmt)) {
         return false;
     }
     
     // Check if user exists and verify password
-    if (mysql_num_rows(result) == 0) {
-        mysql_free_result(result);
+    if (!stmt->fetch()) {
+        stmt->finish();
         return false;
     }
     
-    MYSQL_ROW row = mysql_fetch_row(result);
-    std::string hashedPassword = row[0] ? row[0] : "";
-    mysql_free_result(result);
+    std::string hashedPassword = stmt->getString(0);
+    stmt->finish();
     
     // Verify the password
     return verifyPassword(password, hashedPassword);
 }
 
+bool DBConnector::loadUserByEmail(const std::string& email, User& user) {
+    MetricsTimer timer(loadUserLatency);
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return false;
+    }
+    
+    PreparedStatement* stmt = prepare(handle, SQL_LOAD_USER_BY_EMAIL);
+    if (!stmt) {
+        return false;
+    }
+    
+    stmt->bindString(0, email);
+    if (!executeStatement(handle, stmt)) {
+        return false;
+    }
+    
+    if (!stmt->fetch()) {
+        stmt->finish();
+        return false;
+    }
+    
+    user = User();
+    user.setId(stmt->getInt(0));
+    user.setName(stmt->getString(1));
+    user.setPhone(stmt->getString(2));
+    user.setEmail(stmt->getString(3));
+    
+    // Stored hash is set directly (not re-hashed)
+    user.setPasswordHash(stmt->getString(4));
+    stmt->finish();
+    return true;
+}
+
 std::vector<Location> DBConnector::loadCounties() {
+    MetricsTimer timer(loadCountiesLatency);
     std::vector<Location> counties;
     
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return counties;
+    }
+    
     std::string query = "SELECT county_id, county_name FROM county ORDER BY county_id";
     
-    if (!executeQuery(query)) {
+    if (!executeQuery(handle, query)) {
         return counties;
     }
     
-    MYSQL_RES* result = mysql_store_result(conn);
+    MYSQL_RES* result = mysql_store_result(handle.mysql());
     if (!result) {
-        std::cerr << "Failed to get result: " << mysql_error(conn) << std::endl;
+        std::cerr << "Failed to get result: " << mysql_error(handle.mysql()) << std::endl;
         return counties;
     }
     
@@ -179,347 +612,726 @@ std::vector<Location> DBConnector::loadCounties() {
 }
 
 std::vector<Location> DBConnector::loadTowns(int countyId) {
+    MetricsTimer timer(loadTownsLatency);
     std::vector<Location> towns;
     
-    std::string query = "SELECT town_id, town_name FROM town WHERE county_id = " + 
-                        std::to_string(countyId) + " ORDER BY town_id";
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return towns;
+    }
     
-    if (!executeQuery(query)) {
+    PreparedStatement* stmt = prepare(handle, SQL_LOAD_TOWNS);
+    if (!stmt) {
         return towns;
     }
     
-    MYSQL_RES* result = mysql_store_result(conn);
-    if (!result) {
-        std::cerr << "Failed to get result: " << mysql_error(conn) << std::endl;
+    stmt->bindInt(0, countyId);
+    if (!executeStatement(handle, stmt)) {
         return towns;
     }
     
-    MYSQL_ROW row;
-    while ((row = mysql_fetch_row(result))) {
-        int townId = std::stoi(row[0]);
-        std::string name = row[1];
+    while (stmt->fetch()) {
+        int townId = stmt->getInt(0);
+        std::string name = stmt->getString(1);
         towns.push_back(Location(townId, name, "town", countyId));
     }
     
-    mysql_free_result(result);
+    stmt->finish();
     return towns;
 }
 
+std::vector<House> DBConnector::loadHouses(int townId) {
+    MetricsTimer timer(loadHousesLatency);
+    std::vector<House> houses;
+    
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return houses;
+    }
+    
+    PreparedStatement* stmt = prepare(handle, SQL_LOAD_HOUSES);
+    if (!stmt) {
+        return houses;
+    }
+    
+    stmt->bindInt(0, townId);
+    if (!executeStatement(handle, stmt)) {
+        return houses;
+    }
+    
+    while (stmt->fetch()) {
+        houses.push_back(readHouse(stmt));
+    }
+    
+    stmt->finish();
+    return houses;
+}
+
+std::string DBConnector::getChangeMark(int lagSeconds) {
+    MetricsTimer timer(changeMarkLatency);
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return "";
+    }
+    
+    PreparedStatement* stmt = prepare(handle, SQL_CHANGE_MARK);
+    if (!stmt) {
+        return "";
+    }
+    
+    stmt->bindInt(0, lagSeconds);
+    if (!executeStatement(handle, stmt)) {
+        return "";
+    }
+    
+    std::string mark = stmt->fetch() ? stmt->getString(0) : "";
+    stmt->finish();
+    return mark;
+}
+
+bool DBConnector::loadHousesChangedSince(const std::string& since, std::vector<House>& houses) {
+    MetricsTimer timer(housesChangedLatency);
+    houses.clear();
+    
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return false;
+    }
+    
+    PreparedStatement* stmt = prepare(handle, SQL_HOUSES_CHANGED_SINCE);
+    if (!stmt) {
+        return false;
+    }
+    
+    stmt->bindString(0, since);
+    if (!executeStatement(handle, stmt)) {
+        return false;
+    }
+    
+    while (stmt->fetch()) {
+        houses.push_back(readHouse(stmt));
+    }
+    
+    bool ok = stmt->getErrno() == 0;
+    if (!ok) {
+        setError("Failed while reading changed houses: " + stmt->getError());
+    }
+    stmt->finish();
+    return ok;
+}
+
+bool DBConnector::loadBookingsChangedSince(const std::string& since, std::vector<Booking>& bookings, int userId) {
+    MetricsTimer timer(bookingsChangedLatency);
+    bookings.clear();
+    
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return false;
+    }
+    
+    PreparedStatement* stmt = prepare(handle, userId > 0 ? SQL_USER_BOOKINGS_CHANGED_SINCE : SQL_BOOKINGS_CHANGED_SINCE);
+    if (!stmt) {
+        return false;
+    }
+    
+    stmt->bindString(0, since);
+    if (userId > 0) {
+        stmt->bindInt(1, userId);
+    }
+    if (!executeStatement(handle, stmt)) {
+        return false;
+    }
+    
+    while (stmt->fetch()) {
+        bookings.push_back(Booking(stmt->getInt(0), stmt->getInt(1), stmt->getString(2),
+                                   stmt->getString(3), stmt->getString(4), stmt->getInt(5) == 1));
+    }
+    
+    bool ok = stmt->getErrno() == 0;
+    if (!ok) {
+        setError("Failed while reading changed bookings: " + stmt->getError());
+    }
+    stmt->finish();
+    return ok;
+}
+
 std::vector<House> DBConnector::loadAllHouses() {
     std::vector<House> houses;
+    loadAllHousesInto(std::back_inserter(houses));
+    return houses;
+}
+
+bool DBConnector::forEachHouse(const HouseVisitor& visit) {
+    MetricsTimer timer(loadAllHousesLatency);
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return false;
+    }
     
     std::string query = "SELECT h.house_id, h.house_type, h.town_id, "
                         "h.house_address, h.map_link, h.deposit_fee, h.monthly_rent, "
-                        "h.is_available, h.is_booked, h.booked_until "
+                        "h.is_available, h.is_booked, h.booked_until, h.latitude, h.longitude "
                         "FROM houses h ORDER BY h.town_id, h.house_id";
     
-    if (!executeQuery(query)) {
-        return houses;
+    if (!executeQuery(handle, query)) {
+        return false;
     }
     
-    MYSQL_RES* result = mysql_store_result(conn);
+    // Rows are pulled from the server one at a time instead of being
+    // buffered in client memory first
+    MYSQL_RES* result = mysql_use_result(handle.mysql());
     if (!result) {
-        std::cerr << "Failed to get result: " << mysql_error(conn) << std::endl;
-        return houses;
+        setError("Failed to get result: " + std::string(mysql_error(handle.mysql())));
+        return false;
     }
     
     MYSQL_ROW row;
     while ((row = mysql_fetch_row(result))) {
-        std::string id = row[0];
-        std::string type = row[1];
-        int townId = std::stoi(row[2]);
-        std::string address = row[3] ? row[3] : "";
-        std::string mapLink = row[4] ? row[4] : "";
-        double deposit = row[5] ? std::stod(row[5]) : 0.0;
-        double rent = row[6] ? std::stod(row[6]) : 0.0;
-        bool isAvailable = row[7] ? (std::stoi(row[7]) == 1) : true;
-        bool isBooked = row[8] ? (std::stoi(row[8]) == 1) : false;
-        std::string bookedUntil = row[9] ? row[9] : "";
+        if (!visit(decodeHouseRow(row))) {
+            break;
+        }
+    }
+    
+    // mysql_free_result drains any rows left after an early stop
+    bool ok = mysql_errno(handle.mysql()) == 0;
+    if (!ok) {
+        setError("Failed while reading houses: " + std::string(mysql_error(handle.mysql())));
+    }
+    mysql_free_result(result);
+    return ok;
+}
+
+bool DBConnector::loadHouseCatalog(HouseCatalog& catalog) {
+    MetricsTimer timer(loadCatalogLatency);
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return false;
+    }
+    
+    catalog.clear();
+    
+    // Size the columns up front from the optimizer's (approximate) row count
+    if (executeQuery(handle, SQL_HOUSE_ROW_ESTIMATE)) {
+        MYSQL_RES* result = mysql_store_result(handle.mysql());
+        if (result) {
+            MYSQL_ROW row = mysql_fetch_row(result);
+            if (row && row[0]) {
+                catalog.reserve(std::strtoul(row[0], nullptr, 10));
+            }
+            mysql_free_result(result);
+        }
+    }
+    
+    MYSQL_STMT* stmt = mysql_stmt_init(handle.mysql());
+    if (!stmt) {
+        setError("MySQL statement initialization failed");
+        return false;
+    }
+    
+    if (mysql_stmt_prepare(stmt, SQL_HOUSE_CATALOG.c_str(), SQL_HOUSE_CATALOG.length())) {
+        setError("Failed to prepare statement: " + std::string(mysql_stmt_error(stmt)));
+        mysql_stmt_close(stmt);
+        return false;
+    }
+    
+    // One row of typed buffers, reused for every fetch
+    const unsigned int COLUMNS = 10;
+    char id[HouseCatalog::ID_WIDTH];
+    char type[256];
+    char address[512];
+    char mapLink[512];
+    int townId = 0;
+    double deposit = 0.0;
+    double rent = 0.0;
+    signed char isAvailable = 0;
+    signed char isBooked = 0;
+    MYSQL_TIME bookedUntil;
+    unsigned long lengths[COLUMNS];
+    PreparedStatement::BindFlag nulls[COLUMNS];
+    PreparedStatement::BindFlag errors[COLUMNS];
+    
+    MYSQL_BIND columns[COLUMNS];
+    std::memset(columns, 0, sizeof(columns));
+    std::memset(&bookedUntil, 0, sizeof(bookedUntil));
+    
+    columns[0].buffer_type = MYSQL_TYPE_STRING;
+    columns[0].buffer = id;
+    columns[0].buffer_length = sizeof(id);
+    columns[1].buffer_type = MYSQL_TYPE_STRING;
+    columns[1].buffer = type;
+    columns[1].buffer_length = sizeof(type);
+    columns[2].buffer_type = MYSQL_TYPE_LONG;
+    columns[2].buffer = &townId;
+    columns[3].buffer_type = MYSQL_TYPE_STRING;
+    columns[3].buffer = address;
+    columns[3].buffer_length = sizeof(address);
+    columns[4].buffer_type = MYSQL_TYPE_STRING;
+    columns[4].buffer = mapLink;
+    columns[4].buffer_length = sizeof(mapLink);
+    columns[5].buffer_type = MYSQL_TYPE_DOUBLE;
+    columns[5].buffer = &deposit;
+    columns[6].buffer_type = MYSQL_TYPE_DOUBLE;
+    columns[6].buffer = &rent;
+    columns[7].buffer_type = MYSQL_TYPE_TINY;
+    columns[7].buffer = &isAvailable;
+    columns[8].buffer_type = MYSQL_TYPE_TINY;
+    columns[8].buffer = &isBooked;
+    columns[9].buffer_type = MYSQL_TYPE_DATETIME;
+    columns[9].buffer = &bookedUntil;
+    
+    for (unsigned int i = 0; i < COLUMNS; ++i) {
+        columns[i].length = &lengths[i];
+        columns[i].is_null = &nulls[i];
+        columns[i].error = &errors[i];
+    }
+    
+    if (mysql_stmt_execute(stmt) || mysql_stmt_bind_result(stmt, columns)) {
+        setError("MySQL statement error: " + std::string(mysql_stmt_error(stmt)));
+        mysql_stmt_close(stmt);
+        return false;
+    }
+    
+    bool ok = true;
+    for (;;) {
+        int status = mysql_stmt_fetch(stmt);
+        if (status == MYSQL_NO_DATA) {
+            break;
+        }
+        if (status == 1) {
+            setError("Failed while reading houses: " + std::string(mysql_stmt_error(stmt)));
+            ok = false;
+            break;
+        }
         
-        House house(id, type, deposit, rent, townId, address, mapLink);
-        house.setAvailability(isAvailable);
+        // Oversized text (beyond the schema's column widths) is clipped
+        for (unsigned int i = 0; i < COLUMNS; ++i) {
+            if (nulls[i]) {
+                lengths[i] = 0;
+            } else if (columns[i].buffer_length > 0 && lengths[i] > columns[i].buffer_length) {
+                lengths[i] = columns[i].buffer_length;
+            }
+        }
         
-        if (isBooked && !bookedUntil.empty()) {
-            house.book(bookedUntil);
+        unsigned char flags = 0;
+        if (nulls[7] || isAvailable) flags |= HouseCatalog::FLAG_AVAILABLE;
+        long long packedUntil = 0;
+        if (!nulls[8] && isBooked && !nulls[9]) {
+            flags |= HouseCatalog::FLAG_BOOKED;
+            packedUntil = HouseCatalog::packDateTime(bookedUntil.year, bookedUntil.month, bookedUntil.day,
+                                                     bookedUntil.hour, bookedUntil.minute, bookedUntil.second);
         }
         
-        houses.push_back(house);
+        catalog.append(id, lengths[0], type, lengths[1], nulls[2] ? 0 : townId,
+                       address, lengths[3], mapLink, lengths[4],
+                       nulls[5] ? 0.0 : deposit, nulls[6] ? 0.0 : rent, flags, packedUntil);
     }
     
-    mysql_free_result(result);
-    return houses;
+    mysql_stmt_close(stmt);
+    return ok;
 }
 
 std::map<std::string, std::string> DBConnector::getPaymentDetails(const std::string& houseId, int townId) {
+    MetricsTimer timer(paymentDetailsLatency);
     std::map<std::string, std::string> details;
     
-    std::string query = "SELECT bank_acount, m_pesa_till_no, owner_contacts "
-                       "FROM payment_details "
-                       "WHERE house_id = '" + houseId + "'" + 
-                       " AND town_id = " + std::to_string(townId);
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return details;
+    }
     
-    if (!executeQuery(query)) {
+    PreparedStatement* stmt = prepare(handle, SQL_PAYMENT_DETAILS);
+    if (!stmt) {
         return details;
     }
     
-    MYSQL_RES* result = mysql_store_result(conn);
-    if (!result) {
-        std::cerr << "Failed to get result: " << mysql_error(conn) << std::endl;
+    stmt->bindString(0, houseId);
+    stmt->bindInt(1, townId);
+    if (!executeStatement(handle, stmt)) {
         return details;
     }
     
-    MYSQL_ROW row;
-    if ((row = mysql_fetch_row(result))) {
-        details["bank_account"] = row[0];
-        details["mpesa_till"] = row[1];
-        details["owner_contacts"] = row[2];
+    if (stmt->fetch()) {
+        details["bank_account"] = stmt->getString(0);
+        details["mpesa_till"] = stmt->getString(1);
+        details["owner_contacts"] = stmt->getString(2);
     }
     
-    mysql_free_result(result);
+    stmt->finish();
     return details;
 }
 
 std::vector<House> DBConnector::searchHouses(const std::string& type, 
                                            double minRent, 
                                            double maxRent, 
-                                           int townId) {
+                                           int townId,
+                                           const std::string& address) {
+    MetricsTimer timer(searchLatency);
     std::vector<House> results;
     
-    // Build the query based on search criteria
-    std::stringstream queryStream;
-    queryStream << "SELECT h.house_id, h.house_type, rc.deposit, rc.monthly_rent, h.town_id, "
-                << "CONCAT(t.town_name, ' Area, House #', h.house_id) as address, "
-                << "CONCAT('https://maps.google.com/?q=', t.town_name) as map_link "
-                << "FROM houses h "
-                << "JOIN rental_cost rc ON h.house_id = rc.house_id AND h.town_id = rc.town_id "
-                << "JOIN town t ON h.town_id = t.town_id "
-                << "WHERE 1=1 ";  // This allows us to conditionally add clauses
+    // Pick the statement shape for the filters that are set
+    int mask = 0;
+    if (!type.empty()) mask |= SEARCH_BY_TYPE;
+    if (minRent > 0) mask |= SEARCH_BY_MIN_RENT;
+    if (maxRent > 0) mask |= SEARCH_BY_MAX_RENT;
+    if (townId > 0) mask |= SEARCH_BY_TOWN;
+    if (!address.empty()) mask |= SEARCH_BY_ADDRESS;
     
-    // Add type condition if provided
-    if (!type.empty()) {
-        queryStream << "AND h.house_type LIKE '%" << type << "%' ";
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return results;
     }
     
-    // Add minimum rent condition if provided
-    if (minRent > 0) {
-        queryStream << "AND rc.monthly_rent >= " << minRent << " ";
+    PreparedStatement* stmt = prepare(handle, searchHousesSql(mask));
+    if (!stmt) {
+        return results;
     }
     
-    // Add maximum rent condition if provided
-    if (maxRent > 0) {
-        queryStream << "AND rc.monthly_rent <= " << maxRent << " ";
-    }
-    
-    // Add town condition if provided
-    if (townId > 0) {
-        queryStream << "AND h.town_id = " << townId << " ";
-    }
+    // Bind parameters in the order their placeholders appear
+    unsigned int param = 0;
+    if (mask & SEARCH_BY_TYPE) stmt->bindString(param++, type);
+    if (mask & SEARCH_BY_MIN_RENT) stmt->bindDouble(param++, minRent);
+    if (mask & SEARCH_BY_MAX_RENT) stmt->bindDouble(param++, maxRent);
+    if (mask & SEARCH_BY_TOWN) stmt->bindInt(param++, townId);
+    if (mask & SEARCH_BY_ADDRESS) stmt->bindString(param++, address);
     
     // Execute the query
-    std::string query = queryStream.str();
-    if (!executeQuery(query)) {
-        return results;
-    }
-    
-    // Process results
-    MYSQL_RES* result = mysql_store_result(conn);
-    if (!result) {
-        std::cerr << "Failed to get result: " << mysql_error(conn) << std::endl;
+    if (!executeStatement(handle, stmt)) {
         return results;
     }
     
     // Extract houses from the result
-    MYSQL_ROW row;
-    while ((row = mysql_fetch_row(result))) {
-        std::string id = row[0];
-        std::string houseType = row[1];
-        double deposit = std::stod(row[2]);
-        double monthlyRent = std::stod(row[3]);
-        int houseLocationId = std::stoi(row[4]);
-        std::string address = row[5];
-        std::string mapLink = row[6];
-        
+    while (stmt->fetch()) {
         // Create a house object and add to results
-        results.push_back(House(id, houseType, deposit, monthlyRent, 
-                              houseLocationId, address, mapLink));
+        results.push_back(House(stmt->getString(0), stmt->getString(1), 
+                              stmt->getDouble(2), stmt->getDouble(3), 
+                              stmt->getInt(4), stmt->getString(5), stmt->getString(6)));
     }
     
-    mysql_free_result(result);
+    stmt->finish();
     return results;
 }
 
 std::vector<Booking> DBConnector::loadBookings(int userId) {
     std::vector<Booking> bookings;
-    
-    if (!isConnected()) {
-        setError("Not connected to database");
-        return bookings;
+    loadBookingsInto(std::back_inserter(bookings), userId);
+    return bookings;
+}
+
+bool DBConnector::forEachBooking(const BookingVisitor& visit, int userId) {
+    MetricsTimer timer(loadBookingsLatency);
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return false;
     }
     
-    std::string query = "SELECT booking_id, user_id, house_id, booking_date, expiry_date, is_paid FROM bookings";
-    
     // If userId is provided, filter bookings for this user only
+    PreparedStatement* stmt = prepare(handle, userId > 0 ? SQL_LOAD_USER_BOOKINGS : SQL_LOAD_BOOKINGS);
+    if (!stmt) {
+        return false;
+    }
+    
     if (userId > 0) {
-        query += " WHERE user_id = " + std::to_string(userId);
+        stmt->bindInt(0, userId);
     }
     
-    if (mysql_query(conn, query.c_str())) {
-        setError(mysql_error(conn));
-        return bookings;
+    // Unbuffered execution streams rows from the server as they are fetched
+    if (!stmt->execute(false)) {
+        setError("MySQL statement error: " + stmt->getError());
+        return false;
     }
     
-    MYSQL_RES* result = mysql_store_result(conn);
-    if (!result) {
-        setError(mysql_error(conn));
-        return bookings;
+    while (stmt->fetch()) {
+        // Dates and payment status come straight from the database
+        Booking booking(stmt->getInt(0), stmt->getInt(1), stmt->getString(2),
+                        stmt->getString(3), stmt->getString(4), stmt->getInt(5) == 1);
+        if (!visit(std::move(booking))) {
+            break;
+        }
     }
     
-    MYSQL_ROW row;
-    while ((row = mysql_fetch_row(result))) {
-        int bookingId = std::stoi(row[0]);
-        int userIdFromDb = std::stoi(row[1]);
-        std::string houseId = row[2];
-        
-        // Create booking object with core data
-        Booking booking(bookingId, userIdFromDb, houseId);
-        
-        // Set dates from database
-        if (row[3]) booking.setBookingDate(row[3]);
-        if (row[4]) booking.setExpiryDate(row[4]);
-        
-        // Set payment status if booking is paid
-        if (row[5] && std::string(row[5]) == "1") {
-            booking.markAsPaid();
+    bool ok = stmt->getErrno() == 0;
+    if (!ok) {
+        setError("Failed while reading bookings: " + stmt->getError());
+    }
+    stmt->finish();
+    return ok;
+}
+
+bool DBConnector::forEachCurrentBooking(const BookingVisitor& visit) {
+    MetricsTimer timer(currentBookingsLatency);
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return false;
+    }
+    
+    PreparedStatement* stmt = prepare(handle, SQL_LOAD_CURRENT_BOOKINGS);
+    if (!stmt) {
+        return false;
+    }
+    
+    if (!stmt->execute(false)) {
+        setError("MySQL statement error: " + stmt->getError());
+        return false;
+    }
+    
+    while (stmt->fetch()) {
+        Booking booking(stmt->getInt(0), stmt->getInt(1), stmt->getString(2),
+                        stmt->getString(3), stmt->getString(4), stmt->getInt(5) == 1);
+        if (!visit(std::move(booking))) {
+            break;
         }
-        
-        bookings.push_back(booking);
     }
     
-    mysql_free_result(result);
-    return bookings;
+    bool ok = stmt->getErrno() == 0;
+    if (!ok) {
+        setError("Failed while reading current bookings: " + stmt->getError());
+    }
+    stmt->finish();
+    return ok;
 }
 
-int DBConnector::createBooking(int userId, const std::string& houseId, int townId) {
-    // Get the current date and expiry date
-    std::string bookingDate = getCurrentDateTime();
+DBConnector::BookingResult DBConnector::bookHouse(int userId, const std::string& houseId, int townId) {
+    MetricsTimer timer(bookingLatency);
+    BookingResult result;
+    result.status = BOOKING_FAILED;
+    result.bookingId = -1;
+    BookingTally tally = { &result, nullptr };
+    
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return result;
+    }
     
-    // Calculate expiry date (30 days from now)
-    auto now = std::chrono::system_clock::now();
-    auto expiry = now + std::chrono::hours(24 * 30);
-    std::time_t expiry_time = std::chrono::system_clock::to_time_t(expiry);
+    PreparedStatement* stmt = prepare(handle, SQL_BOOK_HOUSE);
+    if (!stmt) {
+        return result;
+    }
     
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&expiry_time), "%Y-%m-%d %H:%M:%S");
-    std::string expiryDate = ss.str();
+    stmt->bindInt(0, userId);
+    stmt->bindString(1, houseId);
+    stmt->bindInt(2, townId);
     
-    // Create the booking query
-    std::string query = "INSERT INTO bookings (user_id, house_id, town_id, booking_date, expiry_date, is_paid) "
-                        "VALUES (" + std::to_string(userId) + ", '" + 
-                        houseId + "', " + 
-                        std::to_string(townId) + ", '" + 
-                        bookingDate + "', '" + 
-                        expiryDate + "', 0)";
-                        
-    if (!executeQuery(query)) {
-        return -1;
+    if (!executeStatement(handle, stmt)) {
+        return result;
     }
     
-    // Get the auto-generated booking ID
-    unsigned long bookingId = mysql_insert_id(conn);
+    if (!stmt->fetch()) {
+        setError("book_house returned no status row: " + stmt->getError());
+        stmt->finish();
+        return result;
+    }
     
-    // Mark the house as booked
-    std::string updateHouseQuery = "UPDATE houses SET is_booked = 1 WHERE house_id = '" + 
-                                  houseId + "' AND town_id = " + 
-                                  std::to_string(townId);
-    executeQuery(updateHouseQuery);
+    int status = stmt->getInt(0);
+    if (status >= BOOKING_CREATED && status <= BOOKING_FAILED) {
+        result.status = static_cast<BookingStatus>(status);
+    }
+    result.bookingId = stmt->getInt(1);
+    result.bookingDate = stmt->getString(2);
+    result.expiryDate = stmt->getString(3);
+    stmt->finish();
     
-    return static_cast<int>(bookingId);
+    if (result.status == BOOKING_FAILED) {
+        setError("book_house failed for house " + houseId);
+    }
+    return result;
+}
+
+int DBConnector::createBooking(int userId, const std::string& houseId, int townId, BookingStatus* status) {
+    BookingResult result = bookHouse(userId, houseId, townId);
+    if (status) {
+        *status = result.status;
+    }
+    return result.status == BOOKING_CREATED ? result.bookingId : -1;
 }
 
-std::string DBConnector::recordPayment(int bookingId, double amount, const std::string& paymentMethod) {
+std::string DBConnector::recordPayment(int userId, int bookingId, double amount, const std::string& paymentMethod) {
+    MetricsTimer timer(paymentLatency);
     std::string paymentDate = getCurrentDateTime();
     std::string receiptNumber = generateReceiptNumber();
     
-    // Escape strings to prevent SQL injection
-    char* escapedMethod = new char[paymentMethod.length() * 2 + 1];
-    char* escapedReceipt = new char[receiptNumber.length() * 2 + 1];
-    
-    mysql_real_escape_string(conn, escapedMethod, paymentMethod.c_str(), paymentMethod.length());
-    mysql_real_escape_string(conn, escapedReceipt, receiptNumber.c_str(), receiptNumber.length());
-    
-    // Create the payment query
-    std::string query = "INSERT INTO payments (booking_id, amount, payment_date, payment_method, receipt_number) "
-                        "VALUES (" + std::to_string(bookingId) + ", " + 
-                        std::to_string(amount) + ", '" + 
-                        paymentDate + "', '" + 
-                        std::string(escapedMethod) + "', '" + 
-                        std::string(escapedReceipt) + "')";
-                        
-    // Free allocated memory
-    delete[] escapedMethod;
-    delete[] escapedReceipt;
-    
-    if (!executeQuery(query)) {
+    PaymentTally tally = { nullptr, false, 0 };
+    
+    // The claim and the payment are committed together or not at all
+    ConnectionPool::Handle handle = acquire();
+    if (!handle || !executeQuery(handle, "START TRANSACTION")) {
         return "";
     }
     
-    // Mark the booking as paid
-    std::string updateBookingQuery = "UPDATE bookings SET is_paid = 1 WHERE booking_id = " + 
-                                    std::to_string(bookingId);
-    executeQuery(updateBookingQuery);
+    PreparedStatement* claimStmt = prepare(handle, SQL_CLAIM_BOOKING_PAYMENT);
+    bool ok = claimStmt != nullptr;
+    bool claimed = false;
+    if (ok) {
+        claimStmt->bindInt(0, bookingId);
+        claimStmt->bindInt(1, userId);
+        ok = executeStatement(handle, claimStmt);
+        claimed = ok && claimStmt->affectedRows() == 1;
+    }
     
+    if (claimed) {
+        PreparedStatement* insertStmt = prepare(handle, SQL_INSERT_PAYMENT);
+        ok = insertStmt != nullptr;
+        if (ok) {
+            insertStmt->bindInt(0, bookingId);
+            insertStmt->bindDouble(1, amount);
+            insertStmt->bindString(2, paymentDate);
+            insertStmt->bindString(3, paymentMethod);
+            insertStmt->bindString(4, receiptNumber);
+            ok = executeStatement(handle, insertStmt);
+        }
+    }
+    
+    if (!endTransaction(handle, claimed && ok)) {
+        tally.rejected = ok && !claimed ? 1 : 0;
+        return "";
+    }
+    
+    tally.recorded = true;
     return receiptNumber;
 }
 
+DBConnector::PaymentResult DBConnector::payBooking(int userId, int bookingId, const std::string& paymentMethod) {
+    MetricsTimer timer(paymentLatency);
+    PaymentResult result;
+    result.status = PAYMENT_FAILED;
+    result.amount = 0.0;
+    
+    ConnectionPool::Handle handle = acquire();
+    if (!handle || !executeQuery(handle, "START TRANSACTION")) {
+        paymentsFailed->add();
+        return result;
+    }
+    
+    // Claim first: a second payment for the booking blocks on the row lock
+    // here, then finds it paid and changes nothing
+    PreparedStatement* claimStmt = prepare(handle, SQL_CLAIM_BOOKING_PAYMENT);
+    bool ok = claimStmt != nullptr;
+    bool claimed = false;
+    if (ok) {
+        claimStmt->bindInt(0, bookingId);
+        claimStmt->bindInt(1, userId);
+        ok = executeStatement(handle, claimStmt);
+        claimed = ok && claimStmt->affectedRows() == 1;
+    }
+    
+    // The house and deposit, or why the claim changed nothing
+    bool found = false;
+    if (ok) {
+        PreparedStatement* stateStmt = prepare(handle, SQL_BOOKING_PAYMENT_STATE);
+        ok = stateStmt != nullptr;
+        if (ok) {
+            stateStmt->bindInt(0, bookingId);
+            stateStmt->bindInt(1, userId);
+            ok = executeStatement(handle, stateStmt);
+        }
+        if (ok && stateStmt->fetch()) {
+            found = true;
+            result.houseId = stateStmt->getString(0);
+            if (stateStmt->isNull(1)) {
+                result.status = PAYMENT_HOUSE_NOT_LISTED;
+            } else {
+                result.amount = stateStmt->getDouble(1);
+            }
+        }
+        if (stateStmt) {
+            stateStmt->finish();
+        }
+    }
+    
+    if (ok && !claimed) {
+        result.status = found ? PAYMENT_ALREADY_PAID : PAYMENT_BOOKING_NOT_FOUND;
+    }
+    
+    std::string receiptNumber;
+    bool insert = ok && claimed && found && result.status != PAYMENT_HOUSE_NOT_LISTED;
+    if (insert) {
+        receiptNumber = generateReceiptNumber();
+        PreparedStatement* insertStmt = prepare(handle, SQL_INSERT_PAYMENT);
+        ok = insertStmt != nullptr;
+        if (ok) {
+            insertStmt->bindInt(0, bookingId);
+            insertStmt->bindDouble(1, result.amount);
+            insertStmt->bindString(2, getCurrentDateTime());
+            insertStmt->bindString(3, paymentMethod);
+            insertStmt->bindString(4, receiptNumber);
+            ok = executeStatement(handle, insertStmt);
+        }
+    }
+    
+    // Rejected payments roll back, leaving the booking as it was
+    if (!endTransaction(handle, insert && ok)) {
+        if (insert || !ok || result.status == PAYMENT_FAILED) {
+            result.status = PAYMENT_FAILED;
+            paymentsFailed->add();
+        } else {
+            paymentsRejected->add();
+        }
+        return result;
+    }
+    
+    result.status = PAYMENT_RECORDED;
+    result.receiptNumber = receiptNumber;
+    paymentsRecorded->add();
+    return result;
+}
+
 std::vector<User> DBConnector::loadUsers() {
     std::vector<User> users;
+    loadUsersInto(std::back_inserter(users));
+    return users;
+}
+
+bool DBConnector::forEachUser(const UserVisitor& visit) {
+    MetricsTimer timer(loadUsersLatency);
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return false;
+    }
     
     std::string query = "SELECT user_id, first_name, phone_number, email, password FROM user_info";
     
-    if (!executeQuery(query)) {
-        return users;
+    if (!executeQuery(handle, query)) {
+        return false;
     }
     
-    MYSQL_RES* result = mysql_store_result(conn);
+    MYSQL_RES* result = mysql_use_result(handle.mysql());
     if (!result) {
-        std::cerr << "Failed to get result: " << mysql_error(conn) << std::endl;
-        return users;
+        setError("Failed to get result: " + std::string(mysql_error(handle.mysql())));
+        return false;
     }
     
     MYSQL_ROW row;
     while ((row = mysql_fetch_row(result))) {
-        // Extract user data
-        // user_id is in row[0] but we don't need it currently
-        std::string name = row[1] ? row[1] : "";
-        std::string phone = row[2] ? row[2] : "";
-        std::string email = row[3] ? row[3] : "";
-        std::string hashedPassword = row[4] ? row[4] : "";
-        
-        // Create user with the existing hashed password (not re-hashing)
-        User user;
-        user.setName(name);
-        user.setPhone(phone);
-        user.setEmail(email);
-        user.setPasswordHash(hashedPassword); // Direct set of hashed password
-        users.push_back(user);
+        if (!visit(decodeUserRow(row))) {
+            break;
+        }
     }
     
+    bool ok = mysql_errno(handle.mysql()) == 0;
+    if (!ok) {
+        setError("Failed while reading users: " + std::string(mysql_error(handle.mysql())));
+    }
     mysql_free_result(result);
-    return users;
+    return ok;
 }
 
 std::vector<Location> DBConnector::loadAllTowns() {
+    MetricsTimer timer(loadAllTownsLatency);
     std::vector<Location> towns;
     
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return towns;
+    }
+    
     std::string query = "SELECT t.town_id, t.town_name, t.county_id FROM town t ORDER BY t.town_id";
     
-    if (!executeQuery(query)) {
+    if (!executeQuery(handle, query)) {
         return towns;
     }
     
-    MYSQL_RES* result = mysql_store_result(conn);
+    MYSQL_RES* result = mysql_store_result(handle.mysql());
     if (!result) {
-        std::cerr << "Failed to get result: " << mysql_error(conn) << std::endl;
+        std::cerr << "Failed to get result: " << mysql_error(handle.mysql()) << std::endl;
         return towns;
     }
     
@@ -534,3 +1346,360 @@ std::vector<Location> DBConnector::loadAllTowns() {
     mysql_free_result(result);
     return towns;
 }
+
+bool DBConnector::bookHouses(const std::vector<BookingRequest>& requests, std::vector<BookingResult>& results) {
+    MetricsTimer timer(bookingBatchLatency);
+    BookingResult failed;
+    failed.status = BOOKING_FAILED;
+    failed.bookingId = -1;
+    results.assign(requests.size(), failed);
+    BookingTally tally = { nullptr, &results };
+    
+    if (requests.empty()) {
+        return true;
+    }
+    
+    ConnectionPool::Handle handle = acquire();
+    if (!handle || !executeQuery(handle, "START TRANSACTION")) {
+        return false;
+    }
+    
+    // Lock every requested house and read its current state
+    struct HouseState {
+        int townId;
+        bool free;
+        std::string bookedUntil;
+    };
+    std::map<std::string, HouseState> houses;
+    std::string now;
+    std::string expiry;
+    
+    PreparedStatement* lockStmt = prepare(handle, lockHousesSql(requests.size()));
+    if (!lockStmt) {
+        return endTransaction(handle, false);
+    }
+    for (size_t i = 0; i < requests.size(); ++i) {
+        lockStmt->bindString(i, requests[i].houseId);
+    }
+    if (!executeStatement(handle, lockStmt)) {
+        return endTransaction(handle, false);
+    }
+    while (lockStmt->fetch()) {
+        HouseState state;
+        state.townId = lockStmt->getInt(1);
+        state.free = lockStmt->getInt(2) == 1 && lockStmt->getInt(3) == 0;
+        state.bookedUntil = lockStmt->getString(4);
+        houses[lockStmt->getString(0)] = state;
+        now = lockStmt->getString(5);
+        expiry = lockStmt->getString(6);
+    }
+    lockStmt->finish();
+    
+    // Decide each request in order; a claimed house is no longer free
+    std::vector<size_t> claimed;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        BookingResult& result = results[i];
+        std::map<std::string, HouseState>::iterator house = houses.find(requests[i].houseId);
+        if (house == houses.end() || house->second.townId != requests[i].townId) {
+            result.status = BOOKING_HOUSE_NOT_FOUND;
+        } else if (!house->second.free) {
+            result.status = BOOKING_HOUSE_TAKEN;
+            result.expiryDate = house->second.bookedUntil;
+        } else {
+            house->second.free = false;
+            house->second.bookedUntil = expiry;
+            result.status = BOOKING_CREATED;
+            result.bookingDate = now;
+            result.expiryDate = expiry;
+            claimed.push_back(i);
+        }
+    }
+    
+    if (claimed.empty()) {
+        if (endTransaction(handle, true)) {
+            return true;
+        }
+        results.assign(requests.size(), failed);
+        return false;
+    }
+    
+    bool ok = true;
+    
+    PreparedStatement* claimStmt = prepare(handle, claimHousesSql(claimed.size()));
+    ok = claimStmt != nullptr;
+    if (ok) {
+        claimStmt->bindString(0, expiry);
+        for (size_t i = 0; i < claimed.size(); ++i) {
+            claimStmt->bindString(i + 1, requests[claimed[i]].houseId);
+        }
+        ok = executeStatement(handle, claimStmt);
+    }
+    
+    unsigned long long firstBookingId = 0;
+    if (ok) {
+        PreparedStatement* insertStmt = prepare(handle, insertBookingsSql(claimed.size()));
+        ok = insertStmt != nullptr;
+        if (ok) {
+            for (size_t i = 0; i < claimed.size(); ++i) {
+                const BookingRequest& request = requests[claimed[i]];
+                insertStmt->bindInt(i * 5, request.userId);
+                insertStmt->bindString(i * 5 + 1, request.houseId);
+                insertStmt->bindInt(i * 5 + 2, request.townId);
+                insertStmt->bindString(i * 5 + 3, now);
+                insertStmt->bindString(i * 5 + 4, expiry);
+            }
+            ok = executeStatement(handle, insertStmt);
+            if (ok) {
+                firstBookingId = insertStmt->insertId();
+            }
+        }
+    }
+    
+    // Auto-increment values of a multi-row insert are not guaranteed to be
+    // consecutive, so map the new IDs back by house
+    std::map<std::string, int> bookingIds;
+    if (ok) {
+        PreparedStatement* idStmt = prepare(handle, newBookingIdsSql(claimed.size()));
+        ok = idStmt != nullptr;
+        if (ok) {
+            idStmt->bindInt(0, static_cast<long long>(firstBookingId));
+            for (size_t i = 0; i < claimed.size(); ++i) {
+                idStmt->bindString(i + 1, requests[claimed[i]].houseId);
+            }
+            ok = executeStatement(handle, idStmt);
+        }
+        if (ok) {
+            while (idStmt->fetch()) {
+                bookingIds[idStmt->getString(1)] = idStmt->getInt(0);
+            }
+            idStmt->finish();
+            ok = bookingIds.size() == claimed.size();
+            if (!ok) {
+                setError("Could not read back the IDs of the new bookings");
+            }
+        }
+    }
+    
+    if (!endTransaction(handle, ok)) {
+        results.assign(requests.size(), failed);
+        return false;
+    }
+    
+    for (size_t i = 0; i < claimed.size(); ++i) {
+        results[claimed[i]].bookingId = bookingIds[requests[claimed[i]].houseId];
+    }
+    return true;
+}
+
+bool DBConnector::recordPayments(const std::vector<PaymentRequest>& requests, std::vector<std::string>& receipts) {
+    MetricsTimer timer(paymentBatchLatency);
+    receipts.assign(requests.size(), "");
+    PaymentTally tally = { &receipts, false, 0 };
+    
+    if (requests.empty()) {
+        return true;
+    }
+    
+    ConnectionPool::Handle handle = acquire();
+    if (!handle || !executeQuery(handle, "START TRANSACTION")) {
+        return false;
+    }
+    
+    // Lock the unpaid bookings and note their owners
+    std::map<int, int> unpaidOwners;
+    PreparedStatement* lockStmt = prepare(handle, lockUnpaidBookingsSql(requests.size()));
+    bool ok = lockStmt != nullptr;
+    if (ok) {
+        for (size_t i = 0; i < requests.size(); ++i) {
+            lockStmt->bindInt(i, requests[i].bookingId);
+        }
+        ok = executeStatement(handle, lockStmt);
+    }
+    if (ok) {
+        while (lockStmt->fetch()) {
+            unpaidOwners[lockStmt->getInt(0)] = lockStmt->getInt(1);
+        }
+        lockStmt->finish();
+    }
+    
+    // Requests are decided in order; a booking is claimed at most once
+    std::vector<size_t> claimed;
+    for (size_t i = 0; ok && i < requests.size(); ++i) {
+        std::map<int, int>::iterator owner = unpaidOwners.find(requests[i].bookingId);
+        if (owner != unpaidOwners.end() && owner->second == requests[i].userId) {
+            claimed.push_back(i);
+            unpaidOwners.erase(owner);
+        }
+    }
+    
+    if (ok && !claimed.empty()) {
+        PreparedStatement* claimStmt = prepare(handle, claimBookingPaymentsSql(claimed.size()));
+        ok = claimStmt != nullptr;
+        if (ok) {
+            for (size_t c = 0; c < claimed.size(); ++c) {
+                claimStmt->bindInt(c, requests[claimed[c]].bookingId);
+            }
+            ok = executeStatement(handle, claimStmt) && claimStmt->affectedRows() == claimed.size();
+        }
+    }
+    
+    std::string paymentDate = getCurrentDateTime();
+    std::vector<std::string> newReceipts(requests.size());
+    if (ok && !claimed.empty()) {
+        PreparedStatement* insertStmt = prepare(handle, insertPaymentsSql(claimed.size()));
+        ok = insertStmt != nullptr;
+        if (ok) {
+            for (size_t c = 0; c < claimed.size(); ++c) {
+                const PaymentRequest& request = requests[claimed[c]];
+                newReceipts[claimed[c]] = generateReceiptNumber();
+                insertStmt->bindInt(c * 5, request.bookingId);
+                insertStmt->bindDouble(c * 5 + 1, request.amount);
+                insertStmt->bindString(c * 5 + 2, paymentDate);
+                insertStmt->bindString(c * 5 + 3, request.paymentMethod);
+                insertStmt->bindString(c * 5 + 4, newReceipts[claimed[c]]);
+            }
+            ok = executeStatement(handle, insertStmt);
+        }
+    }
+    
+    if (!endTransaction(handle, ok)) {
+        return false;
+    }
+    
+    receipts.swap(newReceipts);
+    tally.rejected = requests.size() - claimed.size();
+    return true;
+}
+
+bool DBConnector::forEachPendingExpiry(const ExpiryVisitor& visit) {
+    MetricsTimer timer(pendingExpiriesLatency);
+    ConnectionPool::Handle handle = acquire();
+    if (!handle) {
+        return false;
+    }
+    
+    PreparedStatement* stmt = prepare(handle, SQL_PENDING_EXPIRIES);
+    if (!stmt) {
+        return false;
+    }
+    
+    // Unbuffered: there can be millions of outstanding bookings
+    if (!stmt->execute(false)) {
+        setError("MySQL statement error: " + stmt->getError());
+        return false;
+    }
+    
+    while (stmt->fetch()) {
+        if (!visit(stmt->getInt(0), stmt->getString(1))) {
+            break;
+        }
+    }
+    
+    bool ok = stmt->getErrno() == 0;
+    if (!ok) {
+        setError("Failed while reading pending expiries: " + stmt->getError());
+    }
+    stmt->finish();
+    return ok;
+}
+
+bool DBConnector::expireBookings(const std::vector<int>& bookingIds, std::vector<std::string>& releasedHouses,
+                                 std::vector<std::pair<int, std::string> >& notDue) {
+    releasedHouses.clear();
+    notDue.clear();
+    
+    if (bookingIds.empty()) {
+        return true;
+    }
+    
+    ConnectionPool::Handle handle = acquire();
+    if (!handle || !executeQuery(handle, "START TRANSACTION")) {
+        return false;
+    }
+    
+    // Lock the batch's active bookings, then split the due ones from those
+    // whose timer fired before the server's clock reached their expiry date
+    std::vector<int> due;
+    std::vector<std::string> houses;
+    std::vector<std::pair<int, std::string> > early;
+    PreparedStatement* lockStmt = prepare(handle, lockExpiredBookingsSql(bookingIds.size()));
+    bool ok = lockStmt != nullptr;
+    if (ok) {
+        for (size_t i = 0; i < bookingIds.size(); ++i) {
+            lockStmt->bindInt(i, bookingIds[i]);
+        }
+        ok = executeStatement(handle, lockStmt);
+    }
+    if (ok) {
+        while (lockStmt->fetch()) {
+            if (lockStmt->isNull(2)) {
+                continue;
+            }
+            if (lockStmt->getInt(3) == 0) {
+                early.push_back(std::make_pair(lockStmt->getInt(0), lockStmt->getString(2)));
+                continue;
+            }
+            due.push_back(lockStmt->getInt(0));
+            std::string houseId = lockStmt->getString(1);
+            if (std::find(houses.begin(), houses.end(), houseId) == houses.end()) {
+                houses.push_back(houseId);
+            }
+        }
+        lockStmt->finish();
+    }
+    
+    if (!ok || due.empty()) {
+        if (!endTransaction(handle, ok)) {
+            return false;
+        }
+        notDue.swap(early);
+        return true;
+    }
+    
+    PreparedStatement* expireStmt = prepare(handle, markBookingsExpiredSql(due.size()));
+    ok = expireStmt != nullptr;
+    if (ok) {
+        for (size_t i = 0; i < due.size(); ++i) {
+            expireStmt->bindInt(i, due[i]);
+        }
+        ok = executeStatement(handle, expireStmt);
+    }
+    
+    // Houses booked again since still have a future booked_until
+    std::vector<std::string> released;
+    if (ok) {
+        PreparedStatement* houseStmt = prepare(handle, lockReleasableHousesSql(houses.size()));
+        ok = houseStmt != nullptr;
+        if (ok) {
+            for (size_t i = 0; i < houses.size(); ++i) {
+                houseStmt->bindString(i, houses[i]);
+            }
+            ok = executeStatement(handle, houseStmt);
+        }
+        if (ok) {
+            while (houseStmt->fetch()) {
+                released.push_back(houseStmt->getString(0));
+            }
+            houseStmt->finish();
+        }
+    }
+    
+    if (ok && !released.empty()) {
+        PreparedStatement* releaseStmt = prepare(handle, releaseHousesSql(released.size()));
+        ok = releaseStmt != nullptr;
+        if (ok) {
+            for (size_t i = 0; i < released.size(); ++i) {
+                releaseStmt->bindString(i, released[i]);
+            }
+            ok = executeStatement(handle, releaseStmt);
+        }
+    }
+    
+    if (!endTransaction(handle, ok)) {
+        return false;
+    }
+    
+    releasedHouses.swap(released);
+    notDue.swap(early);
+    return true;
+}
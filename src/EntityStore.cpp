@@ -0,0 +1,580 @@
+#include "include/EntityStore.h"
+#include "include/Utils.h"
+#include <algorithm>
+#include <iterator>
+#include <queue>
+
+namespace {
+    const std::vector<size_t> NO_SLOTS;
+
+    bool byTown(const House& a, const House& b) {
+        return a.getLocationId() < b.getLocationId();
+    }
+
+    bool sameText(const House& a, const House& b) {
+        return a.getType() == b.getType() && a.getAddress() == b.getAddress();
+    }
+
+    bool samePosition(const House& a, const House& b) {
+        return a.hasCoordinates() == b.hasCoordinates() &&
+               a.getLatitude() == b.getLatitude() && a.getLongitude() == b.getLongitude();
+    }
+
+    // Add a search result unless the limit (0 for none) is reached
+    void keep(EntityStore::SearchResult& result, const House& house, size_t limit) {
+        if (limit > 0 && result.houses.size() == limit) {
+            result.truncated = true;
+            return;
+        }
+        result.houses.push_back(house);
+    }
+
+    // The next open house of one town in a rent-ordered search
+    struct RentCursor {
+        const CatalogSnapshot::TownPartition* town;
+        size_t position;    // Into town->openByRent
+        double rent;
+
+        RentCursor(const CatalogSnapshot::TownPartition* town, size_t position)
+            : town(town), position(position),
+              rent(town->houses[town->openByRent[position]].getMonthlyRent()) {}
+    };
+
+    // Orders a priority queue so the cheapest cursor is on top
+    struct CheaperFirst {
+        bool operator()(const RentCursor& a, const RentCursor& b) const { return a.rent > b.rent; }
+    };
+}
+
+void EntityStore::setLocations(const std::vector<Location>& newLocations) {
+    locations.clear();
+    countyOrder.clear();
+    countySlots.clear();
+    townSlots.clear();
+    countyTowns.clear();
+    locationNames.clear();
+
+    locations.reserve(newLocations.size());
+    for (size_t i = 0; i < newLocations.size(); ++i) {
+        locations.push_back(newLocations[i]);
+        indexLocation(locations.size() - 1);
+    }
+    locationNames.sort();
+}
+
+void EntityStore::addLocation(const Location& location) {
+    locations.push_back(location);
+    indexLocation(locations.size() - 1);
+    locationNames.sort();
+}
+
+void EntityStore::indexLocation(size_t slot) {
+    const Location& location = locations[slot];
+
+    // The whole name and every word after the first, so a word in the middle also matches
+    std::string name = location.getName();
+    for (size_t start = 0; start < name.length(); ++start) {
+        if (start == 0 || ((name[start - 1] == ' ' || name[start - 1] == '-') && name[start] != ' ')) {
+            locationNames.add(name.substr(start), slot);
+        }
+    }
+
+    if (location.getType() == "county") {
+        countySlots[location.getId()] = slot;
+        countyOrder.push_back(slot);
+    } else if (location.getType() == "town") {
+        townSlots[location.getId()] = slot;
+        countyTowns[location.getParentId()].push_back(slot);
+    }
+}
+
+const Location* EntityStore::findCounty(int countyId) const {
+    std::unordered_map<int, size_t>::const_iterator it = countySlots.find(countyId);
+    return it == countySlots.end() ? nullptr : &locations[it->second];
+}
+
+const Location* EntityStore::findTown(int townId) const {
+    std::unordered_map<int, size_t>::const_iterator it = townSlots.find(townId);
+    return it == townSlots.end() ? nullptr : &locations[it->second];
+}
+
+std::vector<size_t> EntityStore::completeLocation(const std::string& prefix, const std::string& type,
+                                                  int countyId, size_t limit) const {
+    std::vector<size_t> slots;
+    PrefixIndex::EntryRange matches = locationNames.find(prefix);
+    for (size_t i = matches.first; i < matches.second && slots.size() < limit; ++i) {
+        size_t slot = locationNames.value(i);
+        const Location& location = locations[slot];
+        if ((!type.empty() && location.getType() != type) ||
+            (countyId > 0 && location.getParentId() != countyId)) {
+            continue;
+        }
+        // A name with two matching words appears twice
+        if (std::find(slots.begin(), slots.end(), slot) == slots.end()) {
+            slots.push_back(slot);
+        }
+    }
+    return slots;
+}
+
+const std::vector<size_t>& EntityStore::countiesInOrder() const {
+    return countyOrder;
+}
+
+const std::vector<size_t>& EntityStore::townsInCounty(int countyId) const {
+    std::unordered_map<int, std::vector<size_t> >::const_iterator it = countyTowns.find(countyId);
+    return it == countyTowns.end() ? NO_SLOTS : it->second;
+}
+
+void EntityStore::indexHouses() {
+    houseSlots.clear();
+    townRanges.clear();
+    houseSlots.reserve(houses.size());
+
+    for (size_t slot = 0; slot < houses.size(); ++slot) {
+        houseSlots[houses[slot].getId()] = slot;
+
+        int townId = houses[slot].getLocationId();
+        std::unordered_map<int, SlotRange>::iterator range = townRanges.find(townId);
+        if (range == townRanges.end()) {
+            townRanges[townId] = SlotRange(slot, slot + 1);
+        } else {
+            range->second.second = slot + 1;
+        }
+    }
+}
+
+void EntityStore::rebuildCatalog() {
+    catalog.clear();
+    catalog.reserve(houses.size());
+    for (size_t slot = 0; slot < houses.size(); ++slot) {
+        catalog.append(houses[slot]);
+    }
+}
+
+void EntityStore::updateCatalogRow(size_t slot) {
+    catalog.update(slot, houses[slot]);
+    if (catalog.needsCompaction()) {
+        rebuildCatalog();
+    }
+}
+
+void EntityStore::indexText() {
+    typeText.clear();
+    addressText.clear();
+    for (size_t slot = 0; slot < houses.size(); ++slot) {
+        typeText.add(static_cast<unsigned int>(slot), houses[slot].getType());
+        addressText.add(static_cast<unsigned int>(slot), houses[slot].getAddress());
+    }
+}
+
+void EntityStore::indexPrices(const House& house) {
+    if (isOpen(house)) {
+        rentIndex.insert(house.getLocationId(), house.getMonthlyRent(), house.getId());
+        depositIndex.insert(house.getLocationId(), house.getDepositFee(), house.getId());
+    }
+}
+
+void EntityStore::unindexPrices(const House& house) {
+    if (isOpen(house)) {
+        rentIndex.erase(house.getLocationId(), house.getMonthlyRent(), house.getId());
+        depositIndex.erase(house.getLocationId(), house.getDepositFee(), house.getId());
+    }
+}
+
+void EntityStore::setHouses(std::vector<House>&& newHouses) {
+    houses = std::move(newHouses);
+    // Stable, so houses keep their load order within a town
+    std::stable_sort(houses.begin(), houses.end(), byTown);
+    indexHouses();
+    rebuildCatalog();
+    indexText();
+    geo.build(houses);
+
+    rentIndex.clear();
+    depositIndex.clear();
+    reservationTable.reset(houses.size());
+    for (size_t slot = 0; slot < houses.size(); ++slot) {
+        indexPrices(houses[slot]);
+        reservationTable.add(houses[slot].getId(), houses[slot].getBookingStatus());
+    }
+    snapshotCatalog.publish(houses);
+}
+
+void EntityStore::addHouse(const House& house) {
+    addHouses(std::vector<House>(1, house));
+}
+
+void EntityStore::addHouses(const std::vector<House>& batch) {
+    std::vector<House> added;                             // New houses and houses moving town
+    std::unordered_map<std::string, size_t> addedIndexes; // House ID -> index into added
+    std::vector<size_t> leaving;                          // Slots of the houses moving town
+    bool textChanged = false;
+    bool moved = false;
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const House& house = batch[i];
+        reservationTable.add(house.getId(), house.getBookingStatus());
+
+        // Added earlier in this batch: replace it there
+        std::unordered_map<std::string, size_t>::iterator pending = addedIndexes.find(house.getId());
+        if (pending != addedIndexes.end()) {
+            unindexPrices(added[pending->second]);
+            indexPrices(house);
+            added[pending->second] = house;
+            continue;
+        }
+
+        std::unordered_map<std::string, size_t>::iterator existing = houseSlots.find(house.getId());
+        if (existing != houseSlots.end()) {
+            unindexPrices(houses[existing->second]);
+        }
+        indexPrices(house);
+
+        if (existing != houseSlots.end() && houses[existing->second].getLocationId() == house.getLocationId()) {
+            // Posting lists are append-only, so edited text means a rebuild;
+            // status-only updates (the common case) leave them alone
+            textChanged = textChanged || !sameText(houses[existing->second], house);
+            moved = moved || !samePosition(houses[existing->second], house);
+            houses[existing->second] = house;
+            updateCatalogRow(existing->second);
+            continue;
+        }
+
+        if (existing != houseSlots.end()) {
+            leaving.push_back(existing->second);
+        }
+        addedIndexes[house.getId()] = added.size();
+        added.push_back(house);
+    }
+    snapshotCatalog.putHouses(batch);
+
+    if (added.empty()) {
+        // Rebuilt at most once for the whole batch
+        if (textChanged) {
+            indexText();
+        }
+        if (moved) {
+            geo.build(houses);
+        }
+        return;
+    }
+
+    // Drop the houses moving town, keeping the order of the rest
+    if (!leaving.empty()) {
+        std::sort(leaving.begin(), leaving.end());
+        size_t kept = 0;
+        size_t next = 0;
+        for (size_t slot = 0; slot < houses.size(); ++slot) {
+            if (next < leaving.size() && leaving[next] == slot) {
+                ++next;
+                continue;
+            }
+            if (kept != slot) {
+                houses[kept] = std::move(houses[slot]);
+            }
+            ++kept;
+        }
+        houses.erase(houses.begin() + kept, houses.end());
+    }
+
+    // Stable merge: each added house goes after the houses already in its town
+    std::stable_sort(added.begin(), added.end(), byTown);
+    size_t middle = houses.size();
+    houses.insert(houses.end(), added.begin(), added.end());
+    std::inplace_merge(houses.begin(), houses.begin() + middle, houses.end(), byTown);
+
+    // Slots have shifted, and the catalog, text and grid indexes have no
+    // middle insert, so rebuild them once for the whole batch
+    indexHouses();
+    rebuildCatalog();
+    indexText();
+    geo.build(houses);
+}
+
+const House* EntityStore::findHouse(const std::string& houseId) const {
+    std::unordered_map<std::string, size_t>::const_iterator it = houseSlots.find(houseId);
+    return it == houseSlots.end() ? nullptr : &houses[it->second];
+}
+
+bool EntityStore::bookHouse(const std::string& houseId, const std::string& until) {
+    std::unordered_map<std::string, size_t>::iterator it = houseSlots.find(houseId);
+    if (it == houseSlots.end()) {
+        return false;
+    }
+    unindexPrices(houses[it->second]);
+    houses[it->second].book(until);
+    indexPrices(houses[it->second]);
+    updateCatalogRow(it->second);
+    reservationTable.markBooked(houseId);
+    snapshotCatalog.putHouse(houses[it->second]);
+    return true;
+}
+
+bool EntityStore::unbookHouse(const std::string& houseId) {
+    std::unordered_map<std::string, size_t>::iterator it = houseSlots.find(houseId);
+    if (it == houseSlots.end()) {
+        return false;
+    }
+    unindexPrices(houses[it->second]);
+    houses[it->second].unbook();
+    indexPrices(houses[it->second]);
+    updateCatalogRow(it->second);
+    reservationTable.markFree(houseId);
+    snapshotCatalog.putHouse(houses[it->second]);
+    return true;
+}
+
+bool EntityStore::setHouseAvailability(const std::string& houseId, bool available) {
+    std::unordered_map<std::string, size_t>::iterator it = houseSlots.find(houseId);
+    if (it == houseSlots.end()) {
+        return false;
+    }
+    unindexPrices(houses[it->second]);
+    houses[it->second].setAvailability(available);
+    indexPrices(houses[it->second]);
+    updateCatalogRow(it->second);
+    snapshotCatalog.putHouse(houses[it->second]);
+    return true;
+}
+
+bool EntityStore::matchText(const std::string& type, const std::string& address,
+                            std::vector<size_t>& slots) const {
+    slots.clear();
+
+    std::vector<unsigned int> typeDocs;
+    std::vector<unsigned int> addressDocs;
+    bool byType = typeText.candidates(type, typeDocs);
+    bool byAddress = addressText.candidates(address, addressDocs);
+    if (!byType && !byAddress) {
+        return false;
+    }
+
+    std::vector<unsigned int> docs;
+    if (byType && byAddress) {
+        std::set_intersection(typeDocs.begin(), typeDocs.end(), addressDocs.begin(), addressDocs.end(),
+                              std::back_inserter(docs));
+    } else {
+        docs.swap(byType ? typeDocs : addressDocs);
+    }
+
+    // Trigrams can match out of order, so confirm each candidate
+    for (size_t i = 0; i < docs.size(); ++i) {
+        const House& candidate = houses[docs[i]];
+        if (containsIgnoreCase(candidate.getType(), type) && containsIgnoreCase(candidate.getAddress(), address)) {
+            slots.push_back(docs[i]);
+        }
+    }
+    return true;
+}
+
+bool EntityStore::matches(const House& house, const HouseCatalog::Filter& filter) {
+    // Type last: getType copies the string
+    return (filter.minRent <= 0 || house.getMonthlyRent() >= filter.minRent) &&
+           (filter.maxRent <= 0 || house.getMonthlyRent() <= filter.maxRent) &&
+           (filter.townId <= 0 || house.getLocationId() == filter.townId) &&
+           (!filter.availableOnly || house.getAvailability()) &&
+           (!filter.unbookedOnly || !house.getBookingStatus()) &&
+           (filter.type.empty() || containsIgnoreCase(house.getType(), filter.type));
+}
+
+EntityStore::SearchResult EntityStore::searchOpenHouses(const HouseCatalog::Filter& filter, const std::string& address,
+                                                        size_t limit) const {
+    typedef CatalogSnapshot::TownPartition TownPartition;
+
+    SearchResult result;
+    result.path = SEARCH_BY_CATALOG;
+    result.truncated = false;
+
+    // Pinned for the whole search, so its partitions stay valid whatever writers do
+    SnapshotCatalog::ReadGuard snapshot = snapshotCatalog.read();
+    std::vector<const TownPartition*> towns;
+    if (filter.townId > 0) {
+        const TownPartition* town = snapshot->townPartition(filter.townId);
+        if (town) {
+            towns.push_back(town);
+        }
+    } else {
+        for (size_t i = 0; i < snapshot->towns().size(); ++i) {
+            towns.push_back(snapshot->towns()[i].get());
+        }
+    }
+
+    HouseCatalog::Filter open = filter;
+    open.availableOnly = true;
+    open.unbookedOnly = true;
+
+    if (TrigramIndex::indexable(filter.type) || TrigramIndex::indexable(address)) {
+        // Type or address text: the trigram indexes give the candidates directly
+        result.path = SEARCH_BY_TEXT;
+        std::vector<unsigned int> typeDocs;
+        std::vector<unsigned int> addressDocs;
+        std::vector<unsigned int> docs;
+        for (size_t t = 0; t < towns.size() && !result.truncated; ++t) {
+            const TownPartition& town = *towns[t];
+            bool byType = town.text->types.candidates(filter.type, typeDocs);
+            bool byAddress = town.text->addresses.candidates(address, addressDocs);
+            docs.clear();
+            if (byType && byAddress) {
+                std::set_intersection(typeDocs.begin(), typeDocs.end(), addressDocs.begin(), addressDocs.end(),
+                                      std::back_inserter(docs));
+            } else {
+                docs.swap(byType ? typeDocs : addressDocs);
+            }
+
+            // Trigrams can match out of order, so confirm each candidate
+            for (size_t i = 0; i < docs.size() && !result.truncated; ++i) {
+                const House& house = town.houses[docs[i]];
+                if (matches(house, open) && containsIgnoreCase(house.getAddress(), address)) {
+                    keep(result, house, limit);
+                }
+            }
+        }
+    } else if (filter.minRent > 0 || filter.maxRent > 0) {
+        // Rent range: each town lists its open houses cheapest first, so merge the towns
+        result.path = SEARCH_BY_RENT;
+        std::priority_queue<RentCursor, std::vector<RentCursor>, CheaperFirst> cursors;
+        for (size_t t = 0; t < towns.size(); ++t) {
+            const TownPartition* town = towns[t];
+            std::vector<size_t>::const_iterator first = std::lower_bound(
+                town->openByRent.begin(), town->openByRent.end(), filter.minRent,
+                [town](size_t index, double rent) { return town->houses[index].getMonthlyRent() < rent; });
+            if (first != town->openByRent.end()) {
+                cursors.push(RentCursor(town, first - town->openByRent.begin()));
+            }
+        }
+        while (!cursors.empty() && !result.truncated) {
+            RentCursor cursor = cursors.top();
+            cursors.pop();
+            if (filter.maxRent > 0 && cursor.rent > filter.maxRent) {
+                break;  // Every other town's next house costs at least as much
+            }
+            const House& house = cursor.town->houses[cursor.town->openByRent[cursor.position]];
+            if (containsIgnoreCase(house.getType(), filter.type) && containsIgnoreCase(house.getAddress(), address)) {
+                keep(result, house, limit);
+            }
+            if (cursor.position + 1 < cursor.town->openByRent.size()) {
+                cursors.push(RentCursor(cursor.town, cursor.position + 1));
+            }
+        }
+    } else {
+        // Filter each town's columnar catalog, then copy only the matches
+        HouseCatalog::Bitmap selection;
+        for (size_t t = 0; t < towns.size() && !result.truncated; ++t) {
+            const TownPartition& town = *towns[t];
+            town.catalog.select(open, selection);
+            for (size_t word = 0; word < selection.size() && !result.truncated; ++word) {
+                unsigned long long bits = selection[word];
+                while (bits && !result.truncated) {
+                    const House& house = town.houses[word * 64 + __builtin_ctzll(bits)];
+                    bits &= bits - 1;
+                    // Address text too short for the index (one or two characters)
+                    if (containsIgnoreCase(house.getAddress(), address)) {
+                        keep(result, house, limit);
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+void EntityStore::housesWithin(double lat, double lon, double radiusKm, const HouseCatalog::Filter& filter,
+                               std::vector<GeoIndex::Hit>& hits) const {
+    geo.within(lat, lon, radiusKm, [this, &filter](size_t slot) {
+        return matches(houses[slot], filter);
+    }, hits);
+}
+
+void EntityStore::nearestHouses(double lat, double lon, size_t k, const HouseCatalog::Filter& filter,
+                                std::vector<GeoIndex::Hit>& hits) const {
+    geo.nearest(lat, lon, k, [this, &filter](size_t slot) {
+        return matches(houses[slot], filter);
+    }, hits);
+}
+
+EntityStore::SlotRange EntityStore::housesInTown(int townId) const {
+    std::unordered_map<int, SlotRange>::const_iterator it = townRanges.find(townId);
+    return it == townRanges.end() ? SlotRange(0, 0) : it->second;
+}
+
+void EntityStore::indexBooking(size_t slot) {
+    const Booking& booking = bookings[slot];
+    bookingSlots[booking.getId()] = slot;
+    userBookings[booking.getUserId()].push_back(slot);
+    activeBookings[booking.getHouseId()] = slot;
+    scheduleBooking(booking);
+}
+
+void EntityStore::scheduleBooking(const Booking& booking) {
+    long long start;
+    long long end;
+    if (parseDateTime(booking.getBookingDate(), start) && parseDateTime(booking.getExpiryDate(), end)) {
+        calendar.add(booking.getHouseId(), start, end, booking.getId());
+    }
+}
+
+bool EntityStore::isHouseFree(const std::string& houseId, long long start, long long end) const {
+    return calendar.isFree(houseId, start, end);
+}
+
+std::vector<size_t> EntityStore::housesFree(long long start, long long end,
+                                            const HouseCatalog::Filter& filter) const {
+    SlotRange range(0, houses.size());
+    if (filter.townId > 0) {
+        range = housesInTown(filter.townId);
+    }
+    
+    std::vector<size_t> slots;
+    for (size_t slot = range.first; slot < range.second; ++slot) {
+        if (matches(houses[slot], filter) && calendar.isFree(houses[slot].getId(), start, end)) {
+            slots.push_back(slot);
+        }
+    }
+    return slots;
+}
+
+void EntityStore::setBookings(std::vector<Booking>&& newBookings) {
+    bookings = std::move(newBookings);
+    bookingSlots.clear();
+    userBookings.clear();
+    activeBookings.clear();
+    bookingSlots.reserve(bookings.size());
+
+    // Later bookings of a house replace earlier ones as its active booking
+    for (size_t slot = 0; slot < bookings.size(); ++slot) {
+        indexBooking(slot);
+    }
+}
+
+void EntityStore::addBooking(const Booking& booking) {
+    bookings.push_back(booking);
+    indexBooking(bookings.size() - 1);
+}
+
+void EntityStore::putBooking(const Booking& booking) {
+    std::unordered_map<int, size_t>::iterator it = bookingSlots.find(booking.getId());
+    if (it == bookingSlots.end()) {
+        addBooking(booking);
+        return;
+    }
+
+    // A booking's user and house never change, so only the entity is updated
+    bookings[it->second] = booking;
+    scheduleBooking(booking);
+}
+
+Booking* EntityStore::findBooking(int bookingId) {
+    std::unordered_map<int, size_t>::iterator it = bookingSlots.find(bookingId);
+    return it == bookingSlots.end() ? nullptr : &bookings[it->second];
+}
+
+Booking* EntityStore::findActiveBooking(const std::string& houseId) {
+    std::unordered_map<std::string, size_t>::iterator it = activeBookings.find(houseId);
+    return it == activeBookings.end() ? nullptr : &bookings[it->second];
+}
+
+const std::vector<size_t>& EntityStore::bookingsForUser(int userId) const {
+    std::unordered_map<int, std::vector<size_t> >::const_iterator it = userBookings.find(userId);
+    return it == userBookings.end() ? NO_SLOTS : it->second;
+}
@@ -0,0 +1,93 @@
+#include "include/EpochManager.h"
+#include <thread>
+
+namespace {
+    // Where this thread found a free slot last time; usually free again
+    thread_local int slotHint = 0;
+}
+
+EpochManager::EpochManager() : globalEpoch(1) {
+    for (int i = 0; i < MAX_READERS; ++i) {
+        slots[i].epoch = 0;
+    }
+}
+
+EpochManager::~EpochManager() {
+    for (size_t i = 0; i < limbo.size(); ++i) {
+        limbo[i].free();
+    }
+}
+
+int EpochManager::pin() {
+    while (true) {
+        for (int n = 0; n < MAX_READERS; ++n) {
+            int slot = (slotHint + n) % MAX_READERS;
+            unsigned long long expected = 0;
+
+            // Sequentially consistent, so a writer that sees the slot free has
+            // already published anything this reader goes on to load
+            if (slots[slot].epoch.compare_exchange_strong(expected, globalEpoch.load())) {
+                slotHint = slot;
+                return slot;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+void EpochManager::unpin(int slot) {
+    slots[slot].epoch.store(0);
+}
+
+unsigned long long EpochManager::oldestPinned() const {
+    unsigned long long oldest = globalEpoch.load();
+    for (int i = 0; i < MAX_READERS; ++i) {
+        unsigned long long epoch = slots[i].epoch.load();
+        if (epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+    return oldest;
+}
+
+void EpochManager::retire(const std::function<void()>& free) {
+    Retired retired;
+    retired.free = free;
+
+    // Readers pinned from now on hold a later epoch and cannot reach the object
+    retired.epoch = globalEpoch.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(retireMutex);
+        limbo.push_back(retired);
+    }
+    reclaim();
+}
+
+size_t EpochManager::reclaim() {
+    unsigned long long oldest = oldestPinned();
+
+    std::vector<Retired> freeable;
+    {
+        std::lock_guard<std::mutex> lock(retireMutex);
+        size_t kept = 0;
+        for (size_t i = 0; i < limbo.size(); ++i) {
+            if (limbo[i].epoch < oldest) {
+                freeable.push_back(limbo[i]);
+            } else {
+                limbo[kept++] = limbo[i];
+            }
+        }
+        limbo.resize(kept);
+    }
+
+    // Outside the lock: freeing a large object can take a while
+    for (size_t i = 0; i < freeable.size(); ++i) {
+        freeable[i].free();
+    }
+    return freeable.size();
+}
+
+size_t EpochManager::pendingCount() {
+    std::lock_guard<std::mutex> lock(retireMutex);
+    return limbo.size();
+}
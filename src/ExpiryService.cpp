@@ -0,0 +1,192 @@
+#include "include/ExpiryService.h"
+#include "include/Utils.h"
+#include <algorithm>
+#include <ctime>
+
+namespace {
+    // Rows read from the database before the wheel is locked once for all of them
+    const size_t LOAD_CHUNK = 4096;
+    
+    // Both clocks are read to the second, so the offset can be a second off;
+    // timers fire this much late so the server always agrees they are due
+    const long long CLOCK_MARGIN_SECONDS = 1;
+}
+
+ExpiryService::ExpiryService(DBConnector* db, int tickMs)
+    : db(db), tick(tickMs), clockOffset(0), stopping(false),
+      loadedCount(0), expiredCount(0), releasedCount(0), failedBatchCount(0) {}
+
+ExpiryService::~ExpiryService() {
+    stop();
+}
+
+bool ExpiryService::start() {
+    if (worker.joinable()) {
+        return true;
+    }
+
+    long long serverNow;
+    if (!parseDateTime(db->getChangeMark(0), serverNow)) {
+        return false;
+    }
+    clockOffset = serverNow - static_cast<long long>(std::time(nullptr)) - CLOCK_MARGIN_SECONDS;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        wheel = TimerWheel(now());
+        stopping = false;
+    }
+    worker = std::thread(&ExpiryService::sweepLoop, this);
+    return true;
+}
+
+void ExpiryService::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+long long ExpiryService::now() const {
+    return static_cast<long long>(std::time(nullptr)) + clockOffset;
+}
+
+bool ExpiryService::schedule(int bookingId, const std::string& expiryDate) {
+    long long due;
+    if (!parseDateTime(expiryDate, due)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    wheel.schedule(bookingId, due);
+    return true;
+}
+
+void ExpiryService::loadPending() {
+    std::vector<TimerWheel::Timer> chunk;
+    chunk.reserve(LOAD_CHUNK);
+    db->forEachPendingExpiry([this, &chunk](int bookingId, const std::string& expiryDate) {
+        TimerWheel::Timer timer;
+        timer.id = bookingId;
+        if (parseDateTime(expiryDate, timer.due)) {
+            chunk.push_back(timer);
+        }
+        if (chunk.size() == LOAD_CHUNK) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < chunk.size(); ++i) {
+                wheel.schedule(chunk[i].id, chunk[i].due);
+            }
+            loadedCount += chunk.size();
+            chunk.clear();
+            return !stopping;
+        }
+        return true;
+    });
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < chunk.size(); ++i) {
+        wheel.schedule(chunk[i].id, chunk[i].due);
+    }
+    loadedCount += chunk.size();
+}
+
+void ExpiryService::sweepLoop() {
+    loadPending();
+
+    std::vector<TimerWheel::Timer> fired;
+    std::vector<int> batch;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        fired.clear();
+        wheel.advance(now(), fired);
+
+        // Expire without holding the lock, so schedule never waits on the database
+        lock.unlock();
+        for (size_t first = 0; first < fired.size(); first += DBConfig::EXPIRY_MAX_BATCH) {
+            size_t last = std::min(fired.size(), first + DBConfig::EXPIRY_MAX_BATCH);
+            batch.clear();
+            for (size_t i = first; i < last; ++i) {
+                batch.push_back(fired[i].id);
+            }
+            expireBatch(batch);
+        }
+        lock.lock();
+
+        wake.wait_for(lock, tick, [this] { return stopping; });
+    }
+}
+
+void ExpiryService::expireBatch(const std::vector<int>& bookingIds) {
+    std::vector<std::string> released;
+    std::vector<std::pair<int, std::string> > notDue;
+    if (!db->expireBookings(bookingIds, released, notDue)) {
+        ++failedBatchCount;
+        std::lock_guard<std::mutex> lock(mutex);
+        long long retry = now() + DBConfig::EXPIRY_RETRY_SECONDS;
+        for (size_t i = 0; i < bookingIds.size(); ++i) {
+            wheel.schedule(bookingIds[i], retry);
+        }
+        return;
+    }
+
+    expiredCount += bookingIds.size() - notDue.size();
+    releasedCount += released.size();
+    if (released.empty() && notDue.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingReleases.insert(pendingReleases.end(), released.begin(), released.end());
+
+    // Fired before the server's clock reached the expiry date: try again then
+    long long retry = now() + DBConfig::EXPIRY_RETRY_SECONDS;
+    for (size_t i = 0; i < notDue.size(); ++i) {
+        long long due;
+        if (!parseDateTime(notDue[i].second, due) || due <= now()) {
+            due = retry;
+        }
+        wheel.schedule(notDue[i].first, due);
+    }
+}
+
+size_t ExpiryService::applyPending(EntityStore& store) {
+    std::vector<std::string> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        released.swap(pendingReleases);
+    }
+
+    long long current = now();
+    size_t count = 0;
+    for (size_t i = 0; i < released.size(); ++i) {
+        const House* house = store.findHouse(released[i]);
+        long long until;
+        if (!house || !house->getBookingStatus()) {
+            continue;
+        }
+        if (parseDateTime(house->getBookedUntil(), until) && until > current) {
+            continue;
+        }
+        store.unbookHouse(released[i]);
+        ++count;
+    }
+    return count;
+}
+
+size_t ExpiryService::pendingCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return wheel.size();
+}
+
+ExpiryService::Stats ExpiryService::getStats() const {
+    Stats stats;
+    stats.loaded = loadedCount;
+    stats.expired = expiredCount;
+    stats.released = releasedCount;
+    stats.failedBatches = failedBatchCount;
+    return stats;
+}
@@ -0,0 +1,194 @@
+#include "include/GeoIndex.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const double PI = 3.14159265358979323846;
+    const double EARTH_RADIUS_KM = 6371.0088;           // Mean radius
+    const double KM_PER_DEGREE = EARTH_RADIUS_KM * PI / 180.0;
+
+    double radians(double degrees) {
+        return degrees * PI / 180.0;
+    }
+
+    bool nearer(const GeoIndex::Hit& a, const GeoIndex::Hit& b) {
+        return a.distanceKm < b.distanceKm || (a.distanceKm == b.distanceKm && a.slot < b.slot);
+    }
+
+    struct KeyedPoint {
+        unsigned long long key;
+        unsigned int slot;
+
+        bool operator<(const KeyedPoint& other) const {
+            return key < other.key || (key == other.key && slot < other.slot);
+        }
+    };
+}
+
+GeoIndex::GeoIndex(double cellDegrees)
+    : cellDegrees(cellDegrees),
+      columns(static_cast<unsigned long long>(std::ceil(360.0 / cellDegrees))) {}
+
+long long GeoIndex::rowOf(double lat) const {
+    long long rows = static_cast<long long>(std::ceil(180.0 / cellDegrees));
+    long long row = static_cast<long long>(std::floor((lat + 90.0) / cellDegrees));
+    return row < 0 ? 0 : (row >= rows ? rows - 1 : row);
+}
+
+long long GeoIndex::columnOf(double lon) const {
+    return static_cast<long long>(std::floor((lon + 180.0) / cellDegrees));
+}
+
+void GeoIndex::clear() {
+    cells.clear();
+    latitudes.clear();
+    longitudes.clear();
+    cosLatitudes.clear();
+    slots.clear();
+}
+
+void GeoIndex::build(const std::vector<House>& houses) {
+    clear();
+
+    std::vector<KeyedPoint> points;
+    points.reserve(houses.size());
+    for (size_t slot = 0; slot < houses.size(); ++slot) {
+        if (!houses[slot].hasCoordinates()) {
+            continue;
+        }
+        long long column = columnOf(houses[slot].getLongitude()) % static_cast<long long>(columns);
+        if (column < 0) {
+            column += columns;
+        }
+        KeyedPoint point;
+        point.key = static_cast<unsigned long long>(rowOf(houses[slot].getLatitude())) * columns + column;
+        point.slot = static_cast<unsigned int>(slot);
+        points.push_back(point);
+    }
+    std::sort(points.begin(), points.end());
+
+    cells.reserve(points.size());
+    latitudes.reserve(points.size());
+    longitudes.reserve(points.size());
+    cosLatitudes.reserve(points.size());
+    slots.reserve(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        const House& house = houses[points[i].slot];
+        cells.push_back(points[i].key);
+        latitudes.push_back(house.getLatitude());
+        longitudes.push_back(house.getLongitude());
+        cosLatitudes.push_back(std::cos(radians(house.getLatitude())));
+        slots.push_back(points[i].slot);
+    }
+}
+
+double GeoIndex::distanceKm(double lat1, double lon1, double lat2, double lon2) {
+    // Haversine formula
+    double sinLat = std::sin(radians(lat2 - lat1) / 2);
+    double sinLon = std::sin(radians(lon2 - lon1) / 2);
+    double a = sinLat * sinLat + std::cos(radians(lat1)) * std::cos(radians(lat2)) * sinLon * sinLon;
+    return 2 * EARTH_RADIUS_KM * std::asin(std::min(1.0, std::sqrt(a)));
+}
+
+void GeoIndex::scanCells(unsigned long long firstKey, unsigned long long lastKey, const Circle& circle,
+                         const SlotFilter& accept, std::vector<Hit>& hits) const {
+    size_t first = std::lower_bound(cells.begin(), cells.end(), firstKey) - cells.begin();
+    size_t last = std::upper_bound(cells.begin() + first, cells.end(), lastKey) - cells.begin();
+
+    for (size_t i = first; i < last; ++i) {
+        // Compare the haversine term with the radius's; only hits need the full distance
+        double sinLat = std::sin(radians(latitudes[i] - circle.lat) / 2);
+        double sinLon = std::sin(radians(longitudes[i] - circle.lon) / 2);
+        double a = sinLat * sinLat + circle.cosLat * cosLatitudes[i] * sinLon * sinLon;
+        if (a <= circle.limit && (!accept || accept(slots[i]))) {
+            Hit hit;
+            hit.slot = slots[i];
+            hit.distanceKm = 2 * EARTH_RADIUS_KM * std::asin(std::min(1.0, std::sqrt(a)));
+            hits.push_back(hit);
+        }
+    }
+}
+
+void GeoIndex::collect(double lat, double lon, double radiusKm, const SlotFilter& accept,
+                       std::vector<Hit>& hits) const {
+    if (cells.empty() || radiusKm < 0) {
+        return;
+    }
+
+    double latSpan = radiusKm / KM_PER_DEGREE;
+    long long firstRow = rowOf(lat - latSpan);
+    long long lastRow = rowOf(lat + latSpan);
+
+    // Longitude half-width of the circle's bounding box; a circle that
+    // reaches a pole covers every longitude
+    bool wholeBands = lat + latSpan >= 90.0 || lat - latSpan <= -90.0;
+    double lonSpan = 180.0;
+    if (!wholeBands) {
+        double ratio = std::sin(radiusKm / EARTH_RADIUS_KM) / std::cos(radians(lat));
+        wholeBands = ratio >= 1.0;
+        if (!wholeBands) {
+            lonSpan = std::asin(ratio) * 180.0 / PI;
+        }
+    }
+
+    Circle circle;
+    circle.lat = lat;
+    circle.lon = lon;
+    circle.cosLat = std::cos(radians(lat));
+    double halfAngle = std::min(PI / 2, radiusKm / EARTH_RADIUS_KM / 2);
+    circle.limit = std::sin(halfAngle) * std::sin(halfAngle);
+
+    long long firstColumn = columnOf(lon - lonSpan);
+    long long lastColumn = columnOf(lon + lonSpan);
+    long long width = static_cast<long long>(columns);
+    if (lastColumn - firstColumn + 1 >= width) {
+        wholeBands = true;
+    }
+
+    for (long long row = firstRow; row <= lastRow; ++row) {
+        unsigned long long base = static_cast<unsigned long long>(row) * columns;
+        if (wholeBands) {
+            scanCells(base, base + columns - 1, circle, accept, hits);
+        } else if (firstColumn < 0) {
+            // The box crosses the 180th meridian: two runs of cells
+            scanCells(base + (firstColumn + width), base + columns - 1, circle, accept, hits);
+            scanCells(base, base + lastColumn, circle, accept, hits);
+        } else if (lastColumn >= width) {
+            scanCells(base + firstColumn, base + columns - 1, circle, accept, hits);
+            scanCells(base, base + (lastColumn - width), circle, accept, hits);
+        } else {
+            scanCells(base + firstColumn, base + lastColumn, circle, accept, hits);
+        }
+    }
+}
+
+void GeoIndex::within(double lat, double lon, double radiusKm, const SlotFilter& accept,
+                      std::vector<Hit>& hits) const {
+    hits.clear();
+    collect(lat, lon, radiusKm, accept, hits);
+    std::sort(hits.begin(), hits.end(), nearer);
+}
+
+void GeoIndex::nearest(double lat, double lon, size_t k, const SlotFilter& accept,
+                       std::vector<Hit>& hits) const {
+    hits.clear();
+    if (k == 0 || cells.empty()) {
+        return;
+    }
+
+    // Everything within the radius is collected, so once k points are in,
+    // no point outside it can be nearer than the k-th
+    double halfCircumference = PI * EARTH_RADIUS_KM;
+    // Start well inside one cell, since dense areas hold many points per cell
+    for (double radius = cellDegrees * KM_PER_DEGREE / 8; ; radius *= 2) {
+        hits.clear();
+        collect(lat, lon, radius, accept, hits);
+        if (hits.size() >= k || radius >= halfCircumference) {
+            break;
+        }
+    }
+
+    size_t count = std::min(k, hits.size());
+    std::partial_sort(hits.begin(), hits.begin() + count, hits.end(), nearer);
+    hits.resize(count);
+}
@@ -0,0 +1,115 @@
+#include "include/HdrHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+HdrHistogram::HdrHistogram(long long highestTrackable, int significantDigits)
+    : highestTrackable(std::max(2LL, highestTrackable)), totalCount(0), minValue(0), maxValue(0), sum(0.0) {
+    significantDigits = std::min(5, std::max(1, significantDigits));
+
+    // Sub-buckets per power of two: enough to tell 1 in 10^digits apart
+    long long largestSingleUnit = 2 * static_cast<long long>(std::pow(10.0, significantDigits));
+    int subBucketCountMagnitude = static_cast<int>(std::ceil(std::log2(static_cast<double>(largestSingleUnit))));
+    subBucketHalfCountMagnitude = subBucketCountMagnitude - 1;
+    long long subBucketCount = 1LL << subBucketCountMagnitude;
+    subBucketHalfCount = subBucketCount / 2;
+    subBucketMask = subBucketCount - 1;
+
+    // Buckets until the range covers highestTrackable; the first holds a full sub-bucket count
+    int bucketCount = 1;
+    for (long long smallestUntrackable = subBucketCount; smallestUntrackable <= this->highestTrackable;
+         smallestUntrackable <<= 1) {
+        ++bucketCount;
+        if (smallestUntrackable > (1LL << 61)) {
+            break;
+        }
+    }
+    counts.assign(static_cast<size_t>((bucketCount + 1) * subBucketHalfCount), 0);
+}
+
+int HdrHistogram::bucketIndex(long long value) const {
+    // Position of the highest set bit, with values below one sub-bucket count in bucket 0
+    int pow2Ceiling = 64 - __builtin_clzll(static_cast<unsigned long long>(value | subBucketMask));
+    return pow2Ceiling - (subBucketHalfCountMagnitude + 1);
+}
+
+size_t HdrHistogram::countsIndex(long long value) const {
+    int bucket = bucketIndex(value);
+    long long subBucket = value >> bucket;
+    return static_cast<size_t>(((static_cast<long long>(bucket) + 1) << subBucketHalfCountMagnitude) +
+                               (subBucket - subBucketHalfCount));
+}
+
+long long HdrHistogram::valueAtIndex(size_t index) const {
+    long long bucket = static_cast<long long>(index >> subBucketHalfCountMagnitude) - 1;
+    long long subBucket = static_cast<long long>(index & (subBucketHalfCount - 1)) + subBucketHalfCount;
+    if (bucket < 0) {
+        subBucket -= subBucketHalfCount;
+        bucket = 0;
+    }
+    return subBucket << bucket;
+}
+
+long long HdrHistogram::highestEquivalent(long long value) const {
+    int bucket = bucketIndex(value);
+    long long lowest = (value >> bucket) << bucket;
+    return lowest + (1LL << bucket) - 1;
+}
+
+bool HdrHistogram::record(long long value) {
+    bool inRange = value <= highestTrackable;
+    value = std::min(highestTrackable, std::max(0LL, value));
+
+    ++counts[countsIndex(value)];
+    if (totalCount == 0 || value < minValue) {
+        minValue = value;
+    }
+    if (totalCount == 0 || value > maxValue) {
+        maxValue = value;
+    }
+    ++totalCount;
+    sum += static_cast<double>(value);
+    return inRange;
+}
+
+bool HdrHistogram::add(const HdrHistogram& other) {
+    if (other.counts.size() != counts.size() || other.subBucketHalfCountMagnitude != subBucketHalfCountMagnitude) {
+        return false;
+    }
+    if (other.totalCount == 0) {
+        return true;
+    }
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] += other.counts[i];
+    }
+    minValue = totalCount ? std::min(minValue, other.minValue) : other.minValue;
+    maxValue = totalCount ? std::max(maxValue, other.maxValue) : other.maxValue;
+    totalCount += other.totalCount;
+    sum += other.sum;
+    return true;
+}
+
+void HdrHistogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    totalCount = 0;
+    minValue = 0;
+    maxValue = 0;
+    sum = 0.0;
+}
+
+long long HdrHistogram::valueAtPercentile(double percentile) const {
+    if (totalCount == 0) {
+        return 0;
+    }
+    percentile = std::min(100.0, std::max(0.0, percentile));
+    unsigned long long wanted = static_cast<unsigned long long>(std::ceil(percentile / 100.0 * totalCount));
+    wanted = std::max(1ULL, wanted);
+
+    unsigned long long seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= wanted) {
+            return std::min(maxValue, highestEquivalent(valueAtIndex(i)));
+        }
+    }
+    return maxValue;
+}
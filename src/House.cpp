@@ -4,7 +4,8 @@ House::House(const std::string& id, const std::string& type, double depositFee,
       int locationId, const std::string& address, const std::string& mapLink)
     : id(id), type(type), depositFee(depositFee), monthlyRent(monthlyRent),
       locationId(locationId), address(address), mapLink(mapLink),
-      isAvailable(true), isBooked(false), bookedUntil("") {}
+      isAvailable(true), isBooked(false), bookedUntil(""),
+      hasLocation(false), latitude(0.0), longitude(0.0) {}
 
 std::string House::getId() const {
     return id;
@@ -46,6 +47,24 @@ std::string House::getBookedUntil() const {
     return bookedUntil;
 }
 
+bool House::hasCoordinates() const {
+    return hasLocation;
+}
+
+double House::getLatitude() const {
+    return latitude;
+}
+
+double House::getLongitude() const {
+    return longitude;
+}
+
+void House::setCoordinates(double lat, double lon) {
+    hasLocation = true;
+    latitude = lat;
+    longitude = lon;
+}
+
 void House::setAvailability(bool available) {
     isAvailable = available;
 }
@@ -0,0 +1,396 @@
+#include "include/HouseCatalog.h"
+#include "include/Utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// The AVX2 kernel is compiled with a target attribute, so the rest of the
+// build needs no -mavx2 and the binary still runs on CPUs without AVX2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HOUSE_CATALOG_AVX2 1
+#include <immintrin.h>
+#endif
+
+const size_t HouseCatalog::ID_WIDTH;
+const unsigned char HouseCatalog::FLAG_AVAILABLE;
+const unsigned char HouseCatalog::FLAG_BOOKED;
+
+namespace {
+    unsigned char flagsOf(const House& house) {
+        unsigned char rowFlags = 0;
+        if (house.getAvailability()) rowFlags |= HouseCatalog::FLAG_AVAILABLE;
+        if (house.getBookingStatus()) rowFlags |= HouseCatalog::FLAG_BOOKED;
+        return rowFlags;
+    }
+
+    // Flag bits a filter looks at, and the value they must have
+    unsigned char flagMaskOf(const HouseCatalog::Filter& filter) {
+        return (filter.availableOnly ? HouseCatalog::FLAG_AVAILABLE : 0) |
+               (filter.unbookedOnly ? HouseCatalog::FLAG_BOOKED : 0);
+    }
+
+    unsigned char flagValueOf(const HouseCatalog::Filter& filter) {
+        return filter.availableOnly ? HouseCatalog::FLAG_AVAILABLE : 0;
+    }
+}
+
+namespace {
+    // Garbage below this is not worth a rebuild
+    const size_t MIN_COMPACTION_BYTES = 64 * 1024;
+}
+
+HouseCatalog::HouseCatalog() : garbageText(0), lastTypeId(0) {}
+
+void HouseCatalog::clear() {
+    ids.clear();
+    townIds.clear();
+    deposits.clear();
+    rents.clear();
+    flags.clear();
+    bookedUntil.clear();
+    typeIds.clear();
+    addresses.clear();
+    mapLinks.clear();
+    typeNames.clear();
+    text.clear();
+    garbageText = 0;
+    lastTypeId = 0;
+}
+
+bool HouseCatalog::needsCompaction() const {
+    return garbageText >= MIN_COMPACTION_BYTES && garbageText * 2 > text.size();
+}
+
+void HouseCatalog::reserve(size_t rows, size_t textBytesPerRow) {
+    ids.reserve(rows * ID_WIDTH);
+    townIds.reserve(rows);
+    deposits.reserve(rows);
+    rents.reserve(rows);
+    flags.reserve(rows);
+    bookedUntil.reserve(rows);
+    typeIds.reserve(rows);
+    addresses.reserve(rows);
+    mapLinks.reserve(rows);
+    text.reserve(rows * textBytesPerRow);
+}
+
+size_t HouseCatalog::size() const {
+    return townIds.size();
+}
+
+HouseCatalog::TextRef HouseCatalog::storeText(const char* value, size_t length) {
+    TextRef ref;
+    ref.offset = static_cast<unsigned int>(text.size());
+    ref.length = static_cast<unsigned int>(length);
+    text.insert(text.end(), value, value + length);
+    return ref;
+}
+
+void HouseCatalog::replaceText(TextRef& ref, const char* value, size_t length) {
+    if (length <= ref.length) {
+        // Status-only updates land here with identical text, which keeps its place
+        if (length != 0) {
+            std::memmove(&text[ref.offset], value, length);
+        }
+        garbageText += ref.length - length;
+        ref.length = static_cast<unsigned int>(length);
+        return;
+    }
+    garbageText += ref.length;
+    ref = storeText(value, length);
+}
+
+unsigned short HouseCatalog::internType(const char* value, size_t length) {
+    // Consecutive rows usually share a type, so check the last hit first
+    if (lastTypeId < typeNames.size()) {
+        const std::string& last = typeNames[lastTypeId];
+        if (last.length() == length && std::memcmp(last.data(), value, length) == 0) {
+            return lastTypeId;
+        }
+    }
+
+    // The dictionary holds a few dozen types at most; a scan beats hashing
+    for (size_t i = 0; i < typeNames.size(); ++i) {
+        if (typeNames[i].length() == length && std::memcmp(typeNames[i].data(), value, length) == 0) {
+            lastTypeId = static_cast<unsigned short>(i);
+            return lastTypeId;
+        }
+    }
+
+    typeNames.push_back(std::string(value, length));
+    lastTypeId = static_cast<unsigned short>(typeNames.size() - 1);
+    return lastTypeId;
+}
+
+size_t HouseCatalog::append(const char* id, size_t idLength, const char* type, size_t typeLength,
+                            int townId, const char* address, size_t addressLength,
+                            const char* mapLink, size_t mapLinkLength,
+                            double deposit, double rent, unsigned char rowFlags,
+                            long long packedBookedUntil) {
+    size_t row = townIds.size();
+
+    // IDs are stored NUL-padded in fixed-width slots
+    if (idLength >= ID_WIDTH) {
+        idLength = ID_WIDTH - 1;
+    }
+    ids.resize(ids.size() + ID_WIDTH, '\0');
+    std::memcpy(&ids[row * ID_WIDTH], id, idLength);
+
+    townIds.push_back(townId);
+    deposits.push_back(deposit);
+    rents.push_back(rent);
+    flags.push_back(rowFlags);
+    bookedUntil.push_back(packedBookedUntil);
+    typeIds.push_back(internType(type, typeLength));
+    addresses.push_back(storeText(address, addressLength));
+    mapLinks.push_back(storeText(mapLink, mapLinkLength));
+    return row;
+}
+
+size_t HouseCatalog::append(const House& house) {
+    std::string id = house.getId();
+    std::string type = house.getType();
+    std::string address = house.getAddress();
+    std::string mapLink = house.getMapLink();
+
+    return append(id.data(), id.length(), type.data(), type.length(), house.getLocationId(),
+                  address.data(), address.length(), mapLink.data(), mapLink.length(),
+                  house.getDepositFee(), house.getMonthlyRent(), flagsOf(house),
+                  house.getBookingStatus() ? packDateTime(house.getBookedUntil()) : 0);
+}
+
+void HouseCatalog::update(size_t row, const House& house) {
+    std::string id = house.getId();
+    std::string type = house.getType();
+    std::string address = house.getAddress();
+    std::string mapLink = house.getMapLink();
+
+    size_t idLength = std::min(id.length(), ID_WIDTH - 1);
+    std::memset(&ids[row * ID_WIDTH], 0, ID_WIDTH);
+    std::memcpy(&ids[row * ID_WIDTH], id.data(), idLength);
+
+    townIds[row] = house.getLocationId();
+    deposits[row] = house.getDepositFee();
+    rents[row] = house.getMonthlyRent();
+    flags[row] = flagsOf(house);
+    bookedUntil[row] = house.getBookingStatus() ? packDateTime(house.getBookedUntil()) : 0;
+    typeIds[row] = internType(type.data(), type.length());
+    replaceText(addresses[row], address.data(), address.length());
+    replaceText(mapLinks[row], mapLink.data(), mapLink.length());
+}
+
+size_t HouseCatalog::select(const Filter& filter, Bitmap& selection, bool useSimd) const {
+    return select(filter, selection, 0, size(), useSimd);
+}
+
+size_t HouseCatalog::select(const Filter& filter, Bitmap& selection, size_t begin, size_t end,
+                            bool useSimd) const {
+    selection.assign((size() + 63) / 64, 0);
+    end = std::min(end, size());
+    if (begin >= end) {
+        return 0;
+    }
+
+    // Match the type against the dictionary once instead of against every row
+    std::vector<unsigned short> typeMatches;
+    if (!filter.type.empty()) {
+        for (size_t i = 0; i < typeNames.size(); ++i) {
+            if (containsIgnoreCase(typeNames[i], filter.type)) {
+                typeMatches.push_back(static_cast<unsigned short>(i));
+            }
+        }
+        if (typeMatches.empty()) {
+            return 0;
+        }
+        if (typeMatches.size() == typeNames.size()) {
+            typeMatches.clear();  // Every type matches; skip the column
+        }
+    }
+
+#ifdef HOUSE_CATALOG_AVX2
+    if (useSimd && simdAvailable()) {
+        // Scalar head and tail so the kernel's 8-row blocks never straddle a bitmap word
+        size_t simdBegin = std::min(end, (begin + 7) / 8 * 8);
+        size_t simdEnd = simdBegin + (end - simdBegin) / 8 * 8;
+        selectScalar(filter, typeMatches, begin, simdBegin, selection);
+        selectAvx2(filter, typeMatches, simdBegin, simdEnd, selection);
+        selectScalar(filter, typeMatches, simdEnd, end, selection);
+    } else {
+        selectScalar(filter, typeMatches, begin, end, selection);
+    }
+#else
+    (void)useSimd;
+    selectScalar(filter, typeMatches, begin, end, selection);
+#endif
+
+    size_t count = 0;
+    for (size_t word = begin / 64; word < (end + 63) / 64; ++word) {
+        count += __builtin_popcountll(selection[word]);
+    }
+    return count;
+}
+
+void HouseCatalog::selectScalar(const Filter& filter, const std::vector<unsigned short>& typeMatches,
+                                size_t begin, size_t end, Bitmap& selection) const {
+    double minRent = filter.minRent > 0 ? filter.minRent : -HUGE_VAL;
+    double maxRent = filter.maxRent > 0 ? filter.maxRent : HUGE_VAL;
+    unsigned char flagMask = flagMaskOf(filter);
+    unsigned char flagValue = flagValueOf(filter);
+
+    for (size_t row = begin; row < end; ++row) {
+        bool match = rents[row] >= minRent && rents[row] <= maxRent;
+        if (filter.townId > 0) {
+            match = match && townIds[row] == filter.townId;
+        }
+        if (flagMask) {
+            match = match && (flags[row] & flagMask) == flagValue;
+        }
+        if (match && !typeMatches.empty()) {
+            match = std::find(typeMatches.begin(), typeMatches.end(), typeIds[row]) != typeMatches.end();
+        }
+        if (match) {
+            selection[row / 64] |= 1ULL << (row % 64);
+        }
+    }
+}
+
+#ifdef HOUSE_CATALOG_AVX2
+__attribute__((target("avx2")))
+void HouseCatalog::selectAvx2(const Filter& filter, const std::vector<unsigned short>& typeMatches,
+                              size_t begin, size_t end, Bitmap& selection) const {
+    const __m256d minRent = _mm256_set1_pd(filter.minRent > 0 ? filter.minRent : -HUGE_VAL);
+    const __m256d maxRent = _mm256_set1_pd(filter.maxRent > 0 ? filter.maxRent : HUGE_VAL);
+    const __m256i town = _mm256_set1_epi32(filter.townId);
+    const __m256i flagMask = _mm256_set1_epi32(flagMaskOf(filter));
+    const __m256i flagValue = _mm256_set1_epi32(flagValueOf(filter));
+    const bool byFlags = flagMaskOf(filter) != 0;
+    const bool byTown = filter.townId > 0;
+    const bool byType = !typeMatches.empty();
+
+    const double* rentData = rents.data();
+    const int* townData = townIds.data();
+    const unsigned char* flagData = flags.data();
+    const unsigned short* typeData = typeIds.data();
+
+    // Eight rows per step; each predicate yields an 8-bit mask via movemask.
+    // The narrow columns go first so rent (8 bytes a row) is only read for
+    // blocks that still have candidates
+    for (size_t row = begin; row < end; row += 8) {
+        unsigned int mask = 0xFF;
+
+        if (byTown) {
+            __m256i towns = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(townData + row));
+            mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(towns, town)));
+            if (!mask) {
+                continue;
+            }
+        }
+        if (byFlags) {
+            __m256i rowFlags = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(flagData + row)));
+            __m256i flagsMatch = _mm256_cmpeq_epi32(_mm256_and_si256(rowFlags, flagMask), flagValue);
+            mask &= _mm256_movemask_ps(_mm256_castsi256_ps(flagsMatch));
+        }
+        if (byType && mask) {
+            __m256i types = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(typeData + row)));
+            __m256i anyType = _mm256_setzero_si256();
+            for (size_t i = 0; i < typeMatches.size(); ++i) {
+                anyType = _mm256_or_si256(anyType, _mm256_cmpeq_epi32(types, _mm256_set1_epi32(typeMatches[i])));
+            }
+            mask &= _mm256_movemask_ps(_mm256_castsi256_ps(anyType));
+        }
+        if (!mask) {
+            continue;
+        }
+
+        __m256d low = _mm256_loadu_pd(rentData + row);
+        __m256d high = _mm256_loadu_pd(rentData + row + 4);
+        mask &= _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(low, minRent, _CMP_GE_OQ),
+                                                 _mm256_cmp_pd(low, maxRent, _CMP_LE_OQ))) |
+                (_mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(high, minRent, _CMP_GE_OQ),
+                                                  _mm256_cmp_pd(high, maxRent, _CMP_LE_OQ))) << 4);
+
+        selection[row / 64] |= static_cast<unsigned long long>(mask) << (row % 64);
+    }
+}
+#endif
+
+bool HouseCatalog::simdAvailable() {
+#ifdef HOUSE_CATALOG_AVX2
+    static const bool available = __builtin_cpu_supports("avx2");
+    return available;
+#else
+    return false;
+#endif
+}
+
+std::vector<House> HouseCatalog::materialize(const Bitmap& selection) const {
+    size_t count = 0;
+    for (size_t word = 0; word < selection.size(); ++word) {
+        count += __builtin_popcountll(selection[word]);
+    }
+
+    std::vector<House> houses;
+    houses.reserve(count);
+    for (size_t word = 0; word < selection.size(); ++word) {
+        unsigned long long bits = selection[word];
+        while (bits) {
+            houses.push_back(toHouse(word * 64 + __builtin_ctzll(bits)));
+            bits &= bits - 1;
+        }
+    }
+    return houses;
+}
+
+House HouseCatalog::toHouse(size_t row) const {
+    const TextRef& address = addresses[row];
+    const TextRef& mapLink = mapLinks[row];
+    const char* arena = text.empty() ? "" : &text[0];
+
+    House house(getId(row), typeNames[typeIds[row]], deposits[row], rents[row], townIds[row],
+                std::string(arena + address.offset, address.length),
+                std::string(arena + mapLink.offset, mapLink.length));
+    house.setAvailability((flags[row] & FLAG_AVAILABLE) != 0);
+    if (flags[row] & FLAG_BOOKED) {
+        house.book(getBookedUntil(row));
+    }
+    return house;
+}
+
+const char* HouseCatalog::getId(size_t row) const {
+    return &ids[row * ID_WIDTH];
+}
+
+const std::string& HouseCatalog::getType(size_t row) const {
+    return typeNames[typeIds[row]];
+}
+
+std::string HouseCatalog::getBookedUntil(size_t row) const {
+    long long packed = bookedUntil[row];
+    if (packed == 0) {
+        return "";
+    }
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d",
+                  static_cast<int>(packed / 10000000000LL),
+                  static_cast<int>(packed / 100000000LL % 100),
+                  static_cast<int>(packed / 1000000LL % 100),
+                  static_cast<int>(packed / 10000LL % 100),
+                  static_cast<int>(packed / 100LL % 100),
+                  static_cast<int>(packed % 100));
+    return buffer;
+}
+
+long long HouseCatalog::packDateTime(unsigned int year, unsigned int month, unsigned int day,
+                                     unsigned int hour, unsigned int minute, unsigned int second) {
+    return ((((year * 100LL + month) * 100LL + day) * 100LL + hour) * 100LL + minute) * 100LL + second;
+}
+
+long long HouseCatalog::packDateTime(const std::string& value) {
+    unsigned int year, month, day, hour = 0, minute = 0, second = 0;
+    if (std::sscanf(value.c_str(), "%u-%u-%u %u:%u:%u", &year, &month, &day, &hour, &minute, &second) < 3) {
+        return 0;
+    }
+    return packDateTime(year, month, day, hour, minute, second);
+}
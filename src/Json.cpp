@@ -0,0 +1,367 @@
+#include "include/Json.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+    const char HEX_DIGITS[] = "0123456789abcdef";
+
+    void skipSpace(const std::string& text, size_t& pos) {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+            ++pos;
+        }
+    }
+
+    bool parseHex4(const std::string& text, size_t pos, unsigned int& code) {
+        if (pos + 4 > text.size()) {
+            return false;
+        }
+        code = 0;
+        for (size_t i = pos; i < pos + 4; ++i) {
+            char c = text[i];
+            code <<= 4;
+            if (c >= '0' && c <= '9') {
+                code |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                code |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                code |= c - 'A' + 10;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void appendUtf8(std::string& out, unsigned int code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    // Parses the string starting at the opening quote; pos ends after the closing one
+    bool parseString(const std::string& text, size_t& pos, std::string& out, std::string& error) {
+        out.clear();
+        ++pos;
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                error = "control character in string";
+                return false;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) {
+                break;
+            }
+            char escape = text[pos++];
+            switch (escape) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned int code = 0;
+                    if (!parseHex4(text, pos, code)) {
+                        error = "bad \\u escape";
+                        return false;
+                    }
+                    pos += 4;
+
+                    // A high surrogate must be followed by its low half
+                    if (code >= 0xD800 && code < 0xDC00) {
+                        unsigned int low = 0;
+                        if (pos + 1 < text.size() && text[pos] == '\\' && text[pos + 1] == 'u' &&
+                            parseHex4(text, pos + 2, low) && low >= 0xDC00 && low < 0xE000) {
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                            pos += 6;
+                        } else {
+                            error = "unpaired surrogate";
+                            return false;
+                        }
+                    } else if (code >= 0xDC00 && code < 0xE000) {
+                        error = "unpaired surrogate";
+                        return false;
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    error = "bad escape in string";
+                    return false;
+            }
+        }
+        error = "unterminated string";
+        return false;
+    }
+
+    bool parseNumber(const std::string& text, size_t& pos, std::string& out) {
+        size_t start = pos;
+        if (pos < text.size() && text[pos] == '-') {
+            ++pos;
+        }
+        size_t digits = pos;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            ++pos;
+        }
+        if (pos == digits) {
+            return false;
+        }
+        if (pos < text.size() && text[pos] == '.') {
+            size_t fraction = ++pos;
+            while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+                ++pos;
+            }
+            if (pos == fraction) {
+                return false;
+            }
+        }
+        if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+            ++pos;
+            if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+                ++pos;
+            }
+            size_t exponent = pos;
+            while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+                ++pos;
+            }
+            if (pos == exponent) {
+                return false;
+            }
+        }
+        out.assign(text, start, pos - start);
+        return true;
+    }
+
+    bool matchWord(const std::string& text, size_t& pos, const char* word) {
+        size_t length = 0;
+        while (word[length]) {
+            ++length;
+        }
+        if (text.compare(pos, length, word) != 0) {
+            return false;
+        }
+        pos += length;
+        return true;
+    }
+}
+
+JsonWriter::JsonWriter() : afterKey(false) {}
+
+void JsonWriter::separate() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (!firstInScope.empty()) {
+        if (!firstInScope.back()) {
+            out += ',';
+        }
+        firstInScope.back() = false;
+    }
+}
+
+void JsonWriter::appendString(const std::string& text) {
+    out += '"';
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out += "\\u00";
+                    out += HEX_DIGITS[c >> 4];
+                    out += HEX_DIGITS[c & 0x0F];
+                } else {
+                    out += static_cast<char>(c);
+                }
+                break;
+        }
+    }
+    out += '"';
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    out += '{';
+    firstInScope.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out += '}';
+    firstInScope.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    out += '[';
+    firstInScope.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out += ']';
+    firstInScope.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const std::string& name) {
+    separate();
+    appendString(name);
+    out += ':';
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const std::string& text) {
+    separate();
+    appendString(text);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* text) {
+    return value(std::string(text));
+}
+
+JsonWriter& JsonWriter::value(int number) {
+    separate();
+    out += std::to_string(number);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(long long number) {
+    separate();
+    out += std::to_string(number);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned long long number) {
+    separate();
+    out += std::to_string(number);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    out += flag ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number, int decimals) {
+    if (std::isnan(number) || std::isinf(number)) {
+        return null();
+    }
+    separate();
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.*f", decimals, number);
+    out += buffer;
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out += "null";
+    return *this;
+}
+
+bool parseJsonObject(const std::string& text, std::map<std::string, std::string>& fields, std::string& error) {
+    fields.clear();
+    size_t pos = 0;
+    skipSpace(text, pos);
+    if (pos >= text.size() || text[pos] != '{') {
+        error = "expected a JSON object";
+        return false;
+    }
+    ++pos;
+    skipSpace(text, pos);
+    if (pos < text.size() && text[pos] == '}') {
+        ++pos;
+    } else {
+        while (true) {
+            skipSpace(text, pos);
+            std::string name;
+            if (pos >= text.size() || text[pos] != '"') {
+                error = "expected a member name";
+                return false;
+            }
+            if (!parseString(text, pos, name, error)) {
+                return false;
+            }
+            skipSpace(text, pos);
+            if (pos >= text.size() || text[pos] != ':') {
+                error = "expected ':' after \"" + name + "\"";
+                return false;
+            }
+            ++pos;
+            skipSpace(text, pos);
+
+            std::string value;
+            bool isNull = false;
+            if (pos < text.size() && text[pos] == '"') {
+                if (!parseString(text, pos, value, error)) {
+                    return false;
+                }
+            } else if (pos < text.size() && (text[pos] == '{' || text[pos] == '[')) {
+                error = "nested values are not supported (\"" + name + "\")";
+                return false;
+            } else if (matchWord(text, pos, "true")) {
+                value = "true";
+            } else if (matchWord(text, pos, "false")) {
+                value = "false";
+            } else if (matchWord(text, pos, "null")) {
+                isNull = true;
+            } else if (!parseNumber(text, pos, value)) {
+                error = "bad value for \"" + name + "\"";
+                return false;
+            }
+            if (!isNull) {
+                fields[name] = value;
+            }
+
+            skipSpace(text, pos);
+            if (pos < text.size() && text[pos] == ',') {
+                ++pos;
+                continue;
+            }
+            if (pos < text.size() && text[pos] == '}') {
+                ++pos;
+                break;
+            }
+            error = "expected ',' or '}'";
+            return false;
+        }
+    }
+    skipSpace(text, pos);
+    if (pos != text.size()) {
+        error = "unexpected text after the object";
+        return false;
+    }
+    return true;
+}
@@ -1,36 +1,89 @@
 #include "include/MBomaHousingSystem.h"
 #include "include/DBConnector.h"
+#include "include/SyncService.h"
+#include "include/ExpiryService.h"
 #include "include/DBConfig.h"
 #include "include/Utils.h"
+#include "include/Metrics.h"
 #include <iostream>
 #include <limits>
 #include <iomanip>
+#include <iterator>
 
-MBomaHousingSystem::MBomaHousingSystem() : currentUserId(0), dbConnector(nullptr), isLoggedIn(false), useDatabase(false) {
+namespace {
+    // Most completions listed for a typed county or town name
+    const size_t LOCATION_MATCHES = 10;
+    
+    // Houses listed by a nearest search without a radius
+    const size_t NEARBY_RESULTS = 10;
+    
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    MetricsCounter* const loginsSucceeded = metrics.counter(
+        "mboma_logins_total", "Login attempts by outcome", "result=\"success\"");
+    MetricsCounter* const loginsFailed = metrics.counter(
+        "mboma_logins_total", "Login attempts by outcome", "result=\"failure\"");
+    MetricsCounter* const userCacheHits = metrics.counter(
+        "mboma_user_cache_lookups_total", "Lookups of users by email in the user cache", "result=\"hit\"");
+    MetricsCounter* const userCacheMisses = metrics.counter(
+        "mboma_user_cache_lookups_total", "Lookups of users by email in the user cache", "result=\"miss\"");
+    
+    // One series per way findHouses can answer
+    MetricsHistogram* searchHistogram(const std::string& path) {
+        return metrics.histogram("mboma_search_seconds", "Time to answer a house search", "path=\"" + path + "\"");
+    }
+    MetricsHistogram* const calendarSearchLatency = searchHistogram("calendar");
+    MetricsHistogram* const databaseSearchLatency = searchHistogram("database");
+    MetricsHistogram* const textSearchLatency = searchHistogram("text");
+    MetricsHistogram* const rentSearchLatency = searchHistogram("rent");
+    MetricsHistogram* const catalogSearchLatency = searchHistogram("catalog");
+}
+
+MBomaHousingSystem::MBomaHousingSystem(bool interactive) : users(DBConfig::USER_CACHE_SIZE), currentUserId(0), dbConnector(nullptr), syncService(nullptr), expiryService(nullptr), isLoggedIn(false), useDatabase(false) {
+    // Batch mode keeps stdout for its results
+    std::ostream& messages = interactive ? std::cout : std::cerr;
+    
     // Try to initialize database connection
     dbConnector = new DBConnector();
     if (dbConnector->connect(DBConfig::DB_HOST, DBConfig::DB_USER, DBConfig::DB_PASS, DBConfig::DB_NAME)) {
         useDatabase = true;
-        std::cout << "Database connection established successfully.\n";
+        messages << "Database connection established successfully.\n";
         
-        // Load users and bookings from database if connection is successful
+        // Users and their bookings are loaded at login; load everything else now
         if (useDatabase && dbConnector && dbConnector->isConnected()) {
-            users = dbConnector->loadUsers();
-            bookings = dbConnector->loadBookings(); // Load all bookings from database
+            // Started before the load, so later changes reach the store as patches
+            syncService = new SyncService(dbConnector);
+            if (!syncService->start()) {
+                messages << "Warning: Background sync is disabled. " << dbConnector->getLastError() << "\n";
+                delete syncService;
+                syncService = nullptr;
+            }
             
-            // Initialize all other data from database
             initializeData();
+            
+            // Loads the active bookings on its own thread
+            expiryService = new ExpiryService(dbConnector);
+            if (!expiryService->start()) {
+                messages << "Warning: Booking expiry is disabled. " << dbConnector->getLastError() << "\n";
+                delete expiryService;
+                expiryService = nullptr;
+            }
         }
     } else {
-        std::cout << "Error: Database connection failed. This application requires a database connection.\n";
-        std::cout << "Error details: " << dbConnector->getLastError() << "\n";
-        std::cout << "Please ensure the database is properly configured and try again.\n";
+        messages << "Error: Database connection failed. This application requires a database connection.\n";
+        messages << "Error details: " << dbConnector->getLastError() << "\n";
+        messages << "Please ensure the database is properly configured and try again.\n";
         delete dbConnector;
         dbConnector = nullptr;
     }
 }
 
 MBomaHousingSystem::~MBomaHousingSystem() {
+    // Stop syncing and expiring before the connection they use goes away
+    delete syncService;
+    syncService = nullptr;
+    delete expiryService;
+    expiryService = nullptr;
+    
     // Clean up database connection if it exists
     if (dbConnector) {
         dbConnector->disconnect();
@@ -43,20 +96,22 @@ void MBomaHousingSystem::initializeData() {
     if (useDatabase && dbConnector && dbConnector->isConnected()) {
         // Load all data from database
         
-        // Load counties
-        std::vector<Location> counties = dbConnector->loadCounties();
-        for (const auto& county : counties) {
-            locations.push_back(county);
-        }
-        
-        // Load towns
+        // Load counties, then towns
+        std::vector<Location> locations = dbConnector->loadCounties();
         std::vector<Location> towns = dbConnector->loadAllTowns();
-        for (const auto& town : towns) {
-            locations.push_back(town);
-        }
+        locations.insert(locations.end(), towns.begin(), towns.end());
+        store.setLocations(locations);
+        
+        // Load houses, decoding rows straight into the catalog
+        std::vector<House> houses;
+        dbConnector->loadAllHousesInto(std::back_inserter(houses));
+        store.setHouses(std::move(houses));
         
-        // Load houses
-        houses = dbConnector->loadAllHouses();
+        // Booked date ranges of every user, for date-accurate availability
+        dbConnector->forEachCurrentBooking([this](Booking&& booking) {
+            store.scheduleBooking(booking);
+            return true;
+        });
     } else {
         std::cout << "Error: Database connection is required for this application to function.\n";
         std::cout << "Please ensure the database is properly configured and try again.\n";
@@ -77,10 +132,8 @@ void MBomaHousingSystem::waitForEnter() {
 }
 
 int MBomaHousingSystem::getNextId(const std::string& entityType) {
-    if (entityType == "user") {
-        return users.size() + 1;
-    } else if (entityType == "booking") {
-        return bookings.size() + 1;
+    if (entityType == "booking") {
+        return store.bookingCount() + 1;
     } else if (entityType == "payment") {
         return payments.size() + 1;
     }
@@ -89,10 +142,9 @@ int MBomaHousingSystem::getNextId(const std::string& entityType) {
 
 void MBomaHousingSystem::displayCounties() {
     std::cout << "\n===== COUNTIES =====\n";
-    for (const auto& location : locations) {
-        if (location.getType() == "county") {
-            std::cout << location.getId() << ". " << location.getName() << "\n";
-        }
+    for (size_t slot : store.countiesInOrder()) {
+        const Location& county = store.location(slot);
+        std::cout << county.getId() << ". " << county.getName() << "\n";
     }
 }
 
@@ -100,40 +152,78 @@ void MBomaHousingSystem::displayTowns(int countyId) {
     std::cout << "\n===== TOWNS IN ";
     
     // Find county name
-    for (const auto& location : locations) {
-        if (location.getType() == "county" && location.getId() == countyId) {
-            std::cout << location.getName() << " =====\n";
-            break;
-        }
+    const Location* county = store.findCounty(countyId);
+    if (county) {
+        std::cout << county->getName() << " =====\n";
     }
     
-    bool found = false;
-    for (const auto& location : locations) {
-        if (location.getType() == "town" && location.getParentId() == countyId) {
-            std::cout << location.getId() << ". " << location.getName() << "\n";
-            found = true;
-        }
+    const std::vector<size_t>& towns = store.townsInCounty(countyId);
+    for (size_t slot : towns) {
+        const Location& town = store.location(slot);
+        std::cout << town.getId() << ". " << town.getName() << "\n";
     }
     
-    if (!found) {
+    if (towns.empty()) {
         std::cout << "No towns available in this county.\n";
     }
 }
 
+int MBomaHousingSystem::readLocationChoice(const std::string& type, int countyId) {
+    std::string input;
+    std::getline(std::cin, input);
+    
+    size_t start = input.find_first_not_of(" \t");
+    size_t end = input.find_last_not_of(" \t");
+    if (start == std::string::npos) {
+        return -1;
+    }
+    input = input.substr(start, end - start + 1);
+    
+    // A number is taken as the ID itself
+    if (input.find_first_not_of("0123456789") == std::string::npos) {
+        try {
+            return std::stoi(input);
+        } catch (const std::exception& e) {
+            return -1;
+        }
+    }
+    
+    std::vector<size_t> matches = store.completeLocation(input, type, countyId, LOCATION_MATCHES);
+    if (matches.empty()) {
+        std::cout << "No " << type << " name starts with \"" << input << "\".\n";
+        return -1;
+    }
+    if (matches.size() == 1) {
+        const Location& location = store.location(matches[0]);
+        std::cout << "Selected " << location.getName() << ".\n";
+        return location.getId();
+    }
+    
+    std::cout << "\nMatching " << type << "s:\n";
+    for (size_t slot : matches) {
+        const Location& location = store.location(slot);
+        std::cout << location.getId() << ". " << location.getName() << "\n";
+    }
+    std::cout << "Enter " << type << " number or more of the name: ";
+    return readLocationChoice(type, countyId);
+}
+
 void MBomaHousingSystem::displayHouses(int townId) {
     std::cout << "\n===== HOUSES IN ";
     
     // Find town name
-    for (const auto& location : locations) {
-        if (location.getType() == "town" && location.getId() == townId) {
-            std::cout << location.getName() << " =====\n";
-            break;
-        }
+    const Location* town = store.findTown(townId);
+    if (town) {
+        std::cout << town->getName() << " =====\n";
     }
     
+    // Read from a pinned snapshot, as readers on other threads do
     bool found = false;
-    for (const auto& house : houses) {
-        if (house.getLocationId() == townId && house.getAvailability()) {
+    SnapshotCatalog::ReadGuard snapshot = store.snapshots().read();
+    const std::vector<House>& houses = snapshot->town(townId);
+    for (size_t i = 0; i < houses.size(); ++i) {
+        const House& house = houses[i];
+        if (house.getAvailability()) {
             std::cout << "\nHouse ID: " << house.getId() << "\n";
             std::cout << "Type: " << house.getType() << "\n";
             std::cout << "Address: " << house.getAddress() << "\n";
@@ -151,20 +241,253 @@ void MBomaHousingSystem::displayHouses(int townId) {
     }
 }
 
-House* MBomaHousingSystem::findHouse(const std::string& houseId) {
-    for (auto& house : houses) {
-        if (house.getId() == houseId) {
-            return &house;
-        }
+const House* MBomaHousingSystem::findHouse(const std::string& houseId) {
+    return store.findHouse(houseId);
+}
+
+User* MBomaHousingSystem::findUser(const std::string& email) {
+    User* user = users.find(email);
+    (user ? userCacheHits : userCacheMisses)->add();
+    if (user || !useDatabase || !dbConnector || !dbConnector->isConnected()) {
+        return user;
     }
-    return nullptr;
+    
+    // One indexed lookup instead of keeping every user in memory
+    User loaded;
+    if (!dbConnector->loadUserByEmail(email, loaded)) {
+        return nullptr;
+    }
+    return users.put(loaded);
+}
+
+void MBomaHousingSystem::loadUserBookings() {
+    if (!useDatabase || !dbConnector || !dbConnector->isConnected()) {
+        return;
+    }
+    
+    // Picks up bookings made in other sessions; known ones are updated in place
+    dbConnector->forEachBooking([this](Booking&& booking) {
+        store.putBooking(booking);
+        return true;
+    }, currentUserId);
 }
 
 User* MBomaHousingSystem::getCurrentUser() {
-    if (!isLoggedIn || currentUserId <= 0 || currentUserId > users.size()) {
+    if (!isLoggedIn) {
         return nullptr;
     }
-    return &users[currentUserId - 1];
+    return findUser(currentUserEmail);
+}
+
+int MBomaHousingSystem::getCurrentUserId() const {
+    return isLoggedIn ? currentUserId : 0;
+}
+
+bool MBomaHousingSystem::isReady() const {
+    return useDatabase && dbConnector && dbConnector->isConnected();
+}
+
+std::string MBomaHousingSystem::getLastError() const {
+    return dbConnector ? dbConnector->getLastError() : "Not connected to the database";
+}
+
+void MBomaHousingSystem::applyPending() {
+    if (syncService) {
+        syncService->applyPending(store);
+    }
+    if (expiryService) {
+        expiryService->applyPending(store);
+    }
+}
+
+bool MBomaHousingSystem::registerAccount(User& user) {
+    // Bookings need the user_id the database assigns
+    if (!isReady() || !dbConnector->registerUser(user)) {
+        return false;
+    }
+    users.put(user);
+    currentUserId = user.getId();
+    currentUserEmail = user.getEmail();
+    isLoggedIn = true;
+    if (syncService) {
+        syncService->watchUser(currentUserId);
+    }
+    return true;
+}
+
+bool MBomaHousingSystem::login(const std::string& email, const std::string& password) {
+    // Cached user, or one lookup by email; the password is checked locally
+    User* user = findUser(email);
+    if (!user || !user->login(email, password)) {
+        loginsFailed->add();
+        return false;
+    }
+    loginsSucceeded->add();
+    currentUserId = user->getId();
+    currentUserEmail = user->getEmail();
+    isLoggedIn = true;
+    loadUserBookings();
+    if (syncService) {
+        syncService->watchUser(currentUserId);
+    }
+    return true;
+}
+
+void MBomaHousingSystem::logout() {
+    currentUserId = 0;
+    currentUserEmail.clear();
+    if (syncService) {
+        syncService->watchUser(0);
+    }
+    isLoggedIn = false;
+}
+
+std::vector<House> MBomaHousingSystem::findHouses(const HouseQuery& query) {
+    std::vector<House> searchResults;
+    MetricsTimer timer(calendarSearchLatency);
+    
+    if (query.moveIn > 0) {
+        // Free for a whole booking period from the move-in date
+        HouseCatalog::Filter filter;
+        filter.type = query.type;
+        filter.minRent = query.minRent;
+        filter.maxRent = query.maxRent;
+        filter.townId = query.townId;
+        filter.availableOnly = true;
+        
+        long long moveOut = query.moveIn + Booking::GRACE_PERIOD_DAYS * 24LL * 3600;
+        std::vector<size_t> slots = store.housesFree(query.moveIn, moveOut, filter);
+        for (size_t i = 0; i < slots.size(); ++i) {
+            const House& house = store.house(slots[i]);
+            if (containsIgnoreCase(house.getAddress(), query.address)) {
+                searchResults.push_back(house);
+            }
+        }
+    } else if (useDatabase && dbConnector && dbConnector->isConnected()) {
+        // Use database search if available
+        timer.retarget(databaseSearchLatency);
+        searchResults = dbConnector->searchHouses(query.type, query.minRent, query.maxRent, query.townId, query.address);
+    } else {
+        // Use in-memory search over the houses open for booking
+        HouseCatalog::Filter filter;
+        filter.type = query.type;
+        filter.minRent = query.minRent;
+        filter.maxRent = query.maxRent;
+        filter.townId = query.townId;
+
+        EntityStore::SearchResult found = store.searchOpenHouses(filter, query.address, 0);
+        switch (found.path) {
+            case EntityStore::SEARCH_BY_TEXT:
+                timer.retarget(textSearchLatency);
+                break;
+            case EntityStore::SEARCH_BY_RENT:
+                timer.retarget(rentSearchLatency);
+                break;
+            default:
+                timer.retarget(catalogSearchLatency);
+                break;
+        }
+        searchResults.swap(found.houses);
+    }
+    
+    return searchResults;
+}
+
+MBomaHousingSystem::BookingOutcome MBomaHousingSystem::bookHouse(const std::string& houseId, Booking& booking) {
+    const House* house = findHouse(houseId);
+    if (!house || !house->getAvailability()) {
+        return BOOKING_NO_SUCH_HOUSE;
+    }
+    if (house->getBookingStatus()) {
+        return BOOKING_ALREADY_BOOKED;
+    }
+    
+    // Hold the house first, so racing sessions cannot both go on to book it
+    ReservationTable::Token hold = store.reservations().hold(houseId, DBConfig::RESERVATION_HOLD_SECONDS);
+    if (!hold) {
+        return BOOKING_HELD;
+    }
+    
+    // The booking exists only once the database has committed it
+    DBConnector::BookingResult result;
+    result.status = DBConnector::BOOKING_FAILED;
+    if (isReady()) {
+        result = dbConnector->bookHouse(currentUserId, houseId, house->getLocationId());
+    }
+    if (result.status != DBConnector::BOOKING_CREATED) {
+        store.reservations().release(houseId, hold);
+        if (result.status == DBConnector::BOOKING_HOUSE_TAKEN) {
+            // Another session booked the house after it was listed
+            store.bookHouse(houseId, result.expiryDate);
+            return BOOKING_TAKEN;
+        }
+        return result.status == DBConnector::BOOKING_HOUSE_NOT_FOUND ? BOOKING_NO_SUCH_HOUSE : BOOKING_NOT_SAVED;
+    }
+    
+    // Use the ID and dates stored by the database; the hold becomes the booking
+    booking = Booking(result.bookingId, currentUserId, houseId, result.bookingDate, result.expiryDate, false);
+    if (expiryService) {
+        expiryService->schedule(booking.getId(), booking.getExpiryDate());
+    }
+    store.reservations().confirm(houseId, hold);
+    store.addBooking(booking);
+    store.bookHouse(houseId, booking.getExpiryDate());
+    return BOOKING_SAVED;
+}
+
+MBomaHousingSystem::PaymentOutcome MBomaHousingSystem::payBooking(int bookingId, const std::string& method,
+                                                                  std::string& receiptNumber, double& amount) {
+    Booking* booking = store.findBooking(bookingId);
+    if (!booking || !isLoggedIn || booking->getUserId() != currentUserId) {
+        return PAYMENT_NO_SUCH_BOOKING;
+    }
+    if (booking->getPaymentStatus()) {
+        return PAYMENT_ALREADY_PAID;
+    }
+    
+    if (!isReady()) {
+        return PAYMENT_NOT_SAVED;
+    }
+    
+    // The database checks ownership and claims the booking, so a payment
+    // from another session cannot slip in between
+    DBConnector::PaymentResult result = dbConnector->payBooking(currentUserId, bookingId, method);
+    switch (result.status) {
+        case DBConnector::PAYMENT_RECORDED:
+            break;
+        case DBConnector::PAYMENT_ALREADY_PAID:
+            return PAYMENT_ALREADY_PAID;
+        case DBConnector::PAYMENT_BOOKING_NOT_FOUND:
+            return PAYMENT_NO_SUCH_BOOKING;
+        case DBConnector::PAYMENT_HOUSE_NOT_LISTED:
+            return PAYMENT_HOUSE_NOT_LISTED;
+        default:
+            return PAYMENT_NOT_SAVED;
+    }
+    
+    // Keep the payment with the receipt number generated by the database
+    amount = result.amount;
+    Payment payment(getNextId("payment"), bookingId, amount, method);
+    payment.setReceiptNumber(result.receiptNumber);
+    payments.push_back(payment);
+    receiptNumber = payment.getReceiptNumber();
+    
+    // Mark the booking paid; a paid house is no longer listed
+    booking->markAsPaid();
+    store.setHouseAvailability(result.houseId, false);
+    return PAYMENT_SAVED;
+}
+
+std::vector<Booking> MBomaHousingSystem::myBookings() const {
+    std::vector<Booking> mine;
+    if (!isLoggedIn) {
+        return mine;
+    }
+    const std::vector<size_t>& slots = store.bookingsForUser(currentUserId);
+    for (size_t i = 0; i < slots.size(); ++i) {
+        mine.push_back(store.booking(slots[i]));
+    }
+    return mine;
 }
 
 void MBomaHousingSystem::processPayment(int bookingId, double amount) {
@@ -205,45 +528,81 @@ void MBomaHousingSystem::processPayment(int bookingId, double amount) {
             break;
     }
     
-    // Create payment record
-    int paymentId = getNextId("payment");
-    Payment payment(paymentId, bookingId, amount, paymentMethod);
-    payments.push_back(payment);
+    std::string receiptNumber;
+    PaymentOutcome outcome = payBooking(bookingId, paymentMethod, receiptNumber, amount);
+    if (outcome == PAYMENT_NO_SUCH_BOOKING) {
+        std::cout << "Booking " << bookingId << " was not found.\n";
+        return;
+    }
+    if (outcome == PAYMENT_ALREADY_PAID) {
+        std::cout << "This booking is already paid.\n";
+        return;
+    }
+    if (outcome == PAYMENT_HOUSE_NOT_LISTED) {
+        std::cout << "The booked house is no longer listed.\n";
+        return;
+    }
+    if (outcome == PAYMENT_NOT_SAVED) {
+        std::cout << "Failed to save the payment. Please try again. " << getLastError() << "\n";
+        return;
+    }
+    std::cout << "Payment saved to database.\n";
     
-    // Save payment to database if connected
-    std::string receiptNumber = "";
-    if (useDatabase && dbConnector && dbConnector->isConnected()) {
-        receiptNumber = dbConnector->recordPayment(bookingId, amount, paymentMethod);
-        if (!receiptNumber.empty()) {
-            std::cout << "Payment saved to database.\n";
-            // Update the receipt number if generated by database
-            payment.setReceiptNumber(receiptNumber);
-        } else {
-            std::cout << "Warning: Failed to save payment to database. " << dbConnector->getLastError() << "\n";
-        }
+    // Generate receipt
+    const Booking* booking = store.findBooking(bookingId);
+    const House* house = booking ? findHouse(booking->getHouseId()) : nullptr;
+    User* user = getCurrentUser();
+    if (house && user) {
+        payments.back().generateReceipt(*user, *house);
     }
     
-    // Find the booking and mark it as paid
-    for (auto& booking : bookings) {
-        if (booking.getId() == bookingId) {
-            booking.markAsPaid();
-            
-            // Find the house and update its status
-            House* house = findHouse(booking.getHouseId());
-            if (house) {
-                house->setAvailability(false);
-                
-                // Generate receipt
-                User* user = getCurrentUser();
-                if (user) {
-                    payment.generateReceipt(*user, *house);
-                }
-            }
-            break;
+    std::cout << "Payment successful!\n";
+}
+
+bool MBomaHousingSystem::bookAndOfferPayment(const std::string& houseId) {
+    Booking booking(0, currentUserId, houseId);
+    BookingOutcome outcome = bookHouse(houseId, booking);
+    switch (outcome) {
+        case BOOKING_NO_SUCH_HOUSE:
+            std::cout << "Invalid house ID. Please try again.\n";
+            return false;
+        case BOOKING_ALREADY_BOOKED: {
+            const House* house = findHouse(houseId);
+            std::cout << "This house is already booked until " << (house ? house->getBookedUntil() : "") << ".\n";
+            return false;
         }
+        case BOOKING_HELD:
+            std::cout << "This house is being booked by someone else. Please try again shortly.\n";
+            return false;
+        case BOOKING_TAKEN:
+            std::cout << "Sorry, this house has just been booked by someone else.\n";
+            return false;
+        case BOOKING_NOT_SAVED:
+            std::cout << "Failed to save the booking. Please try again. " << getLastError() << "\n";
+            return false;
+        case BOOKING_SAVED:
+            std::cout << "Booking saved to database.\n";
+            break;
     }
     
-    std::cout << "Payment successful!\n";
+    std::cout << "\nHouse booked successfully!\n";
+    std::cout << "Booking ID: " << booking.getId() << "\n";
+    std::cout << "Booking Date: " << booking.getBookingDate() << "\n";
+    std::cout << "Expiry Date: " << booking.getExpiryDate() << "\n";
+    
+    // Ask for payment
+    std::cout << "\nWould you like to make a payment now? (y/n): ";
+    char payNow;
+    std::cin >> payNow;
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    
+    const House* house = findHouse(houseId);
+    if ((payNow == 'y' || payNow == 'Y') && house) {
+        processPayment(booking.getId(), house->getDepositFee());
+    } else {
+        std::cout << "You can make the payment later from the 'View My Bookings' menu.\n";
+    }
+    return true;
 }
 
 void MBomaHousingSystem::searchHouses() {
@@ -252,23 +611,23 @@ void MBomaHousingSystem::searchHouses() {
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
     
     // Get search criteria from user
-    std::string type = "";
-    double minRent = 0.0;
-    double maxRent = -1.0;
-    int townId = -1;
+    HouseQuery query;
     
     std::cout << "Enter house type (leave blank for any): ";
-    std::getline(std::cin, type);
+    std::getline(std::cin, query.type);
+    
+    std::cout << "Enter a street or area in the address (leave blank for any): ";
+    std::getline(std::cin, query.address);
     
     std::cout << "Enter minimum monthly rent (0 for any): ";
     std::string minRentStr;
     std::getline(std::cin, minRentStr);
     if (!minRentStr.empty()) {
         try {
-            minRent = std::stod(minRentStr);
+            query.minRent = std::stod(minRentStr);
         } catch (const std::exception& e) {
             std::cout << "Invalid input, using default (0).\n";
-            minRent = 0.0;
+            query.minRent = 0.0;
         }
     }
     
@@ -277,10 +636,10 @@ void MBomaHousingSystem::searchHouses() {
     std::getline(std::cin, maxRentStr);
     if (!maxRentStr.empty()) {
         try {
-            maxRent = std::stod(maxRentStr);
+            query.maxRent = std::stod(maxRentStr);
         } catch (const std::exception& e) {
             std::cout << "Invalid input, using no maximum.\n";
-            maxRent = -1.0;
+            query.maxRent = -1.0;
         }
     }
     
@@ -293,70 +652,108 @@ void MBomaHousingSystem::searchHouses() {
         // Display counties first
         displayCounties();
         
-        std::cout << "\nEnter county number: ";
-        int countyId;
-        std::cin >> countyId;
-        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "\nEnter county number or name: ";
+        int countyId = readLocationChoice("county");
         
         // Display towns in the selected county
         displayTowns(countyId);
         
-        std::cout << "\nEnter town number: ";
-        std::cin >> townId;
-        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "\nEnter town number or name: ";
+        query.townId = readLocationChoice("town", countyId);
+    }
+    
+    // A move-in date asks the availability calendar instead of the booked flag
+    std::cout << "Enter move-in date (YYYY-MM-DD, leave blank for now): ";
+    std::string moveInStr;
+    std::getline(std::cin, moveInStr);
+    if (!moveInStr.empty() && !parseDateTime(moveInStr, query.moveIn)) {
+        std::cout << "Invalid date, searching for houses free now.\n";
+        query.moveIn = 0;
     }
     
     std::cout << "\nSearching for houses...\n";
     
-    std::vector<House> searchResults;
+    // Display search results
+    displaySearchResults(findHouses(query));
+}
+
+void MBomaHousingSystem::searchNearby() {
+    std::cout << "\n===== HOUSES NEAR A LOCATION =====\n";
     
-    if (useDatabase && dbConnector && dbConnector->isConnected()) {
-        // Use database search if available
-        searchResults = dbConnector->searchHouses(type, minRent, maxRent, townId);
-    } else {
-        // Use in-memory search
-        for (const auto& house : houses) {
-            bool matches = true;
-            
-            // Check type
-            if (!type.empty()) {
-                if (house.getType().find(type) == std::string::npos) {
-                    matches = false;
-                }
-            }
-            
-            // Check min rent
-            if (minRent > 0 && house.getMonthlyRent() < minRent) {
-                matches = false;
-            }
-            
-            // Check max rent
-            if (maxRent > 0 && house.getMonthlyRent() > maxRent) {
-                matches = false;
-            }
-            
-            // Check town
-            if (townId > 0 && house.getLocationId() != townId) {
-                matches = false;
-            }
-            
-            if (matches && house.getAvailability()) {
-                searchResults.push_back(house);
-            }
+    double lat = 0.0;
+    double lon = 0.0;
+    std::string input;
+    try {
+        std::cout << "Enter latitude (e.g. -1.2921 for Nairobi): ";
+        std::getline(std::cin, input);
+        lat = std::stod(input);
+        std::cout << "Enter longitude (e.g. 36.8219 for Nairobi): ";
+        std::getline(std::cin, input);
+        lon = std::stod(input);
+    } catch (const std::exception& e) {
+        std::cout << "Invalid coordinates.\n";
+        waitForEnter();
+        return;
+    }
+    if (lat < -90 || lat > 90 || lon < -180 || lon > 180) {
+        std::cout << "Coordinates are out of range.\n";
+        waitForEnter();
+        return;
+    }
+    
+    double radiusKm = -1.0;
+    std::cout << "Enter search radius in km (leave blank for the nearest " << NEARBY_RESULTS << "): ";
+    std::getline(std::cin, input);
+    if (!input.empty()) {
+        try {
+            radiusKm = std::stod(input);
+        } catch (const std::exception& e) {
+            std::cout << "Invalid input, showing the nearest houses.\n";
+            radiusKm = -1.0;
         }
     }
     
-    // Display search results
-    displaySearchResults(searchResults);
+    // The same filters as a normal search, over houses open for booking
+    HouseCatalog::Filter filter;
+    filter.availableOnly = true;
+    filter.unbookedOnly = true;
+    std::cout << "Enter house type (leave blank for any): ";
+    std::getline(std::cin, filter.type);
+    std::cout << "Enter maximum monthly rent (leave blank for any): ";
+    std::getline(std::cin, input);
+    if (!input.empty()) {
+        try {
+            filter.maxRent = std::stod(input);
+        } catch (const std::exception& e) {
+            std::cout << "Invalid input, using no maximum.\n";
+        }
+    }
+    
+    std::vector<GeoIndex::Hit> hits;
+    if (radiusKm > 0) {
+        store.housesWithin(lat, lon, radiusKm, filter, hits);
+    } else {
+        store.nearestHouses(lat, lon, NEARBY_RESULTS, filter, hits);
+    }
+    
+    std::vector<House> results;
+    std::vector<double> distances;
+    for (size_t i = 0; i < hits.size(); ++i) {
+        results.push_back(store.house(hits[i].slot));
+        distances.push_back(hits[i].distanceKm);
+    }
+    displaySearchResults(results, distances);
 }
 
-void MBomaHousingSystem::displaySearchResults(const std::vector<House>& searchResults) {
+void MBomaHousingSystem::displaySearchResults(const std::vector<House>& searchResults,
+                                              const std::vector<double>& distances) {
     if (searchResults.empty()) {
         std::cout << "\nNo houses match your search criteria.\n";
     } else {
         std::cout << "\n===== SEARCH RESULTS (" << searchResults.size() << " houses found) =====\n";
         
-        for (const auto& house : searchResults) {
+        for (size_t i = 0; i < searchResults.size(); ++i) {
+            const House& house = searchResults[i];
             std::cout << "\nHouse ID: " << house.getId() << "\n";
             std::cout << "Type: " << house.getType() << "\n";
             std::cout << "Address: " << house.getAddress() << "\n";
@@ -364,16 +761,14 @@ void MBomaHousingSystem::displaySearchResults(const std::vector<House>& searchRe
             std::cout << "Monthly Rent: KES " << std::fixed << std::setprecision(2) << house.getMonthlyRent() << "\n";
             
             // Get town name
-            std::string townName = "Unknown";
-            for (const auto& location : locations) {
-                if (location.getId() == house.getLocationId()) {
-                    townName = location.getName();
-                    break;
-                }
-            }
+            const Location* town = store.findTown(house.getLocationId());
+            std::string townName = town ? town->getName() : "Unknown";
             
             std::cout << "Town: " << townName << "\n";
             std::cout << "Map Link: " << house.getMapLink() << "\n";
+            if (i < distances.size()) {
+                std::cout << "Distance: " << std::fixed << std::setprecision(2) << distances[i] << " km\n";
+            }
             std::cout << "Status: " << (house.getBookingStatus() ? "Booked until " + house.getBookedUntil() : "Available") << "\n";
             std::cout << "------------------------------\n";
         }
@@ -388,62 +783,17 @@ void MBomaHousingSystem::displaySearchResults(const std::vector<House>& searchRe
             std::cin >> houseId;
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
             
-            // Find the house
-            House* house = nullptr;
-            for (auto& h : searchResults) {
-                if (h.getId() == houseId) {
-                    house = findHouse(houseId);
+            // Only a listed result can be booked from here
+            bool listed = false;
+            for (size_t i = 0; i < searchResults.size(); ++i) {
+                if (searchResults[i].getId() == houseId) {
+                    listed = true;
                     break;
                 }
             }
             
-            if (house && house->getAvailability() && !house->getBookingStatus()) {
-                // Create booking in memory
-                int bookingId = getNextId("booking");
-                Booking booking(bookingId, currentUserId, houseId);
-                bookings.push_back(booking);
-                
-                // Save booking to database if connected
-                int dbBookingId = -1;
-                if (useDatabase && dbConnector && dbConnector->isConnected()) {
-                    int townId = house->getLocationId();
-                    dbBookingId = dbConnector->createBooking(currentUserId, houseId, townId);
-                    if (dbBookingId > 0) {
-                        // Update the booking ID to match the database-generated ID
-                        bookings.pop_back();  // Remove original booking
-                        booking.setId(dbBookingId);  // Update ID
-                        
-                        // Reload all bookings to ensure we have the latest data with correct dates
-                        bookings = dbConnector->loadBookings();
-                        
-                        bookingId = dbBookingId;  // Update bookingId for further use
-                        std::cout << "Booking saved to database.\n";
-                    } else {
-                        std::cout << "Warning: Failed to save booking to database. " << dbConnector->getLastError() << "\n";
-                    }
-                }
-                
-                // Mark house as booked
-                house->book(booking.getExpiryDate());
-                
-                std::cout << "\nHouse booked successfully!\n";
-                std::cout << "Booking ID: " << bookingId << "\n";
-                std::cout << "Booking Date: " << booking.getBookingDate() << "\n";
-                std::cout << "Expiry Date: " << booking.getExpiryDate() << "\n";
-                
-                // Ask for payment
-                std::cout << "\nWould you like to make a payment now? (y/n): ";
-                char payNow;
-                std::cin >> payNow;
-                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                
-                if (payNow == 'y' || payNow == 'Y') {
-                    processPayment(bookingId, house->getDepositFee());
-                } else {
-                    std::cout << "You can make the payment later from the 'View My Bookings' menu.\n";
-                }
-            } else if (house && house->getBookingStatus()) {
-                std::cout << "This house is already booked until " << house->getBookedUntil() << ".\n";
+            if (listed) {
+                bookAndOfferPayment(houseId);
             } else {
                 std::cout << "Invalid house ID. Please try again.\n";
             }
@@ -464,6 +814,9 @@ void MBomaHousingSystem::run() {
     bool running = true;
     
     while (running) {
+        // Apply changes made by other sessions since the last screen
+        applyPending();
+        
         clearScreen();
         std::cout << "======================================\n";
         std::cout << "   M-BOMA HOUSING MANAGEMENT SYSTEM   \n";
@@ -483,18 +836,12 @@ void MBomaHousingSystem::run() {
                 case 1: {
                     User newUser;
                     if (newUser.registerUser()) {
-                        users.push_back(newUser);
-                        currentUserId = users.size();
-                        isLoggedIn = true;
-                        std::cout << "You are now logged in!\n";
-                        
-                        // Save user to database
-                        if (useDatabase && dbConnector && dbConnector->isConnected()) {
-                            if (dbConnector->registerUser(newUser)) {
-                                std::cout << "User info saved to database.\n";
-                            } else {
-                                std::cout << "Warning: Failed to save user to database. " << dbConnector->getLastError() << "\n";
-                            }
+                        // Save user to database and log in
+                        if (registerAccount(newUser)) {
+                            std::cout << "User info saved to database.\n";
+                            std::cout << "You are now logged in!\n";
+                        } else {
+                            std::cout << "Error: Failed to save user to database. " << getLastError() << "\n";
                         }
                         
                         waitForEnter();
@@ -509,47 +856,12 @@ void MBomaHousingSystem::run() {
                     std::cout << "Password: ";
                     std::getline(std::cin, password);
                     
-                    bool loginSuccess = false;
-                    
-                    // First try authenticating with in-memory users
-                    for (size_t i = 0; i < users.size(); ++i) {
-                        if (users[i].login(email, password)) {
-                            currentUserId = i + 1;
-                            isLoggedIn = true;
-                            loginSuccess = true;
-                            std::cout << "Login successful!\n";
-                            waitForEnter();
-                            break;
-                        }
-                    }
-                    
-                    // If in-memory login failed, try direct database authentication
-                    if (!loginSuccess && useDatabase && dbConnector && dbConnector->isConnected()) {
-                        if (dbConnector->authenticateUser(email, password)) {
-                            // Reload all users from database to ensure we have the latest data
-                            users = dbConnector->loadUsers();
-                            
-                            // Reload all bookings from the database
-                            bookings = dbConnector->loadBookings();
-                            
-                            // Find the user in the updated list
-                            for (size_t i = 0; i < users.size(); ++i) {
-                                if (equalsIgnoreCase(users[i].getEmail(), email)) {
-                                    currentUserId = i + 1;
-                                    isLoggedIn = true;
-                                    loginSuccess = true;
-                                    std::cout << "Login successful!\n";
-                                    waitForEnter();
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                    
-                    if (!loginSuccess) {
+                    if (login(email, password)) {
+                        std::cout << "Login successful!\n";
+                    } else {
                         std::cout << "Invalid email or password. Please try again.\n";
-                        waitForEnter();
                     }
+                    waitForEnter();
                     break;
                 }
                 case 3:
@@ -567,10 +879,11 @@ void MBomaHousingSystem::run() {
             
             std::cout << "\n1. Browse Counties\n";
             std::cout << "2. Search Houses\n";
-            std::cout << "3. View My Bookings\n";
-            std::cout << "4. Logout\n";
-            std::cout << "5. Exit\n";
-            std::cout << "\nEnter your choice (1-5): ";
+            std::cout << "3. Houses Near a Location\n";
+            std::cout << "4. View My Bookings\n";
+            std::cout << "5. Logout\n";
+            std::cout << "6. Exit\n";
+            std::cout << "\nEnter your choice (1-6): ";
             
             int choice;
             std::cin >> choice;
@@ -583,46 +896,30 @@ void MBomaHousingSystem::run() {
                     while (browsing) {
                         displayCounties();
                         std::cout << "\n0. Back to Main Menu\n";
-                        std::cout << "Enter county number (or 0 to go back): ";
+                        std::cout << "Enter county number or name (or 0 to go back): ";
                         
-                        int countyId;
-                        std::cin >> countyId;
-                        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                        int countyId = readLocationChoice("county");
                         
                         if (countyId == 0) {
                             browsing = false;
                         } else {
                             // Display towns in the selected county
-                            bool validCounty = false;
-                            for (const auto& location : locations) {
-                                if (location.getType() == "county" && location.getId() == countyId) {
-                                    validCounty = true;
-                                    break;
-                                }
-                            }
+                            bool validCounty = store.findCounty(countyId) != nullptr;
                             
                             if (validCounty) {
                                 bool browsingTowns = true;
                                 while (browsingTowns) {
                                     displayTowns(countyId);
                                     std::cout << "\n0. Back to Counties\n";
-                                    std::cout << "Enter town number (or 0 to go back): ";
+                                    std::cout << "Enter town number or name (or 0 to go back): ";
                                     
-                                    int townId;
-                                    std::cin >> townId;
-                                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                                    int townId = readLocationChoice("town", countyId);
                                     
                                     if (townId == 0) {
                                         browsingTowns = false;
                                     } else {
                                         // Display houses in the selected town
-                                        bool validTown = false;
-                                        for (const auto& location : locations) {
-                                            if (location.getType() == "town" && location.getId() == townId) {
-                                                validTown = true;
-                                                break;
-                                            }
-                                        }
+                                        bool validTown = store.findTown(townId) != nullptr;
                                         
                                         if (validTown) {
                                             bool browsingHouses = true;
@@ -639,59 +936,12 @@ void MBomaHousingSystem::run() {
                                                     browsingHouses = false;
                                                 } else {
                                                     // Book the selected house
-                                                    House* house = findHouse(houseId);
-                                                    if (house && house->getAvailability() && !house->getBookingStatus()) {
-                                                        // Create booking
-                                                        int bookingId = getNextId("booking");
-                                                        Booking booking(bookingId, currentUserId, houseId);
-                                                        bookings.push_back(booking);
-                                                        
-                                                        // Save booking to database if connected
-                                                        int dbBookingId = -1;
-                                                        if (useDatabase && dbConnector && dbConnector->isConnected()) {
-                                                            int townId = house->getLocationId();
-                                                            dbBookingId = dbConnector->createBooking(currentUserId, houseId, townId);
-                                                            if (dbBookingId > 0) {
-                                                                // Update the booking ID to match the database-generated ID
-                                                                bookings.pop_back();  // Remove original booking
-                                                                booking.setId(dbBookingId);  // Update ID
-                                                                bookings.push_back(booking);  // Add updated booking
-                                                                bookingId = dbBookingId;  // Update bookingId for further use
-                                                                std::cout << "Booking saved to database.\n";
-                                                            } else {
-                                                                std::cout << "Warning: Failed to save booking to database. " << dbConnector->getLastError() << "\n";
-                                                            }
-                                                        }
-                                                        
-                                                        // Mark house as booked
-                                                        house->book(booking.getExpiryDate());
-                                                        
-                                                        std::cout << "\nHouse booked successfully!\n";
-                                                        std::cout << "Booking ID: " << bookingId << "\n";
-                                                        std::cout << "Booking Date: " << booking.getBookingDate() << "\n";
-                                                        std::cout << "Expiry Date: " << booking.getExpiryDate() << "\n";
-                                                        
-                                                        // Ask for payment
-                                                        std::cout << "\nWould you like to make a payment now? (y/n): ";
-                                                        char payNow;
-                                                        std::cin >> payNow;
-                                                        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                                                        
-                                                        if (payNow == 'y' || payNow == 'Y') {
-                                                            processPayment(bookingId, house->getDepositFee());
-                                                        } else {
-                                                            std::cout << "You can make the payment later from the 'View My Bookings' menu.\n";
-                                                        }
-                                                        
+                                                    if (bookAndOfferPayment(houseId)) {
                                                         waitForEnter();
                                                         browsingHouses = false;
                                                         browsingTowns = false;
                                                         browsing = false;
-                                                    } else if (house && house->getBookingStatus()) {
-                                                        std::cout << "This house is already booked until " << house->getBookedUntil() << ".\n";
-                                                        waitForEnter();
                                                     } else {
-                                                        std::cout << "Invalid house ID. Please try again.\n";
                                                         waitForEnter();
                                                     }
                                                 }
@@ -714,33 +964,38 @@ void MBomaHousingSystem::run() {
                     // Search Houses
                     searchHouses();
                     break;
-                case 3: {
+                case 3:
+                    // Houses Near a Location
+                    searchNearby();
+                    break;
+                case 4: {
                     // View My Bookings
                     std::cout << "\n===== MY BOOKINGS =====\n";
                     bool hasBookings = false;
                     
-                    for (const auto& booking : bookings) {
-                        if (booking.getUserId() == currentUserId) {
-                            hasBookings = true;
-                            House* house = findHouse(booking.getHouseId());
+                    // Copies, so paying inside the loop cannot invalidate them
+                    std::vector<Booking> mine = myBookings();
+                    for (size_t i = 0; i < mine.size(); ++i) {
+                        const Booking& booking = mine[i];
+                        hasBookings = true;
+                        const House* house = findHouse(booking.getHouseId());
+                        
+                        if (house) {
+                            std::cout << "\nBooking ID: " << booking.getId() << "\n";
+                            std::cout << "House: " << house->getType() << " at " << house->getAddress() << "\n";
+                            std::cout << "Booking Date: " << booking.getBookingDate() << "\n";
+                            std::cout << "Expiry Date: " << booking.getExpiryDate() << "\n";
+                            std::cout << "Payment Status: " << (booking.getPaymentStatus() ? "Paid" : "Pending") << "\n";
+                            std::cout << "------------------------------\n";
                             
-                            if (house) {
-                                std::cout << "\nBooking ID: " << booking.getId() << "\n";
-                                std::cout << "House: " << house->getType() << " at " << house->getAddress() << "\n";
-                                std::cout << "Booking Date: " << booking.getBookingDate() << "\n";
-                                std::cout << "Expiry Date: " << booking.getExpiryDate() << "\n";
-                                std::cout << "Payment Status: " << (booking.getPaymentStatus() ? "Paid" : "Pending") << "\n";
-                                std::cout << "------------------------------\n";
+                            if (!booking.getPaymentStatus()) {
+                                std::cout << "Would you like to make a payment for this booking? (y/n): ";
+                                char payNow;
+                                std::cin >> payNow;
+                                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
                                 
-                                if (!booking.getPaymentStatus()) {
-                                    std::cout << "Would you like to make a payment for this booking? (y/n): ";
-                                    char payNow;
-                                    std::cin >> payNow;
-                                    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                                    
-                                    if (payNow == 'y' || payNow == 'Y') {
-                                        processPayment(booking.getId(), house->getDepositFee());
-                                    }
+                                if (payNow == 'y' || payNow == 'Y') {
+                                    processPayment(booking.getId(), house->getDepositFee());
                                 }
                             }
                         }
@@ -753,14 +1008,13 @@ void MBomaHousingSystem::run() {
                     waitForEnter();
                     break;
                 }
-                case 4:
+                case 5:
                     // Logout
-                    currentUserId = 0;
-                    isLoggedIn = false;
+                    logout();
                     std::cout << "Logged out successfully.\n";
                     waitForEnter();
                     break;
-                case 5:
+                case 6:
                     // Exit
                     running = false;
                     break;
@@ -0,0 +1,230 @@
+#include "include/Metrics.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+namespace {
+    const char* const TYPE_NAMES[] = { "counter", "gauge", "histogram" };    // By MetricsRegistry::Type
+
+    // Metrics are over-aligned, which plain new does not honor before C++17
+    template <typename Metric>
+    Metric* newAligned() {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, 64, sizeof(Metric)) != 0) {
+            throw std::bad_alloc();
+        }
+        return new (memory) Metric();
+    }
+
+    void writeSeconds(std::ostream& out, unsigned long long micros) {
+        out << static_cast<double>(micros) / 1e6;
+    }
+
+    // name{labels} or name{labels,extra}, without braces if both are empty
+    void writeSeries(std::ostream& out, const std::string& name, const std::string& labels,
+                     const std::string& extra = "") {
+        out << name;
+        if (!labels.empty() || !extra.empty()) {
+            out << '{' << labels << (labels.empty() || extra.empty() ? "" : ",") << extra << '}';
+        }
+        out << ' ';
+    }
+
+    // HELP text escapes only backslashes and newlines
+    std::string escapeHelp(const std::string& help) {
+        std::string escaped;
+        for (size_t i = 0; i < help.size(); ++i) {
+            if (help[i] == '\\') {
+                escaped += "\\\\";
+            } else if (help[i] == '\n') {
+                escaped += "\\n";
+            } else {
+                escaped += help[i];
+            }
+        }
+        return escaped;
+    }
+}
+
+size_t metricsShardSlow() {
+    static std::atomic<size_t> nextShard(0);
+    static thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) & (METRICS_SHARDS - 1);
+    return shard;
+}
+
+MetricsCounter::MetricsCounter() {
+    for (size_t i = 0; i < METRICS_SHARDS; ++i) {
+        shards[i].value.store(0, std::memory_order_relaxed);
+    }
+}
+
+unsigned long long MetricsCounter::value() const {
+    unsigned long long total = 0;
+    for (size_t i = 0; i < METRICS_SHARDS; ++i) {
+        total += shards[i].value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+MetricsHistogram::MetricsHistogram() {
+    for (size_t i = 0; i < METRICS_SHARDS; ++i) {
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            shards[i].counts[b].store(0, std::memory_order_relaxed);
+        }
+        shards[i].sum.store(0, std::memory_order_relaxed);
+    }
+}
+
+long long MetricsHistogram::bucketBound(size_t bucket) {
+    if (bucket < 2) {
+        return static_cast<long long>(bucket) + 1;
+    }
+    // Bucket 2 + 2(m - 1) + half holds (2^m, 2^m + 2^(m-1)] or (2^m + 2^(m-1), 2^(m+1)]
+    size_t magnitude = (bucket - 2) / 2 + 1;
+    bool upperHalf = (bucket - 2) % 2 == 1;
+    return upperHalf ? 1LL << (magnitude + 1) : (1LL << magnitude) + (1LL << (magnitude - 1));
+}
+
+unsigned long long MetricsHistogram::snapshot(std::vector<unsigned long long>& counts,
+                                              unsigned long long& sumMicros) const {
+    counts.assign(BUCKETS, 0);
+    sumMicros = 0;
+    unsigned long long total = 0;
+    for (size_t i = 0; i < METRICS_SHARDS; ++i) {
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            unsigned long long count = shards[i].counts[b].load(std::memory_order_relaxed);
+            counts[b] += count;
+            total += count;
+        }
+        sumMicros += shards[i].sum.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Family* MetricsRegistry::familyFor(const std::string& name, const std::string& help, Type type) {
+    std::map<std::string, Family>::iterator found = families.find(name);
+    if (found == families.end()) {
+        Family family;
+        family.type = type;
+        family.help = help;
+        found = families.insert(std::make_pair(name, family)).first;
+    }
+    return found->second.type == type ? &found->second : nullptr;
+}
+
+MetricsCounter* MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Family* family = familyFor(name, help, COUNTER);
+    if (!family) {
+        return newAligned<MetricsCounter>();
+    }
+    void*& metric = family->series[labels];
+    if (!metric) {
+        metric = newAligned<MetricsCounter>();
+    }
+    return static_cast<MetricsCounter*>(metric);
+}
+
+MetricsGauge* MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Family* family = familyFor(name, help, GAUGE);
+    if (!family) {
+        return new MetricsGauge();
+    }
+    void*& metric = family->series[labels];
+    if (!metric) {
+        metric = new MetricsGauge();
+    }
+    return static_cast<MetricsGauge*>(metric);
+}
+
+MetricsHistogram* MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                             const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Family* family = familyFor(name, help, HISTOGRAM);
+    if (!family) {
+        return newAligned<MetricsHistogram>();
+    }
+    void*& metric = family->series[labels];
+    if (!metric) {
+        metric = newAligned<MetricsHistogram>();
+    }
+    return static_cast<MetricsHistogram*>(metric);
+}
+
+std::string MetricsRegistry::exportText() const {
+    std::ostringstream out;
+    out << std::setprecision(12);
+
+    // Bucket bounds are the same for every histogram
+    std::vector<std::string> bounds(MetricsHistogram::BUCKETS);
+    for (size_t b = 0; b + 1 < MetricsHistogram::BUCKETS; ++b) {
+        std::ostringstream bound;
+        bound << std::setprecision(12) << "le=\"";
+        writeSeconds(bound, static_cast<unsigned long long>(MetricsHistogram::bucketBound(b)));
+        bound << '"';
+        bounds[b] = bound.str();
+    }
+    bounds[MetricsHistogram::BUCKETS - 1] = "le=\"+Inf\"";
+
+    std::vector<unsigned long long> counts;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::map<std::string, Family>::const_iterator it = families.begin(); it != families.end(); ++it) {
+        const std::string& name = it->first;
+        const Family& family = it->second;
+        out << "# HELP " << name << ' ' << escapeHelp(family.help) << '\n';
+        out << "# TYPE " << name << ' ' << TYPE_NAMES[family.type] << '\n';
+
+        for (std::map<std::string, void*>::const_iterator series = family.series.begin();
+             series != family.series.end(); ++series) {
+            const std::string& labels = series->first;
+            if (family.type == COUNTER) {
+                writeSeries(out, name, labels);
+                out << static_cast<const MetricsCounter*>(series->second)->value() << '\n';
+            } else if (family.type == GAUGE) {
+                writeSeries(out, name, labels);
+                out << static_cast<const MetricsGauge*>(series->second)->value() << '\n';
+            } else {
+                unsigned long long sumMicros = 0;
+                unsigned long long total = static_cast<const MetricsHistogram*>(series->second)->snapshot(counts, sumMicros);
+                unsigned long long cumulative = 0;
+                for (size_t b = 0; b < counts.size(); ++b) {
+                    cumulative += counts[b];
+                    writeSeries(out, name + "_bucket", labels, bounds[b]);
+                    out << cumulative << '\n';
+                }
+                writeSeries(out, name + "_sum", labels);
+                writeSeconds(out, sumMicros);
+                out << '\n';
+                writeSeries(out, name + "_count", labels);
+                out << total << '\n';
+            }
+        }
+    }
+    return out.str();
+}
+
+bool MetricsRegistry::writeFile(const std::string& path) const {
+    std::string text = exportText();
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary.c_str(), std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << text;
+        if (!file.flush()) {
+            return false;
+        }
+    }
+    // Readers see either the old file or the new one, never a partial write
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
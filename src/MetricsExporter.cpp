@@ -0,0 +1,208 @@
+#include "include/MetricsExporter.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+    const size_t MAX_REQUEST_BYTES = 8192;
+    const int READ_TIMEOUT_MS = 1000;   // A scraper that stalls mid-request is dropped after this
+
+    void sendAll(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t written = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return;
+            }
+            sent += static_cast<size_t>(written);
+        }
+    }
+
+    std::string response(const std::string& status, const std::string& contentType, const std::string& body) {
+        return "HTTP/1.1 " + status + "\r\n"
+               "Content-Type: " + contentType + "\r\n"
+               "Content-Length: " + std::to_string(body.size()) + "\r\n"
+               "Connection: close\r\n\r\n" + body;
+    }
+}
+
+MetricsExporter::MetricsExporter(MetricsRegistry& registry)
+    : registry(registry), listenFd(-1), wakeFd(-1),
+      fileInterval(DBConfig::METRICS_FILE_INTERVAL_MS) {}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+    if (listenFd >= 0) {
+        close(listenFd);
+    }
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+}
+
+bool MetricsExporter::listen(const std::string& host, int port) {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<unsigned short>(port));
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        lastError = "Invalid metrics address: " + host;
+        return false;
+    }
+
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        lastError = std::string("Failed to create metrics socket: ") + std::strerror(errno);
+        return false;
+    }
+
+    int enable = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd, 16) != 0) {
+        lastError = "Failed to listen on " + host + ":" + std::to_string(port) + ": " + std::strerror(errno);
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    return true;
+}
+
+void MetricsExporter::writeTo(const std::string& path, int intervalMs) {
+    filePath = path;
+    fileInterval = std::chrono::milliseconds(intervalMs > 0 ? intervalMs : DBConfig::METRICS_FILE_INTERVAL_MS);
+}
+
+bool MetricsExporter::start() {
+    if (worker.joinable()) {
+        return true;
+    }
+    if (listenFd < 0 && filePath.empty()) {
+        lastError = "Nothing to export to: set a port or a file first";
+        return false;
+    }
+
+    if (wakeFd < 0) {
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd < 0) {
+            lastError = std::string("Failed to create eventfd: ") + std::strerror(errno);
+            return false;
+        }
+    }
+    worker = std::thread(&MetricsExporter::exportLoop, this);
+    return true;
+}
+
+void MetricsExporter::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    unsigned long long one = 1;
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void)written;
+    worker.join();
+
+    // Leave the final counts behind for whoever reads the file after exit
+    if (!filePath.empty() && !registry.writeFile(filePath)) {
+        lastError = "Failed to write metrics to " + filePath;
+    }
+}
+
+std::string MetricsExporter::getLastError() const {
+    return lastError;
+}
+
+void MetricsExporter::exportLoop() {
+    std::chrono::steady_clock::time_point nextWrite = std::chrono::steady_clock::now();
+
+    while (true) {
+        int timeoutMs = -1;
+        if (!filePath.empty()) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (now >= nextWrite) {
+                registry.writeFile(filePath);
+                nextWrite = now + fileInterval;
+            }
+            timeoutMs = static_cast<int>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(nextWrite - now).count()) + 1;
+        }
+
+        pollfd fds[2];
+        fds[0].fd = wakeFd;
+        fds[0].events = POLLIN;
+        fds[1].fd = listenFd;    // Ignored by poll while -1
+        fds[1].events = POLLIN;
+        int ready = poll(fds, 2, timeoutMs);
+        if (ready < 0 && errno != EINTR) {
+            lastError = std::string("poll failed: ") + std::strerror(errno);
+            return;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        if (fds[0].revents) {
+            unsigned long long counter;
+            ssize_t drained = read(wakeFd, &counter, sizeof(counter));
+            (void)drained;
+            return;
+        }
+        if (fds[1].revents & POLLIN) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                serve(fd);
+                close(fd);
+            }
+        }
+    }
+}
+
+void MetricsExporter::serve(int fd) {
+    timeval timeout;
+    timeout.tv_sec = READ_TIMEOUT_MS / 1000;
+    timeout.tv_usec = (READ_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Only the request line matters; read up to the end of the headers
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_BYTES) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    std::string line = request.substr(0, request.find("\r\n"));
+    std::string::size_type methodEnd = line.find(' ');
+    std::string::size_type pathEnd = line.find(' ', methodEnd == std::string::npos ? 0 : methodEnd + 1);
+    std::string method = line.substr(0, methodEnd);
+    std::string path = methodEnd == std::string::npos ? "" : line.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+    path = path.substr(0, path.find('?'));
+
+    if (method != "GET" && method != "HEAD") {
+        sendAll(fd, response("405 Method Not Allowed", "text/plain", "Use GET\n"));
+    } else if (path != "/metrics" && path != "/") {
+        sendAll(fd, response("404 Not Found", "text/plain", "Metrics are at /metrics\n"));
+    } else {
+        std::string text = registry.exportText();
+        std::string reply = response("200 OK", "text/plain; version=0.0.4; charset=utf-8", text);
+        if (method == "HEAD") {
+            reply.resize(reply.size() - text.size());
+        }
+        sendAll(fd, reply);
+    }
+}
@@ -11,33 +11,28 @@ Payment::Payment(int id, int bookingId, double amount, const std::string& paymen
     receiptNumber = generateReceiptNumber();
 }
 
+void Payment::formatReceipt(std::ostream& out, const User& user, const House& house) const {
+    out << "========== PAYMENT RECEIPT ==========\n"
+        << "Receipt Number: " << receiptNumber << "\n"
+        << "Date: " << paymentDate << "\n"
+        << "Customer: " << user.getName() << "\n"
+        << "Phone: " << user.getPhone() << "\n"
+        << "Email: " << user.getEmail() << "\n"
+        << "Property: " << house.getType() << " at " << house.getAddress() << "\n"
+        << "Amount Paid: KES " << std::fixed << std::setprecision(2) << amount << "\n"
+        << "Payment Method: " << paymentMethod << "\n"
+        << "Status: PAID\n"
+        << "======================================\n";
+}
+
 void Payment::generateReceipt(const User& user, const House& house) const {
-    std::cout << "\n========== PAYMENT RECEIPT ==========\n";
-    std::cout << "Receipt Number: " << receiptNumber << "\n";
-    std::cout << "Date: " << paymentDate << "\n";
-    std::cout << "Customer: " << user.getName() << "\n";
-    std::cout << "Phone: " << user.getPhone() << "\n";
-    std::cout << "Email: " << user.getEmail() << "\n";
-    std::cout << "Property: " << house.getType() << " at " << house.getAddress() << "\n";
-    std::cout << "Amount Paid: KES " << std::fixed << std::setprecision(2) << amount << "\n";
-    std::cout << "Payment Method: " << paymentMethod << "\n";
-    std::cout << "Status: PAID\n";
-    std::cout << "======================================\n";
+    std::cout << "\n";
+    formatReceipt(std::cout, user, house);
     
     // Save receipt to file
     std::ofstream receiptFile(receiptNumber + ".txt");
     if (receiptFile.is_open()) {
-        receiptFile << "========== PAYMENT RECEIPT ==========\n";
-        receiptFile << "Receipt Number: " << receiptNumber << "\n";
-        receiptFile << "Date: " << paymentDate << "\n";
-        receiptFile << "Customer: " << user.getName() << "\n";
-        receiptFile << "Phone: " << user.getPhone() << "\n";
-        receiptFile << "Email: " << user.getEmail() << "\n";
-        receiptFile << "Property: " << house.getType() << " at " << house.getAddress() << "\n";
-        receiptFile << "Amount Paid: KES " << std::fixed << std::setprecision(2) << amount << "\n";
-        receiptFile << "Payment Method: " << paymentMethod << "\n";
-        receiptFile << "Status: PAID\n";
-        receiptFile << "======================================\n";
+        formatReceipt(receiptFile, user, house);
         receiptFile.close();
         std::cout << "Receipt saved to " << receiptNumber << ".txt\n";
     }
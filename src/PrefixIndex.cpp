@@ -0,0 +1,75 @@
+#include "include/PrefixIndex.h"
+#include "include/Utils.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // Compares a stored key with the prefix, looking at the prefix length only
+    struct PrefixOrder {
+        const std::string* keys;
+        size_t length;
+
+        int compare(unsigned int offset, unsigned int keyLength, const std::string& prefix) const {
+            size_t common = keyLength < length ? keyLength : length;
+            int order = std::memcmp(keys->data() + offset, prefix.data(), common);
+            if (order != 0 || keyLength >= length) {
+                return order;
+            }
+            return -1;  // Key is a proper prefix of the prefix: it sorts first
+        }
+    };
+}
+
+bool PrefixIndex::KeyLess::operator()(const Entry& a, const Entry& b) const {
+    size_t common = a.length < b.length ? a.length : b.length;
+    int order = std::memcmp(keys->data() + a.offset, keys->data() + b.offset, common);
+    return order != 0 ? order < 0 : a.length < b.length;
+}
+
+void PrefixIndex::clear() {
+    keys.clear();
+    entries.clear();
+}
+
+void PrefixIndex::add(const std::string& key, size_t value) {
+    Entry entry;
+    entry.offset = static_cast<unsigned int>(keys.size());
+    entry.length = static_cast<unsigned int>(key.size());
+    entry.value = value;
+    keys += toLowerCase(key);
+    entries.push_back(entry);
+}
+
+void PrefixIndex::sort() {
+    KeyLess less = { &keys };
+    std::stable_sort(entries.begin(), entries.end(), less);
+}
+
+PrefixIndex::EntryRange PrefixIndex::find(const std::string& prefix) const {
+    std::string folded = toLowerCase(prefix);
+    PrefixOrder order = { &keys, folded.size() };
+
+    // First entry not before the prefix, then first entry past it
+    size_t low = 0;
+    size_t high = entries.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (order.compare(entries[middle].offset, entries[middle].length, folded) < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    size_t first = low;
+    high = entries.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (order.compare(entries[middle].offset, entries[middle].length, folded) <= 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return EntryRange(first, low);
+}
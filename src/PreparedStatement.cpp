@@ -0,0 +1,302 @@
+#include "include/PreparedStatement.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    // Upper bound for a column buffer sized from metadata; longer values are
+    // re-fetched into a grown buffer when the row actually needs it
+    const unsigned long MAX_INITIAL_COLUMN_BUFFER = 4096;
+}
+
+PreparedStatement::PreparedStatement(MYSQL* conn, const std::string& sql)
+    : stmt(nullptr), sql(sql), hasResult(false), needsResultBind(false) {
+    stmt = mysql_stmt_init(conn);
+}
+
+PreparedStatement::~PreparedStatement() {
+    if (stmt) {
+        mysql_stmt_close(stmt);
+        stmt = nullptr;
+    }
+}
+
+bool PreparedStatement::prepare() {
+    if (!stmt) {
+        return false;
+    }
+
+    if (mysql_stmt_prepare(stmt, sql.c_str(), sql.length())) {
+        return false;
+    }
+
+    // Parameter storage is allocated once so bound pointers stay valid
+    unsigned long paramCount = mysql_stmt_param_count(stmt);
+    paramValues.assign(paramCount, Param());
+    params.assign(paramCount, MYSQL_BIND());
+    for (unsigned long i = 0; i < paramCount; ++i) {
+        std::memset(&params[i], 0, sizeof(MYSQL_BIND));
+        paramValues[i].intValue = 0;
+        paramValues[i].doubleValue = 0.0;
+        paramValues[i].length = 0;
+        paramValues[i].isNull = 0;
+        params[i].buffer_type = MYSQL_TYPE_NULL;
+        params[i].is_null = &paramValues[i].isNull;
+    }
+
+    setupColumns();
+    return true;
+}
+
+void PreparedStatement::setupColumns() {
+    MYSQL_RES* metadata = mysql_stmt_result_metadata(stmt);
+    if (!metadata) {
+        // Statement does not produce a result set (INSERT/UPDATE)
+        columns.clear();
+        return;
+    }
+
+    unsigned int fieldCount = mysql_num_fields(metadata);
+    MYSQL_FIELD* fields = mysql_fetch_fields(metadata);
+
+    columnValues.assign(fieldCount, Column());
+    columns.assign(fieldCount, MYSQL_BIND());
+
+    for (unsigned int i = 0; i < fieldCount; ++i) {
+        // Every column is fetched as text; the client library converts
+        // numeric and temporal values while decoding the binary row
+        unsigned long width = fields[i].length;
+        if (width < 32) {
+            width = 32;
+        } else if (width > MAX_INITIAL_COLUMN_BUFFER) {
+            width = MAX_INITIAL_COLUMN_BUFFER;
+        }
+        Column& value = columnValues[i];
+        value.buffer.assign(width + 1, '\0');
+        value.length = 0;
+        value.isNull = 0;
+        value.error = 0;
+
+        std::memset(&columns[i], 0, sizeof(MYSQL_BIND));
+        columns[i].buffer_type = MYSQL_TYPE_STRING;
+        columns[i].buffer = &value.buffer[0];
+        columns[i].buffer_length = width;
+        columns[i].length = &value.length;
+        columns[i].is_null = &value.isNull;
+        columns[i].error = &value.error;
+    }
+
+    mysql_free_result(metadata);
+    needsResultBind = true;
+}
+
+const std::string& PreparedStatement::getSql() const {
+    return sql;
+}
+
+void PreparedStatement::bindInt(unsigned int index, long long value) {
+    if (index >= params.size()) {
+        return;
+    }
+    Param& param = paramValues[index];
+    param.intValue = value;
+    param.isNull = 0;
+    params[index].buffer_type = MYSQL_TYPE_LONGLONG;
+    params[index].buffer = &param.intValue;
+    params[index].buffer_length = sizeof(param.intValue);
+    params[index].length = nullptr;
+}
+
+void PreparedStatement::bindDouble(unsigned int index, double value) {
+    if (index >= params.size()) {
+        return;
+    }
+    Param& param = paramValues[index];
+    param.doubleValue = value;
+    param.isNull = 0;
+    params[index].buffer_type = MYSQL_TYPE_DOUBLE;
+    params[index].buffer = &param.doubleValue;
+    params[index].buffer_length = sizeof(param.doubleValue);
+    params[index].length = nullptr;
+}
+
+void PreparedStatement::bindString(unsigned int index, const std::string& value) {
+    if (index >= params.size()) {
+        return;
+    }
+    Param& param = paramValues[index];
+    param.textValue = value;
+    param.length = param.textValue.length();
+    param.isNull = 0;
+    params[index].buffer_type = MYSQL_TYPE_STRING;
+    params[index].buffer = const_cast<char*>(param.textValue.data());
+    params[index].buffer_length = param.length;
+    params[index].length = &param.length;
+}
+
+void PreparedStatement::bindNull(unsigned int index) {
+    if (index >= params.size()) {
+        return;
+    }
+    paramValues[index].isNull = 1;
+    params[index].buffer_type = MYSQL_TYPE_NULL;
+    params[index].buffer = nullptr;
+    params[index].length = nullptr;
+}
+
+bool PreparedStatement::execute(bool buffered) {
+    if (!stmt) {
+        return false;
+    }
+
+    // Drop any rows left over from a previous execution
+    finish();
+
+    if (!params.empty() && mysql_stmt_bind_param(stmt, &params[0])) {
+        return false;
+    }
+
+    if (mysql_stmt_execute(stmt)) {
+        return false;
+    }
+
+    // CALL statements only describe their result set once executed
+    if (columns.empty() && mysql_stmt_field_count(stmt) > 0) {
+        setupColumns();
+    }
+
+    if (columns.empty()) {
+        return true;
+    }
+
+    hasResult = true;
+    if (needsResultBind) {
+        if (mysql_stmt_bind_result(stmt, &columns[0])) {
+            return false;
+        }
+        needsResultBind = false;
+    }
+
+    if (buffered && mysql_stmt_store_result(stmt)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool PreparedStatement::fetch() {
+    if (!hasResult) {
+        return false;
+    }
+
+    if (needsResultBind) {
+        if (mysql_stmt_bind_result(stmt, &columns[0])) {
+            return false;
+        }
+        needsResultBind = false;
+    }
+
+    int status = mysql_stmt_fetch(stmt);
+    if (status == 1 || status == MYSQL_NO_DATA) {
+        return false;
+    }
+
+    if (status == MYSQL_DATA_TRUNCATED) {
+        refetchTruncated();
+    }
+
+    // Terminate each value so callers can treat buffers as C strings
+    for (size_t i = 0; i < columns.size(); ++i) {
+        Column& value = columnValues[i];
+        unsigned long length = value.length;
+        if (length > columns[i].buffer_length) {
+            length = columns[i].buffer_length;
+        }
+        value.buffer[length] = '\0';
+    }
+
+    return true;
+}
+
+void PreparedStatement::refetchTruncated() {
+    for (unsigned int i = 0; i < columns.size(); ++i) {
+        Column& value = columnValues[i];
+        if (!value.error || value.length <= columns[i].buffer_length) {
+            continue;
+        }
+
+        value.buffer.assign(value.length + 1, '\0');
+        columns[i].buffer = &value.buffer[0];
+        columns[i].buffer_length = value.length;
+        mysql_stmt_fetch_column(stmt, &columns[i], i, 0);
+
+        // The grown buffer must be re-registered before the next fetch
+        needsResultBind = true;
+    }
+}
+
+void PreparedStatement::finish() {
+    if (!stmt || !hasResult) {
+        return;
+    }
+
+    mysql_stmt_free_result(stmt);
+
+    // CALL statements return an extra status result after the rows
+    while (mysql_stmt_next_result(stmt) == 0) {
+        mysql_stmt_free_result(stmt);
+    }
+
+    hasResult = false;
+}
+
+bool PreparedStatement::isNull(unsigned int column) const {
+    return column >= columnValues.size() || columnValues[column].isNull;
+}
+
+const char* PreparedStatement::getCString(unsigned int column) const {
+    if (isNull(column)) {
+        return "";
+    }
+    return &columnValues[column].buffer[0];
+}
+
+std::string PreparedStatement::getString(unsigned int column) const {
+    if (isNull(column)) {
+        return "";
+    }
+    const Column& value = columnValues[column];
+    return std::string(&value.buffer[0], value.length);
+}
+
+int PreparedStatement::getInt(unsigned int column) const {
+    if (isNull(column)) {
+        return 0;
+    }
+    return static_cast<int>(std::strtol(&columnValues[column].buffer[0], nullptr, 10));
+}
+
+double PreparedStatement::getDouble(unsigned int column) const {
+    if (isNull(column)) {
+        return 0.0;
+    }
+    return std::strtod(&columnValues[column].buffer[0], nullptr);
+}
+
+unsigned long long PreparedStatement::affectedRows() const {
+    return stmt ? mysql_stmt_affected_rows(stmt) : 0;
+}
+
+unsigned long long PreparedStatement::insertId() const {
+    return stmt ? mysql_stmt_insert_id(stmt) : 0;
+}
+
+std::string PreparedStatement::getError() const {
+    if (!stmt) {
+        return "MySQL statement initialization failed";
+    }
+    return mysql_stmt_error(stmt);
+}
+
+unsigned int PreparedStatement::getErrno() const {
+    return stmt ? mysql_stmt_errno(stmt) : 0;
+}
@@ -0,0 +1,64 @@
+#include "include/PriceIndex.h"
+
+namespace {
+    const PriceIndex::Entries NO_ENTRIES;
+}
+
+PriceIndex::Range PriceIndex::rangeOf(const Entries& entries, double minPrice, double maxPrice) {
+    Iterator first = minPrice > 0 ? entries.lower_bound(minPrice) : entries.begin();
+    Iterator last = maxPrice > 0 ? entries.upper_bound(maxPrice) : entries.end();
+    if (minPrice > 0 && maxPrice > 0 && maxPrice < minPrice) {
+        last = first;
+    }
+    return Range(first, last);
+}
+
+void PriceIndex::eraseFrom(Entries& entries, double price, const std::string& houseId) {
+    std::pair<Entries::iterator, Entries::iterator> equal = entries.equal_range(price);
+    for (Entries::iterator it = equal.first; it != equal.second; ++it) {
+        if (it->second == houseId) {
+            entries.erase(it);
+            return;
+        }
+    }
+}
+
+void PriceIndex::clear() {
+    all.clear();
+    byTown.clear();
+}
+
+void PriceIndex::insert(int townId, double price, const std::string& houseId) {
+    all.insert(Entries::value_type(price, houseId));
+    byTown[townId].insert(Entries::value_type(price, houseId));
+}
+
+void PriceIndex::erase(int townId, double price, const std::string& houseId) {
+    eraseFrom(all, price, houseId);
+
+    std::unordered_map<int, Entries>::iterator town = byTown.find(townId);
+    if (town != byTown.end()) {
+        eraseFrom(town->second, price, houseId);
+        if (town->second.empty()) {
+            byTown.erase(town);
+        }
+    }
+}
+
+PriceIndex::Range PriceIndex::range(double minPrice, double maxPrice) const {
+    return rangeOf(all, minPrice, maxPrice);
+}
+
+PriceIndex::Range PriceIndex::range(int townId, double minPrice, double maxPrice) const {
+    std::unordered_map<int, Entries>::const_iterator town = byTown.find(townId);
+    return rangeOf(town == byTown.end() ? NO_ENTRIES : town->second, minPrice, maxPrice);
+}
+
+std::vector<std::string> PriceIndex::cheapest(int townId, size_t k) const {
+    std::vector<std::string> houseIds;
+    Range houses = range(townId, 0.0, 0.0);
+    for (Iterator it = houses.first; it != houses.second && houseIds.size() < k; ++it) {
+        houseIds.push_back(it->second);
+    }
+    return houseIds;
+}
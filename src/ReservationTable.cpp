@@ -0,0 +1,216 @@
+#include "include/ReservationTable.h"
+#include <functional>
+
+namespace {
+    const size_t MIN_CAPACITY = 64;
+}
+
+ReservationTable::ReservationTable()
+    : segments(nullptr), lastSegment(nullptr), houseCount(0), nextToken(1), epoch(std::chrono::steady_clock::now()) {
+    reset();
+}
+
+ReservationTable::~ReservationTable() {
+    freeSegments();
+}
+
+unsigned long long ReservationTable::pack(State state, Token token, unsigned long long deadline) {
+    return (static_cast<unsigned long long>(state) << STATE_SHIFT) |
+           ((token & TOKEN_MASK) << TOKEN_SHIFT) | (deadline & DEADLINE_MASK);
+}
+
+ReservationTable::State ReservationTable::stateOf(unsigned long long word) {
+    return static_cast<State>(word >> STATE_SHIFT);
+}
+
+ReservationTable::Token ReservationTable::tokenOf(unsigned long long word) {
+    return static_cast<Token>((word >> TOKEN_SHIFT) & TOKEN_MASK);
+}
+
+unsigned long long ReservationTable::deadlineOf(unsigned long long word) {
+    return word & DEADLINE_MASK;
+}
+
+unsigned long long ReservationTable::seconds() const {
+    return static_cast<unsigned long long>(
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+ReservationTable::Segment* ReservationTable::newSegment(size_t capacity) {
+    Segment* segment = new Segment();
+    segment->slots = new Slot[capacity];
+    segment->mask = capacity - 1;
+    segment->count = 0;
+    segment->next.store(nullptr);
+    return segment;
+}
+
+void ReservationTable::freeSegments() {
+    Segment* segment = segments;
+    while (segment) {
+        Segment* next = segment->next.load();
+        delete[] segment->slots;
+        delete segment;
+        segment = next;
+    }
+    segments = nullptr;
+    lastSegment = nullptr;
+}
+
+std::atomic<unsigned long long>* ReservationTable::find(const std::string& houseId) {
+    const ReservationTable* self = this;
+    return const_cast<std::atomic<unsigned long long>*>(self->find(houseId));
+}
+
+const std::atomic<unsigned long long>* ReservationTable::find(const std::string& houseId) const {
+    size_t hash = std::hash<std::string>()(houseId);
+    for (const Segment* segment = segments; segment; segment = segment->next.load(std::memory_order_acquire)) {
+        // Linear probing; houses are never removed, so the first free slot ends the search
+        for (size_t i = hash & segment->mask; ; i = (i + 1) & segment->mask) {
+            const Slot& slot = segment->slots[i];
+            if (!slot.used.load(std::memory_order_acquire)) {
+                break;
+            }
+            if (slot.houseId == houseId) {
+                return &slot.word;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void ReservationTable::reset(size_t expectedHouses) {
+    freeSegments();
+
+    // At most half full, so probe runs stay short
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < expectedHouses * 2) {
+        capacity *= 2;
+    }
+    segments = newSegment(capacity);
+    lastSegment = segments;
+    houseCount.store(0);
+}
+
+void ReservationTable::add(const std::string& houseId, bool booked) {
+    std::lock_guard<std::mutex> lock(addMutex);
+    if (find(houseId)) {
+        if (booked) {
+            markBooked(houseId);
+        } else {
+            markFree(houseId);
+        }
+        return;
+    }
+
+    Segment* segment = lastSegment;
+    if ((segment->count + 1) * 2 > segment->mask + 1) {
+        Segment* overflow = newSegment((segment->mask + 1) * 2);
+        segment->next.store(overflow, std::memory_order_release);
+        lastSegment = overflow;
+        segment = overflow;
+    }
+
+    size_t i = std::hash<std::string>()(houseId) & segment->mask;
+    while (segment->slots[i].used.load(std::memory_order_relaxed)) {
+        i = (i + 1) & segment->mask;
+    }
+    Slot& slot = segment->slots[i];
+    slot.houseId = houseId;
+    slot.word.store(pack(booked ? BOOKED : FREE, 0, 0), std::memory_order_relaxed);
+    slot.used.store(true, std::memory_order_release);
+    ++segment->count;
+    ++houseCount;
+}
+
+ReservationTable::Token ReservationTable::hold(const std::string& houseId, int holdSeconds) {
+    std::atomic<unsigned long long>* word = find(houseId);
+    if (!word) {
+        return 0;
+    }
+
+    // Tokens wrap after 2^30 holds; 0 is skipped so it can mean "no hold"
+    Token token = nextToken.fetch_add(1) & TOKEN_MASK;
+    if (token == 0) {
+        token = nextToken.fetch_add(1) & TOKEN_MASK;
+    }
+
+    unsigned long long now = seconds();
+    unsigned long long held = pack(HELD, token, now + (holdSeconds > 0 ? holdSeconds : 0));
+    unsigned long long current = word->load();
+    while (true) {
+        State state = stateOf(current);
+        bool lapsed = state == HELD && deadlineOf(current) < now;
+        if (state != FREE && !lapsed) {
+            return 0;
+        }
+        // On failure current is reloaded, and the loop re-checks what changed
+        if (word->compare_exchange_weak(current, held)) {
+            return token;
+        }
+    }
+}
+
+bool ReservationTable::confirm(const std::string& houseId, Token token) {
+    std::atomic<unsigned long long>* word = find(houseId);
+    if (!word) {
+        return false;
+    }
+
+    unsigned long long current = word->load();
+    while (stateOf(current) == HELD && tokenOf(current) == token) {
+        if (word->compare_exchange_weak(current, pack(BOOKED, 0, 0))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReservationTable::release(const std::string& houseId, Token token) {
+    std::atomic<unsigned long long>* word = find(houseId);
+    if (!word) {
+        return false;
+    }
+
+    unsigned long long current = word->load();
+    while (stateOf(current) == HELD && tokenOf(current) == token) {
+        if (word->compare_exchange_weak(current, pack(FREE, 0, 0))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ReservationTable::markBooked(const std::string& houseId) {
+    std::atomic<unsigned long long>* word = find(houseId);
+    if (word) {
+        word->store(pack(BOOKED, 0, 0));
+    }
+}
+
+void ReservationTable::markFree(const std::string& houseId) {
+    std::atomic<unsigned long long>* word = find(houseId);
+    if (!word) {
+        return;
+    }
+
+    unsigned long long current = word->load();
+    while (stateOf(current) == BOOKED) {
+        if (word->compare_exchange_weak(current, pack(FREE, 0, 0))) {
+            return;
+        }
+    }
+}
+
+ReservationTable::State ReservationTable::state(const std::string& houseId) const {
+    const std::atomic<unsigned long long>* word = find(houseId);
+    if (!word) {
+        return FREE;
+    }
+
+    unsigned long long current = word->load();
+    if (stateOf(current) == HELD && deadlineOf(current) < seconds()) {
+        return FREE;
+    }
+    return stateOf(current);
+}
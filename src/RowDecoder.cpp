@@ -0,0 +1,44 @@
+#include "include/RowDecoder.h"
+#include <cstdlib>
+
+House decodeHouseRow(MYSQL_ROW row) {
+    int townId = row[2] ? std::atoi(row[2]) : 0;
+    double deposit = row[5] ? std::strtod(row[5], nullptr) : 0.0;
+    double rent = row[6] ? std::strtod(row[6], nullptr) : 0.0;
+    bool isAvailable = row[7] ? (std::atoi(row[7]) == 1) : true;
+    bool isBooked = row[8] ? (std::atoi(row[8]) == 1) : false;
+
+    House house(row[0] ? row[0] : "", row[1] ? row[1] : "", deposit, rent, townId,
+                row[3] ? row[3] : "", row[4] ? row[4] : "");
+    house.setAvailability(isAvailable);
+
+    if (isBooked && row[9] && row[9][0]) {
+        house.book(row[9]);
+    }
+    if (row[10] && row[11]) {
+        house.setCoordinates(std::strtod(row[10], nullptr), std::strtod(row[11], nullptr));
+    }
+
+    return house;
+}
+
+House decodeSearchRow(MYSQL_ROW row) {
+    double deposit = row[2] ? std::strtod(row[2], nullptr) : 0.0;
+    double rent = row[3] ? std::strtod(row[3], nullptr) : 0.0;
+    int townId = row[4] ? std::atoi(row[4]) : 0;
+
+    return House(row[0] ? row[0] : "", row[1] ? row[1] : "", deposit, rent, townId,
+                 row[5] ? row[5] : "", row[6] ? row[6] : "");
+}
+
+User decodeUserRow(MYSQL_ROW row) {
+    User user;
+    user.setId(row[0] ? std::atoi(row[0]) : 0);
+    user.setName(row[1] ? row[1] : "");
+    user.setPhone(row[2] ? row[2] : "");
+    user.setEmail(row[3] ? row[3] : "");
+
+    // Stored hash is set directly (not re-hashed)
+    user.setPasswordHash(row[4] ? row[4] : "");
+    return user;
+}
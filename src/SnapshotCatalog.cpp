@@ -0,0 +1,300 @@
+#include "include/SnapshotCatalog.h"
+#include <algorithm>
+#include <map>
+
+namespace {
+    typedef CatalogSnapshot::TownPartition TownPartition;
+    typedef CatalogSnapshot::TownText TownText;
+    typedef CatalogSnapshot::PositionMap PositionMap;
+
+    bool isOpen(const House& house) {
+        return house.getAvailability() && !house.getBookingStatus();
+    }
+
+    // Rebuild the trigram indexes of a town
+    void indexText(TownPartition& partition) {
+        std::shared_ptr<TownText> text = std::make_shared<TownText>();
+        for (size_t i = 0; i < partition.houses.size(); ++i) {
+            text->types.add(static_cast<unsigned int>(i), partition.houses[i].getType());
+            text->addresses.add(static_cast<unsigned int>(i), partition.houses[i].getAddress());
+        }
+        partition.text = text;
+    }
+
+    // List the open houses of a town, cheapest first (load order among equal rents)
+    void sortByRent(TownPartition& partition) {
+        const std::vector<House>& houses = partition.houses;
+        partition.openByRent.clear();
+        for (size_t i = 0; i < houses.size(); ++i) {
+            if (isOpen(houses[i])) {
+                partition.openByRent.push_back(i);
+            }
+        }
+        std::stable_sort(partition.openByRent.begin(), partition.openByRent.end(), [&houses](size_t a, size_t b) {
+            return houses[a].getMonthlyRent() < houses[b].getMonthlyRent();
+        });
+    }
+
+    // Rebuild every search index of a town
+    void indexTown(TownPartition& partition) {
+        partition.catalog.clear();
+        partition.catalog.reserve(partition.houses.size());
+        for (size_t i = 0; i < partition.houses.size(); ++i) {
+            partition.catalog.append(partition.houses[i]);
+        }
+        indexText(partition);
+        sortByRent(partition);
+    }
+
+    // Take a house out of a town, moving the positions of the houses after it
+    void removeHouse(TownPartition& partition, size_t index, PositionMap& positions) {
+        partition.houses.erase(partition.houses.begin() + index);
+        for (size_t i = index; i < partition.houses.size(); ++i) {
+            positions[partition.houses[i].getId()].index = i;
+        }
+    }
+
+    // A town copied into the next version by a batch, and how its indexes must change
+    struct TownChange {
+        std::shared_ptr<TownPartition> partition;
+        size_t firstAdded;     // Houses from here on were appended by the batch
+        bool textChanged;      // A house before firstAdded got a new type or address
+        bool removed;          // A house moved away, so later houses moved up a row
+    };
+}
+
+CatalogSnapshot::CatalogSnapshot() : versionNumber(0), positions(std::make_shared<PositionMap>()) {}
+
+size_t CatalogSnapshot::partitionIndex(int townId) const {
+    size_t low = 0;
+    size_t high = partitions.size();
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (partitions[mid]->townId < townId) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < partitions.size() && partitions[low]->townId == townId) {
+        return low;
+    }
+    return partitions.size();
+}
+
+const std::vector<House>& CatalogSnapshot::town(int townId) const {
+    static const std::vector<House> none;
+
+    size_t index = partitionIndex(townId);
+    if (index == partitions.size()) {
+        return none;
+    }
+    return partitions[index]->houses;
+}
+
+const CatalogSnapshot::TownPartition* CatalogSnapshot::townPartition(int townId) const {
+    size_t index = partitionIndex(townId);
+    return index == partitions.size() ? nullptr : partitions[index].get();
+}
+
+const House* CatalogSnapshot::findHouse(const std::string& houseId) const {
+    PositionMap::const_iterator position = positions->find(houseId);
+    if (position == positions->end()) {
+        return nullptr;
+    }
+    return &partitions[partitionIndex(position->second.townId)]->houses[position->second.index];
+}
+
+SnapshotCatalog::ReadGuard::ReadGuard(EpochManager* epochs, int slot, const CatalogSnapshot* snapshot)
+    : epochs(epochs), slot(slot), snapshot(snapshot) {}
+
+SnapshotCatalog::ReadGuard::ReadGuard(ReadGuard&& other)
+    : epochs(other.epochs), slot(other.slot), snapshot(other.snapshot) {
+    other.epochs = nullptr;
+}
+
+SnapshotCatalog::ReadGuard::~ReadGuard() {
+    if (epochs) {
+        epochs->unpin(slot);
+    }
+}
+
+SnapshotCatalog::SnapshotCatalog() : current(new CatalogSnapshot()) {}
+
+SnapshotCatalog::~SnapshotCatalog() {
+    delete current.load();
+}
+
+SnapshotCatalog::ReadGuard SnapshotCatalog::read() const {
+    // Pin before loading: whatever we load is not freed until we unpin
+    int slot = epochs.pin();
+    return ReadGuard(&epochs, slot, current.load());
+}
+
+unsigned long long SnapshotCatalog::version() const {
+    ReadGuard guard = read();
+    return guard->version();
+}
+
+void SnapshotCatalog::swapIn(CatalogSnapshot* next) {
+    const CatalogSnapshot* old = current.exchange(next);
+    epochs.retire([old]() { delete old; });
+}
+
+void SnapshotCatalog::publish(const std::vector<House>& houses) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    std::map<int, std::shared_ptr<TownPartition> > towns;
+    std::shared_ptr<PositionMap> positions = std::make_shared<PositionMap>();
+    positions->reserve(houses.size());
+
+    for (size_t i = 0; i < houses.size(); ++i) {
+        const House& house = houses[i];
+        int townId = house.getLocationId();
+
+        std::shared_ptr<TownPartition>& partition = towns[townId];
+        if (!partition) {
+            partition = std::make_shared<TownPartition>();
+            partition->townId = townId;
+        }
+
+        // A repeated ID replaces the earlier house, as in EntityStore
+        PositionMap::iterator known = positions->find(house.getId());
+        if (known != positions->end() && known->second.townId == townId) {
+            partition->houses[known->second.index] = house;
+            continue;
+        }
+        if (known != positions->end()) {
+            removeHouse(*towns[known->second.townId], known->second.index, *positions);
+        }
+        CatalogSnapshot::Position position = { townId, partition->houses.size() };
+        (*positions)[house.getId()] = position;
+        partition->houses.push_back(house);
+    }
+
+    CatalogSnapshot* next = new CatalogSnapshot();
+    next->versionNumber = current.load()->versionNumber + 1;
+    for (std::map<int, std::shared_ptr<TownPartition> >::iterator it = towns.begin(); it != towns.end(); ++it) {
+        if (!it->second->houses.empty()) {
+            indexTown(*it->second);
+            next->partitions.push_back(it->second);
+        }
+    }
+    next->positions = positions;
+    swapIn(next);
+}
+
+void SnapshotCatalog::putHouse(const House& house) {
+    putHouses(std::vector<House>(1, house));
+}
+
+void SnapshotCatalog::putHouses(const std::vector<House>& batch) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    // Only writers change current, and we hold the writer lock
+    const CatalogSnapshot* old = current.load();
+    CatalogSnapshot* next = new CatalogSnapshot(*old);
+    next->versionNumber = old->versionNumber + 1;
+
+    std::shared_ptr<PositionMap> positions;   // Copied on the first house added or moved
+    std::map<int, TownChange> changes;
+
+    // Copy a town into the next version once, or start it
+    auto changeFor = [next, &changes](int townId) -> TownChange& {
+        std::map<int, TownChange>::iterator found = changes.find(townId);
+        if (found != changes.end()) {
+            return found->second;
+        }
+        TownChange change;
+        size_t index = next->partitionIndex(townId);
+        if (index != next->partitions.size()) {
+            change.partition = std::make_shared<TownPartition>(*next->partitions[index]);
+            next->partitions[index] = change.partition;
+        } else {
+            change.partition = std::make_shared<TownPartition>();
+            change.partition->townId = townId;
+            std::vector<CatalogSnapshot::PartitionPtr>::iterator at = next->partitions.begin();
+            while (at != next->partitions.end() && (*at)->townId < townId) {
+                ++at;
+            }
+            next->partitions.insert(at, change.partition);
+        }
+        change.firstAdded = change.partition->houses.size();
+        change.textChanged = false;
+        change.removed = false;
+        return changes[townId] = change;
+    };
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const House& house = batch[i];
+        const std::string& houseId = house.getId();
+        int townId = house.getLocationId();
+        const PositionMap& knownPositions = positions ? *positions : *old->positions;
+        PositionMap::const_iterator known = knownPositions.find(houseId);
+
+        // Replaced in its own town: positions stay as they are
+        if (known != knownPositions.end() && known->second.townId == townId) {
+            TownChange& change = changeFor(townId);
+            TownPartition& partition = *change.partition;
+            size_t index = known->second.index;
+            if (index < change.firstAdded && (partition.houses[index].getType() != house.getType() ||
+                                              partition.houses[index].getAddress() != house.getAddress())) {
+                change.textChanged = true;
+            }
+            partition.houses[index] = house;
+            partition.catalog.update(index, house);
+            continue;
+        }
+
+        if (!positions) {
+            positions = std::make_shared<PositionMap>(*old->positions);
+        }
+
+        // Moved to another town: take it out of the old one
+        if (known != knownPositions.end()) {
+            TownChange& previous = changeFor(known->second.townId);
+            removeHouse(*previous.partition, known->second.index, *positions);
+            previous.removed = true;
+        }
+
+        TownChange& change = changeFor(townId);
+        CatalogSnapshot::Position position = { townId, change.partition->houses.size() };
+        (*positions)[houseId] = position;
+        change.partition->houses.push_back(house);
+        change.partition->catalog.append(house);
+    }
+
+    // Bring each copied town's indexes up to date once
+    for (std::map<int, TownChange>::iterator it = changes.begin(); it != changes.end(); ++it) {
+        TownChange& change = it->second;
+        TownPartition& partition = *change.partition;
+        if (partition.houses.empty()) {
+            next->partitions.erase(next->partitions.begin() + next->partitionIndex(it->first));
+            continue;
+        }
+        if (change.removed || partition.catalog.needsCompaction()) {
+            indexTown(partition);
+            continue;
+        }
+
+        // Status-only changes (the common case) keep sharing the text indexes
+        if (change.textChanged) {
+            indexText(partition);
+        } else if (partition.houses.size() > change.firstAdded) {
+            // Posting lists are append-only, so the new houses extend a copy
+            std::shared_ptr<TownText> text = partition.text ? std::make_shared<TownText>(*partition.text)
+                                                            : std::make_shared<TownText>();
+            for (size_t i = change.firstAdded; i < partition.houses.size(); ++i) {
+                text->types.add(static_cast<unsigned int>(i), partition.houses[i].getType());
+                text->addresses.add(static_cast<unsigned int>(i), partition.houses[i].getAddress());
+            }
+            partition.text = text;
+        }
+        sortByRent(partition);
+    }
+
+    if (positions) {
+        next->positions = positions;
+    }
+    swapIn(next);
+}
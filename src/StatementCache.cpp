@@ -0,0 +1,40 @@
+#include "include/StatementCache.h"
+
+StatementCache::StatementCache(MYSQL* conn) : conn(conn) {}
+
+StatementCache::~StatementCache() {
+    clear();
+}
+
+PreparedStatement* StatementCache::get(const std::string& sql) {
+    std::map<std::string, PreparedStatement*>::iterator it = statements.find(sql);
+    if (it != statements.end()) {
+        return it->second;
+    }
+
+    PreparedStatement* stmt = new PreparedStatement(conn, sql);
+    if (!stmt->prepare()) {
+        lastError = "Failed to prepare statement: " + stmt->getError();
+        delete stmt;
+        return nullptr;
+    }
+
+    statements[sql] = stmt;
+    return stmt;
+}
+
+void StatementCache::clear() {
+    for (std::map<std::string, PreparedStatement*>::iterator it = statements.begin();
+         it != statements.end(); ++it) {
+        delete it->second;
+    }
+    statements.clear();
+}
+
+size_t StatementCache::size() const {
+    return statements.size();
+}
+
+std::string StatementCache::getLastError() const {
+    return lastError;
+}
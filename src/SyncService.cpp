@@ -0,0 +1,139 @@
+#include "include/SyncService.h"
+#include <utility>
+#include <vector>
+
+SyncService::SyncService(DBConnector* db, int intervalMs, int lagSeconds)
+    : db(db), interval(intervalMs), lagSeconds(lagSeconds), watchedUser(0), stopping(false),
+      pollCount(0), failedPollCount(0), housePatchCount(0), bookingPatchCount(0) {}
+
+SyncService::~SyncService() {
+    stop();
+}
+
+bool SyncService::start() {
+    if (worker.joinable()) {
+        return true;
+    }
+
+    mark = db->getChangeMark(lagSeconds);
+    if (mark.empty()) {
+        return false;
+    }
+
+    stopping = false;
+    worker = std::thread(&SyncService::syncLoop, this);
+    return true;
+}
+
+void SyncService::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void SyncService::watchUser(int userId) {
+    watchedUser = userId;
+}
+
+void SyncService::syncLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (wake.wait_for(lock, interval, [this] { return stopping; })) {
+            break;
+        }
+
+        // Query without holding the lock, so applyPending never waits on the database
+        lock.unlock();
+        if (pollOnce()) {
+            ++pollCount;
+        } else {
+            ++failedPollCount;
+        }
+        lock.lock();
+    }
+}
+
+bool SyncService::pollOnce() {
+    // Taken first: anything changed while the queries run is picked up next time
+    std::string nextMark = db->getChangeMark(lagSeconds);
+    if (nextMark.empty()) {
+        return false;
+    }
+
+    std::vector<House> houses;
+    if (!db->loadHousesChangedSince(mark, houses)) {
+        return false;
+    }
+
+    // Every user's bookings: they all feed the availability calendar
+    std::vector<Booking> bookings;
+    if (!db->loadBookingsChangedSince(mark, bookings, -1)) {
+        return false;
+    }
+
+    {
+        // A later row for the same house or booking replaces an unapplied one
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < houses.size(); ++i) {
+            std::pair<std::unordered_map<std::string, House>::iterator, bool> added =
+                pendingHouses.insert(std::make_pair(houses[i].getId(), houses[i]));
+            if (!added.second) {
+                added.first->second = houses[i];
+            }
+        }
+        for (size_t i = 0; i < bookings.size(); ++i) {
+            std::pair<std::unordered_map<int, Booking>::iterator, bool> added =
+                pendingBookings.insert(std::make_pair(bookings[i].getId(), bookings[i]));
+            if (!added.second) {
+                added.first->second = bookings[i];
+            }
+        }
+    }
+
+    housePatchCount += houses.size();
+    bookingPatchCount += bookings.size();
+    mark = nextMark;
+    return true;
+}
+
+size_t SyncService::applyPending(EntityStore& store) {
+    std::unordered_map<std::string, House> houses;
+    std::unordered_map<int, Booking> bookings;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        houses.swap(pendingHouses);
+        bookings.swap(pendingBookings);
+    }
+
+    // One batch, so the store rebuilds its indexes at most once per sync
+    std::vector<House> batch;
+    batch.reserve(houses.size());
+    for (std::unordered_map<std::string, House>::const_iterator it = houses.begin(); it != houses.end(); ++it) {
+        batch.push_back(it->second);
+    }
+    store.addHouses(batch);
+    int userId = watchedUser;
+    for (std::unordered_map<int, Booking>::const_iterator it = bookings.begin(); it != bookings.end(); ++it) {
+        if (userId > 0 && it->second.getUserId() == userId) {
+            store.putBooking(it->second);
+        } else {
+            store.scheduleBooking(it->second);
+        }
+    }
+    return houses.size() + bookings.size();
+}
+
+SyncService::Stats SyncService::getStats() const {
+    Stats stats;
+    stats.polls = pollCount;
+    stats.failedPolls = failedPollCount;
+    stats.housePatches = housePatchCount;
+    stats.bookingPatches = bookingPatchCount;
+    return stats;
+}
@@ -0,0 +1,75 @@
+#include "include/TimerWheel.h"
+
+TimerWheel::TimerWheel(long long start) : current(start), timerCount(0) {}
+
+void TimerWheel::place(const Timer& timer) {
+    if (timer.due < current) {
+        overdue.push_back(timer);
+        return;
+    }
+    long long due = timer.due;
+    long long delta = due - current;
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1LL << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+
+    // Beyond the last level: park one full span ahead; it is placed again when it comes down
+    if (delta >= (1LL << (SLOT_BITS * LEVELS))) {
+        due = current + (1LL << (SLOT_BITS * LEVELS)) - 1;
+    }
+    slots[level][(due >> (SLOT_BITS * level)) & SLOT_MASK].push_back(timer);
+}
+
+int TimerWheel::cascade(int level) {
+    int index = static_cast<int>((current >> (SLOT_BITS * level)) & SLOT_MASK);
+
+    // Swap out first: the timers may land back in this same level
+    std::vector<Timer> moving;
+    moving.swap(slots[level][index]);
+    for (size_t i = 0; i < moving.size(); ++i) {
+        place(moving[i]);
+    }
+    return index;
+}
+
+void TimerWheel::schedule(int id, long long due) {
+    Timer timer;
+    timer.due = due;
+    timer.id = id;
+    place(timer);
+    ++timerCount;
+}
+
+void TimerWheel::advance(long long now, std::vector<Timer>& fired) {
+    fired.insert(fired.end(), overdue.begin(), overdue.end());
+    timerCount -= overdue.size();
+    overdue.clear();
+
+    while (current <= now) {
+        // Nothing pending: no slot can fire, so jump straight to now
+        if (timerCount == 0) {
+            current = now + 1;
+            return;
+        }
+
+        // Level 0 wrapped: refill it from level 1, and level 1 from level 2 when that wraps too
+        if ((current & SLOT_MASK) == 0) {
+            for (int level = 1; level < LEVELS && cascade(level) == 0; ++level) {
+            }
+        }
+
+        std::vector<Timer> due;
+        due.swap(slots[0][current & SLOT_MASK]);
+        for (size_t i = 0; i < due.size(); ++i) {
+            if (due[i].due > current) {
+                place(due[i]);          // Parked beyond the span
+            } else {
+                fired.push_back(due[i]);
+                --timerCount;
+            }
+        }
+        ++current;
+    }
+}
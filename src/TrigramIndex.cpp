@@ -0,0 +1,147 @@
+#include "include/TrigramIndex.h"
+#include "include/Utils.h"
+#include <algorithm>
+
+namespace {
+    unsigned int packTrigram(const std::string& text, size_t offset) {
+        return (static_cast<unsigned int>(static_cast<unsigned char>(text[offset])) << 16) |
+               (static_cast<unsigned int>(static_cast<unsigned char>(text[offset + 1])) << 8) |
+               static_cast<unsigned int>(static_cast<unsigned char>(text[offset + 2]));
+    }
+
+    // Reads one varint; returns the position after it
+    const unsigned char* readVarint(const unsigned char* in, unsigned int& value) {
+        value = 0;
+        int shift = 0;
+        while (*in & 0x80) {
+            value |= static_cast<unsigned int>(*in++ & 0x7F) << shift;
+            shift += 7;
+        }
+        value |= static_cast<unsigned int>(*in++) << shift;
+        return in;
+    }
+
+    bool fewerDocs(const std::pair<size_t, const void*>& a, const std::pair<size_t, const void*>& b) {
+        return a.first < b.first;
+    }
+}
+
+TrigramIndex::TrigramIndex() : documentCount(0) {}
+
+void TrigramIndex::clear() {
+    postings.clear();
+    documentCount = 0;
+}
+
+void TrigramIndex::append(PostingList& list, unsigned int docId) {
+    // The first entry stores docId + 1 so that document 0 still has a gap
+    unsigned int gap = list.count == 0 ? docId + 1 : docId - list.lastDoc;
+    while (gap >= 0x80) {
+        list.bytes.push_back(static_cast<unsigned char>(gap | 0x80));
+        gap >>= 7;
+    }
+    list.bytes.push_back(static_cast<unsigned char>(gap));
+    list.lastDoc = docId;
+    ++list.count;
+}
+
+void TrigramIndex::decode(const PostingList& list, std::vector<unsigned int>& docs) {
+    docs.clear();
+    docs.reserve(list.count);
+
+    const unsigned char* in = list.bytes.data();
+    unsigned int doc = 0;
+    for (unsigned int i = 0; i < list.count; ++i) {
+        unsigned int gap;
+        in = readVarint(in, gap);
+        doc = i == 0 ? gap - 1 : doc + gap;
+        docs.push_back(doc);
+    }
+}
+
+void TrigramIndex::intersect(std::vector<unsigned int>& docs, const PostingList& list) {
+    // Merge the decoded candidates with the list as it is decoded; stop as
+    // soon as either side runs out
+    const unsigned char* in = list.bytes.data();
+    unsigned int doc = 0;
+    unsigned int read = 0;
+    size_t kept = 0;
+
+    for (size_t i = 0; i < docs.size() && read < list.count; ) {
+        if (read == 0 || doc < docs[i]) {
+            unsigned int gap;
+            in = readVarint(in, gap);
+            doc = read == 0 ? gap - 1 : doc + gap;
+            ++read;
+        }
+        while (i < docs.size() && docs[i] < doc) {
+            ++i;
+        }
+        if (i < docs.size() && docs[i] == doc) {
+            docs[kept++] = doc;
+            ++i;
+        }
+    }
+    docs.resize(kept);
+}
+
+void TrigramIndex::trigramsOf(const std::string& folded, std::vector<unsigned int>& trigrams) {
+    trigrams.clear();
+    for (size_t i = 0; i + 3 <= folded.length(); ++i) {
+        trigrams.push_back(packTrigram(folded, i));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+void TrigramIndex::add(unsigned int docId, const std::string& text) {
+    std::vector<unsigned int> trigrams;
+    trigramsOf(toLowerCase(text), trigrams);
+
+    for (size_t i = 0; i < trigrams.size(); ++i) {
+        std::unordered_map<unsigned int, PostingList>::iterator it = postings.find(trigrams[i]);
+        if (it == postings.end()) {
+            PostingList list;
+            list.lastDoc = 0;
+            list.count = 0;
+            it = postings.insert(std::make_pair(trigrams[i], list)).first;
+        }
+        append(it->second, docId);
+    }
+    ++documentCount;
+}
+
+bool TrigramIndex::candidates(const std::string& pattern, std::vector<unsigned int>& docs) const {
+    docs.clear();
+    if (!indexable(pattern)) {
+        return false;
+    }
+
+    std::vector<unsigned int> trigrams;
+    trigramsOf(toLowerCase(pattern), trigrams);
+
+    // Shortest list first, so the candidate set starts as small as possible
+    std::vector<std::pair<size_t, const void*> > lists;
+    for (size_t i = 0; i < trigrams.size(); ++i) {
+        std::unordered_map<unsigned int, PostingList>::const_iterator it = postings.find(trigrams[i]);
+        if (it == postings.end()) {
+            return true;  // A trigram no document has: no candidates
+        }
+        lists.push_back(std::make_pair(static_cast<size_t>(it->second.count), static_cast<const void*>(&it->second)));
+    }
+    std::sort(lists.begin(), lists.end(), fewerDocs);
+
+    decode(*static_cast<const PostingList*>(lists[0].second), docs);
+    for (size_t i = 1; i < lists.size() && !docs.empty(); ++i) {
+        intersect(docs, *static_cast<const PostingList*>(lists[i].second));
+    }
+    return true;
+}
+
+size_t TrigramIndex::postingBytes() const {
+    size_t bytes = 0;
+    for (std::unordered_map<unsigned int, PostingList>::const_iterator it = postings.begin(); it != postings.end(); ++it) {
+        bytes += it->second.bytes.size();
+    }
+    return bytes;
+}
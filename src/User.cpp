@@ -3,11 +3,11 @@
 #include <iostream>
 #include <limits>
 
-User::User() : isLoggedIn(false) {}
+User::User() : id(0), isLoggedIn(false) {}
 
 User::User(const std::string& name, const std::string& phone, 
            const std::string& email, const std::string& password)
-    : name(name), phone(phone), email(email), 
+    : id(0), name(name), phone(phone), email(email), 
       password(hashPassword(password)), isLoggedIn(false) {}
 
 bool User::registerUser() {
@@ -61,6 +61,10 @@ bool User::isAuthenticated() const {
     return isLoggedIn;
 }
 
+int User::getId() const {
+    return id;
+}
+
 std::string User::getName() const {
     return name;
 }
@@ -77,6 +81,10 @@ std::string User::getPhone() const {
     return phone;
 }
 
+void User::setId(int id) {
+    this->id = id;
+}
+
 void User::setName(const std::string& name) {
     this->name = name;
 }
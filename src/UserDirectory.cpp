@@ -0,0 +1,44 @@
+#include "include/UserDirectory.h"
+#include "include/Utils.h"
+
+UserDirectory::UserDirectory(size_t capacity)
+    : capacity(capacity > 0 ? capacity : 1) {}
+
+User* UserDirectory::find(const std::string& email) {
+    std::unordered_map<std::string, UserList::iterator>::iterator it = byEmail.find(toLowerCase(email));
+    if (it == byEmail.end()) {
+        return nullptr;
+    }
+
+    // Move to the front without copying the user
+    entries.splice(entries.begin(), entries, it->second);
+    return &*it->second;
+}
+
+User* UserDirectory::put(const User& user) {
+    std::string key = toLowerCase(user.getEmail());
+
+    std::unordered_map<std::string, UserList::iterator>::iterator it = byEmail.find(key);
+    if (it != byEmail.end()) {
+        *it->second = user;
+        entries.splice(entries.begin(), entries, it->second);
+        return &*it->second;
+    }
+
+    if (entries.size() >= capacity) {
+        byEmail.erase(toLowerCase(entries.back().getEmail()));
+        entries.pop_back();
+    }
+
+    entries.push_front(user);
+    byEmail[key] = entries.begin();
+    return &entries.front();
+}
+
+void UserDirectory::remove(const std::string& email) {
+    std::unordered_map<std::string, UserList::iterator>::iterator it = byEmail.find(toLowerCase(email));
+    if (it != byEmail.end()) {
+        entries.erase(it->second);
+        byEmail.erase(it);
+    }
+}
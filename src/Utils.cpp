@@ -3,7 +3,10 @@
 #include <ctime>
 #include <iomanip>
 #include <sstream>
+#include <cstdio>
 #include <functional> // for std::hash
+#include <atomic>
+#include <algorithm>
 #include <openssl/sha.h>
 
 std::string getCurrentDateTime() {
@@ -15,12 +18,32 @@ std::string getCurrentDateTime() {
     return ss.str();
 }
 
+bool parseDateTime(const std::string& text, long long& seconds) {
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    int matched = std::sscanf(text.c_str(), "%4d-%2d-%2d %2d:%2d:%2d", &year, &month, &day, &hour, &minute, &second);
+    if ((matched != 3 && matched != 6) || month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    // Days since the epoch in the proleptic Gregorian calendar (March-based year)
+    long long y = year - (month <= 2 ? 1 : 0);
+    long long era = (y >= 0 ? y : y - 399) / 400;
+    long long yearOfEra = y - era * 400;
+    long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    long long days = era * 146097 + dayOfEra - 719468;
+
+    seconds = days * 86400 + hour * 3600 + minute * 60 + second;
+    return true;
+}
+
 std::string generateReceiptNumber() {
-    static int receiptCounter = 1000;
-    receiptCounter++;
+    // Payments may be recorded from several threads
+    static std::atomic<int> receiptCounter(1000);
     
     std::stringstream ss;
-    ss << "RCP" << receiptCounter;
+    ss << "RCP" << ++receiptCounter;
     return ss.str();
 }
 
@@ -57,3 +80,19 @@ bool equalsIgnoreCase(const std::string& str1, const std::string& str2) {
     
     return true;
 }
+
+std::string toLowerCase(const std::string& str) {
+    std::string lower(str);
+    for (size_t i = 0; i < lower.size(); ++i) {
+        lower[i] = static_cast<char>(tolower(static_cast<unsigned char>(lower[i])));
+    }
+    return lower;
+}
+
+bool containsIgnoreCase(const std::string& text, const std::string& pattern) {
+    std::string::const_iterator found = std::search(text.begin(), text.end(), pattern.begin(), pattern.end(),
+        [](char a, char b) {
+            return tolower(static_cast<unsigned char>(a)) == tolower(static_cast<unsigned char>(b));
+        });
+    return pattern.empty() || found != text.end();
+}
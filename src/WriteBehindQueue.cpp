@@ -0,0 +1,238 @@
+#include "include/WriteBehindQueue.h"
+
+WriteBehindQueue::WriteBehindQueue(DBConnector* db, size_t maxBatch, int maxLingerMs)
+    : db(db), maxBatch(maxBatch ? maxBatch : 1), maxLinger(maxLingerMs),
+      writerSleeping(false), accepting(false), enqueuing(0), stopping(false),
+      bookingCount(0), paymentCount(0), commitCount(0), failedBatchCount(0), largestBatch(0) {}
+
+WriteBehindQueue::~WriteBehindQueue() {
+    shutdown();
+}
+
+void WriteBehindQueue::start() {
+    if (writer.joinable()) {
+        return;
+    }
+    stopping = false;
+    accepting = true;
+    writer = std::thread(&WriteBehindQueue::writerLoop, this);
+}
+
+void WriteBehindQueue::shutdown() {
+    accepting = false;
+    if (!writer.joinable()) {
+        return;
+    }
+    stopping = true;
+    notifyWriter();
+    writer.join();
+
+    // Pairs with enqueue: a producer either saw accepting cleared or is
+    // counted here, so once the count drops to zero nothing more is pushed
+    while (enqueuing.load() != 0) {
+        std::this_thread::yield();
+    }
+    failLeftovers();
+}
+
+void WriteBehindQueue::failLeftovers() {
+    DBConnector::BookingResult failed;
+    failed.status = DBConnector::BOOKING_FAILED;
+    failed.bookingId = -1;
+
+    BookingIntent booking;
+    while (bookingQueue.pop(booking)) {
+        booking.result.set_value(failed);
+    }
+    PaymentIntent payment;
+    while (paymentQueue.pop(payment)) {
+        payment.receipt.set_value("");
+    }
+}
+
+std::future<DBConnector::BookingResult> WriteBehindQueue::enqueueBooking(int userId, const std::string& houseId,
+                                                                        int townId) {
+    BookingIntent intent;
+    intent.request.userId = userId;
+    intent.request.houseId = houseId;
+    intent.request.townId = townId;
+    std::future<DBConnector::BookingResult> result = intent.result.get_future();
+
+    ++enqueuing;
+    if (!accepting) {
+        --enqueuing;
+        DBConnector::BookingResult failed;
+        failed.status = DBConnector::BOOKING_FAILED;
+        failed.bookingId = -1;
+        intent.result.set_value(failed);
+        return result;
+    }
+
+    bookingQueue.push(std::move(intent));
+    --enqueuing;
+    notifyWriter();
+    return result;
+}
+
+std::future<std::string> WriteBehindQueue::enqueuePayment(int userId, int bookingId, double amount,
+                                                          const std::string& paymentMethod) {
+    PaymentIntent intent;
+    intent.request.userId = userId;
+    intent.request.bookingId = bookingId;
+    intent.request.amount = amount;
+    intent.request.paymentMethod = paymentMethod;
+    std::future<std::string> receipt = intent.receipt.get_future();
+
+    ++enqueuing;
+    if (!accepting) {
+        --enqueuing;
+        intent.receipt.set_value("");
+        return receipt;
+    }
+
+    paymentQueue.push(std::move(intent));
+    --enqueuing;
+    notifyWriter();
+    return receipt;
+}
+
+WriteBehindQueue::Stats WriteBehindQueue::getStats() const {
+    Stats stats;
+    stats.bookings = bookingCount;
+    stats.payments = paymentCount;
+    stats.commits = commitCount;
+    stats.failedBatches = failedBatchCount;
+    stats.largestBatch = largestBatch;
+    return stats;
+}
+
+void WriteBehindQueue::notifyWriter() {
+    // Pairs with the fence in waitForWork: either the writer sees the new
+    // item before sleeping, or we see it sleeping and wake it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (writerSleeping.load(std::memory_order_relaxed) || stopping) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wake.notify_one();
+    }
+}
+
+bool WriteBehindQueue::queuesEmpty() const {
+    return bookingQueue.empty() && paymentQueue.empty();
+}
+
+void WriteBehindQueue::waitForWork(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    writerSleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (queuesEmpty() && !stopping) {
+        wake.wait_until(lock, deadline);
+    }
+    writerSleeping.store(false, std::memory_order_relaxed);
+}
+
+void WriteBehindQueue::writerLoop() {
+    // Upper bound on an idle sleep, in case a wakeup is ever missed
+    const std::chrono::milliseconds idlePoll(100);
+
+    std::vector<BookingIntent> bookings;
+    std::vector<PaymentIntent> payments;
+    bookings.reserve(maxBatch);
+    payments.reserve(maxBatch);
+    BookingIntent booking;
+    PaymentIntent payment;
+
+    while (true) {
+        if (queuesEmpty()) {
+            if (stopping) {
+                break;
+            }
+            waitForWork(std::chrono::steady_clock::now() + idlePoll);
+            continue;
+        }
+
+        // Collect until the batch is full or its first intent has lingered long enough
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + maxLinger;
+        while (true) {
+            while (bookings.size() < maxBatch && bookingQueue.pop(booking)) {
+                bookings.push_back(std::move(booking));
+            }
+            while (payments.size() < maxBatch && paymentQueue.pop(payment)) {
+                payments.push_back(std::move(payment));
+            }
+
+            if (bookings.size() >= maxBatch || payments.size() >= maxBatch || stopping ||
+                std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+            waitForWork(deadline);
+        }
+
+        flushBookings(bookings);
+        flushPayments(payments);
+    }
+}
+
+void WriteBehindQueue::flushBookings(std::vector<BookingIntent>& batch) {
+    if (batch.empty()) {
+        return;
+    }
+
+    std::vector<DBConnector::BookingRequest> requests;
+    requests.reserve(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        requests.push_back(batch[i].request);
+    }
+
+    std::vector<DBConnector::BookingResult> results;
+    if (db->bookHouses(requests, results)) {
+        ++commitCount;
+    } else if (batch.size() > 1) {
+        ++failedBatchCount;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            results[i] = db->bookHouse(requests[i].userId, requests[i].houseId, requests[i].townId);
+        }
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        batch[i].result.set_value(results[i]);
+    }
+
+    bookingCount += batch.size();
+    if (batch.size() > largestBatch) {
+        largestBatch = batch.size();
+    }
+    batch.clear();
+}
+
+void WriteBehindQueue::flushPayments(std::vector<PaymentIntent>& batch) {
+    if (batch.empty()) {
+        return;
+    }
+
+    std::vector<DBConnector::PaymentRequest> requests;
+    requests.reserve(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        requests.push_back(batch[i].request);
+    }
+
+    std::vector<std::string> receipts;
+    if (db->recordPayments(requests, receipts)) {
+        ++commitCount;
+    } else if (batch.size() > 1) {
+        ++failedBatchCount;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            receipts[i] = db->recordPayment(requests[i].userId, requests[i].bookingId, requests[i].amount,
+                                            requests[i].paymentMethod);
+        }
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        batch[i].receipt.set_value(receipts[i]);
+    }
+
+    paymentCount += batch.size();
+    if (batch.size() > largestBatch) {
+        largestBatch = batch.size();
+    }
+    batch.clear();
+}
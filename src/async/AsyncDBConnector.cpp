@@ -0,0 +1,336 @@
+#include "../include/async/AsyncDBConnector.h"
+#include "../include/RowDecoder.h"
+#include "../include/Utils.h"
+#include <mysql/errmsg.h>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+    // Same columns as the DBConnector statements, so RowDecoder can decode them
+    const std::string SQL_LOAD_HOUSES =
+        "SELECT h.house_id, h.house_type, h.town_id, "
+        "h.house_address, h.map_link, h.deposit_fee, h.monthly_rent, "
+        "h.is_available, h.is_booked, h.booked_until, h.latitude, h.longitude "
+        "FROM houses h WHERE h.town_id = ";
+    const std::string SQL_SEARCH_HOUSES =
+        "SELECT h.house_id, h.house_type, rc.deposit, rc.monthly_rent, h.town_id, "
+        "CONCAT(t.town_name, ' Area, House #', h.house_id) as address, "
+        "CONCAT('https://maps.google.com/?q=', t.town_name) as map_link "
+        "FROM houses h "
+        "JOIN rental_cost rc ON h.house_id = rc.house_id AND h.town_id = rc.town_id "
+        "JOIN town t ON h.town_id = t.town_id "
+        "WHERE 1=1";
+
+    std::string number(double value) {
+        std::ostringstream text;
+        text.precision(17);
+        text << value;
+        return text.str();
+    }
+}
+
+bool AsyncDBConnector::ConnectionAwaiter::await_ready() {
+    if (db->idle.empty()) {
+        return false;
+    }
+    connection = db->idle.back();
+    db->idle.pop_back();
+    return true;
+}
+
+void AsyncDBConnector::ConnectionAwaiter::await_suspend(std::coroutine_handle<> caller) {
+    waiting = caller;
+    db->waiters.push_back(this);
+}
+
+AsyncDBConnector::AsyncDBConnector(Reactor& reactor)
+    : reactor(reactor), inFlight(0), peakInFlight(0) {}
+
+AsyncDBConnector::~AsyncDBConnector() {
+    disconnect();
+}
+
+MYSQL* AsyncDBConnector::openConnection() {
+    MYSQL* mysql = mysql_init(nullptr);
+    if (!mysql) {
+        lastError = "MySQL initialization failed";
+        return nullptr;
+    }
+
+    // CLIENT_MULTI_RESULTS for CALL book_house
+    if (!mysql_real_connect(mysql, host.c_str(), user.c_str(), password.c_str(),
+                            database.c_str(), 0, nullptr, CLIENT_MULTI_RESULTS)) {
+        lastError = mysql_error(mysql);
+        mysql_close(mysql);
+        return nullptr;
+    }
+    return mysql;
+}
+
+bool AsyncDBConnector::connect(const std::string& host, const std::string& user,
+                               const std::string& password, const std::string& db,
+                               size_t connectionCount) {
+    disconnect();
+    this->host = host;
+    this->user = user;
+    this->password = password;
+    this->database = db;
+
+    for (size_t i = 0; i < connectionCount; ++i) {
+        MYSQL* mysql = openConnection();
+        if (!mysql) {
+            disconnect();
+            return false;
+        }
+        connections.push_back(mysql);
+        idle.push_back(mysql);
+    }
+    return !connections.empty();
+}
+
+void AsyncDBConnector::disconnect() {
+    for (size_t i = 0; i < connections.size(); ++i) {
+        mysql_close(connections[i]);
+    }
+    connections.clear();
+    idle.clear();
+}
+
+std::string AsyncDBConnector::getLastError() const {
+    return lastError;
+}
+
+size_t AsyncDBConnector::getPeakInFlight() const {
+    return peakInFlight;
+}
+
+void AsyncDBConnector::setError(MYSQL* mysql, const std::string& context) {
+    lastError = context + ": " + mysql_error(mysql);
+}
+
+void AsyncDBConnector::release(MYSQL* connection) {
+    // A lost connection is replaced before anyone else gets it; this is the
+    // only place the async connector blocks, and only after a failure
+    unsigned int errorCode = mysql_errno(connection);
+    if (errorCode == CR_SERVER_GONE_ERROR || errorCode == CR_SERVER_LOST) {
+        MYSQL* fresh = openConnection();
+        if (fresh) {
+            for (size_t i = 0; i < connections.size(); ++i) {
+                if (connections[i] == connection) {
+                    connections[i] = fresh;
+                }
+            }
+            mysql_close(connection);
+            connection = fresh;
+        }
+    }
+
+    if (waiters.empty()) {
+        idle.push_back(connection);
+        return;
+    }
+
+    // Resume the waiter from the loop rather than from inside this coroutine
+    ConnectionAwaiter* next = waiters.front();
+    waiters.pop_front();
+    next->connection = connection;
+    reactor.post(next->waiting);
+}
+
+std::string AsyncDBConnector::quote(MYSQL* mysql, const std::string& value) const {
+    std::vector<char> escaped(value.length() * 2 + 1);
+    unsigned long length = mysql_real_escape_string(mysql, &escaped[0], value.c_str(), value.length());
+    return "'" + std::string(&escaped[0], length) + "'";
+}
+
+Task<bool> AsyncDBConnector::query(MYSQL* mysql, const std::string& sql) {
+    if (++inFlight > peakInFlight) {
+        peakInFlight = inFlight;
+    }
+
+    net_async_status status;
+    while ((status = mysql_real_query_nonblocking(mysql, sql.c_str(), sql.length())) == NET_ASYNC_NOT_READY) {
+        co_await reactor.readable(mysql->net.fd);
+    }
+
+    --inFlight;
+    if (status == NET_ASYNC_ERROR) {
+        setError(mysql, "MySQL query error");
+        co_return false;
+    }
+    co_return true;
+}
+
+Task<MYSQL_RES*> AsyncDBConnector::storeResult(MYSQL* mysql) {
+    MYSQL_RES* result = nullptr;
+    net_async_status status;
+    while ((status = mysql_store_result_nonblocking(mysql, &result)) == NET_ASYNC_NOT_READY) {
+        co_await reactor.readable(mysql->net.fd);
+    }
+
+    if (status == NET_ASYNC_ERROR || (!result && mysql_errno(mysql))) {
+        setError(mysql, "MySQL result error");
+        co_return nullptr;
+    }
+    co_return result;
+}
+
+Task<bool> AsyncDBConnector::drainResults(MYSQL* mysql) {
+    while (true) {
+        net_async_status status;
+        while ((status = mysql_next_result_nonblocking(mysql)) == NET_ASYNC_NOT_READY) {
+            co_await reactor.readable(mysql->net.fd);
+        }
+
+        if (status == NET_ASYNC_COMPLETE_NO_MORE_RESULTS) {
+            co_return true;
+        }
+        if (status == NET_ASYNC_ERROR) {
+            setError(mysql, "MySQL result error");
+            co_return false;
+        }
+
+        MYSQL_RES* result = co_await storeResult(mysql);
+        if (result) {
+            mysql_free_result(result);
+        }
+    }
+}
+
+Task<std::vector<House> > AsyncDBConnector::queryHouses(const std::string& sql, House (*decode)(MYSQL_ROW)) {
+    std::vector<House> houses;
+    if (connections.empty()) {
+        lastError = "Not connected to database";
+        co_return houses;
+    }
+
+    Lease lease(this, co_await checkout());
+
+    if (!co_await query(lease.mysql(), sql)) {
+        co_return houses;
+    }
+
+    MYSQL_RES* result = co_await storeResult(lease.mysql());
+    if (!result) {
+        co_return houses;
+    }
+
+    // The result is fully buffered, so reading rows does no I/O
+    houses.reserve(mysql_num_rows(result));
+    MYSQL_ROW row;
+    while ((row = mysql_fetch_row(result))) {
+        houses.push_back(decode(row));
+    }
+    mysql_free_result(result);
+    co_return houses;
+}
+
+Task<std::vector<House> > AsyncDBConnector::loadHouses(int townId) {
+    co_return co_await queryHouses(SQL_LOAD_HOUSES + std::to_string(townId) + " ORDER BY h.house_id",
+                                   decodeHouseRow);
+}
+
+Task<std::vector<House> > AsyncDBConnector::searchHouses(std::string type, double minRent,
+                                                         double maxRent, int townId) {
+    if (connections.empty()) {
+        lastError = "Not connected to database";
+        co_return std::vector<House>();
+    }
+
+    // Any connection will do for escaping; it only reads the character set
+    std::string sql = SQL_SEARCH_HOUSES;
+    if (!type.empty()) {
+        sql += " AND h.house_type LIKE CONCAT('%', " + quote(connections[0], type) + ", '%')";
+    }
+    if (minRent > 0) {
+        sql += " AND rc.monthly_rent >= " + number(minRent);
+    }
+    if (maxRent > 0) {
+        sql += " AND rc.monthly_rent <= " + number(maxRent);
+    }
+    if (townId > 0) {
+        sql += " AND h.town_id = " + std::to_string(townId);
+    }
+
+    co_return co_await queryHouses(sql, decodeSearchRow);
+}
+
+Task<DBConnector::BookingResult> AsyncDBConnector::createBooking(int userId, std::string houseId, int townId) {
+    DBConnector::BookingResult booking;
+    booking.status = DBConnector::BOOKING_FAILED;
+    booking.bookingId = -1;
+    if (connections.empty()) {
+        lastError = "Not connected to database";
+        co_return booking;
+    }
+
+    Lease lease(this, co_await checkout());
+    MYSQL* mysql = lease.mysql();
+
+    std::string sql = "CALL book_house(" + std::to_string(userId) + ", " + quote(mysql, houseId) + ", " +
+                      std::to_string(townId) + ")";
+    if (!co_await query(mysql, sql)) {
+        co_return booking;
+    }
+
+    MYSQL_RES* result = co_await storeResult(mysql);
+    if (result) {
+        MYSQL_ROW row = mysql_fetch_row(result);
+        if (row && row[0]) {
+            int status = std::atoi(row[0]);
+            if (status >= DBConnector::BOOKING_CREATED && status <= DBConnector::BOOKING_FAILED) {
+                booking.status = static_cast<DBConnector::BookingStatus>(status);
+            }
+            booking.bookingId = row[1] ? std::atoi(row[1]) : -1;
+            booking.bookingDate = row[2] ? row[2] : "";
+            booking.expiryDate = row[3] ? row[3] : "";
+        } else {
+            lastError = "book_house returned no status row";
+        }
+        mysql_free_result(result);
+    }
+
+    // The CALL status result must be read before the connection is reused
+    co_await drainResults(mysql);
+    co_return booking;
+}
+
+Task<std::string> AsyncDBConnector::recordPayment(int userId, int bookingId, double amount, std::string paymentMethod) {
+    if (connections.empty()) {
+        lastError = "Not connected to database";
+        co_return std::string();
+    }
+    std::string receiptNumber = generateReceiptNumber();
+
+    Lease lease(this, co_await checkout());
+    MYSQL* mysql = lease.mysql();
+
+    // The claim and the payment are committed together or not at all
+    if (!co_await query(mysql, "START TRANSACTION")) {
+        co_return std::string();
+    }
+
+    // Changes the row only for the owner's unpaid booking
+    std::string claim = "UPDATE bookings SET is_paid = 1 WHERE booking_id = " + std::to_string(bookingId) +
+                        " AND user_id = " + std::to_string(userId) + " AND is_paid = 0";
+    bool claimed = co_await query(mysql, claim);
+    if (claimed && mysql_affected_rows(mysql) != 1) {
+        claimed = false;
+        lastError = "Booking " + std::to_string(bookingId) + " is not the user's or is already paid";
+    }
+    if (!claimed) {
+        co_await query(mysql, "ROLLBACK");
+        co_return std::string();
+    }
+
+    std::string insert = "INSERT INTO payments (booking_id, amount, payment_date, payment_method, receipt_number) "
+                         "VALUES (" + std::to_string(bookingId) + ", " + number(amount) + ", " +
+                         quote(mysql, getCurrentDateTime()) + ", " + quote(mysql, paymentMethod) + ", " +
+                         quote(mysql, receiptNumber) + ")";
+    bool ok = co_await query(mysql, insert) && co_await query(mysql, "COMMIT");
+    if (!ok) {
+        co_await query(mysql, "ROLLBACK");
+        co_return std::string();
+    }
+    co_return receiptNumber;
+}
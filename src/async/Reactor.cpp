@@ -0,0 +1,107 @@
+#include "../include/async/Reactor.h"
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+
+namespace {
+    // Fire-and-forget coroutine that owns a spawned task until it finishes
+    struct DetachedTask {
+        struct promise_type {
+            DetachedTask get_return_object() { return DetachedTask(); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    DetachedTask runDetached(Reactor* reactor, Task<void> task) {
+        co_await task;
+        reactor->taskFinished();
+    }
+
+    const int MAX_EVENTS = 64;
+}
+
+Reactor::Reactor() : epollFd(epoll_create1(EPOLL_CLOEXEC)), liveTasks(0), watchedFds(0) {
+    if (epollFd < 0) {
+        lastError = std::string("epoll_create1 failed: ") + std::strerror(errno);
+    }
+}
+
+Reactor::~Reactor() {
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+void Reactor::spawn(Task<void> task) {
+    ++liveTasks;
+    runDetached(this, std::move(task));
+}
+
+void Reactor::post(std::coroutine_handle<> waiting) {
+    ready.push_back(waiting);
+}
+
+void Reactor::taskFinished() {
+    --liveTasks;
+}
+
+std::string Reactor::getLastError() const {
+    return lastError;
+}
+
+void Reactor::watch(int fd, std::coroutine_handle<> waiting) {
+    // One-shot, so a descriptor is reported once per suspension
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.ptr = waiting.address();
+
+    if (epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event) == 0 ||
+        (errno == ENOENT && epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0)) {
+        ++watchedFds;
+        return;
+    }
+
+    // Resume straight away; the caller's next nonblocking call reports the error
+    lastError = std::string("epoll_ctl failed: ") + std::strerror(errno);
+    ready.push_back(waiting);
+}
+
+bool Reactor::run() {
+    epoll_event events[MAX_EVENTS];
+
+    while (liveTasks > 0) {
+        while (!ready.empty()) {
+            std::coroutine_handle<> next = ready.front();
+            ready.pop_front();
+            next.resume();
+        }
+
+        if (liveTasks == 0) {
+            break;
+        }
+        if (watchedFds == 0) {
+            lastError = "Tasks are suspended without waiting on a descriptor";
+            return false;
+        }
+
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            lastError = std::string("epoll_wait failed: ") + std::strerror(errno);
+            return false;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            --watchedFds;
+            std::coroutine_handle<>::from_address(events[i].data.ptr).resume();
+        }
+    }
+    return true;
+}
@@ -0,0 +1,112 @@
+#ifndef AVAILABILITY_CALENDAR_H
+#define AVAILABILITY_CALENDAR_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Booked date intervals of every house
+ *
+ * Each house keeps its bookings as half-open [start, end) intervals sorted
+ * by start, with a running maximum of the end times. Intervals that start
+ * before a window ends are a prefix of that order, and one of them reaches
+ * into the window exactly when the prefix's largest end does, so an
+ * overlap test is one binary search. This holds even if bookings of a
+ * house overlap each other.
+ *
+ * Times are seconds as returned by parseDateTime. Changes cost O(n) in
+ * the bookings of that one house, which are few.
+ */
+class AvailabilityCalendar {
+public:
+    /**
+     * @brief One booked interval
+     */
+    struct Interval {
+        long long start;
+        long long end;          // Exclusive
+        int bookingId;
+    };
+
+private:
+    struct HouseIntervals {
+        std::vector<Interval> intervals;    // Sorted by start
+        std::vector<long long> maxEnd;      // maxEnd[i] = largest end in intervals[0..i]
+    };
+
+    std::unordered_map<std::string, HouseIntervals> houses;
+    size_t intervalCount;
+
+    /**
+     * @brief Recompute the running maximum from a position onwards
+     */
+    static void refreshMaxEnd(HouseIntervals& house, size_t from);
+
+public:
+    /**
+     * @brief Constructor
+     */
+    AvailabilityCalendar();
+
+    /**
+     * @brief Remove all intervals
+     */
+    void clear();
+
+    /**
+     * @brief Add a booking, replacing an earlier interval with the same booking ID
+     * @param houseId House ID
+     * @param start Start time
+     * @param end End time (exclusive); ignored unless after start
+     * @param bookingId Booking ID
+     */
+    void add(const std::string& houseId, long long start, long long end, int bookingId);
+
+    /**
+     * @brief Remove a booking
+     * @param houseId House ID
+     * @param bookingId Booking ID
+     * @return true if it was found
+     */
+    bool remove(const std::string& houseId, int bookingId);
+
+    /**
+     * @brief Drop every interval that ended at or before a time
+     * @param time Cut-off time
+     * @return Number of intervals dropped
+     */
+    size_t pruneBefore(long long time);
+
+    /**
+     * @brief Check whether a house has no booking overlapping a window
+     * @param houseId House ID
+     * @param start Window start
+     * @param end Window end (exclusive)
+     * @return true if the house is free for the whole window
+     */
+    bool isFree(const std::string& houseId, long long start, long long end) const;
+
+    /**
+     * @brief Find when a house is next free for a given length of time
+     * @param houseId House ID
+     * @param from Earliest start
+     * @param length Length of the stay in seconds
+     * @return Earliest start at or after from with the house free for length
+     */
+    long long nextFree(const std::string& houseId, long long from, long long length) const;
+
+    /**
+     * @brief Get the intervals of a house
+     * @param houseId House ID
+     * @return Intervals sorted by start, empty if the house has none
+     */
+    const std::vector<Interval>& bookingsOf(const std::string& houseId) const;
+
+    /**
+     * @brief Get the number of stored intervals
+     */
+    size_t size() const { return intervalCount; }
+};
+
+#endif // AVAILABILITY_CALENDAR_H
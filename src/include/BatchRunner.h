@@ -0,0 +1,93 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Forward declarations
+class MBomaHousingSystem;
+class JsonWriter;
+
+/**
+ * @brief Runs scripted commands against the housing system, without a TTY
+ *
+ * Input is one flat JSON object per line; blank lines and lines starting
+ * with '#' are skipped. "cmd" names the operation and "id", if given, is
+ * echoed back:
+ *
+ *   {"cmd":"register","name":"...","phone":"...","email":"...","password":"..."}
+ *   {"cmd":"login","email":"...","password":"..."}
+ *   {"cmd":"logout"}
+ *   {"cmd":"search","type":"...","address":"...","min_rent":0,"max_rent":50000,
+ *    "town":100,"move_in":"2025-01-01"}            (every field optional)
+ *   {"cmd":"book","house_id":"RB01"}
+ *   {"cmd":"pay","booking_id":12,"method":"M-Pesa"}
+ *   {"cmd":"bookings"}
+ *
+ * Each command produces one JSON line with "ok", its results (or "error")
+ * and "latency_us", the time spent in the housing system. Commands call
+ * the same MBomaHousingSystem operations as the menus, and pending sync
+ * and expiry patches are applied before each one, as before each screen.
+ */
+class BatchRunner {
+public:
+    /**
+     * @brief Latencies of one command type
+     */
+    struct CommandStats {
+        std::vector<double> latenciesUs;
+        size_t failed;
+
+        CommandStats() : failed(0) {}
+    };
+
+private:
+    typedef std::map<std::string, std::string> Fields;
+
+    MBomaHousingSystem& system;
+    std::map<std::string, CommandStats> stats;   // By command name
+    size_t rejectedLines;                        // Not JSON, or no known command
+
+    BatchRunner(const BatchRunner&);
+    BatchRunner& operator=(const BatchRunner&);
+
+    /**
+     * @brief Run one command, writing its results
+     * @return false if the command failed; json then holds "error"
+     */
+    bool execute(const std::string& command, const Fields& fields, JsonWriter& json);
+
+    bool doRegister(const Fields& fields, JsonWriter& json);
+    bool doLogin(const Fields& fields, JsonWriter& json);
+    bool doSearch(const Fields& fields, JsonWriter& json);
+    bool doBook(const Fields& fields, JsonWriter& json);
+    bool doPay(const Fields& fields, JsonWriter& json);
+    bool doBookings(JsonWriter& json);
+
+public:
+    /**
+     * @brief Constructor
+     * @param system Housing system to run commands against
+     */
+    explicit BatchRunner(MBomaHousingSystem& system);
+
+    /**
+     * @brief Run every command of a stream
+     * @param in Commands, one JSON object per line
+     * @param out Receives one JSON result line per command
+     * @return false if any line was not a valid command
+     */
+    bool run(std::istream& in, std::ostream& out);
+
+    /**
+     * @brief Print count, failures and latency percentiles per command
+     * @param out Stream to print to
+     * @param elapsedSeconds Wall time of the run, for the overall rate
+     */
+    void printSummary(std::ostream& out, double elapsedSeconds) const;
+};
+
+#endif // BATCH_RUNNER_H
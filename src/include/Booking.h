@@ -16,6 +16,8 @@ private:
     bool isPaid;
 
 public:
+    static const int GRACE_PERIOD_DAYS = 30;   // Length of a new booking
+
     /**
      * @brief Constructor with parameters
      * @param id Booking identifier
@@ -24,6 +26,18 @@ public:
      */
     Booking(int id, int userId, const std::string& houseId);
     
+    /**
+     * @brief Constructor for bookings loaded from storage
+     * @param id Booking identifier
+     * @param userId User identifier
+     * @param houseId House identifier
+     * @param bookingDate Date when booking was made
+     * @param expiryDate Date when booking expires
+     * @param isPaid Whether the booking has been paid for
+     */
+    Booking(int id, int userId, const std::string& houseId,
+            const std::string& bookingDate, const std::string& expiryDate, bool isPaid);
+    
     /**
      * @brief Get booking ID
      * @return Booking ID
@@ -0,0 +1,203 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include <mysql/mysql.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include "StatementCache.h"
+
+/**
+ * @brief Thread-safe pool of MySQL connections
+ *
+ * Keeps between minSize and maxSize open connections, each with its own
+ * prepared statement cache. Callers check a connection out with acquire()
+ * and it is returned automatically when the Handle goes out of scope.
+ * Connections that sat idle are verified with mysql_ping before reuse.
+ */
+class ConnectionPool {
+public:
+    /**
+     * @brief Pool usage counters for monitoring checkout latency
+     */
+    struct Stats {
+        unsigned long long acquisitions;     // Successful checkouts
+        unsigned long long waits;            // Checkouts that had to wait
+        unsigned long long timeouts;         // Checkouts that gave up
+        unsigned long long totalWaitMicros;  // Time spent waiting in total
+        unsigned long long maxWaitMicros;    // Longest single wait
+        unsigned long long reconnects;       // Connections replaced after a failed ping
+        size_t openConnections;
+        size_t idleConnections;
+    };
+
+private:
+    struct Connection {
+        MYSQL* mysql;
+        StatementCache* statements;
+        std::chrono::steady_clock::time_point lastUsed;
+        bool broken;
+    };
+
+public:
+    /**
+     * @brief RAII checkout of a pooled connection
+     */
+    class Handle {
+    private:
+        ConnectionPool* pool;
+        Connection* connection;
+
+        Handle(const Handle&);
+        Handle& operator=(const Handle&);
+
+    public:
+        Handle();
+        Handle(ConnectionPool* pool, Connection* connection);
+        Handle(Handle&& other);
+        Handle& operator=(Handle&& other);
+
+        /**
+         * @brief Destructor returns the connection to the pool
+         */
+        ~Handle();
+
+        /**
+         * @brief Check whether the checkout succeeded
+         */
+        explicit operator bool() const;
+
+        /**
+         * @brief Get the underlying MySQL connection
+         * @return Connection handle
+         */
+        MYSQL* mysql() const;
+
+        /**
+         * @brief Get the prepared statement cache of this connection
+         * @return Statement cache
+         */
+        StatementCache* statements() const;
+
+        /**
+         * @brief Flag the connection as unusable so the pool replaces it
+         */
+        void markBroken();
+
+        /**
+         * @brief Return the connection to the pool before destruction
+         */
+        void release();
+    };
+
+private:
+    std::string host;
+    std::string user;
+    std::string password;
+    std::string database;
+    size_t minSize;
+    size_t maxSize;
+
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    std::vector<Connection*> all;
+    std::vector<Connection*> idle;
+    size_t opening;          // Connections currently being established
+    bool shuttingDown;
+    std::thread warmer;
+    std::string lastError;
+    Stats stats;
+
+    /**
+     * @brief Open a new connection (called without the pool lock held)
+     * @return New connection, or nullptr on failure
+     */
+    Connection* openConnection();
+
+    /**
+     * @brief Close a connection and free its statements
+     * @param connection Connection to close
+     */
+    void closeConnection(Connection* connection);
+
+    /**
+     * @brief Open connections in the background until minSize is reached
+     */
+    void warmUp();
+
+    /**
+     * @brief Verify an idle connection before handing it out
+     * @param connection Connection to check
+     * @return true if the connection is usable
+     */
+    bool checkHealth(Connection* connection);
+
+    /**
+     * @brief Put a checked-out connection back into the pool
+     * @param connection Connection being returned
+     */
+    void giveBack(Connection* connection);
+
+    ConnectionPool(const ConnectionPool&);
+    ConnectionPool& operator=(const ConnectionPool&);
+
+public:
+    /**
+     * @brief Constructor
+     * @param host Database host
+     * @param user Database username
+     * @param password Database password
+     * @param db Database name
+     * @param minSize Connections kept open at all times
+     * @param maxSize Upper bound on open connections
+     */
+    ConnectionPool(const std::string& host, const std::string& user,
+                   const std::string& password, const std::string& db,
+                   size_t minSize, size_t maxSize);
+
+    /**
+     * @brief Destructor; shuts down, waiting for checked-out connections
+     */
+    ~ConnectionPool();
+
+    /**
+     * @brief Open the first connection and warm the rest in the background
+     * @return true if the first connection could be established
+     */
+    bool start();
+
+    /**
+     * @brief Stop warming and close every connection
+     *
+     * New checkouts fail at once. Idle connections are closed straight
+     * away; connections still checked out are closed as their handles
+     * release them, and shutdown() waits for the last one. It must not be
+     * called by a thread that still holds a Handle, and nothing may call
+     * acquire() on a pool that is being destroyed.
+     */
+    void shutdown();
+
+    /**
+     * @brief Check out a connection, waiting if the pool is exhausted
+     * @param timeoutMs Maximum time to wait for a free connection
+     * @return Handle that is empty if no connection became available
+     */
+    Handle acquire(int timeoutMs);
+
+    /**
+     * @brief Get a snapshot of the pool counters
+     * @return Pool statistics
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief Get the last connection error message
+     * @return Error message
+     */
+    std::string getLastError() const;
+};
+
+#endif // CONNECTION_POOL_H
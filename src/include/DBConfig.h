@@ -14,6 +14,50 @@ namespace DBConfig {
     // Connection retry settings
     const int CONNECTION_RETRY_ATTEMPTS = 3;
     const int CONNECTION_RETRY_DELAY_MS = 1000;
+    const int ERROR_LOG_INTERVAL_MS = 1000;      // Errors go to stderr at most this often; the rest are only counted
+    
+    // Connection pool settings
+    const size_t POOL_MIN_SIZE = 2;              // Connections opened at startup
+    const size_t POOL_MAX_SIZE = 8;              // Upper bound on concurrent connections
+    const int POOL_ACQUIRE_TIMEOUT_MS = 5000;    // Wait limit when all connections are busy
+    const int POOL_PING_AFTER_IDLE_MS = 30000;   // Ping connections idle longer than this
+    
+    // Write-behind queue settings
+    const size_t WRITE_BEHIND_MAX_BATCH = 64;    // Writes committed together in one transaction
+    const int WRITE_BEHIND_LINGER_MS = 5;        // Longest wait for a batch to fill up
+    
+    // In-memory cache settings
+    const size_t USER_CACHE_SIZE = 1024;         // Users kept after login; older ones are reloaded on demand
+    
+    // Delta sync settings
+    const int SYNC_INTERVAL_MS = 10000;          // Time between polls for changed houses and bookings
+    const int SYNC_LAG_SECONDS = 5;              // Change marks are set back this far to catch late commits
+    
+    // Reservation settings
+    const int RESERVATION_HOLD_SECONDS = 60;     // A house held for a booking in progress is freed after this
+    
+    // Booking expiry settings
+    const int EXPIRY_TICK_MS = 1000;             // How often the expiry sweeper checks its timer wheel
+    const size_t EXPIRY_MAX_BATCH = 64;          // Bookings expired together in one transaction
+    const int EXPIRY_RETRY_SECONDS = 30;         // Delay before a failed batch is tried again
+    
+    // HTTP API server settings
+    const int SERVER_PORT = 8080;                // Port mboma-server listens on by default
+    const size_t SERVER_WORKERS = 8;             // Request handler threads (matches POOL_MAX_SIZE)
+    const size_t SERVER_MAX_PIPELINE = 32;       // Requests in flight per connection before reading pauses
+    const size_t SERVER_MAX_HEADER_BYTES = 16384;  // Request line and headers
+    const size_t SERVER_MAX_BODY_BYTES = 65536;  // Request body
+    const int SERVER_IDLE_TIMEOUT_SECONDS = 60;  // Keep-alive connections with nothing in flight are closed after this
+    const int SERVER_TICK_MS = 1000;             // How often the server applies sync and expiry patches
+    const int SESSION_IDLE_TIMEOUT_SECONDS = 1800;  // Session tokens unused for this long are logged out
+    const int SESSION_SWEEP_INTERVAL_SECONDS = 60;  // How often idle sessions are dropped
+    
+    // Metrics export settings
+    const std::string METRICS_HOST = "127.0.0.1";  // Address the metrics port is bound to (local only)
+    const int METRICS_FILE_INTERVAL_MS = 15000;  // Time between rewrites of the metrics file
+    
+    // Async connector settings
+    const size_t ASYNC_CONNECTIONS = 32;         // Queries one reactor thread can keep in flight
 }
 
 #endif // DB_CONFIG_H
@@ -5,26 +5,141 @@
 #include <string>
 #include <vector>
 #include <map>  // Add missing include for std::map
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include "User.h"
 #include "House.h"
 #include "Location.h"
 #include "Booking.h"
+#include "ConnectionPool.h"
+#include "HouseCatalog.h"
 
 /**
  * @brief Database connector class to handle MySQL operations
+ *
+ * Every operation checks a connection out of a ConnectionPool for its
+ * duration, so one DBConnector can be shared by multiple worker threads.
  */
 class DBConnector {
+public:
+    /**
+     * @brief Row visitors for the streaming loaders; return false to stop early
+     *
+     * Visitors run while the result is still being read, so they must not
+     * keep references to the row after returning.
+     */
+    typedef std::function<bool(House&&)> HouseVisitor;
+    typedef std::function<bool(User&&)> UserVisitor;
+    typedef std::function<bool(Booking&&)> BookingVisitor;
+    typedef std::function<bool(int, const std::string&)> ExpiryVisitor;  // Booking ID, expiry date
+    
+    /**
+     * @brief Outcome of a booking attempt (values match the book_house procedure)
+     */
+    enum BookingStatus {
+        BOOKING_CREATED = 0,        // House claimed and booking inserted
+        BOOKING_HOUSE_TAKEN = 1,    // House is already booked or not listed
+        BOOKING_HOUSE_NOT_FOUND = 2,
+        BOOKING_FAILED = 3          // Database or connection error
+    };
+    
+    /**
+     * @brief Result of bookHouse
+     */
+    struct BookingResult {
+        BookingStatus status;
+        int bookingId;              // -1 unless status is BOOKING_CREATED
+        std::string bookingDate;    // Set when status is BOOKING_CREATED
+        std::string expiryDate;     // Booking expiry, or when a taken house becomes free
+    };
+    
+    /**
+     * @brief Outcome of payBooking
+     */
+    enum PaymentStatus {
+        PAYMENT_RECORDED = 0,           // Booking claimed as paid and payment inserted
+        PAYMENT_ALREADY_PAID = 1,
+        PAYMENT_BOOKING_NOT_FOUND = 2,  // No such booking, or it belongs to another user
+        PAYMENT_HOUSE_NOT_LISTED = 3,   // The booked house row is gone
+        PAYMENT_FAILED = 4              // Database or connection error
+    };
+    
+    /**
+     * @brief Result of payBooking
+     */
+    struct PaymentResult {
+        PaymentStatus status;
+        std::string receiptNumber;  // Set when status is PAYMENT_RECORDED
+        std::string houseId;        // The booked house, when the booking was found
+        double amount;              // Deposit charged, when status is PAYMENT_RECORDED
+    };
+    
+    /**
+     * @brief One booking in a bookHouses batch
+     */
+    struct BookingRequest {
+        int userId;
+        std::string houseId;
+        int townId;
+    };
+    
+    /**
+     * @brief One payment in a recordPayments batch
+     */
+    struct PaymentRequest {
+        int userId;                 // Payer; the booking must be theirs
+        int bookingId;
+        double amount;
+        std::string paymentMethod;
+    };
+
 private:
-    MYSQL* conn;
-    bool connected;
+    ConnectionPool* pool;
+    std::atomic<bool> connected;
+    mutable std::mutex errorMutex;
     std::string lastError;  // Store the last error message
+    std::chrono::steady_clock::time_point nextErrorLog;   // Guarded by errorMutex
+    unsigned long long unloggedErrors;                    // Errors not printed since the last one was
+    
+    /**
+     * @brief Check a connection out of the pool
+     * @return Connection handle, empty if none is available
+     */
+    ConnectionPool::Handle acquire();
     
     /**
      * @brief Execute a query and check for errors
+     * @param handle Connection to run the query on
      * @param query SQL query string
      * @return true if query was successful
      */
-    bool executeQuery(const std::string& query);
+    bool executeQuery(ConnectionPool::Handle& handle, const std::string& query);
+    
+    /**
+     * @brief Get the cached prepared statement for a query shape
+     * @param handle Connection whose statement cache to use
+     * @param sql SQL text with '?' placeholders
+     * @return Prepared statement, or nullptr if it could not be prepared
+     */
+    PreparedStatement* prepare(ConnectionPool::Handle& handle, const std::string& sql);
+    
+    /**
+     * @brief Execute a prepared statement and check for errors
+     * @param handle Connection the statement belongs to
+     * @param stmt Statement with its parameters already bound
+     * @return true if execution was successful
+     */
+    bool executeStatement(ConnectionPool::Handle& handle, PreparedStatement* stmt);
+    
+    /**
+     * @brief Commit or roll back the open transaction
+     * @param handle Connection the transaction runs on
+     * @param success Commit if true, roll back otherwise
+     * @return true if the transaction was committed
+     */
+    bool endTransaction(ConnectionPool::Handle& handle, bool success);
     
     /**
      * @brief Set the last error message
@@ -62,6 +177,9 @@ public:
     
     /**
      * @brief Close database connection
+     *
+     * Waits for queries still running on other threads to give their
+     * connections back.
      */
     void disconnect();
     
@@ -71,12 +189,20 @@ public:
      */
     bool isConnected() const;
     
+    /**
+     * @brief Get connection pool usage and wait-time counters
+     * @return Pool statistics (all zero when not connected)
+     */
+    ConnectionPool::Stats getPoolStats() const;
+    
     /**
      * @brief Register a new user in the database
-     * @param user User object to register
+     * @param user User object to register; its ID is set on success
+     * @param emailTaken If given, set to whether it failed because the email
+     *                   is already registered (the unique key rejected it)
      * @return true if registration successful
      */
-    bool registerUser(const User& user);
+    bool registerUser(User& user, bool* emailTaken = nullptr);
     
     /**
      * @brief Authenticate a user
@@ -86,6 +212,14 @@ public:
      */
     bool authenticateUser(const std::string& email, const std::string& password);
     
+    /**
+     * @brief Load one user by email (case-insensitive)
+     * @param email User email
+     * @param user Receives the user with its stored password hash
+     * @return true if the user was found
+     */
+    bool loadUserByEmail(const std::string& email, User& user);
+    
     /**
      * @brief Load counties from the database
      * @return Vector of Location objects
@@ -98,6 +232,26 @@ public:
      */
     std::vector<User> loadUsers();
     
+    /**
+     * @brief Stream all users, decoding each row as it arrives
+     * @param visit Called once per user; return false to stop
+     * @return true if the whole result was read without error
+     */
+    bool forEachUser(const UserVisitor& visit);
+    
+    /**
+     * @brief Stream all users into an output iterator
+     * @param out Destination, e.g. std::back_inserter of a reserved vector
+     * @return true if the whole result was read without error
+     */
+    template <typename OutputIt>
+    bool loadUsersInto(OutputIt out) {
+        return forEachUser([&out](User&& user) {
+            *out++ = std::move(user);
+            return true;
+        });
+    }
+    
     /**
      * @brief Load towns in a county from the database
      * @param countyId County ID
@@ -118,12 +272,73 @@ public:
      */
     std::vector<House> loadHouses(int townId);
     
+    /**
+     * @brief Get a change mark for the *ChangedSince loaders
+     *
+     * The mark is the server time minus a lag, so rows from transactions
+     * that were still open when it was taken are picked up by the next
+     * sync as long as they commit within the lag.
+     *
+     * @param lagSeconds How far the mark is set back
+     * @return Server timestamp, empty string if failed
+     */
+    std::string getChangeMark(int lagSeconds);
+    
+    /**
+     * @brief Load houses whose row changed at or after a change mark
+     * @param since Mark from getChangeMark
+     * @param houses Receives the changed houses
+     * @return true if the query succeeded (an empty result is not an error)
+     */
+    bool loadHousesChangedSince(const std::string& since, std::vector<House>& houses);
+    
+    /**
+     * @brief Load bookings whose row changed at or after a change mark
+     * @param since Mark from getChangeMark
+     * @param bookings Receives the changed bookings
+     * @param userId User ID to load bookings for, or -1 for all bookings
+     * @return true if the query succeeded (an empty result is not an error)
+     */
+    bool loadBookingsChangedSince(const std::string& since, std::vector<Booking>& bookings, int userId = -1);
+    
     /**
      * @brief Load all houses from the database
      * @return Vector of House objects
      */
     std::vector<House> loadAllHouses();
     
+    /**
+     * @brief Stream all houses, decoding each row as it arrives
+     * @param visit Called once per house; return false to stop
+     * @return true if the whole result was read without error
+     */
+    bool forEachHouse(const HouseVisitor& visit);
+    
+    /**
+     * @brief Stream all houses into an output iterator
+     * @param out Destination, e.g. std::back_inserter of a reserved vector
+     * @return true if the whole result was read without error
+     */
+    template <typename OutputIt>
+    bool loadAllHousesInto(OutputIt out) {
+        return forEachHouse([&out](House&& house) {
+            *out++ = std::move(house);
+            return true;
+        });
+    }
+    
+    /**
+     * @brief Bulk-load all houses into a columnar catalog
+     *
+     * Uses the binary protocol with typed result buffers, so numeric and
+     * date columns arrive without text conversion and rows are appended
+     * to the catalog without per-row heap allocation.
+     *
+     * @param catalog Catalog to fill (cleared first)
+     * @return true if all rows were loaded
+     */
+    bool loadHouseCatalog(HouseCatalog& catalog);
+    
     /**
      * @brief Get payment details for a house
      * @param houseId House ID
@@ -133,17 +348,19 @@ public:
     std::map<std::string, std::string> getPaymentDetails(const std::string& houseId, int townId);
     
     /**
-     * @brief Search for houses based on criteria
+     * @brief Search the houses open for booking (listed and not booked)
      * @param type House type (optional)
      * @param minRent Minimum monthly rent (optional)
      * @param maxRent Maximum monthly rent (optional)
      * @param townId Town ID (optional)
+     * @param address Substring of the house address (optional)
      * @return Vector of matching House objects
      */
     std::vector<House> searchHouses(const std::string& type = "", 
                                    double minRent = 0.0,
                                    double maxRent = -1.0,  
-                                   int townId = -1);
+                                   int townId = -1,
+                                   const std::string& address = "");
                                    
     /**
      * @brief Load bookings from the database for a specific user
@@ -152,23 +369,146 @@ public:
      */
     std::vector<Booking> loadBookings(int userId = -1);
     
+    /**
+     * @brief Stream bookings, decoding each row as it arrives
+     * @param visit Called once per booking; return false to stop
+     * @param userId User ID to load bookings for, or -1 for all bookings
+     * @return true if the whole result was read without error
+     */
+    bool forEachBooking(const BookingVisitor& visit, int userId = -1);
+    
+    /**
+     * @brief Stream the bookings of all users that have not expired yet
+     * @param visit Called once per booking; return false to stop
+     * @return true if the whole result was read without error
+     */
+    bool forEachCurrentBooking(const BookingVisitor& visit);
+    
+    /**
+     * @brief Stream bookings into an output iterator
+     * @param out Destination, e.g. std::back_inserter of a reserved vector
+     * @param userId User ID to load bookings for, or -1 for all bookings
+     * @return true if the whole result was read without error
+     */
+    template <typename OutputIt>
+    bool loadBookingsInto(OutputIt out, int userId = -1) {
+        return forEachBooking([&out](Booking&& booking) {
+            *out++ = std::move(booking);
+            return true;
+        }, userId);
+    }
+    
+    /**
+     * @brief Atomically claim a house and create a booking for it
+     *
+     * Runs the book_house stored procedure: the house row is only claimed if
+     * it is still listed and free, and the booking is inserted in the same
+     * transaction, all in one round trip.
+     *
+     * @param userId User making the booking
+     * @param houseId House being booked
+     * @param townId Town where house is located
+     * @return Status, booking ID and the dates stored by the database
+     */
+    BookingResult bookHouse(int userId, const std::string& houseId, int townId);
+    
     /**
      * @brief Create a new booking in the database
      * @param userId User making the booking
      * @param houseId House being booked
      * @param townId Town where house is located
-     * @return Booking ID if successful, -1 if failed
+     * @param status Optional; receives why the booking was or was not created
+     * @return Booking ID if successful, -1 if failed or the house is taken
      */
-    int createBooking(int userId, const std::string& houseId, int townId);
+    int createBooking(int userId, const std::string& houseId, int townId, BookingStatus* status = nullptr);
     
     /**
      * @brief Record a payment in the database
+     *
+     * Claims the booking as payBooking does (its user, not yet paid) and
+     * inserts the payment only if the claim changed the row, in one
+     * transaction.
+     *
+     * @param userId User paying; the booking must be theirs
      * @param bookingId Booking that is being paid for
      * @param amount Payment amount
      * @param paymentMethod Method of payment (e.g. "M-Pesa", "Bank Transfer")
-     * @return Receipt number if successful, empty string if failed
+     * @return Receipt number if successful, empty string if failed or the
+     *         booking is not the user's or is already paid
+     */
+    std::string recordPayment(int userId, int bookingId, double amount, const std::string& paymentMethod);
+    
+    /**
+     * @brief Pay the deposit of a user's own booking, at most once
+     *
+     * In one transaction: claims the booking with a conditional UPDATE
+     * (its user, not yet paid), and only if exactly that row changed
+     * inserts the payment for the house's deposit. Concurrent payments for
+     * one booking are serialized on its row lock, so only one is recorded
+     * and the others report PAYMENT_ALREADY_PAID.
+     *
+     * @param userId User paying; the booking must be theirs
+     * @param bookingId Booking being paid for
+     * @param paymentMethod Method of payment (e.g. "M-Pesa", "Bank Transfer")
+     * @return Status, and the receipt number, house and amount
+     */
+    PaymentResult payBooking(int userId, int bookingId, const std::string& paymentMethod);
+    
+    /**
+     * @brief Book several houses in one transaction
+     *
+     * Locks all requested houses, claims the free ones and inserts their
+     * bookings with multi-row statements, then commits once. Requests are
+     * decided in order, so if two requests name the same house the first
+     * one wins and the second is reported as BOOKING_HOUSE_TAKEN.
+     *
+     * @param requests Bookings to create
+     * @param results Receives one result per request, in request order
+     * @return true if the batch was committed; on false every result is BOOKING_FAILED
+     */
+    bool bookHouses(const std::vector<BookingRequest>& requests, std::vector<BookingResult>& results);
+    
+    /**
+     * @brief Record several payments in one transaction
+     *
+     * Locks the batch's unpaid bookings, claims those whose user matches
+     * the request, and inserts payments only for the claimed ones. A
+     * request for a booking that is not the payer's or is already paid
+     * gets an empty receipt, as does a second request for a booking paid
+     * earlier in the same batch; the rest of the batch still commits.
+     *
+     * @param requests Payments to record
+     * @param receipts Receives one receipt number per request, in request order
+     * @return true if the batch was committed; on false every receipt is empty
+     */
+    bool recordPayments(const std::vector<PaymentRequest>& requests, std::vector<std::string>& receipts);
+    
+    /**
+     * @brief Stream the ID and expiry date of every booking not yet marked expired
+     * @param visit Called once per booking; return false to stop
+     * @return true if the whole result was read without error
+     */
+    bool forEachPendingExpiry(const ExpiryVisitor& visit);
+    
+    /**
+     * @brief Expire several bookings and release their houses in one transaction
+     *
+     * Only bookings that are still active and whose expiry date has passed
+     * on the server are marked expired. A house is released only if it is
+     * still booked and its booked_until has passed too, so a house booked
+     * again since is left alone. Calling this twice is harmless.
+     *
+     * Active bookings whose expiry date has not passed yet (the timer fired
+     * early, or the booking was extended) are left active and reported in
+     * notDue so the caller can schedule them again.
+     *
+     * @param bookingIds Bookings whose expiry timer fired
+     * @param releasedHouses Receives the IDs of the houses that were released
+     * @param notDue Receives the active bookings not yet due, with their expiry date
+     * @return true if the batch was committed
      */
-    std::string recordPayment(int bookingId, double amount, const std::string& paymentMethod);
+    bool expireBookings(const std::vector<int>& bookingIds, std::vector<std::string>& releasedHouses,
+                        std::vector<std::pair<int, std::string> >& notDue);
 };
 
 #endif // DB_CONNECTOR_H
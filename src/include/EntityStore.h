@@ -0,0 +1,477 @@
+#ifndef ENTITY_STORE_H
+#define ENTITY_STORE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include "Location.h"
+#include "House.h"
+#include "Booking.h"
+#include "HouseCatalog.h"
+#include "PriceIndex.h"
+#include "PrefixIndex.h"
+#include "TrigramIndex.h"
+#include "GeoIndex.h"
+#include "AvailabilityCalendar.h"
+#include "ReservationTable.h"
+#include "SnapshotCatalog.h"
+
+/**
+ * @brief In-memory locations, houses and bookings with lookup indexes
+ *
+ * Indexes kept alongside the entity vectors:
+ *  - county / town ID -> location slot, county ID -> its town slots
+ *  - a PrefixIndex over location names (and each later word of them),
+ *    for type-ahead
+ *  - house ID -> house slot; houses are kept grouped by town, so each
+ *    town's houses form one contiguous slot range
+ *  - booking ID -> booking slot, user ID -> booking slots,
+ *    house ID -> its active (most recent) booking
+ *  - an AvailabilityCalendar of the booked date intervals of every house,
+ *    fed with all current bookings (not only the stored ones)
+ *  - a columnar HouseCatalog whose row N mirrors house slot N, for
+ *    filter scans
+ *  - rent and deposit PriceIndexes over the houses open for booking
+ *    (listed and not booked), globally and per town
+ *  - TrigramIndexes over house types and addresses (document = house
+ *    slot), for substring search
+ *  - a GeoIndex grid over the coordinates of located houses, for radius
+ *    and nearest searches
+ *  - a ReservationTable word per house (free / held / booked), which
+ *    concurrent booking sessions claim by compare-and-swap
+ *  - a SnapshotCatalog: immutable, versioned copies of the houses by
+ *    town with per-town search indexes, republished on every house
+ *    change, for readers on other threads
+ *
+ * House state must be changed through the store (bookHouse,
+ * setHouseAvailability, addHouse, addHouses) so the catalog, price indexes,
+ * reservation table and snapshots stay in step. The reservation table,
+ * the snapshot reader (snapshots().read()) and searchOpenHouses, which
+ * reads the snapshots, are the only parts that may be used from several
+ * threads at once.
+ *
+ * Indexes are updated in place as entities are added or changed. Slots stay valid
+ * until the entity vector is replaced; pointers returned by the find
+ * functions are invalidated by the next add of the same kind.
+ */
+class EntityStore {
+public:
+    typedef std::pair<size_t, size_t> SlotRange;  // [first, second)
+
+    /**
+     * @brief Which index answered a searchOpenHouses call
+     */
+    enum SearchPath {
+        SEARCH_BY_TEXT = 0,    // Type or address trigrams
+        SEARCH_BY_RENT = 1,    // Open houses by rent
+        SEARCH_BY_CATALOG = 2  // Columnar catalog scan
+    };
+
+    /**
+     * @brief Houses found by searchOpenHouses
+     */
+    struct SearchResult {
+        std::vector<House> houses;
+        SearchPath path;
+        bool truncated;        // More houses matched than the limit
+    };
+
+private:
+    std::vector<Location> locations;
+    std::vector<size_t> countyOrder;              // County slots in load order
+    std::unordered_map<int, size_t> countySlots;
+    std::unordered_map<int, size_t> townSlots;
+    std::unordered_map<int, std::vector<size_t> > countyTowns;
+    PrefixIndex locationNames;                    // Name words -> location slot
+
+    std::vector<House> houses;                    // Grouped by town ID
+    std::unordered_map<std::string, size_t> houseSlots;
+    std::unordered_map<int, SlotRange> townRanges;
+    HouseCatalog catalog;                         // Row N = house slot N
+    PriceIndex rentIndex;                         // Open houses by monthly rent
+    PriceIndex depositIndex;                      // Open houses by deposit
+    TrigramIndex typeText;                        // House slot -> type trigrams
+    TrigramIndex addressText;                     // House slot -> address trigrams
+    GeoIndex geo;                                 // Located houses by position
+    ReservationTable reservationTable;            // House ID -> free / held / booked word
+    SnapshotCatalog snapshotCatalog;              // Published copies for lock-free readers
+
+    std::vector<Booking> bookings;
+    std::unordered_map<int, size_t> bookingSlots;
+    std::unordered_map<int, std::vector<size_t> > userBookings;
+    std::unordered_map<std::string, size_t> activeBookings;
+    AvailabilityCalendar calendar;                // Booked intervals of all users
+
+    /**
+     * @brief Add one location slot to the location indexes (names left unsorted)
+     */
+    void indexLocation(size_t slot);
+
+    /**
+     * @brief Rebuild the house ID and town range indexes from scratch
+     */
+    void indexHouses();
+
+    /**
+     * @brief Rebuild the catalog from the house vector
+     */
+    void rebuildCatalog();
+
+    /**
+     * @brief Copy a changed house into its catalog row
+     *
+     * Rebuilds the catalog when replaced address and map link text has
+     * come to fill most of its text arena.
+     */
+    void updateCatalogRow(size_t slot);
+
+    /**
+     * @brief Rebuild the type and address trigram indexes
+     */
+    void indexText();
+
+    /**
+     * @brief Add a house to the price indexes if it is open for booking
+     */
+    void indexPrices(const House& house);
+
+    /**
+     * @brief Remove a house from the price indexes if it was open for booking
+     */
+    void unindexPrices(const House& house);
+
+    /**
+     * @brief Add one booking slot to the booking indexes
+     */
+    void indexBooking(size_t slot);
+
+public:
+    /**
+     * @brief Replace all locations (counties and towns)
+     * @param newLocations Locations in display order
+     */
+    void setLocations(const std::vector<Location>& newLocations);
+
+    /**
+     * @brief Add a county or town
+     * @param location Location to add
+     */
+    void addLocation(const Location& location);
+
+    /**
+     * @brief Find a county by ID
+     * @param countyId County ID
+     * @return Pointer to the county, nullptr if not found
+     */
+    const Location* findCounty(int countyId) const;
+
+    /**
+     * @brief Find a town by ID
+     * @param townId Town ID
+     * @return Pointer to the town, nullptr if not found
+     */
+    const Location* findTown(int townId) const;
+
+    /**
+     * @brief Get all counties in load order
+     * @return County slots
+     */
+    const std::vector<size_t>& countiesInOrder() const;
+
+    /**
+     * @brief Get the towns of a county
+     * @param countyId County ID
+     * @return Town slots, empty if the county has none
+     */
+    const std::vector<size_t>& townsInCounty(int countyId) const;
+
+    /**
+     * @brief Find locations by the start of their name or of a later word in it
+     *
+     * "nai" matches "Nairobi" and "cbd" matches "Nairobi CBD". A lookup is
+     * two binary searches over the sorted names plus the matches read.
+     *
+     * @param prefix Typed prefix, any case
+     * @param type "county", "town", or empty for both
+     * @param countyId Only towns of this county if > 0
+     * @param limit Most locations returned
+     * @return Location slots in alphabetical order of the matching word
+     */
+    std::vector<size_t> completeLocation(const std::string& prefix, const std::string& type,
+                                         int countyId, size_t limit) const;
+
+    /**
+     * @brief Get a location by slot
+     */
+    const Location& location(size_t slot) const { return locations[slot]; }
+
+    /**
+     * @brief Replace all houses; they are regrouped by town
+     * @param newHouses Houses to take over
+     */
+    void setHouses(std::vector<House>&& newHouses);
+
+    /**
+     * @brief Add a house at the end of its town's range
+     *
+     * Later slots shift by one, so this is O(N); batches should use
+     * addHouses and bulk loads setHouses.
+     *
+     * @param house House to add (replaces an existing house with the same ID)
+     */
+    void addHouse(const House& house);
+
+    /**
+     * @brief Add or replace a batch of houses, as addHouse does for each
+     *
+     * Status changes to known houses update their rows in place. New
+     * houses, houses moving town and edited text or coordinates rebuild
+     * the affected indexes once for the whole batch, so k houses cost
+     * O(N + k) rather than O(k * N).
+     *
+     * @param batch Houses in the order they were changed; a later house
+     *              with the same ID wins
+     */
+    void addHouses(const std::vector<House>& batch);
+
+    /**
+     * @brief Find a house by ID
+     * @param houseId House ID
+     * @return Pointer to the house, nullptr if not found
+     */
+    const House* findHouse(const std::string& houseId) const;
+
+    /**
+     * @brief Mark a house as booked
+     * @param houseId House ID
+     * @param until Booking expiry date
+     * @return true if the house was found
+     */
+    bool bookHouse(const std::string& houseId, const std::string& until);
+
+    /**
+     * @brief Clear the booking of a house
+     * @param houseId House ID
+     * @return true if the house was found
+     */
+    bool unbookHouse(const std::string& houseId);
+
+    /**
+     * @brief List or unlist a house
+     * @param houseId House ID
+     * @param available New availability
+     * @return true if the house was found
+     */
+    bool setHouseAvailability(const std::string& houseId, bool available);
+
+    /**
+     * @brief Get the reservation table for holding houses during a booking
+     */
+    ReservationTable& reservations() { return reservationTable; }
+
+    /**
+     * @brief Get the published house snapshots, safe to read from any thread
+     */
+    const SnapshotCatalog& snapshots() const { return snapshotCatalog; }
+
+    /**
+     * @brief Get the columnar copy of the houses
+     * @return Catalog whose row N is house slot N
+     */
+    const HouseCatalog& houseCatalog() const { return catalog; }
+
+    /**
+     * @brief Get the houses open for booking ordered by monthly rent
+     */
+    const PriceIndex& byRent() const { return rentIndex; }
+
+    /**
+     * @brief Get the houses open for booking ordered by deposit
+     */
+    const PriceIndex& byDeposit() const { return depositIndex; }
+
+    /**
+     * @brief Find houses whose type and address contain the given text
+     *
+     * Candidates come from the trigram indexes and are then checked
+     * against the text, so the cost follows the number of candidates
+     * rather than the number of houses.
+     *
+     * @param type Substring of the house type, any case (empty for any)
+     * @param address Substring of the address, any case (empty for any)
+     * @param slots Receives matching house slots in ascending order
+     * @return false if neither text is at least three characters long, in
+     *         which case the index cannot help and slots is left empty
+     */
+    bool matchText(const std::string& type, const std::string& address, std::vector<size_t>& slots) const;
+
+    /**
+     * @brief Search the houses open for booking (listed and not booked)
+     *
+     * Reads the current snapshot, so it takes no lock and may run on any
+     * thread alongside store changes. Type or address text of three or
+     * more characters is looked up in the town trigram indexes; otherwise
+     * a rent bound walks the towns' open houses cheapest first; otherwise
+     * the town catalogs are scanned. With a town in the filter only that
+     * town is searched.
+     *
+     * @param filter Type, rent and town (the status fields are ignored)
+     * @param address Substring of the address, any case (empty for any)
+     * @param limit Most houses returned, 0 for all
+     * @return Matching houses: in town and load order, or cheapest first
+     *         when answered by rent
+     */
+    SearchResult searchOpenHouses(const HouseCatalog::Filter& filter, const std::string& address, size_t limit) const;
+
+    /**
+     * @brief Find houses within a distance that pass a search filter
+     * @param lat Latitude in degrees
+     * @param lon Longitude in degrees
+     * @param radiusKm Distance in kilometres
+     * @param filter Type, rent, town and status filter
+     * @param hits Receives house slots and distances, nearest first
+     */
+    void housesWithin(double lat, double lon, double radiusKm, const HouseCatalog::Filter& filter,
+                      std::vector<GeoIndex::Hit>& hits) const;
+
+    /**
+     * @brief Find the houses nearest to a point that pass a search filter
+     * @param lat Latitude in degrees
+     * @param lon Longitude in degrees
+     * @param k Most houses returned
+     * @param filter Type, rent, town and status filter
+     * @param hits Receives house slots and distances, nearest first
+     */
+    void nearestHouses(double lat, double lon, size_t k, const HouseCatalog::Filter& filter,
+                       std::vector<GeoIndex::Hit>& hits) const;
+
+    /**
+     * @brief Check whether a house passes a search filter
+     */
+    static bool matches(const House& house, const HouseCatalog::Filter& filter);
+
+    /**
+     * @brief Check whether a house can be booked (listed and not booked)
+     */
+    static bool isOpen(const House& house) { return house.getAvailability() && !house.getBookingStatus(); }
+
+    /**
+     * @brief Get the slot range of a town's houses
+     * @param townId Town ID
+     * @return Range of house slots, empty if the town has no houses
+     */
+    SlotRange housesInTown(int townId) const;
+
+    /**
+     * @brief Get a house by slot
+     */
+    const House& house(size_t slot) const { return houses[slot]; }
+
+    /**
+     * @brief Get all houses, grouped by town
+     */
+    const std::vector<House>& allHouses() const { return houses; }
+
+    /**
+     * @brief Get the number of houses
+     */
+    size_t houseCount() const { return houses.size(); }
+
+    /**
+     * @brief Replace all bookings
+     * @param newBookings Bookings to take over
+     */
+    void setBookings(std::vector<Booking>&& newBookings);
+
+    /**
+     * @brief Add a booking; it becomes the active booking of its house
+     * @param booking Booking to add
+     */
+    void addBooking(const Booking& booking);
+
+    /**
+     * @brief Add a booking, or update it in place if its ID is already stored
+     * @param booking Booking as stored in the database
+     */
+    void putBooking(const Booking& booking);
+
+    /**
+     * @brief Find a booking by ID
+     * @param bookingId Booking ID
+     * @return Pointer to the booking, nullptr if not found
+     */
+    Booking* findBooking(int bookingId);
+
+    /**
+     * @brief Find the most recent booking of a house
+     * @param houseId House ID
+     * @return Pointer to the booking, nullptr if the house was never booked
+     */
+    Booking* findActiveBooking(const std::string& houseId);
+
+    /**
+     * @brief Get the bookings of a user
+     * @param userId User ID
+     * @return Booking slots in the order they were added
+     */
+    const std::vector<size_t>& bookingsForUser(int userId) const;
+
+    /**
+     * @brief Record a booking's dates in the availability calendar only
+     *
+     * For bookings of other users, which are not stored. Stored bookings
+     * are added to the calendar by addBooking and putBooking.
+     *
+     * @param booking Booking with database dates
+     */
+    void scheduleBooking(const Booking& booking);
+
+    /**
+     * @brief Check whether a house has no booking overlapping a window
+     * @param houseId House ID
+     * @param start Window start (parseDateTime seconds)
+     * @param end Window end, exclusive
+     * @return true if the house is free for the whole window
+     */
+    bool isHouseFree(const std::string& houseId, long long start, long long end) const;
+
+    /**
+     * @brief Find the houses passing a search filter that are free for a whole window
+     *
+     * With a town in the filter only that town's slot range is visited.
+     * unbookedOnly is usually left false: a house booked today can still
+     * be free for a later window.
+     *
+     * @param start Window start (parseDateTime seconds)
+     * @param end Window end, exclusive
+     * @param filter Type, rent, town and status filter
+     * @return House slots in slot order
+     */
+    std::vector<size_t> housesFree(long long start, long long end, const HouseCatalog::Filter& filter) const;
+
+    /**
+     * @brief Get the availability calendar
+     */
+    const AvailabilityCalendar& availability() const { return calendar; }
+
+    /**
+     * @brief Drop calendar intervals that ended at or before a time
+     * @param time Cut-off (parseDateTime seconds)
+     * @return Number of intervals dropped
+     */
+    size_t pruneCalendar(long long time) { return calendar.pruneBefore(time); }
+
+    /**
+     * @brief Get a booking by slot
+     */
+    Booking& booking(size_t slot) { return bookings[slot]; }
+    const Booking& booking(size_t slot) const { return bookings[slot]; }
+
+    /**
+     * @brief Get the number of bookings
+     */
+    size_t bookingCount() const { return bookings.size(); }
+};
+
+#endif // ENTITY_STORE_H
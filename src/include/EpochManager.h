@@ -0,0 +1,93 @@
+#ifndef EPOCH_MANAGER_H
+#define EPOCH_MANAGER_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Epoch-based reclamation for objects read without locks
+ *
+ * A reader pins the current global epoch in one of MAX_READERS slots
+ * before it loads a shared pointer, and unpins when it is done. A writer
+ * that has unlinked an object retires it: the object is tagged with the
+ * epoch it was retired in, the global epoch moves on, and the object is
+ * freed once no pinned slot holds that epoch or an older one. Readers
+ * never block and never write anything but their own slot.
+ *
+ * Each slot sits on its own cache line so readers on different cores do
+ * not contend. If every slot is pinned, pin() spins until one is free.
+ */
+class EpochManager {
+public:
+    static const int MAX_READERS = 128;
+
+private:
+    struct Slot {
+        std::atomic<unsigned long long> epoch;   // 0 when free
+        char padding[64 - sizeof(std::atomic<unsigned long long>)];
+    };
+
+    struct Retired {
+        unsigned long long epoch;
+        std::function<void()> free;
+    };
+
+    Slot slots[MAX_READERS];
+    std::atomic<unsigned long long> globalEpoch;
+
+    std::mutex retireMutex;                       // Guards limbo
+    std::vector<Retired> limbo;
+
+    EpochManager(const EpochManager&);
+    EpochManager& operator=(const EpochManager&);
+
+    /**
+     * @brief Get the oldest pinned epoch
+     * @return Oldest epoch, or the current global epoch if nothing is pinned
+     */
+    unsigned long long oldestPinned() const;
+
+public:
+    /**
+     * @brief Constructor
+     */
+    EpochManager();
+
+    /**
+     * @brief Destructor; frees everything still retired (no reader may be pinned)
+     */
+    ~EpochManager();
+
+    /**
+     * @brief Pin the current epoch
+     * @return Slot to pass to unpin
+     */
+    int pin();
+
+    /**
+     * @brief Release a pinned slot
+     * @param slot Slot returned by pin
+     */
+    void unpin(int slot);
+
+    /**
+     * @brief Free an unlinked object once no reader can still see it
+     * @param free Frees the object; runs on whichever thread reclaims it
+     */
+    void retire(const std::function<void()>& free);
+
+    /**
+     * @brief Free the retired objects no pinned reader can still see
+     * @return Number of objects freed
+     */
+    size_t reclaim();
+
+    /**
+     * @brief Get the number of retired objects not freed yet
+     */
+    size_t pendingCount();
+};
+
+#endif // EPOCH_MANAGER_H
@@ -0,0 +1,148 @@
+#ifndef EXPIRY_SERVICE_H
+#define EXPIRY_SERVICE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "DBConnector.h"
+#include "DBConfig.h"
+#include "EntityStore.h"
+#include "TimerWheel.h"
+
+/**
+ * @brief Background expiry of bookings whose grace period has ended
+ *
+ * On start the sweeper thread streams the ID and expiry date of every
+ * active booking into a TimerWheel (16 bytes per booking), then ticks it
+ * every EXPIRY_TICK_MS. Fired bookings are expired in batches of up to
+ * EXPIRY_MAX_BATCH with DBConnector::expireBookings, which marks them
+ * expired and releases their houses in one transaction; a failed batch
+ * is retried later, and a booking not yet due on the server is scheduled
+ * again at its expiry date. No query ever scans the bookings or houses tables.
+ *
+ * Released house IDs are kept as pending patches. The owner of the
+ * EntityStore applies them with applyPending() from its own thread, so
+ * the store needs no locking.
+ *
+ * Times are server times: the offset between the server clock and the
+ * local clock is measured once on start. Bookings made through this
+ * process must be passed to schedule(); bookings made by other processes
+ * are expired by their own sweeper, or picked up by the next start.
+ */
+class ExpiryService {
+public:
+    /**
+     * @brief Expiry counters
+     */
+    struct Stats {
+        unsigned long long loaded;          // Bookings read on start
+        unsigned long long expired;         // Bookings whose timer fired, that were due, and whose batch committed
+        unsigned long long released;        // Houses released
+        unsigned long long failedBatches;   // Batches rescheduled after an error
+    };
+
+private:
+    DBConnector* db;
+    std::chrono::milliseconds tick;
+    long long clockOffset;                  // Server time minus local time, in seconds
+
+    std::mutex mutex;                       // Guards the wheel, the pending releases and stopping
+    std::condition_variable wake;
+    bool stopping;
+    TimerWheel wheel;
+    std::vector<std::string> pendingReleases;
+    std::thread worker;
+
+    std::atomic<unsigned long long> loadedCount;
+    std::atomic<unsigned long long> expiredCount;
+    std::atomic<unsigned long long> releasedCount;
+    std::atomic<unsigned long long> failedBatchCount;
+
+    ExpiryService(const ExpiryService&);
+    ExpiryService& operator=(const ExpiryService&);
+
+    /**
+     * @brief Sweeper thread main loop
+     */
+    void sweepLoop();
+
+    /**
+     * @brief Read the active bookings into the wheel
+     */
+    void loadPending();
+
+    /**
+     * @brief Expire one batch of fired bookings
+     */
+    void expireBatch(const std::vector<int>& bookingIds);
+
+public:
+    /**
+     * @brief Constructor
+     * @param db Connected database connector (not owned)
+     * @param tickMs Time between checks of the wheel
+     */
+    explicit ExpiryService(DBConnector* db, int tickMs = DBConfig::EXPIRY_TICK_MS);
+
+    /**
+     * @brief Destructor; stops the sweeper thread
+     */
+    ~ExpiryService();
+
+    /**
+     * @brief Read the server clock and start the sweeper thread
+     *
+     * The active bookings are loaded by the sweeper thread, so start
+     * returns without waiting for them.
+     *
+     * @return true if the server clock could be read
+     */
+    bool start();
+
+    /**
+     * @brief Stop and join the sweeper thread; pending releases are kept
+     */
+    void stop();
+
+    /**
+     * @brief Add a booking to the wheel
+     * @param bookingId Booking ID
+     * @param expiryDate Expiry date as stored in the database
+     * @return false if the date could not be parsed
+     */
+    bool schedule(int bookingId, const std::string& expiryDate);
+
+    /**
+     * @brief Get the current server time
+     * @return Seconds on the parseDateTime scale
+     */
+    long long now() const;
+
+    /**
+     * @brief Mark the released houses free in a store
+     *
+     * A house whose in-memory booking runs past now (booked again after
+     * the release) is left booked.
+     *
+     * @param store Store to update (caller's thread)
+     * @return Number of houses released
+     */
+    size_t applyPending(EntityStore& store);
+
+    /**
+     * @brief Get the number of bookings waiting in the wheel
+     */
+    size_t pendingCount();
+
+    /**
+     * @brief Get a snapshot of the expiry counters
+     * @return Current counters
+     */
+    Stats getStats() const;
+};
+
+#endif // EXPIRY_SERVICE_H
@@ -0,0 +1,131 @@
+#ifndef GEO_INDEX_H
+#define GEO_INDEX_H
+
+#include <functional>
+#include <vector>
+#include "House.h"
+
+/**
+ * @brief Grid index over house coordinates for radius and nearest searches
+ *
+ * The map is divided into cells of a fixed size in degrees. Points are
+ * kept sorted by cell key (row-major: latitude band, then longitude), so
+ * the cells of one band that overlap a search circle are one contiguous
+ * run found by binary search. A radius search visits only the bands and
+ * columns that overlap the circle's bounding box and measures great-circle
+ * distance to each point in them.
+ *
+ * Nearest-k searches grow the radius from one cell until k accepted
+ * points are found, so their cost follows local density rather than the
+ * number of points. Houses without coordinates are not indexed.
+ */
+class GeoIndex {
+public:
+    /**
+     * @brief A point found by a search
+     */
+    struct Hit {
+        size_t slot;        // Position of the house in the indexed vector
+        double distanceKm;
+    };
+
+    /**
+     * @brief Decides whether a point may be returned (e.g. rent or type filters)
+     */
+    typedef std::function<bool(size_t slot)> SlotFilter;
+
+private:
+    /**
+     * @brief A search circle with the terms shared by every distance test
+     */
+    struct Circle {
+        double lat;
+        double lon;
+        double cosLat;
+        double limit;           // Haversine term of the radius: sin^2(radius / 2R)
+    };
+
+    double cellDegrees;
+    unsigned long long columns;                   // Cells per latitude band
+
+    std::vector<unsigned long long> cells;        // Sorted cell key of each point
+    std::vector<double> latitudes;                // Same order as cells
+    std::vector<double> longitudes;
+    std::vector<double> cosLatitudes;             // Cached for the distance test
+    std::vector<unsigned int> slots;
+
+    /**
+     * @brief Get the latitude band of a latitude
+     */
+    long long rowOf(double lat) const;
+
+    /**
+     * @brief Get the longitude column of a longitude (may be outside [0, columns))
+     */
+    long long columnOf(double lon) const;
+
+    /**
+     * @brief Test the points of cells [firstKey, lastKey] against a circle
+     */
+    void scanCells(unsigned long long firstKey, unsigned long long lastKey, const Circle& circle,
+                   const SlotFilter& accept, std::vector<Hit>& hits) const;
+
+    /**
+     * @brief Collect accepted points within a radius, unordered
+     */
+    void collect(double lat, double lon, double radiusKm, const SlotFilter& accept,
+                 std::vector<Hit>& hits) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param cellDegrees Cell size; 0.01 degrees is about 1.1 km
+     */
+    explicit GeoIndex(double cellDegrees = 0.01);
+
+    /**
+     * @brief Index the houses that have coordinates
+     * @param houses Houses; a hit's slot is the position in this vector
+     */
+    void build(const std::vector<House>& houses);
+
+    /**
+     * @brief Remove all points
+     */
+    void clear();
+
+    /**
+     * @brief Find points within a radius
+     * @param lat Latitude of the centre in degrees
+     * @param lon Longitude of the centre in degrees
+     * @param radiusKm Radius in kilometres
+     * @param accept Filter applied to points inside the radius (empty for all)
+     * @param hits Receives the points, nearest first
+     */
+    void within(double lat, double lon, double radiusKm, const SlotFilter& accept,
+                std::vector<Hit>& hits) const;
+
+    /**
+     * @brief Find the k nearest points
+     * @param lat Latitude of the centre in degrees
+     * @param lon Longitude of the centre in degrees
+     * @param k Number of points wanted
+     * @param accept Filter applied to candidate points (empty for all)
+     * @param hits Receives up to k points, nearest first
+     */
+    void nearest(double lat, double lon, size_t k, const SlotFilter& accept,
+                 std::vector<Hit>& hits) const;
+
+    /**
+     * @brief Get the great-circle distance between two points
+     * @return Distance in kilometres
+     */
+    static double distanceKm(double lat1, double lon1, double lat2, double lon2);
+
+    /**
+     * @brief Get the number of indexed points
+     */
+    size_t size() const { return cells.size(); }
+};
+
+#endif // GEO_INDEX_H
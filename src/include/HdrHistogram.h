@@ -0,0 +1,109 @@
+#ifndef HDR_HISTOGRAM_H
+#define HDR_HISTOGRAM_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief High dynamic range histogram of non-negative integer values
+ *
+ * Values are counted in log-linear buckets: every power-of-two range is
+ * split into the same number of linear sub-buckets, enough that any value
+ * up to the highest trackable one is kept to the chosen number of
+ * significant decimal digits. Recording is one index computation and an
+ * increment, and memory does not grow with the number of values, so a
+ * histogram can take every latency of a long load run (e.g. in
+ * microseconds) and still report exact-enough p99.9 and max values.
+ *
+ * Not thread-safe; record into one histogram per thread, or under a lock,
+ * and merge with add().
+ */
+class HdrHistogram {
+private:
+    long long highestTrackable;
+    int subBucketHalfCountMagnitude;
+    long long subBucketHalfCount;
+    long long subBucketMask;
+    std::vector<unsigned long long> counts;
+    unsigned long long totalCount;
+    long long minValue;
+    long long maxValue;
+    double sum;
+
+    /**
+     * @brief Index of the power-of-two bucket holding a value
+     */
+    int bucketIndex(long long value) const;
+
+    /**
+     * @brief Index into counts for a value
+     */
+    size_t countsIndex(long long value) const;
+
+    /**
+     * @brief Lowest value counted at an index of counts
+     */
+    long long valueAtIndex(size_t index) const;
+
+    /**
+     * @brief Highest value that shares a count with this one
+     */
+    long long highestEquivalent(long long value) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param highestTrackable Largest value kept exactly; larger values are
+     *                         counted as this one (e.g. 60000000 for a minute in microseconds)
+     * @param significantDigits Decimal digits of precision, 1-5 (3 keeps 0.1%)
+     */
+    explicit HdrHistogram(long long highestTrackable, int significantDigits = 3);
+
+    /**
+     * @brief Count a value
+     * @param value Value to count; negative values count as 0
+     * @return false if the value was above the trackable range and was clamped
+     */
+    bool record(long long value);
+
+    /**
+     * @brief Add the counts of another histogram
+     * @param other Histogram with the same range and precision
+     * @return false (nothing added) if the layouts differ
+     */
+    bool add(const HdrHistogram& other);
+
+    /**
+     * @brief Remove all counts
+     */
+    void reset();
+
+    /**
+     * @brief Get the value below or at which a share of the values lie
+     * @param percentile 0-100, e.g. 99.9
+     * @return Value (the top of its bucket, at most the largest recorded), 0 if empty
+     */
+    long long valueAtPercentile(double percentile) const;
+
+    /**
+     * @brief Get the number of values recorded
+     */
+    unsigned long long count() const { return totalCount; }
+
+    /**
+     * @brief Get the smallest value recorded, 0 if empty
+     */
+    long long min() const { return totalCount ? minValue : 0; }
+
+    /**
+     * @brief Get the largest value recorded (after clamping), 0 if empty
+     */
+    long long max() const { return totalCount ? maxValue : 0; }
+
+    /**
+     * @brief Get the mean of the values recorded, 0 if empty
+     */
+    double mean() const { return totalCount ? sum / totalCount : 0.0; }
+};
+
+#endif // HDR_HISTOGRAM_H
@@ -18,6 +18,9 @@ private:
     bool isAvailable;
     bool isBooked;
     std::string bookedUntil;
+    bool hasLocation;        // Coordinates are known
+    double latitude;         // Degrees, WGS 84
+    double longitude;
 
 public:
     /**
@@ -93,6 +96,31 @@ public:
      */
     std::string getBookedUntil() const;
     
+    /**
+     * @brief Check whether the house has map coordinates
+     * @return true if latitude and longitude are set
+     */
+    bool hasCoordinates() const;
+    
+    /**
+     * @brief Get latitude
+     * @return Latitude in degrees (0 if not set)
+     */
+    double getLatitude() const;
+    
+    /**
+     * @brief Get longitude
+     * @return Longitude in degrees (0 if not set)
+     */
+    double getLongitude() const;
+    
+    /**
+     * @brief Set map coordinates
+     * @param lat Latitude in degrees
+     * @param lon Longitude in degrees
+     */
+    void setCoordinates(double lat, double lon);
+    
     /**
      * @brief Set house availability
      * @param available New availability status
@@ -0,0 +1,260 @@
+#ifndef HOUSE_CATALOG_H
+#define HOUSE_CATALOG_H
+
+#include <string>
+#include <vector>
+#include "House.h"
+
+/**
+ * @brief Structure-of-arrays house catalog
+ *
+ * Each house attribute is stored in its own contiguous column so scans that
+ * only look at rent or town touch only those bytes. Strings are kept in a
+ * shared text arena and house types are dictionary-encoded, so appending a
+ * row never allocates once the columns have been reserved.
+ *
+ * select() evaluates search filters column by column into a selection
+ * bitmap, using AVX2 when the CPU supports it; only the selected rows are
+ * materialized as House objects.
+ */
+class HouseCatalog {
+public:
+    static const size_t ID_WIDTH = 16;  // Fixed-width, NUL-padded house IDs (VARCHAR(15) plus the NUL)
+
+    // Bits stored in the flags column
+    static const unsigned char FLAG_AVAILABLE = 1;
+    static const unsigned char FLAG_BOOKED = 2;
+
+    /**
+     * @brief Search filter; same meaning as the searchHouses parameters
+     */
+    struct Filter {
+        std::string type;      // Substring of the house type (any case), empty for any
+        double minRent;        // Minimum monthly rent, <= 0 for none
+        double maxRent;        // Maximum monthly rent, <= 0 for none
+        int townId;            // Town ID, <= 0 for any
+        bool availableOnly;    // Only rows with FLAG_AVAILABLE
+        bool unbookedOnly;     // Only rows without FLAG_BOOKED
+
+        Filter() : minRent(0.0), maxRent(-1.0), townId(-1), availableOnly(false), unbookedOnly(false) {}
+    };
+
+    // One bit per row: bit (row % 64) of word (row / 64)
+    typedef std::vector<unsigned long long> Bitmap;
+
+private:
+    struct TextRef {
+        unsigned int offset;
+        unsigned int length;
+    };
+
+    std::vector<char> ids;
+    std::vector<int> townIds;
+    std::vector<double> deposits;
+    std::vector<double> rents;
+    std::vector<unsigned char> flags;
+    std::vector<long long> bookedUntil;     // Packed YYYYMMDDhhmmss, 0 if not booked
+    std::vector<unsigned short> typeIds;
+    std::vector<TextRef> addresses;
+    std::vector<TextRef> mapLinks;
+
+    std::vector<std::string> typeNames;     // Dictionary for typeIds
+    std::vector<char> text;                 // Arena for addresses and map links
+    size_t garbageText;                     // Arena bytes no row refers to any more
+    unsigned short lastTypeId;
+
+    /**
+     * @brief Copy a string into the text arena
+     */
+    TextRef storeText(const char* value, size_t length);
+
+    /**
+     * @brief Point a row's text at a new value, reusing its arena bytes
+     *
+     * Unchanged text keeps its reference and shorter text is written over
+     * the old bytes; only longer text is appended.
+     */
+    void replaceText(TextRef& ref, const char* value, size_t length);
+
+    /**
+     * @brief Look up or add a house type in the dictionary
+     */
+    unsigned short internType(const char* value, size_t length);
+
+    /**
+     * @brief Filter rows [begin, end) one at a time into the bitmap
+     */
+    void selectScalar(const Filter& filter, const std::vector<unsigned short>& typeMatches,
+                      size_t begin, size_t end, Bitmap& selection) const;
+
+    /**
+     * @brief Filter rows [begin, end) eight at a time with AVX2; both must be multiples of 8
+     */
+    void selectAvx2(const Filter& filter, const std::vector<unsigned short>& typeMatches,
+                    size_t begin, size_t end, Bitmap& selection) const;
+
+public:
+    /**
+     * @brief Constructor
+     */
+    HouseCatalog();
+
+    /**
+     * @brief Remove all rows (keeps reserved capacity)
+     */
+    void clear();
+
+    /**
+     * @brief Check whether most of the text arena is replaced text
+     *
+     * The owner should then rebuild the catalog (clear() and append every
+     * row again), which stores each row's text once.
+     *
+     * @return true if over half the arena (and at least 64 KiB) is garbage
+     */
+    bool needsCompaction() const;
+
+    /**
+     * @brief Reserve capacity for a number of rows
+     * @param rows Expected row count
+     * @param textBytesPerRow Expected address + map link bytes per row
+     */
+    void reserve(size_t rows, size_t textBytesPerRow = 96);
+
+    /**
+     * @brief Get number of rows
+     * @return Row count
+     */
+    size_t size() const;
+
+    /**
+     * @brief Append a row
+     * @param id House ID
+     * @param idLength Length of the house ID
+     * @param type House type
+     * @param typeLength Length of the house type
+     * @param townId Town ID
+     * @param address House address
+     * @param addressLength Length of the address
+     * @param mapLink Map link
+     * @param mapLinkLength Length of the map link
+     * @param deposit Deposit fee
+     * @param rent Monthly rent
+     * @param rowFlags FLAG_AVAILABLE / FLAG_BOOKED bits
+     * @param packedBookedUntil Booking expiry as YYYYMMDDhhmmss, 0 if none
+     * @return Index of the new row
+     */
+    size_t append(const char* id, size_t idLength, const char* type, size_t typeLength,
+                  int townId, const char* address, size_t addressLength,
+                  const char* mapLink, size_t mapLinkLength,
+                  double deposit, double rent, unsigned char rowFlags,
+                  long long packedBookedUntil);
+
+    /**
+     * @brief Append a row copied from a House
+     * @param house Source house
+     * @return Index of the new row
+     */
+    size_t append(const House& house);
+
+    /**
+     * @brief Overwrite a row with the attributes of a House
+     *
+     * Address and map link text is rewritten in place when it is unchanged
+     * or shorter; longer text is appended and the old bytes are left as
+     * garbage until clear() (see needsCompaction()).
+     *
+     * @param row Row index
+     * @param house Source house
+     */
+    void update(size_t row, const House& house);
+
+    /**
+     * @brief Find the rows that pass a filter
+     * @param filter Search filter
+     * @param selection Receives one bit per row
+     * @param useSimd Use the AVX2 kernel if the CPU supports it
+     * @return Number of selected rows
+     */
+    size_t select(const Filter& filter, Bitmap& selection, bool useSimd = true) const;
+
+    /**
+     * @brief Find the rows in a row range that pass a filter
+     *
+     * Rows outside [begin, end) are left unselected. Useful when the rows
+     * are grouped, e.g. the houses of one town in EntityStore.
+     *
+     * @param filter Search filter
+     * @param selection Receives one bit per row of the whole catalog
+     * @param begin First row to scan
+     * @param end One past the last row to scan
+     * @param useSimd Use the AVX2 kernel if the CPU supports it
+     * @return Number of selected rows
+     */
+    size_t select(const Filter& filter, Bitmap& selection, size_t begin, size_t end,
+                  bool useSimd = true) const;
+
+    /**
+     * @brief Materialize the selected rows
+     * @param selection Bitmap from select()
+     * @return Selected rows as House objects, in row order
+     */
+    std::vector<House> materialize(const Bitmap& selection) const;
+
+    /**
+     * @brief Check whether select() can use its AVX2 kernel on this CPU
+     * @return true if AVX2 is available
+     */
+    static bool simdAvailable();
+
+    /**
+     * @brief Materialize a row as a House object
+     * @param row Row index
+     * @return House with all attributes of the row
+     */
+    House toHouse(size_t row) const;
+
+    /**
+     * @brief Get the house ID of a row
+     * @param row Row index
+     * @return NUL-terminated house ID
+     */
+    const char* getId(size_t row) const;
+
+    /**
+     * @brief Get the house type name of a row
+     * @param row Row index
+     * @return House type
+     */
+    const std::string& getType(size_t row) const;
+
+    /**
+     * @brief Get the booking expiry of a row as "YYYY-MM-DD HH:MM:SS"
+     * @param row Row index
+     * @return Expiry date, or empty string if not booked
+     */
+    std::string getBookedUntil(size_t row) const;
+
+    // Direct column access for scans
+    const std::vector<int>& townIdColumn() const { return townIds; }
+    const std::vector<double>& depositColumn() const { return deposits; }
+    const std::vector<double>& rentColumn() const { return rents; }
+    const std::vector<unsigned char>& flagColumn() const { return flags; }
+    const std::vector<unsigned short>& typeIdColumn() const { return typeIds; }
+    const std::vector<std::string>& typeDictionary() const { return typeNames; }
+
+    /**
+     * @brief Pack date-time fields as YYYYMMDDhhmmss
+     */
+    static long long packDateTime(unsigned int year, unsigned int month, unsigned int day,
+                                  unsigned int hour, unsigned int minute, unsigned int second);
+
+    /**
+     * @brief Parse "YYYY-MM-DD HH:MM:SS" into the packed form
+     * @param value Date-time string
+     * @return Packed value, 0 if empty or malformed
+     */
+    static long long packDateTime(const std::string& value);
+};
+
+#endif // HOUSE_CATALOG_H
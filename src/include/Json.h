@@ -0,0 +1,84 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Streaming JSON text builder
+ *
+ * Values are appended in document order; commas and colons are inserted
+ * automatically. The caller is responsible for balancing begin/end calls.
+ */
+class JsonWriter {
+private:
+    std::string out;
+    std::vector<bool> firstInScope;   // One entry per open object or array
+    bool afterKey;
+
+    /**
+     * @brief Write the separator due before the next value or key
+     */
+    void separate();
+
+    /**
+     * @brief Append a quoted, escaped string
+     */
+    void appendString(const std::string& text);
+
+public:
+    /**
+     * @brief Constructor for an empty document
+     */
+    JsonWriter();
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    /**
+     * @brief Write an object key; the next call writes its value
+     * @param name Key
+     */
+    JsonWriter& key(const std::string& name);
+
+    JsonWriter& value(const std::string& text);
+    JsonWriter& value(const char* text);
+    JsonWriter& value(int number);
+    JsonWriter& value(long long number);
+    JsonWriter& value(unsigned long long number);
+    JsonWriter& value(bool flag);
+
+    /**
+     * @brief Write a number with a fixed number of decimals (e.g. money)
+     * @param number Value; NaN and infinities are written as null
+     * @param decimals Digits after the point
+     */
+    JsonWriter& value(double number, int decimals = 2);
+
+    JsonWriter& null();
+
+    /**
+     * @brief Get the text written so far
+     */
+    const std::string& str() const { return out; }
+};
+
+/**
+ * @brief Parse a flat JSON object, e.g. a request body
+ *
+ * Members must be strings, numbers, true, false or null. Strings are
+ * unescaped (\uXXXX as UTF-8), numbers are kept as written, true and false
+ * become "true" and "false", and null members are left out. Nested
+ * objects and arrays are rejected.
+ *
+ * @param text JSON text
+ * @param fields Receives member name -> value
+ * @param error Receives a description of the first problem
+ * @return false if the text is not a flat JSON object
+ */
+bool parseJsonObject(const std::string& text, std::map<std::string, std::string>& fields, std::string& error);
+
+#endif // JSON_H
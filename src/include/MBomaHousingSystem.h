@@ -9,25 +9,72 @@
 #include "House.h"
 #include "Booking.h"
 #include "Payment.h"
+#include "EntityStore.h"
+#include "UserDirectory.h"
 
-// Forward declaration for DBConnector
+// Forward declarations
 class DBConnector;
+class SyncService;
+class ExpiryService;
 
 /**
  * @brief Main housing management system class
+ *
+ * The menus only read input and print results; the operations themselves
+ * (findHouses, bookHouse, payBooking, ...) take plain arguments and
+ * return outcomes, so batch mode runs exactly the same code.
  */
 class MBomaHousingSystem {
+public:
+    /**
+     * @brief Outcome of bookHouse
+     */
+    enum BookingOutcome {
+        BOOKING_SAVED = 0,          // Booked and saved to the database
+        BOOKING_NOT_SAVED = 1,      // Not booked; the database write failed
+        BOOKING_NO_SUCH_HOUSE = 2,  // No listed house with that ID
+        BOOKING_ALREADY_BOOKED = 3,
+        BOOKING_HELD = 4,           // Another session is booking the house right now
+        BOOKING_TAKEN = 5           // Booked by another session after it was listed
+    };
+    
+    /**
+     * @brief Outcome of payBooking
+     */
+    enum PaymentOutcome {
+        PAYMENT_SAVED = 0,          // Paid and saved to the database
+        PAYMENT_NOT_SAVED = 1,      // Not paid; the database write failed
+        PAYMENT_NO_SUCH_BOOKING = 2,  // Not a booking of the logged-in user
+        PAYMENT_ALREADY_PAID = 3,
+        PAYMENT_HOUSE_NOT_LISTED = 4  // The booked house was removed from the listings
+    };
+    
+    /**
+     * @brief Search criteria for findHouses
+     */
+    struct HouseQuery {
+        std::string type;      // Substring of the house type (any case), empty for any
+        std::string address;   // Substring of the address (any case), empty for any
+        double minRent;        // Minimum monthly rent, <= 0 for none
+        double maxRent;        // Maximum monthly rent, <= 0 for none
+        int townId;            // Town ID, <= 0 for any
+        long long moveIn;      // Move-in time (seconds since the epoch), 0 for now
+        
+        HouseQuery() : minRent(0.0), maxRent(-1.0), townId(-1), moveIn(0) {}
+    };
+
 private:
-    std::vector<User> users;
-    std::vector<Location> locations;
-    std::vector<House> houses;
-    std::vector<Booking> bookings;
+    UserDirectory users;  // Users loaded on demand, by email
+    EntityStore store;  // Locations, houses and bookings with their indexes
     std::vector<Payment> payments;
     
     DBConnector* dbConnector;
+    SyncService* syncService;  // Keeps the store up to date; nullptr without a database
+    ExpiryService* expiryService;  // Releases houses when bookings expire; nullptr without a database
     bool useDatabase;
     
-    int currentUserId;
+    int currentUserId;  // Database user_id of the logged-in user
+    std::string currentUserEmail;
     bool isLoggedIn;
     
     /**
@@ -47,7 +94,7 @@ private:
     
     /**
      * @brief Get next available ID for a given entity type
-     * @param entityType Type of entity ("user", "booking", or "payment")
+     * @param entityType Type of entity ("booking" or "payment")
      * @return Next available ID
      */
     int getNextId(const std::string& entityType);
@@ -63,6 +110,18 @@ private:
      */
     void displayTowns(int countyId);
     
+    /**
+     * @brief Read a county or town choice as a number or the start of a name
+     *
+     * Typed text is completed against location names; a single match is
+     * taken, several are listed and the user picks one by number.
+     *
+     * @param type "county" or "town"
+     * @param countyId For towns, the county to complete within (-1 for any)
+     * @return Chosen location ID, 0 for "back", -1 if nothing matched
+     */
+    int readLocationChoice(const std::string& type, int countyId = -1);
+    
     /**
      * @brief Display houses in a specific town
      * @param townId Town ID
@@ -74,7 +133,19 @@ private:
      * @param houseId House ID to find
      * @return Pointer to house if found, nullptr otherwise
      */
-    House* findHouse(const std::string& houseId);
+    const House* findHouse(const std::string& houseId);
+    
+    /**
+     * @brief Find a user by email, loading it from the database if not cached
+     * @param email Email address (any case)
+     * @return Pointer to the cached user, nullptr if there is no such user
+     */
+    User* findUser(const std::string& email);
+    
+    /**
+     * @brief Load the current user's bookings into the store
+     */
+    void loadUserBookings();
     
     /**
      * @brief Get current logged-in user
@@ -83,28 +154,43 @@ private:
     User* getCurrentUser();
     
     /**
-     * @brief Process payment for a booking
+     * @brief Ask for a payment method, pay for a booking and print the receipt
      * @param bookingId Booking ID
      * @param amount Amount to pay
      */
     void processPayment(int bookingId, double amount);
     
+    /**
+     * @brief Book a house and print the outcome, offering to pay
+     * @param houseId House ID
+     * @return true if the house was booked
+     */
+    bool bookAndOfferPayment(const std::string& houseId);
+    
     /**
      * @brief Search for houses based on user criteria
      */
     void searchHouses();
     
+    /**
+     * @brief Search for houses near a point given by the user
+     */
+    void searchNearby();
+    
     /**
      * @brief Display search results
      * @param searchResults Vector of houses matching search criteria
+     * @param distances Distance in km of each result (optional)
      */
-    void displaySearchResults(const std::vector<House>& searchResults);
+    void displaySearchResults(const std::vector<House>& searchResults,
+                              const std::vector<double>& distances = std::vector<double>());
 
 public:
     /**
-     * @brief Constructor
+     * @brief Constructor; connects to the database and loads the data
+     * @param interactive false to print status messages to stderr, keeping stdout for results
      */
-    MBomaHousingSystem();
+    explicit MBomaHousingSystem(bool interactive = true);
     
     /**
      * @brief Destructor
@@ -115,6 +201,88 @@ public:
      * @brief Run the housing management system
      */
     void run();
+    
+    /**
+     * @brief Whether the database is connected and the data loaded
+     */
+    bool isReady() const;
+    
+    /**
+     * @brief Get the last database error message
+     */
+    std::string getLastError() const;
+    
+    /**
+     * @brief Apply changes made by other sessions and expired bookings to the store
+     */
+    void applyPending();
+    
+    /**
+     * @brief Save a new user to the database and log in as that user
+     * @param user User to save; receives its database ID
+     * @return false if the user could not be saved
+     */
+    bool registerAccount(User& user);
+    
+    /**
+     * @brief Log in and load the user's bookings
+     * @param email Email address (any case)
+     * @param password Password
+     * @return false if the email or password is wrong
+     */
+    bool login(const std::string& email, const std::string& password);
+    
+    /**
+     * @brief Log out the current user
+     */
+    void logout();
+    
+    /**
+     * @brief Get the logged-in user's ID
+     * @return User ID, 0 if nobody is logged in
+     */
+    int getCurrentUserId() const;
+    
+    /**
+     * @brief Find houses matching a query
+     *
+     * Without a move-in date, lists houses open for booking now; with one,
+     * houses with no booking for a whole grace period from that date.
+     *
+     * @param query Search criteria
+     * @return Matching houses
+     */
+    std::vector<House> findHouses(const HouseQuery& query);
+    
+    /**
+     * @brief Book a house for the logged-in user
+     * @param houseId House ID
+     * @param booking Receives the booking on BOOKING_SAVED
+     * @return Outcome of the attempt
+     */
+    BookingOutcome bookHouse(const std::string& houseId, Booking& booking);
+    
+    /**
+     * @brief Pay the deposit of one of the logged-in user's bookings
+     *
+     * Goes through DBConnector::payBooking, which checks the owner and
+     * that the booking is unpaid in the database; the booking is marked
+     * paid in memory only once that commits. A paid house is no longer
+     * listed.
+     *
+     * @param bookingId Booking ID
+     * @param method Payment method, e.g. "M-Pesa" or "Bank Transfer"
+     * @param receiptNumber Receives the receipt number
+     * @param amount Receives the amount paid
+     * @return Outcome of the payment
+     */
+    PaymentOutcome payBooking(int bookingId, const std::string& method,
+                              std::string& receiptNumber, double& amount);
+    
+    /**
+     * @brief Get the logged-in user's bookings
+     */
+    std::vector<Booking> myBookings() const;
 };
 
 #endif // MBOMA_HOUSING_SYSTEM_H
@@ -0,0 +1,257 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sched.h>
+
+const size_t METRICS_SHARDS = 16;    // Power of two
+
+/**
+ * @brief Per-thread shard, for when the current CPU cannot be read
+ */
+size_t metricsShardSlow();
+
+/**
+ * @brief Shard used by the calling thread: its current CPU
+ *
+ * Threads on different cores then update different cache lines.
+ */
+inline size_t metricsShard() {
+    int cpu = sched_getcpu();
+    return cpu >= 0 ? static_cast<size_t>(cpu) & (METRICS_SHARDS - 1) : metricsShardSlow();
+}
+
+/**
+ * @brief Monotonic count, e.g. queries run or errors seen
+ *
+ * Each shard is a separate cache line, so an increment is one relaxed
+ * atomic add with no contention between cores; value() sums the shards.
+ */
+class MetricsCounter {
+private:
+    struct alignas(64) Shard {
+        std::atomic<unsigned long long> value;
+    };
+    Shard shards[METRICS_SHARDS];
+
+    MetricsCounter(const MetricsCounter&);
+    MetricsCounter& operator=(const MetricsCounter&);
+
+public:
+    MetricsCounter();
+
+    /**
+     * @brief Add to the count
+     * @param amount Amount to add
+     */
+    void add(unsigned long long amount = 1) {
+        shards[metricsShard()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the total over all shards
+     */
+    unsigned long long value() const;
+};
+
+/**
+ * @brief Value that goes up and down, e.g. connections in use
+ */
+class MetricsGauge {
+private:
+    std::atomic<long long> current;
+
+    MetricsGauge(const MetricsGauge&);
+    MetricsGauge& operator=(const MetricsGauge&);
+
+public:
+    MetricsGauge() : current(0) {}
+
+    void set(long long value) { current.store(value, std::memory_order_relaxed); }
+    void add(long long amount) { current.fetch_add(amount, std::memory_order_relaxed); }
+    long long value() const { return current.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @brief Distribution of durations in microseconds, e.g. query latency
+ *
+ * Buckets are log-linear: 1us, 2us, then every power of two split in two
+ * (3, 4, 6, 8, 12, 16, ... us) up to 2^27us (about 134 s), plus an
+ * overflow bucket, so any value is kept to within 50% with 55 counters.
+ * Recording is an index computation and two relaxed atomic adds on the
+ * caller's shard; nothing is allocated.
+ */
+class MetricsHistogram {
+public:
+    static const size_t BUCKETS = 55;    // The last one counts values above bucketBound(BUCKETS - 2)
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<unsigned long long> counts[BUCKETS];
+        std::atomic<unsigned long long> sum;
+    };
+    Shard shards[METRICS_SHARDS];
+
+    MetricsHistogram(const MetricsHistogram&);
+    MetricsHistogram& operator=(const MetricsHistogram&);
+
+public:
+    MetricsHistogram();
+
+    /**
+     * @brief Get the bucket a value is counted in
+     */
+    static size_t bucketFor(long long micros) {
+        if (micros <= 2) {
+            return micros <= 1 ? 0 : 1;
+        }
+        unsigned long long offset = static_cast<unsigned long long>(micros) - 1;
+        size_t magnitude = 63 - static_cast<size_t>(__builtin_clzll(offset));
+        size_t bucket = 2 + 2 * (magnitude - 1) + ((offset >> (magnitude - 1)) & 1);
+        return bucket < BUCKETS - 1 ? bucket : BUCKETS - 1;
+    }
+
+    /**
+     * @brief Get the largest value counted in a bucket (all but the last)
+     */
+    static long long bucketBound(size_t bucket);
+
+    /**
+     * @brief Count a duration
+     * @param micros Duration in microseconds; negative values count as 0
+     */
+    void record(long long micros) {
+        Shard& shard = shards[metricsShard()];
+        shard.counts[bucketFor(micros)].fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(micros > 0 ? static_cast<unsigned long long>(micros) : 0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sum the shards
+     * @param counts Set to the count of each bucket (not cumulative)
+     * @param sumMicros Set to the sum of the values recorded
+     * @return Number of values recorded
+     */
+    unsigned long long snapshot(std::vector<unsigned long long>& counts, unsigned long long& sumMicros) const;
+};
+
+/**
+ * @brief Records the time from construction to destruction into a histogram
+ */
+class MetricsTimer {
+private:
+    MetricsHistogram* histogram;
+    std::chrono::steady_clock::time_point start;
+
+    MetricsTimer(const MetricsTimer&);
+    MetricsTimer& operator=(const MetricsTimer&);
+
+public:
+    explicit MetricsTimer(MetricsHistogram* histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+
+    ~MetricsTimer() {
+        if (histogram) {
+            histogram->record(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+    }
+
+    /**
+     * @brief Record into another histogram, e.g. once the code path is known
+     * @param other Histogram to record into, nullptr to record nothing
+     */
+    void retarget(MetricsHistogram* other) { histogram = other; }
+};
+
+/**
+ * @brief Process-wide set of named metrics, exported as Prometheus text
+ *
+ * Metrics are registered once (usually into a namespace-scope pointer)
+ * and then updated through the pointer without touching the registry.
+ * Series of one name share a family, so the name, help and type are
+ * written once; each series is told apart by its labels, given
+ * pre-formatted (e.g. "loader=\"houses\""). Registering the same name and
+ * labels again returns the same metric. A name already used for another
+ * type gets a working metric that is left out of the export. Metrics are
+ * never freed.
+ *
+ * Histograms are recorded in microseconds and exported in seconds, as
+ * Prometheus expects.
+ */
+class MetricsRegistry {
+private:
+    enum Type {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM
+    };
+
+    struct Family {
+        Type type;
+        std::string help;
+        std::map<std::string, void*> series;    // Labels -> metric of the family's type
+    };
+
+    mutable std::mutex mutex;                   // Guards families (registration and export only)
+    std::map<std::string, Family> families;
+
+    MetricsRegistry() {}
+    MetricsRegistry(const MetricsRegistry&);
+    MetricsRegistry& operator=(const MetricsRegistry&);
+
+    /**
+     * @brief Find or add a family; called with mutex held
+     * @return nullptr if the name is taken by a family of another type
+     */
+    Family* familyFor(const std::string& name, const std::string& help, Type type);
+
+public:
+    /**
+     * @brief Get the registry shared by the whole process
+     */
+    static MetricsRegistry& instance();
+
+    /**
+     * @brief Register a counter
+     * @param name Metric name, ending in _total by convention
+     * @param help One-line description
+     * @param labels Pre-formatted labels, empty for none
+     * @return Counter, valid for the life of the process
+     */
+    MetricsCounter* counter(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /**
+     * @brief Register a gauge
+     * @return Gauge, valid for the life of the process
+     */
+    MetricsGauge* gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /**
+     * @brief Register a histogram of durations
+     * @param name Metric name, ending in _seconds by convention
+     * @return Histogram, valid for the life of the process
+     */
+    MetricsHistogram* histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /**
+     * @brief Write every metric in the Prometheus text format (version 0.0.4)
+     * @return Exposition text, families sorted by name
+     */
+    std::string exportText() const;
+
+    /**
+     * @brief Write exportText() to a file, replacing it atomically
+     * @param path File to write; a temporary file next to it is renamed over it
+     * @return true if written
+     */
+    bool writeFile(const std::string& path) const;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,91 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include "Metrics.h"
+#include "DBConfig.h"
+
+/**
+ * @brief Publishes a metrics registry from a background thread
+ *
+ * Either or both of:
+ *  - a small HTTP listener answering GET /metrics with the Prometheus
+ *    text, one request per connection, for a scraper on the same host;
+ *  - a file rewritten every interval (and once more on stop), for a
+ *    collector that tails files, e.g. the node exporter's textfile
+ *    directory.
+ *
+ * Export runs on the exporter's own thread and only reads the metrics,
+ * so it never slows down the threads recording them.
+ */
+class MetricsExporter {
+private:
+    MetricsRegistry& registry;
+    int listenFd;
+    int wakeFd;
+    std::string filePath;
+    std::chrono::milliseconds fileInterval;
+    std::thread worker;
+    std::string lastError;
+
+    MetricsExporter(const MetricsExporter&);
+    MetricsExporter& operator=(const MetricsExporter&);
+
+    /**
+     * @brief Exporter thread main loop
+     */
+    void exportLoop();
+
+    /**
+     * @brief Read one request from a connection and answer it
+     * @param fd Accepted connection (closed by the caller)
+     */
+    void serve(int fd);
+
+public:
+    /**
+     * @brief Constructor
+     * @param registry Registry to export
+     */
+    explicit MetricsExporter(MetricsRegistry& registry = MetricsRegistry::instance());
+
+    /**
+     * @brief Destructor; stops the exporter thread
+     */
+    ~MetricsExporter();
+
+    /**
+     * @brief Serve GET /metrics on a port (before start())
+     * @param host IPv4 address to bind
+     * @param port TCP port
+     * @return true if listening
+     */
+    bool listen(const std::string& host, int port);
+
+    /**
+     * @brief Write the metrics to a file periodically (before start())
+     * @param path File to replace on each write
+     * @param intervalMs Time between writes
+     */
+    void writeTo(const std::string& path, int intervalMs = DBConfig::METRICS_FILE_INTERVAL_MS);
+
+    /**
+     * @brief Start the exporter thread
+     * @return false if neither a port nor a file is set up
+     */
+    bool start();
+
+    /**
+     * @brief Stop and join the exporter thread, writing the file a last time
+     */
+    void stop();
+
+    /**
+     * @brief Get the last error message
+     */
+    std::string getLastError() const;
+};
+
+#endif // METRICS_EXPORTER_H
@@ -0,0 +1,93 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+/**
+ * @brief Unbounded lock-free multi-producer, single-consumer queue
+ *
+ * A linked list with a stub node (D. Vyukov's MPSC design). push() is one
+ * atomic exchange plus one store and never blocks, whatever the number of
+ * producers. pop() and empty() may only be called from the consumer thread.
+ *
+ * While a producer is between its exchange and its store, the consumer can
+ * briefly see the queue as empty; the item shows up on the next pop().
+ *
+ * @tparam T Value type; must be default- and move-constructible
+ */
+template <typename T>
+class MpscQueue {
+private:
+    struct Node {
+        std::atomic<Node*> next;
+        T value;
+
+        Node() : next(nullptr), value() {}
+        explicit Node(T&& item) : next(nullptr), value(std::move(item)) {}
+    };
+
+    std::atomic<Node*> head;  // Last pushed node, shared by producers
+    Node* tail;               // Consumed stub node, owned by the consumer
+
+    MpscQueue(const MpscQueue&);
+    MpscQueue& operator=(const MpscQueue&);
+
+public:
+    /**
+     * @brief Constructor
+     */
+    MpscQueue() {
+        Node* stub = new Node();
+        head.store(stub, std::memory_order_relaxed);
+        tail = stub;
+    }
+
+    /**
+     * @brief Destructor; discards any values still queued
+     */
+    ~MpscQueue() {
+        T discarded;
+        while (pop(discarded)) {
+        }
+        delete tail;
+    }
+
+    /**
+     * @brief Append a value (any thread)
+     * @param item Value to move into the queue
+     */
+    void push(T&& item) {
+        Node* node = new Node(std::move(item));
+        Node* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief Remove the oldest value (consumer thread only)
+     * @param out Receives the value
+     * @return true if a value was removed, false if the queue looked empty
+     */
+    bool pop(T& out) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+
+        // The popped node becomes the new stub
+        out = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+    /**
+     * @brief Check for queued values (consumer thread only)
+     * @return true if pop() would currently return false
+     */
+    bool empty() const {
+        return tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+};
+
+#endif // MPSC_QUEUE_H
@@ -1,6 +1,7 @@
 #ifndef PAYMENT_H
 #define PAYMENT_H
 
+#include <ostream>
 #include <string>
 #include "User.h"
 #include "House.h"
@@ -28,7 +29,15 @@ public:
     Payment(int id, int bookingId, double amount, const std::string& paymentMethod);
     
     /**
-     * @brief Generate and print receipt
+     * @brief Write the receipt text
+     * @param out Stream to write to
+     * @param user User who made the payment
+     * @param house House that was paid for
+     */
+    void formatReceipt(std::ostream& out, const User& user, const House& house) const;
+    
+    /**
+     * @brief Print the receipt and save it to <receipt number>.txt
      * @param user User who made the payment
      * @param house House that was paid for
      */
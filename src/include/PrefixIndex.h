@@ -0,0 +1,77 @@
+#ifndef PREFIX_INDEX_H
+#define PREFIX_INDEX_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Case-insensitive prefix lookup over a sorted array of keys
+ *
+ * Keys are lower-cased and stored back to back in one string; a sorted
+ * array of (offset, length, value) entries points into it. All keys with
+ * a given prefix are adjacent in sorted order, so a lookup is two binary
+ * searches and the matches are read off in alphabetical order.
+ *
+ * Keys are added unsorted and sort() must be called before lookups.
+ */
+class PrefixIndex {
+public:
+    typedef std::pair<size_t, size_t> EntryRange;  // [first, second)
+
+private:
+    struct Entry {
+        unsigned int offset;    // Start of the key in keys
+        unsigned int length;
+        size_t value;
+    };
+
+    std::string keys;
+    std::vector<Entry> entries;   // Sorted by key after sort()
+
+    /**
+     * @brief Orders entries by key
+     */
+    struct KeyLess {
+        const std::string* keys;
+        bool operator()(const Entry& a, const Entry& b) const;
+    };
+
+public:
+    /**
+     * @brief Remove all keys
+     */
+    void clear();
+
+    /**
+     * @brief Add a key
+     * @param key Key text (any case)
+     * @param value Value returned for the key
+     */
+    void add(const std::string& key, size_t value);
+
+    /**
+     * @brief Sort the keys added since the last sort
+     */
+    void sort();
+
+    /**
+     * @brief Find the entries whose key starts with a prefix
+     * @param prefix Prefix (any case); empty matches every entry
+     * @return Range of entry positions, in key order
+     */
+    EntryRange find(const std::string& prefix) const;
+
+    /**
+     * @brief Get the value of an entry
+     * @param position Entry position from find()
+     */
+    size_t value(size_t position) const { return entries[position].value; }
+
+    /**
+     * @brief Get the number of keys
+     */
+    size_t size() const { return entries.size(); }
+};
+
+#endif // PREFIX_INDEX_H
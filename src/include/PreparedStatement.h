@@ -0,0 +1,191 @@
+#ifndef PREPARED_STATEMENT_H
+#define PREPARED_STATEMENT_H
+
+#include <mysql/mysql.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Server-side prepared statement with typed parameters and row access
+ *
+ * Wraps a MYSQL_STMT that is prepared once and executed many times. Parameters
+ * are bound by position before each execute(); result columns are bound to
+ * reusable buffers sized from the statement metadata, so fetching rows does
+ * not allocate unless a value is larger than its declared column width.
+ */
+class PreparedStatement {
+public:
+    // my_bool in MySQL 5.7, bool in MySQL 8.0
+    typedef decltype(MYSQL_BIND::is_null_value) BindFlag;
+
+private:
+    struct Param {
+        long long intValue;
+        double doubleValue;
+        std::string textValue;
+        unsigned long length;
+        BindFlag isNull;
+    };
+
+    struct Column {
+        std::vector<char> buffer;
+        unsigned long length;
+        BindFlag isNull;
+        BindFlag error;
+    };
+
+    MYSQL_STMT* stmt;
+    std::string sql;
+    std::vector<Param> paramValues;
+    std::vector<MYSQL_BIND> params;
+    std::vector<Column> columnValues;
+    std::vector<MYSQL_BIND> columns;
+    bool hasResult;
+    bool needsResultBind;
+
+    /**
+     * @brief Size result buffers from the statement metadata
+     */
+    void setupColumns();
+
+    /**
+     * @brief Re-fetch columns whose value did not fit the bound buffer
+     */
+    void refetchTruncated();
+
+    // Statements own a server handle and cannot be copied
+    PreparedStatement(const PreparedStatement&);
+    PreparedStatement& operator=(const PreparedStatement&);
+
+public:
+    /**
+     * @brief Constructor
+     * @param conn Connection the statement belongs to
+     * @param sql SQL text with '?' placeholders
+     */
+    PreparedStatement(MYSQL* conn, const std::string& sql);
+
+    /**
+     * @brief Destructor closes the server-side statement
+     */
+    ~PreparedStatement();
+
+    /**
+     * @brief Prepare the statement on the server
+     * @return true if the statement was prepared
+     */
+    bool prepare();
+
+    /**
+     * @brief Get the SQL text of the statement
+     * @return SQL text
+     */
+    const std::string& getSql() const;
+
+    /**
+     * @brief Bind an integer parameter
+     * @param index Zero-based parameter position
+     * @param value Parameter value
+     */
+    void bindInt(unsigned int index, long long value);
+
+    /**
+     * @brief Bind a floating point parameter
+     * @param index Zero-based parameter position
+     * @param value Parameter value
+     */
+    void bindDouble(unsigned int index, double value);
+
+    /**
+     * @brief Bind a string parameter
+     * @param index Zero-based parameter position
+     * @param value Parameter value
+     */
+    void bindString(unsigned int index, const std::string& value);
+
+    /**
+     * @brief Bind SQL NULL to a parameter
+     * @param index Zero-based parameter position
+     */
+    void bindNull(unsigned int index);
+
+    /**
+     * @brief Execute the statement with the currently bound parameters
+     * @param buffered Buffer the whole result set on the client (frees the
+     *                 connection for other queries while rows are read)
+     * @return true if execution succeeded
+     */
+    bool execute(bool buffered = true);
+
+    /**
+     * @brief Fetch the next result row
+     * @return true if a row was fetched, false at end of data or on error
+     */
+    bool fetch();
+
+    /**
+     * @brief Release the current result set and any trailing results
+     */
+    void finish();
+
+    /**
+     * @brief Check whether a column of the current row is NULL
+     * @param column Zero-based column index
+     * @return true if the value is NULL
+     */
+    bool isNull(unsigned int column) const;
+
+    /**
+     * @brief Get a column of the current row as a C string
+     * @param column Zero-based column index
+     * @return Column text (empty string for NULL)
+     */
+    const char* getCString(unsigned int column) const;
+
+    /**
+     * @brief Get a column of the current row as a string
+     * @param column Zero-based column index
+     * @return Column text (empty string for NULL)
+     */
+    std::string getString(unsigned int column) const;
+
+    /**
+     * @brief Get a column of the current row as an integer
+     * @param column Zero-based column index
+     * @return Column value (0 for NULL)
+     */
+    int getInt(unsigned int column) const;
+
+    /**
+     * @brief Get a column of the current row as a double
+     * @param column Zero-based column index
+     * @return Column value (0.0 for NULL)
+     */
+    double getDouble(unsigned int column) const;
+
+    /**
+     * @brief Get the number of rows changed by the last execute
+     * @return Affected row count
+     */
+    unsigned long long affectedRows() const;
+
+    /**
+     * @brief Get the AUTO_INCREMENT value generated by the last execute
+     * @return Generated ID
+     */
+    unsigned long long insertId() const;
+
+    /**
+     * @brief Get the last statement error message
+     * @return Error message
+     */
+    std::string getError() const;
+
+    /**
+     * @brief Get the last statement error code
+     * @return MySQL error number
+     */
+    unsigned int getErrno() const;
+};
+
+#endif // PREPARED_STATEMENT_H
@@ -0,0 +1,91 @@
+#ifndef PRICE_INDEX_H
+#define PRICE_INDEX_H
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Ordered index of houses by one price (monthly rent or deposit)
+ *
+ * Keeps a price-ordered map over all indexed houses and one per town.
+ * Range queries binary-search the map and return an iterator range, so
+ * results can be read in price order without sorting; the cheapest k in
+ * a town are simply its first k entries. Insert and erase are O(log N).
+ */
+class PriceIndex {
+public:
+    typedef std::multimap<double, std::string> Entries;  // Price -> house ID
+    typedef Entries::const_iterator Iterator;
+    typedef std::pair<Iterator, Iterator> Range;
+
+private:
+    Entries all;
+    std::unordered_map<int, Entries> byTown;
+
+    /**
+     * @brief Entries with a price in [minPrice, maxPrice]; bounds <= 0 mean none
+     */
+    static Range rangeOf(const Entries& entries, double minPrice, double maxPrice);
+
+    /**
+     * @brief Remove one house from an entry map
+     */
+    static void eraseFrom(Entries& entries, double price, const std::string& houseId);
+
+public:
+    /**
+     * @brief Remove all entries
+     */
+    void clear();
+
+    /**
+     * @brief Add a house
+     * @param townId Town of the house
+     * @param price Indexed price
+     * @param houseId House ID
+     */
+    void insert(int townId, double price, const std::string& houseId);
+
+    /**
+     * @brief Remove a house; price and town must be the ones it was added with
+     * @param townId Town of the house
+     * @param price Indexed price
+     * @param houseId House ID
+     */
+    void erase(int townId, double price, const std::string& houseId);
+
+    /**
+     * @brief Get houses in a price range, cheapest first
+     * @param minPrice Lowest price, <= 0 for none
+     * @param maxPrice Highest price, <= 0 for none
+     * @return Iterator range over (price, house ID)
+     */
+    Range range(double minPrice, double maxPrice) const;
+
+    /**
+     * @brief Get a town's houses in a price range, cheapest first
+     * @param townId Town ID
+     * @param minPrice Lowest price, <= 0 for none
+     * @param maxPrice Highest price, <= 0 for none
+     * @return Iterator range over (price, house ID), empty for an unknown town
+     */
+    Range range(int townId, double minPrice, double maxPrice) const;
+
+    /**
+     * @brief Get the k cheapest houses in a town
+     * @param townId Town ID
+     * @param k Most houses returned
+     * @return House IDs, cheapest first
+     */
+    std::vector<std::string> cheapest(int townId, size_t k) const;
+
+    /**
+     * @brief Get the number of indexed houses
+     */
+    size_t size() const { return all.size(); }
+};
+
+#endif // PRICE_INDEX_H
@@ -0,0 +1,174 @@
+#ifndef RESERVATION_TABLE_H
+#define RESERVATION_TABLE_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Per-house reservation state shared by concurrent booking sessions
+ *
+ * Each house has one 64-bit atomic word: its state (free, held or
+ * booked), the token of the current hold and the second the hold lapses.
+ * A session claims a house with hold(), which succeeds for exactly one
+ * of any number of racing callers (compare-and-swap, no lock), books it
+ * in the database, then turns the hold into a booking with confirm() or
+ * gives it back with release(). A hold whose session never comes back
+ * lapses after its timeout and can be taken by the next caller.
+ *
+ * Houses live in an insert-only open-addressing table sized by reset()
+ * for the houses loaded. A lookup takes no lock; add() publishes a new
+ * house with a release store after filling its slot, so lookups see
+ * either no house or a complete one. Adds beyond the loaded size go to an
+ * overflow segment twice as large, linked after the last one; slots never
+ * move, so a word found once stays valid.
+ *
+ * hold, confirm, release, markBooked, markFree, state and add may be
+ * called from any thread at once (adds are serialized among themselves).
+ * reset frees the table and must not run concurrently with anything else.
+ */
+class ReservationTable {
+public:
+    enum State {
+        FREE = 0,
+        HELD = 1,
+        BOOKED = 2
+    };
+
+    typedef unsigned int Token;   // Identifies one hold; 0 is never a valid token
+
+private:
+    // Word layout: state in bits 62-63, token in bits 32-61, deadline in bits 0-31
+    static const int STATE_SHIFT = 62;
+    static const int TOKEN_SHIFT = 32;
+    static const unsigned long long TOKEN_MASK = (1ULL << 30) - 1;
+    static const unsigned long long DEADLINE_MASK = (1ULL << 32) - 1;
+
+    struct Slot {
+        std::string houseId;                       // Written before used is set, then never changed
+        std::atomic<unsigned long long> word;
+        std::atomic<bool> used;
+
+        Slot() : word(0), used(false) {}
+    };
+
+    struct Segment {
+        Slot* slots;
+        size_t mask;                               // Capacity - 1; capacity is a power of two
+        size_t count;                              // Used slots; only touched by add, under addMutex
+        std::atomic<Segment*> next;                // Overflow segment, published when this one is half full
+    };
+
+    Segment* segments;                             // First segment; replaced only by reset
+    Segment* lastSegment;                          // Where add inserts; guarded by addMutex
+    std::mutex addMutex;                           // Serializes add
+    std::atomic<size_t> houseCount;
+    std::atomic<Token> nextToken;
+    std::chrono::steady_clock::time_point epoch;
+
+    static unsigned long long pack(State state, Token token, unsigned long long deadline);
+    static State stateOf(unsigned long long word);
+    static Token tokenOf(unsigned long long word);
+    static unsigned long long deadlineOf(unsigned long long word);
+
+    /**
+     * @brief Seconds since the table was created
+     */
+    unsigned long long seconds() const;
+
+    /**
+     * @brief Allocate an empty segment
+     * @param capacity Slot count, a power of two
+     */
+    static Segment* newSegment(size_t capacity);
+
+    /**
+     * @brief Free every segment
+     */
+    void freeSegments();
+
+    /**
+     * @brief Find the word of a house
+     * @return Pointer to the word, nullptr if the house is unknown
+     */
+    std::atomic<unsigned long long>* find(const std::string& houseId);
+    const std::atomic<unsigned long long>* find(const std::string& houseId) const;
+
+    ReservationTable(const ReservationTable&);
+    ReservationTable& operator=(const ReservationTable&);
+
+public:
+    /**
+     * @brief Constructor; the table starts empty
+     */
+    ReservationTable();
+
+    /**
+     * @brief Destructor
+     */
+    ~ReservationTable();
+
+    /**
+     * @brief Forget all houses and size the table for a load
+     * @param expectedHouses Houses about to be added; more can be added later
+     */
+    void reset(size_t expectedHouses = 0);
+
+    /**
+     * @brief Add a house, or update a known one as markBooked / markFree do
+     * @param houseId House ID
+     * @param booked true if the house is booked, false if free
+     */
+    void add(const std::string& houseId, bool booked);
+
+    /**
+     * @brief Claim a free house (or one whose hold has lapsed) for a while
+     * @param houseId House ID
+     * @param holdSeconds How long the hold lasts unless confirmed or released
+     * @return Hold token, or 0 if the house is unknown, booked or held by someone else
+     */
+    Token hold(const std::string& houseId, int holdSeconds);
+
+    /**
+     * @brief Turn a hold into a booking, once the database booking has committed
+     * @param houseId House ID
+     * @param token Token returned by hold
+     * @return false if the hold had lapsed and was taken by someone else
+     */
+    bool confirm(const std::string& houseId, Token token);
+
+    /**
+     * @brief Give back a hold, e.g. when the database booking failed
+     * @param houseId House ID
+     * @param token Token returned by hold
+     * @return false if the hold had already lapsed and been taken
+     */
+    bool release(const std::string& houseId, Token token);
+
+    /**
+     * @brief Record that a house is booked, whatever its state
+     * @param houseId House ID
+     */
+    void markBooked(const std::string& houseId);
+
+    /**
+     * @brief Record that a booking ended; a hold in progress is left alone
+     * @param houseId House ID
+     */
+    void markFree(const std::string& houseId);
+
+    /**
+     * @brief Get the state of a house; a lapsed hold reads as free
+     * @param houseId House ID
+     * @return State, FREE for an unknown house
+     */
+    State state(const std::string& houseId) const;
+
+    /**
+     * @brief Get the number of houses
+     */
+    size_t size() const { return houseCount.load(); }
+};
+
+#endif // RESERVATION_TABLE_H
@@ -0,0 +1,41 @@
+#ifndef ROW_DECODER_H
+#define ROW_DECODER_H
+
+#include <mysql/mysql.h>
+#include "House.h"
+#include "User.h"
+
+/**
+ * @brief Decode a text-protocol row of the houses table
+ *
+ * Expected columns: house_id, house_type, town_id, house_address, map_link,
+ * deposit_fee, monthly_rent, is_available, is_booked, booked_until,
+ * latitude, longitude
+ *
+ * @param row Row returned by mysql_fetch_row
+ * @return Decoded House
+ */
+House decodeHouseRow(MYSQL_ROW row);
+
+/**
+ * @brief Decode a text-protocol row of a house search
+ *
+ * Expected columns: house_id, house_type, deposit, monthly_rent, town_id,
+ * address, map_link (the rental_cost join used by house searches)
+ *
+ * @param row Row returned by mysql_fetch_row
+ * @return Decoded House
+ */
+House decodeSearchRow(MYSQL_ROW row);
+
+/**
+ * @brief Decode a text-protocol row of the user_info table
+ *
+ * Expected columns: user_id, first_name, phone_number, email, password
+ *
+ * @param row Row returned by mysql_fetch_row
+ * @return Decoded User with its stored password hash
+ */
+User decodeUserRow(MYSQL_ROW row);
+
+#endif // ROW_DECODER_H
@@ -0,0 +1,216 @@
+#ifndef SNAPSHOT_CATALOG_H
+#define SNAPSHOT_CATALOG_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "House.h"
+#include "HouseCatalog.h"
+#include "TrigramIndex.h"
+#include "EpochManager.h"
+
+/**
+ * @brief One immutable version of the houses, partitioned by town
+ *
+ * Partitions are shared between versions: a change to one house copies
+ * only that house's town, and the other towns are reused as they are.
+ * The ID-to-position map is copied only when a house is added or moves.
+ *
+ * Each partition carries its own search indexes (a columnar catalog,
+ * type and address trigrams and the open houses by rent), built with
+ * the partition and as immutable as its houses, so searches can run on
+ * any thread without a lock.
+ */
+class CatalogSnapshot {
+public:
+    /**
+     * @brief Trigram indexes over a town's house types and addresses
+     *
+     * Document N is the town's house N.
+     */
+    struct TownText {
+        TrigramIndex types;
+        TrigramIndex addresses;
+    };
+
+    /**
+     * @brief The houses of one town in load order, with their search indexes
+     */
+    struct TownPartition {
+        int townId;
+        std::vector<House> houses;
+        HouseCatalog catalog;                      // Row N = houses[N]
+        std::shared_ptr<const TownText> text;      // Shared between versions until a type or address changes
+        std::vector<size_t> openByRent;            // Houses open for booking, cheapest first
+    };
+
+    /**
+     * @brief Where a house is: its town and its index among the town's houses
+     */
+    struct Position {
+        int townId;
+        size_t index;
+    };
+
+    typedef std::shared_ptr<const TownPartition> PartitionPtr;
+    typedef std::unordered_map<std::string, Position> PositionMap;
+
+private:
+    unsigned long long versionNumber;
+    std::vector<PartitionPtr> partitions;            // Sorted by town ID
+    std::shared_ptr<const PositionMap> positions;    // House ID -> position, shared until a house is added or moves
+
+    friend class SnapshotCatalog;
+
+    /**
+     * @brief Find the position of a town's partition
+     * @return Index into partitions, or partitions.size() if the town has none
+     */
+    size_t partitionIndex(int townId) const;
+
+public:
+    /**
+     * @brief Constructor for an empty version 0
+     */
+    CatalogSnapshot();
+
+    /**
+     * @brief Get the houses of a town
+     * @param townId Town ID
+     * @return Houses in load order, empty if the town has none
+     */
+    const std::vector<House>& town(int townId) const;
+
+    /**
+     * @brief Get the partition of a town
+     * @param townId Town ID
+     * @return Pointer into this snapshot, nullptr if the town has no houses
+     */
+    const TownPartition* townPartition(int townId) const;
+
+    /**
+     * @brief Find a house by ID
+     * @param houseId House ID
+     * @return Pointer into this snapshot, nullptr if not found
+     */
+    const House* findHouse(const std::string& houseId) const;
+
+    /**
+     * @brief Get all town partitions, sorted by town ID
+     */
+    const std::vector<PartitionPtr>& towns() const { return partitions; }
+
+    /**
+     * @brief Get the version number; each publish increments it
+     */
+    unsigned long long version() const { return versionNumber; }
+
+    /**
+     * @brief Get the number of houses
+     */
+    size_t houseCount() const { return positions->size(); }
+};
+
+/**
+ * @brief Versioned house catalog with lock-free readers
+ *
+ * The current CatalogSnapshot is published through an atomic pointer.
+ * A reader calls read(), which pins an epoch and loads the pointer; the
+ * snapshot stays valid and unchanged until the ReadGuard goes out of
+ * scope, whatever writers do meanwhile. Writers are serialized by a
+ * mutex, build the next version copy-on-write (each town a change
+ * touches, everything for a full publish), swap it in, and retire
+ * the old version to the EpochManager, which frees it once no reader
+ * can still hold it.
+ */
+class SnapshotCatalog {
+public:
+    /**
+     * @brief A pinned snapshot; movable, not copyable
+     */
+    class ReadGuard {
+        EpochManager* epochs;
+        int slot;
+        const CatalogSnapshot* snapshot;
+
+        friend class SnapshotCatalog;
+        ReadGuard(EpochManager* epochs, int slot, const CatalogSnapshot* snapshot);
+        ReadGuard(const ReadGuard&);
+        ReadGuard& operator=(const ReadGuard&);
+
+    public:
+        ReadGuard(ReadGuard&& other);
+        ~ReadGuard();
+
+        const CatalogSnapshot& operator*() const { return *snapshot; }
+        const CatalogSnapshot* operator->() const { return snapshot; }
+    };
+
+private:
+    mutable EpochManager epochs;
+    std::atomic<const CatalogSnapshot*> current;
+    std::mutex writerMutex;                   // One writer at a time
+
+    SnapshotCatalog(const SnapshotCatalog&);
+    SnapshotCatalog& operator=(const SnapshotCatalog&);
+
+    /**
+     * @brief Swap in a new version and retire the old one (writer lock held)
+     */
+    void swapIn(CatalogSnapshot* next);
+
+public:
+    /**
+     * @brief Constructor; starts with an empty snapshot
+     */
+    SnapshotCatalog();
+
+    /**
+     * @brief Destructor; no reader may still hold a guard
+     */
+    ~SnapshotCatalog();
+
+    /**
+     * @brief Pin and return the current snapshot; never blocks
+     */
+    ReadGuard read() const;
+
+    /**
+     * @brief Replace every house with a new version built from scratch
+     * @param houses Houses in load order
+     */
+    void publish(const std::vector<House>& houses);
+
+    /**
+     * @brief Add or replace one house, copying only the towns it is in
+     * @param house House as it should appear from the next version on
+     */
+    void putHouse(const House& house);
+
+    /**
+     * @brief Add or replace several houses in one new version
+     *
+     * Each town touched is copied and re-indexed once, and the ID-to-position
+     * map is copied once if any house is new or moves, however many houses
+     * the batch holds.
+     *
+     * @param batch Houses as they should appear from the next version on;
+     *              a later house with the same ID wins
+     */
+    void putHouses(const std::vector<House>& batch);
+
+    /**
+     * @brief Get the number of the current version
+     */
+    unsigned long long version() const;
+
+    /**
+     * @brief Get the number of old versions not freed yet
+     */
+    size_t retiredCount() const { return epochs.pendingCount(); }
+};
+
+#endif // SNAPSHOT_CATALOG_H
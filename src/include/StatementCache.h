@@ -0,0 +1,63 @@
+#ifndef STATEMENT_CACHE_H
+#define STATEMENT_CACHE_H
+
+#include <mysql/mysql.h>
+#include <string>
+#include <map>
+#include "PreparedStatement.h"
+
+/**
+ * @brief Per-connection cache of prepared statements keyed by SQL text
+ *
+ * Statements are prepared lazily the first time a query shape is requested
+ * and reused on every later call, so the server parses each shape once per
+ * connection instead of once per query.
+ */
+class StatementCache {
+private:
+    MYSQL* conn;
+    std::map<std::string, PreparedStatement*> statements;
+    std::string lastError;
+
+    // The cache owns its statements and cannot be copied
+    StatementCache(const StatementCache&);
+    StatementCache& operator=(const StatementCache&);
+
+public:
+    /**
+     * @brief Constructor
+     * @param conn Connection the cached statements are prepared on
+     */
+    explicit StatementCache(MYSQL* conn);
+
+    /**
+     * @brief Destructor closes every cached statement
+     */
+    ~StatementCache();
+
+    /**
+     * @brief Get a prepared statement, preparing it on first use
+     * @param sql SQL text with '?' placeholders
+     * @return Prepared statement, or nullptr if preparation failed
+     */
+    PreparedStatement* get(const std::string& sql);
+
+    /**
+     * @brief Close all cached statements (e.g. after the connection was reset)
+     */
+    void clear();
+
+    /**
+     * @brief Get the number of cached statements
+     * @return Cached statement count
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the error from the last failed preparation
+     * @return Error message
+     */
+    std::string getLastError() const;
+};
+
+#endif // STATEMENT_CACHE_H
@@ -0,0 +1,127 @@
+#ifndef SYNC_SERVICE_H
+#define SYNC_SERVICE_H
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "DBConnector.h"
+#include "DBConfig.h"
+#include "EntityStore.h"
+
+/**
+ * @brief Background delta sync of houses and bookings
+ *
+ * A sync thread polls the database every interval for rows whose
+ * updated_at is at or after the last change mark, and keeps the changed
+ * rows as pending patches. The owner of the EntityStore applies them with
+ * applyPending() from its own thread, so the store needs no locking and
+ * no full-table reload is ever done.
+ *
+ * Houses are synced in full. Changed bookings of all users go into the
+ * availability calendar; only the watched user's are also stored, since
+ * the store holds just the logged-in user's bookings.
+ * Patches are idempotent, so rows seen twice (the mark is set back by
+ * lagSeconds to catch late commits) do no harm. Deleted rows are not
+ * detected.
+ */
+class SyncService {
+public:
+    /**
+     * @brief Sync counters
+     */
+    struct Stats {
+        unsigned long long polls;          // Successful polls
+        unsigned long long failedPolls;    // Polls that will be retried from the same mark
+        unsigned long long housePatches;   // Changed house rows received
+        unsigned long long bookingPatches; // Changed booking rows received
+    };
+
+private:
+    DBConnector* db;
+    std::chrono::milliseconds interval;
+    int lagSeconds;
+
+    std::string mark;                  // Sync thread only once started
+    std::atomic<int> watchedUser;
+
+    std::mutex mutex;                  // Guards the pending patches and stopping
+    std::condition_variable wake;
+    bool stopping;
+    std::unordered_map<std::string, House> pendingHouses;
+    std::unordered_map<int, Booking> pendingBookings;
+    std::thread worker;
+
+    std::atomic<unsigned long long> pollCount;
+    std::atomic<unsigned long long> failedPollCount;
+    std::atomic<unsigned long long> housePatchCount;
+    std::atomic<unsigned long long> bookingPatchCount;
+
+    SyncService(const SyncService&);
+    SyncService& operator=(const SyncService&);
+
+    /**
+     * @brief Sync thread main loop
+     */
+    void syncLoop();
+
+    /**
+     * @brief Fetch the changes since the mark and queue them as patches
+     * @return true if the mark was advanced
+     */
+    bool pollOnce();
+
+public:
+    /**
+     * @brief Constructor
+     * @param db Connected database connector (not owned)
+     * @param intervalMs Time between polls
+     * @param lagSeconds How far each change mark is set back
+     */
+    SyncService(DBConnector* db, int intervalMs = DBConfig::SYNC_INTERVAL_MS,
+                int lagSeconds = DBConfig::SYNC_LAG_SECONDS);
+
+    /**
+     * @brief Destructor; stops the sync thread
+     */
+    ~SyncService();
+
+    /**
+     * @brief Take the first change mark and start the sync thread
+     *
+     * Call this before the initial load, so that nothing changed between
+     * the load and the first poll is missed.
+     *
+     * @return true if the mark could be taken
+     */
+    bool start();
+
+    /**
+     * @brief Stop and join the sync thread; pending patches are kept
+     */
+    void stop();
+
+    /**
+     * @brief Set the user whose bookings are synced
+     * @param userId User ID, or 0 to sync no bookings
+     */
+    void watchUser(int userId);
+
+    /**
+     * @brief Apply the pending patches to a store
+     * @param store Store to update (caller's thread)
+     * @return Number of houses and bookings updated
+     */
+    size_t applyPending(EntityStore& store);
+
+    /**
+     * @brief Get a snapshot of the sync counters
+     * @return Current counters
+     */
+    Stats getStats() const;
+};
+
+#endif // SYNC_SERVICE_H
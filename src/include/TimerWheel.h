@@ -0,0 +1,80 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Hierarchical timing wheel of one-second ticks
+ *
+ * Five levels of 64 slots each. Level 0 holds timers due within 64 ticks,
+ * one slot per tick; each higher level covers 64 times the span of the
+ * one below. When level 0 wraps, the next slot of level 1 is cascaded
+ * down (and so on upwards), so every timer is moved at most four times
+ * before it fires. Scheduling is O(1) and advancing costs O(1) per tick
+ * plus the timers fired or cascaded, however many timers are pending.
+ *
+ * Timers further out than the wheel's span (2^30 ticks, about 34 years)
+ * are parked in the last slot and rescheduled when they come round.
+ * Timers due before the next unprocessed tick fire on the next advance.
+ */
+class TimerWheel {
+public:
+    /**
+     * @brief One pending timer
+     */
+    struct Timer {
+        long long due;          // Time in seconds (parseDateTime scale)
+        int id;
+    };
+
+private:
+    static const int LEVELS = 5;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const long long SLOT_MASK = SLOTS - 1;
+
+    std::vector<Timer> slots[LEVELS][SLOTS];
+    std::vector<Timer> overdue; // Scheduled for ticks already processed
+    long long current;          // Next tick to process
+    size_t timerCount;
+
+    /**
+     * @brief Place a timer in the slot for its due tick
+     */
+    void place(const Timer& timer);
+
+    /**
+     * @brief Move the timers of one higher-level slot down
+     * @return Slot index that was cascaded
+     */
+    int cascade(int level);
+
+public:
+    /**
+     * @brief Constructor
+     * @param start Current time; timers due before it fire on the first advance
+     */
+    explicit TimerWheel(long long start = 0);
+
+    /**
+     * @brief Add a timer
+     * @param id Caller's ID for the timer (not required to be unique)
+     * @param due Time at which it fires
+     */
+    void schedule(int id, long long due);
+
+    /**
+     * @brief Move the wheel forward to a time and collect the timers due
+     * @param now Current time; going backwards is a no-op
+     * @param fired Receives the timers due at or before now (appended)
+     */
+    void advance(long long now, std::vector<Timer>& fired);
+
+    /**
+     * @brief Get the number of pending timers
+     */
+    size_t size() const { return timerCount; }
+};
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,95 @@
+#ifndef TRIGRAM_INDEX_H
+#define TRIGRAM_INDEX_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Case-insensitive trigram index for substring search
+ *
+ * Every three-character window of a document's (lower-cased) text maps to
+ * the documents that contain it. A pattern of three or more characters
+ * can only occur in documents that contain all of its trigrams, so the
+ * candidates are the intersection of those posting lists, starting from
+ * the shortest. Candidates still need to be verified against the text,
+ * since the trigrams may occur in a different order.
+ *
+ * Posting lists are sorted document IDs stored as varint-encoded gaps,
+ * usually one byte per entry. Documents must be added in ascending ID order.
+ */
+class TrigramIndex {
+private:
+    struct PostingList {
+        std::vector<unsigned char> bytes;  // Varint gaps between document IDs
+        unsigned int lastDoc;
+        unsigned int count;
+    };
+
+    std::unordered_map<unsigned int, PostingList> postings;  // Packed trigram -> documents
+    unsigned int documentCount;
+
+    /**
+     * @brief Append a document to a posting list (IDs must increase)
+     */
+    static void append(PostingList& list, unsigned int docId);
+
+    /**
+     * @brief Decode a posting list into document IDs
+     */
+    static void decode(const PostingList& list, std::vector<unsigned int>& docs);
+
+    /**
+     * @brief Keep only the documents of docs that are also in list
+     */
+    static void intersect(std::vector<unsigned int>& docs, const PostingList& list);
+
+    /**
+     * @brief Collect the distinct packed trigrams of lower-cased text
+     */
+    static void trigramsOf(const std::string& folded, std::vector<unsigned int>& trigrams);
+
+public:
+    /**
+     * @brief Constructor
+     */
+    TrigramIndex();
+
+    /**
+     * @brief Remove all documents
+     */
+    void clear();
+
+    /**
+     * @brief Index a document
+     * @param docId Document ID, greater than any added before
+     * @param text Document text
+     */
+    void add(unsigned int docId, const std::string& text);
+
+    /**
+     * @brief Check whether a pattern is long enough for the index to narrow a search
+     */
+    static bool indexable(const std::string& pattern) { return pattern.length() >= 3; }
+
+    /**
+     * @brief Find the documents that may contain a pattern
+     * @param pattern Substring to look for (any case)
+     * @param docs Receives candidate document IDs in ascending order
+     * @return false if the pattern is shorter than a trigram, so the index
+     *         cannot narrow the search and every document is a candidate
+     */
+    bool candidates(const std::string& pattern, std::vector<unsigned int>& docs) const;
+
+    /**
+     * @brief Get the number of documents added
+     */
+    unsigned int size() const { return documentCount; }
+
+    /**
+     * @brief Get the bytes used by the encoded posting lists
+     */
+    size_t postingBytes() const;
+};
+
+#endif // TRIGRAM_INDEX_H
@@ -8,6 +8,7 @@
  */
 class User {
 private:
+    int id;                 // user_id in the database, 0 until stored
     std::string name;
     std::string phone;
     std::string email;
@@ -55,6 +56,12 @@ public:
      */
     bool isAuthenticated() const;
     
+    /**
+     * @brief Get user's database ID
+     * @return User ID, 0 if the user is not stored yet
+     */
+    int getId() const;
+    
     /**
      * @brief Get user's name
      * @return User's name
@@ -79,6 +86,12 @@ public:
      */
     std::string getPassword() const;
     
+    /**
+     * @brief Set user's database ID
+     * @param id User ID
+     */
+    void setId(int id);
+    
     /**
      * @brief Set user's name
      * @param name User's name
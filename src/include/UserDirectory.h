@@ -0,0 +1,61 @@
+#ifndef USER_DIRECTORY_H
+#define USER_DIRECTORY_H
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include "User.h"
+
+/**
+ * @brief Bounded, email-keyed cache of user records
+ *
+ * Users are loaded on demand (e.g. with DBConnector::loadUserByEmail) and
+ * kept in least-recently-used order; adding a user to a full directory
+ * drops the one used longest ago. Emails are case-folded, so lookups
+ * ignore case like the login check does.
+ *
+ * Pointers returned by find and put stay valid until that user is evicted
+ * or removed.
+ */
+class UserDirectory {
+private:
+    typedef std::list<User> UserList;
+
+    size_t capacity;
+    UserList entries;                                          // Most recently used first
+    std::unordered_map<std::string, UserList::iterator> byEmail;  // Case-folded email -> entry
+
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Most users kept (at least 1)
+     */
+    explicit UserDirectory(size_t capacity);
+
+    /**
+     * @brief Find a cached user and mark it as recently used
+     * @param email Email address (any case)
+     * @return Pointer to the user, nullptr if not cached
+     */
+    User* find(const std::string& email);
+
+    /**
+     * @brief Add or replace a user, evicting the least recently used one if full
+     * @param user User to cache
+     * @return Pointer to the cached copy
+     */
+    User* put(const User& user);
+
+    /**
+     * @brief Drop a user from the cache
+     * @param email Email address (any case)
+     */
+    void remove(const std::string& email);
+
+    /**
+     * @brief Get the number of cached users
+     */
+    size_t size() const { return entries.size(); }
+};
+
+#endif // USER_DIRECTORY_H
@@ -9,6 +9,20 @@
  */
 std::string getCurrentDateTime();
 
+/**
+ * @brief Parse a date as stored in the database
+ *
+ * Accepts "YYYY-MM-DD HH:MM:SS" (fractional seconds ignored) or
+ * "YYYY-MM-DD" (midnight). The result counts seconds on the same clock as
+ * the text, with no time zone conversion, so values parsed from the same
+ * source can be compared and subtracted.
+ *
+ * @param text Date text
+ * @param seconds Receives seconds since 1970-01-01 00:00:00
+ * @return false if the text is not a valid date
+ */
+bool parseDateTime(const std::string& text, long long& seconds);
+
 /**
  * @brief Generate a unique receipt number
  * @return Receipt number string
@@ -38,4 +52,19 @@ bool verifyPassword(const std::string& password, const std::string& hashedPasswo
  */
 bool equalsIgnoreCase(const std::string& str1, const std::string& str2);
 
+/**
+ * @brief Convert a string to lower case
+ * @param str String to convert
+ * @return Lower-case copy, e.g. for case-insensitive map keys
+ */
+std::string toLowerCase(const std::string& str);
+
+/**
+ * @brief Check whether text contains a pattern, ignoring case
+ * @param text Text to search
+ * @param pattern Substring to look for; an empty pattern always matches
+ * @return true if found
+ */
+bool containsIgnoreCase(const std::string& text, const std::string& pattern);
+
 #endif // UTILS_H
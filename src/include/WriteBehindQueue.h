@@ -0,0 +1,174 @@
+#ifndef WRITE_BEHIND_QUEUE_H
+#define WRITE_BEHIND_QUEUE_H
+
+#include <string>
+#include <vector>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include "DBConnector.h"
+#include "DBConfig.h"
+#include "MpscQueue.h"
+
+/**
+ * @brief Asynchronous group-commit writer for bookings and payments
+ *
+ * Callers enqueue write intents from any thread and get a future back
+ * straight away. A single writer thread drains the queues and hands each
+ * batch to DBConnector::bookHouses / recordPayments, so many small writes
+ * share one transaction and one commit. A batch is flushed when it reaches
+ * maxBatch intents or when its first intent has waited maxLingerMs.
+ *
+ * If a batch fails, its intents are retried one at a time so that a single
+ * bad row does not fail the writes it was grouped with.
+ *
+ * The queue is opt-in: the console and the HTTP API book and pay through
+ * DBConnector directly, since they answer with each write's outcome.
+ */
+class WriteBehindQueue {
+public:
+    /**
+     * @brief Writer counters
+     */
+    struct Stats {
+        unsigned long long bookings;       // Booking intents written
+        unsigned long long payments;       // Payment intents written
+        unsigned long long commits;        // Batch transactions committed
+        unsigned long long failedBatches;  // Batches that fell back to single writes
+        unsigned long long largestBatch;
+    };
+
+private:
+    struct BookingIntent {
+        DBConnector::BookingRequest request;
+        std::promise<DBConnector::BookingResult> result;
+    };
+
+    struct PaymentIntent {
+        DBConnector::PaymentRequest request;
+        std::promise<std::string> receipt;
+    };
+
+    DBConnector* db;
+    size_t maxBatch;
+    std::chrono::milliseconds maxLinger;
+
+    MpscQueue<BookingIntent> bookingQueue;
+    MpscQueue<PaymentIntent> paymentQueue;
+
+    // The writer sleeps on wake only when both queues are empty;
+    // producers take the mutex just to notify a sleeping writer
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<bool> writerSleeping;
+    std::atomic<bool> accepting;
+    std::atomic<unsigned> enqueuing;       // Producers between checking accepting and pushing
+    std::atomic<bool> stopping;
+    std::thread writer;
+
+    std::atomic<unsigned long long> bookingCount;
+    std::atomic<unsigned long long> paymentCount;
+    std::atomic<unsigned long long> commitCount;
+    std::atomic<unsigned long long> failedBatchCount;
+    std::atomic<unsigned long long> largestBatch;
+
+    WriteBehindQueue(const WriteBehindQueue&);
+    WriteBehindQueue& operator=(const WriteBehindQueue&);
+
+    /**
+     * @brief Writer thread main loop
+     */
+    void writerLoop();
+
+    /**
+     * @brief Wake the writer if it is waiting for work
+     */
+    void notifyWriter();
+
+    /**
+     * @brief Block the writer until work arrives, shutdown starts or the deadline passes
+     */
+    void waitForWork(std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * @brief Check both queues (writer thread only)
+     */
+    bool queuesEmpty() const;
+
+    /**
+     * @brief Fail every intent still queued once the writer has exited
+     *
+     * A producer that saw accepting just before shutdown() may push after
+     * the writer's last look at the queues; its future must still be set.
+     */
+    void failLeftovers();
+
+    /**
+     * @brief Write one batch of bookings and fulfil their futures
+     */
+    void flushBookings(std::vector<BookingIntent>& batch);
+
+    /**
+     * @brief Write one batch of payments and fulfil their futures
+     */
+    void flushPayments(std::vector<PaymentIntent>& batch);
+
+public:
+    /**
+     * @brief Constructor
+     * @param db Connected database connector (not owned)
+     * @param maxBatch Most intents written in one transaction
+     * @param maxLingerMs Longest time an intent waits for its batch to fill
+     */
+    WriteBehindQueue(DBConnector* db, size_t maxBatch = DBConfig::WRITE_BEHIND_MAX_BATCH,
+                     int maxLingerMs = DBConfig::WRITE_BEHIND_LINGER_MS);
+
+    /**
+     * @brief Destructor; flushes pending writes
+     */
+    ~WriteBehindQueue();
+
+    /**
+     * @brief Start the writer thread
+     */
+    void start();
+
+    /**
+     * @brief Stop accepting writes, flush everything queued and join the writer
+     *
+     * Writes enqueued after shutdown() get an immediate failure result, as
+     * do writes that raced with it and reached the queue after the writer
+     * exited.
+     */
+    void shutdown();
+
+    /**
+     * @brief Queue a booking
+     * @param userId User making the booking
+     * @param houseId House being booked
+     * @param townId Town where house is located
+     * @return Future result, as from DBConnector::bookHouse
+     */
+    std::future<DBConnector::BookingResult> enqueueBooking(int userId, const std::string& houseId, int townId);
+
+    /**
+     * @brief Queue a payment
+     * @param userId User paying; the booking must be theirs
+     * @param bookingId Booking that is being paid for
+     * @param amount Payment amount
+     * @param paymentMethod Method of payment
+     * @return Future receipt number, empty if the payment failed or the
+     *         booking is not the user's or is already paid
+     */
+    std::future<std::string> enqueuePayment(int userId, int bookingId, double amount, const std::string& paymentMethod);
+
+    /**
+     * @brief Get writer counters
+     * @return Snapshot of the counters
+     */
+    Stats getStats() const;
+};
+
+#endif // WRITE_BEHIND_QUEUE_H
@@ -0,0 +1,211 @@
+#ifndef ASYNC_DB_CONNECTOR_H
+#define ASYNC_DB_CONNECTOR_H
+
+#include <mysql/mysql.h>
+#include <coroutine>
+#include <deque>
+#include <string>
+#include <vector>
+#include "../House.h"
+#include "../DBConnector.h"
+#include "../DBConfig.h"
+#include "Reactor.h"
+#include "Task.h"
+
+/**
+ * @brief Coroutine-based database connector (C++20, MySQL 8.0.16+)
+ *
+ * Uses libmysqlclient's nonblocking API, so a coroutine waiting for a
+ * query result is suspended in the Reactor instead of blocking the thread.
+ * The connector keeps a fixed set of connections. Each connection runs one
+ * query at a time, so up to that many queries are in flight at once, and
+ * further callers wait for a free connection.
+ *
+ * The nonblocking API has no prepared statement support, so values are
+ * escaped with mysql_real_escape_string and sent as text queries.
+ * All methods must be called on the reactor's thread.
+ */
+class AsyncDBConnector {
+private:
+    /**
+     * @brief Awaiter that hands out an idle connection or queues the caller
+     */
+    struct ConnectionAwaiter {
+        AsyncDBConnector* db;
+        MYSQL* connection;
+        std::coroutine_handle<> waiting;
+
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> caller);
+        MYSQL* await_resume() const noexcept { return connection; }
+    };
+
+    /**
+     * @brief Returns a checked-out connection when it goes out of scope
+     */
+    class Lease {
+    private:
+        AsyncDBConnector* db;
+        MYSQL* connection;
+
+    public:
+        Lease(AsyncDBConnector* db, MYSQL* connection) : db(db), connection(connection) {}
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { db->release(connection); }
+
+        MYSQL* mysql() const { return connection; }
+    };
+
+    Reactor& reactor;
+    std::string host;
+    std::string user;
+    std::string password;
+    std::string database;
+
+    std::vector<MYSQL*> connections;
+    std::vector<MYSQL*> idle;
+    std::deque<ConnectionAwaiter*> waiters;
+
+    size_t inFlight;
+    size_t peakInFlight;
+    std::string lastError;
+
+    AsyncDBConnector(const AsyncDBConnector&) = delete;
+    AsyncDBConnector& operator=(const AsyncDBConnector&) = delete;
+
+    /**
+     * @brief Open one blocking-mode connection
+     * @return Connection, or nullptr on failure
+     */
+    MYSQL* openConnection();
+
+    /**
+     * @brief Wait for an idle connection
+     */
+    ConnectionAwaiter checkout() { return ConnectionAwaiter{this, nullptr, nullptr}; }
+
+    /**
+     * @brief Return a connection, handing it straight to the oldest waiter
+     */
+    void release(MYSQL* connection);
+
+    /**
+     * @brief Send a query and wait for the server to accept and answer it
+     * @param mysql Connection to use
+     * @param sql SQL text
+     * @return true if the query succeeded
+     */
+    Task<bool> query(MYSQL* mysql, const std::string& sql);
+
+    /**
+     * @brief Read the whole result set of the last query
+     * @param mysql Connection the query ran on
+     * @return Result (caller frees it), or nullptr if there is none or on error
+     */
+    Task<MYSQL_RES*> storeResult(MYSQL* mysql);
+
+    /**
+     * @brief Read and discard any further results (e.g. after a CALL)
+     * @param mysql Connection the query ran on
+     * @return true if all results were read without error
+     */
+    Task<bool> drainResults(MYSQL* mysql);
+
+    /**
+     * @brief Run a query and decode every house row of its result
+     */
+    Task<std::vector<House> > queryHouses(const std::string& sql, House (*decode)(MYSQL_ROW));
+
+    /**
+     * @brief Quote a string value for SQL text
+     */
+    std::string quote(MYSQL* mysql, const std::string& value) const;
+
+    /**
+     * @brief Record a query failure
+     */
+    void setError(MYSQL* mysql, const std::string& context);
+
+public:
+    /**
+     * @brief Constructor
+     * @param reactor Event loop that resumes suspended queries
+     */
+    explicit AsyncDBConnector(Reactor& reactor);
+
+    /**
+     * @brief Destructor
+     */
+    ~AsyncDBConnector();
+
+    /**
+     * @brief Open the connections (blocking; done once at startup)
+     * @param host Database host
+     * @param user Database username
+     * @param password Database password
+     * @param db Database name
+     * @param connectionCount Most queries kept in flight
+     * @return true if every connection was opened
+     */
+    bool connect(const std::string& host, const std::string& user,
+                 const std::string& password, const std::string& db,
+                 size_t connectionCount = DBConfig::ASYNC_CONNECTIONS);
+
+    /**
+     * @brief Close all connections; no query may be in flight
+     */
+    void disconnect();
+
+    /**
+     * @brief Get the last error message
+     * @return The last error message
+     */
+    std::string getLastError() const;
+
+    /**
+     * @brief Get the largest number of queries that were in flight at once
+     * @return Peak in-flight count
+     */
+    size_t getPeakInFlight() const;
+
+    /**
+     * @brief Load houses in a town
+     * @param townId Town ID
+     * @return Houses, empty on error
+     */
+    Task<std::vector<House> > loadHouses(int townId);
+
+    /**
+     * @brief Search for houses; same filters as DBConnector::searchHouses
+     * @param type House type (optional)
+     * @param minRent Minimum monthly rent (optional)
+     * @param maxRent Maximum monthly rent (optional)
+     * @param townId Town ID (optional)
+     * @return Matching houses, empty on error
+     */
+    Task<std::vector<House> > searchHouses(std::string type = "", double minRent = 0.0,
+                                           double maxRent = -1.0, int townId = -1);
+
+    /**
+     * @brief Atomically claim a house and book it (the book_house procedure)
+     * @param userId User making the booking
+     * @param houseId House being booked
+     * @param townId Town where house is located
+     * @return Same result as DBConnector::bookHouse
+     */
+    Task<DBConnector::BookingResult> createBooking(int userId, std::string houseId, int townId);
+
+    /**
+     * @brief Claim a booking as paid and record its payment, as DBConnector::recordPayment
+     * @param userId User paying; the booking must be theirs
+     * @param bookingId Booking that is being paid for
+     * @param amount Payment amount
+     * @param paymentMethod Method of payment
+     * @return Receipt number, empty string if failed or the booking is not
+     *         the user's or is already paid
+     */
+    Task<std::string> recordPayment(int userId, int bookingId, double amount, std::string paymentMethod);
+};
+
+#endif // ASYNC_DB_CONNECTOR_H
@@ -0,0 +1,95 @@
+#ifndef ASYNC_REACTOR_H
+#define ASYNC_REACTOR_H
+
+#include <coroutine>
+#include <deque>
+#include <string>
+#include "Task.h"
+
+/**
+ * @brief Single-threaded epoll event loop for coroutines (C++20)
+ *
+ * Coroutines suspend on readable(fd) and are resumed by run() when the
+ * descriptor has data. Any number of coroutines can be suspended at once,
+ * each on its own descriptor, so one thread can keep many queries in
+ * flight. Nothing here is thread-safe: spawn, post and run must all be
+ * called from the thread that runs the loop.
+ */
+class Reactor {
+public:
+    /**
+     * @brief Awaiter returned by readable()
+     */
+    struct ReadableAwaiter {
+        Reactor* reactor;
+        int fd;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> waiting) { reactor->watch(fd, waiting); }
+        void await_resume() const noexcept {}
+    };
+
+private:
+    int epollFd;
+    size_t liveTasks;     // Spawned tasks that have not finished
+    size_t watchedFds;    // Coroutines suspended in epoll
+    std::deque<std::coroutine_handle<> > ready;
+    std::string lastError;
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    /**
+     * @brief Resume a coroutine once fd becomes readable
+     */
+    void watch(int fd, std::coroutine_handle<> waiting);
+
+public:
+    /**
+     * @brief Constructor
+     */
+    Reactor();
+
+    /**
+     * @brief Destructor
+     */
+    ~Reactor();
+
+    /**
+     * @brief Suspend the calling coroutine until fd is readable
+     * @param fd Socket to wait on
+     * @return Awaitable
+     */
+    ReadableAwaiter readable(int fd) { return ReadableAwaiter{this, fd}; }
+
+    /**
+     * @brief Start a task; it runs until its first suspension right away
+     * @param task Task to run; it is owned by the reactor until it finishes
+     */
+    void spawn(Task<void> task);
+
+    /**
+     * @brief Queue a suspended coroutine to be resumed by the loop
+     * @param waiting Coroutine to resume
+     */
+    void post(std::coroutine_handle<> waiting);
+
+    /**
+     * @brief Run the loop until every spawned task has finished
+     * @return true on success, false if epoll failed or tasks were left stuck
+     */
+    bool run();
+
+    /**
+     * @brief Called by spawned tasks when they finish
+     */
+    void taskFinished();
+
+    /**
+     * @brief Get the last error message
+     * @return Description of the last epoll failure
+     */
+    std::string getLastError() const;
+};
+
+#endif // ASYNC_REACTOR_H
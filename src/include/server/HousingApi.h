@@ -0,0 +1,153 @@
+#ifndef SERVER_HOUSING_API_H
+#define SERVER_HOUSING_API_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "HttpMessage.h"
+#include "../EntityStore.h"
+#include "../User.h"
+
+// Forward declarations
+class DBConnector;
+class SyncService;
+class ExpiryService;
+
+/**
+ * @brief The housing system as a JSON API, for HttpServer
+ *
+ * Routes (bodies are flat JSON objects; "auth" routes need an
+ * "Authorization: Bearer <token>" header from POST /sessions or POST /users):
+ *
+ *   GET    /health                     houses loaded and snapshot version
+ *   GET    /metrics                    process metrics, Prometheus text format
+ *   GET    /counties                   counties in load order
+ *   GET    /counties/{id}/towns        towns of a county
+ *   GET    /towns/{id}/houses          listed houses of a town
+ *   GET    /houses/{id}                one house
+ *   GET    /houses?type=&address=&town=&min_rent=&max_rent=&move_in=&limit=
+ *                                      houses open for booking (or free for
+ *                                      a booking period from move_in)
+ *   POST   /users                      {name, phone, email, password}
+ *   POST   /sessions                   {email, password}; the token is logged
+ *                                      out after SESSION_IDLE_TIMEOUT_SECONDS
+ *                                      without use
+ *   DELETE /sessions                   auth; logs the token out
+ *   GET    /bookings                   auth; the user's bookings
+ *   POST   /bookings                   auth; {house_id}
+ *   POST   /payments                   auth; {booking_id, method}
+ *
+ * handle() runs on many worker threads at once. Listings, single house
+ * reads and house searches go through the store's snapshots and take no
+ * lock. Everything that changes the store (bookings, payments, sync and
+ * expiry patches) and the reads that are not snapshot-safe (move-in date
+ * searches, which use the availability calendar) are serialized by one
+ * store mutex, held only around in-memory work, never across a database
+ * call. Reservation holds go straight to the store's ReservationTable and
+ * take no lock.
+ */
+class HousingApi {
+private:
+    struct Session {
+        int userId;
+        std::string email;
+        std::string name;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    DBConnector* db;
+    SyncService* syncService;          // nullptr if it could not start
+    ExpiryService* expiryService;      // nullptr if it could not start
+
+    EntityStore store;
+    std::mutex storeMutex;             // Serializes store writers and non-snapshot reads
+
+    std::mutex sessionMutex;           // Guards sessions and nextSessionSweep
+    std::unordered_map<std::string, Session> sessions;   // Token -> user
+    std::chrono::steady_clock::time_point nextSessionSweep;
+
+    std::string lastError;
+
+    HousingApi(const HousingApi&);
+    HousingApi& operator=(const HousingApi&);
+
+    /**
+     * @brief Load locations, houses and current bookings into the store
+     */
+    void loadData();
+
+    /**
+     * @brief Look up the session named by the Authorization header
+     * @return false (with a 401 response) if there is none
+     */
+    bool authenticate(const HttpRequest& request, Session& session, HttpResponse& response);
+
+    /**
+     * @brief Parse the request body as a flat JSON object
+     * @return false (with a 400 response) if it is not one
+     */
+    bool readBody(const HttpRequest& request, std::map<std::string, std::string>& fields, HttpResponse& response);
+
+    /**
+     * @brief Start a session for a user and answer with its token
+     */
+    void openSession(const User& user, int status, HttpResponse& response);
+
+    /**
+     * @brief Drop sessions idle for SESSION_IDLE_TIMEOUT_SECONDS, at most once per sweep interval
+     */
+    void sweepSessions();
+
+    void health(HttpResponse& response);
+    void exportMetrics(HttpResponse& response);
+    void listCounties(HttpResponse& response);
+    void listTowns(int countyId, HttpResponse& response);
+    void listTownHouses(int townId, HttpResponse& response);
+    void getHouse(const std::string& houseId, HttpResponse& response);
+    void searchHouses(const HttpRequest& request, HttpResponse& response);
+    void registerUser(const HttpRequest& request, HttpResponse& response);
+    void login(const HttpRequest& request, HttpResponse& response);
+    void logout(const HttpRequest& request, HttpResponse& response);
+    void listBookings(const Session& session, HttpResponse& response);
+    void createBooking(const Session& session, const HttpRequest& request, HttpResponse& response);
+    void createPayment(const Session& session, const HttpRequest& request, HttpResponse& response);
+
+public:
+    /**
+     * @brief Constructor; call start() before serving
+     */
+    HousingApi();
+
+    /**
+     * @brief Destructor; stops the background services and disconnects
+     */
+    ~HousingApi();
+
+    /**
+     * @brief Connect to the database, load the data and start sync and expiry
+     * @return false if the database is unavailable; see getLastError
+     */
+    bool start();
+
+    /**
+     * @brief Answer one request; safe to call from several threads at once
+     * @param request Parsed request
+     * @param response Receives status and JSON body
+     */
+    void handle(const HttpRequest& request, HttpResponse& response);
+
+    /**
+     * @brief Apply pending sync and expiry patches to the store and drop idle sessions
+     */
+    void applyPending();
+
+    /**
+     * @brief Get the last error message
+     */
+    std::string getLastError() const;
+};
+
+#endif // SERVER_HOUSING_API_H
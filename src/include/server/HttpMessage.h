@@ -0,0 +1,98 @@
+#ifndef SERVER_HTTP_MESSAGE_H
+#define SERVER_HTTP_MESSAGE_H
+
+#include <map>
+#include <string>
+
+/**
+ * @brief A parsed HTTP/1.x request
+ */
+struct HttpRequest {
+    std::string method;                          // e.g. "GET"
+    std::string path;                            // Target without the query, not decoded
+    std::map<std::string, std::string> query;    // Decoded query parameters
+    std::map<std::string, std::string> headers;  // Lower-case name -> value
+    std::string body;
+    int minorVersion;                            // 1 for HTTP/1.1, 0 for HTTP/1.0
+    bool keepAlive;                              // Connection stays open after the response
+
+    HttpRequest() : minorVersion(1), keepAlive(true) {}
+
+    /**
+     * @brief Get a header value
+     * @param name Lower-case header name
+     * @return Value, empty if the header is absent
+     */
+    std::string header(const std::string& name) const;
+};
+
+/**
+ * @brief An HTTP response to be serialized
+ */
+struct HttpResponse {
+    int status;
+    std::string contentType;
+    std::string body;
+
+    HttpResponse() : status(200), contentType("application/json") {}
+
+    /**
+     * @brief Get the reason phrase of a status code, e.g. "Not Found"
+     */
+    static const char* reason(int status);
+
+    /**
+     * @brief Serialize the status line, headers and body
+     * @param minorVersion HTTP minor version of the request
+     * @param keepAlive false to announce that the connection will close
+     * @return Bytes to send
+     */
+    std::string serialize(int minorVersion, bool keepAlive) const;
+};
+
+/**
+ * @brief Incremental HTTP/1.x request parser
+ *
+ * parse() is called on a connection's input buffer; it reports whether a
+ * whole request is there yet, so pipelined requests are taken one at a
+ * time. Bodies must be sent with Content-Length; chunked request bodies
+ * are refused.
+ */
+class HttpParser {
+public:
+    enum Result {
+        INCOMPLETE,    // Need more bytes
+        COMPLETE,      // request holds one request; consumed bytes may be dropped
+        FAILED         // Malformed or over a limit; errorStatus says which
+    };
+
+private:
+    size_t maxHeaderBytes;
+    size_t maxBodyBytes;
+
+public:
+    /**
+     * @brief Constructor
+     * @param maxHeaderBytes Most bytes in the request line and headers
+     * @param maxBodyBytes Largest accepted Content-Length
+     */
+    HttpParser(size_t maxHeaderBytes, size_t maxBodyBytes);
+
+    /**
+     * @brief Parse the request at the start of a buffer
+     * @param data Buffered input
+     * @param length Bytes buffered
+     * @param request Receives the request when COMPLETE
+     * @param consumed Receives the request's length in bytes when COMPLETE
+     * @param errorStatus Receives the status to answer with when FAILED (400, 413, 431, 501, 505)
+     * @return Whether a whole request was parsed
+     */
+    Result parse(const char* data, size_t length, HttpRequest& request, size_t& consumed, int& errorStatus) const;
+};
+
+/**
+ * @brief Decode %XX escapes, and '+' as space, in a query string part
+ */
+std::string decodeQueryComponent(const std::string& text);
+
+#endif // SERVER_HTTP_MESSAGE_H
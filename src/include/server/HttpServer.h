@@ -0,0 +1,176 @@
+#ifndef SERVER_HTTP_SERVER_H
+#define SERVER_HTTP_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "HttpMessage.h"
+#include "../DBConfig.h"
+
+/**
+ * @brief HTTP/1.1 server: one epoll thread for I/O, a pool of handler threads
+ *
+ * The thread that calls run() owns every socket. It accepts connections,
+ * reads and parses requests and writes responses; it never runs a
+ * handler. Each parsed request is queued to the worker threads, which may
+ * block (e.g. on the database) without holding up other connections.
+ *
+ * Connections are kept alive and requests may be pipelined: up to
+ * maxPipeline requests of one connection are handled at once, and their
+ * responses are written back in request order. Reading from a
+ * connection pauses while it has that many in flight. Keep-alive
+ * connections with nothing in flight are closed after the idle timeout.
+ */
+class HttpServer {
+public:
+    /**
+     * @brief Request handler; called on a worker thread, may run concurrently
+     */
+    typedef std::function<void(const HttpRequest&, HttpResponse&)> Handler;
+
+    /**
+     * @brief Server counters
+     */
+    struct Stats {
+        unsigned long long connections;   // Accepted
+        unsigned long long requests;      // Handled
+        unsigned long long rejected;      // Answered with a parse error
+    };
+
+private:
+    struct Connection;
+
+    struct Job {
+        unsigned long long connectionId;
+        unsigned long long sequence;
+        HttpRequest request;
+    };
+
+    struct Completion {
+        unsigned long long connectionId;
+        unsigned long long sequence;
+        std::string bytes;
+    };
+
+    Handler handler;
+    size_t workerCount;
+    size_t maxPipeline;
+    int idleTimeoutSeconds;
+    HttpParser parser;
+
+    int listenFd;
+    int epollFd;
+    int wakeFd;                        // eventfd: completions ready or stop requested
+    bool acceptPaused;                 // Out of descriptors; the listener is not watched
+    std::atomic<bool> stopping;
+
+    // Event loop thread only
+    std::unordered_map<unsigned long long, Connection*> connections;   // By ID, which is also the epoll tag
+    unsigned long long nextConnectionId;
+
+    std::function<void()> tick;
+    int tickMs;
+
+    std::mutex jobMutex;               // Guards jobs and workersStopping
+    std::condition_variable jobReady;
+    std::deque<Job> jobs;
+    bool workersStopping;
+    std::vector<std::thread> workers;
+
+    std::mutex completionMutex;        // Guards completions
+    std::vector<Completion> completions;
+
+    std::atomic<unsigned long long> connectionCount;
+    std::atomic<unsigned long long> requestCount;
+    std::atomic<unsigned long long> rejectedCount;
+
+    std::string lastError;
+
+    HttpServer(const HttpServer&);
+    HttpServer& operator=(const HttpServer&);
+
+    /**
+     * @brief Worker thread main loop
+     */
+    void workerLoop();
+
+    /**
+     * @brief Wake the event loop
+     */
+    void wake();
+
+    void acceptConnections();
+    void readConnection(Connection* connection);
+    void takeCompletions();
+
+    /**
+     * @brief Parse buffered requests, queue them, write what is ready and update the epoll interest
+     * @return false if the connection was closed
+     */
+    bool service(Connection* connection);
+
+    void closeConnection(Connection* connection);
+    void closeIdleConnections();
+    void watchListener(bool watch);
+
+public:
+    /**
+     * @brief Constructor
+     * @param handler Called for every request
+     * @param workers Handler threads
+     * @param maxPipeline Requests of one connection in flight at once
+     * @param idleTimeoutSeconds Idle keep-alive connections are closed after this
+     */
+    HttpServer(const Handler& handler, size_t workers = DBConfig::SERVER_WORKERS,
+               size_t maxPipeline = DBConfig::SERVER_MAX_PIPELINE,
+               int idleTimeoutSeconds = DBConfig::SERVER_IDLE_TIMEOUT_SECONDS);
+
+    /**
+     * @brief Destructor; closes every socket
+     */
+    ~HttpServer();
+
+    /**
+     * @brief Bind and listen
+     * @param host Address to bind, e.g. "127.0.0.1" or "0.0.0.0"
+     * @param port TCP port
+     * @return false on failure; see getLastError
+     */
+    bool listen(const std::string& host, int port);
+
+    /**
+     * @brief Call a function on the event loop thread every interval, e.g. to apply patches
+     * @param function Called between events; must not block for long
+     * @param intervalMs Interval in milliseconds
+     */
+    void setTick(const std::function<void()>& function, int intervalMs);
+
+    /**
+     * @brief Serve until stop() is called
+     * @return false if the server could not run; see getLastError
+     */
+    bool run();
+
+    /**
+     * @brief Ask run() to return; safe from any thread and from a signal handler
+     */
+    void stop();
+
+    /**
+     * @brief Get the server counters
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief Get the last error message
+     */
+    std::string getLastError() const;
+};
+
+#endif // SERVER_HTTP_SERVER_H
@@ -11,10 +11,100 @@
  */
 
 #include "include/MBomaHousingSystem.h"
+#include "include/BatchRunner.h"
+#include "include/MetricsExporter.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
-int main() {
-    MBomaHousingSystem system;
-    system.run();
-    return 0;
+namespace {
+    /**
+     * @brief Run scripted commands instead of the menus
+     * @param path Command file, or nullptr for stdin
+     * @return Process exit status
+     */
+    int runBatch(const char* path) {
+        std::ifstream file;
+        if (path) {
+            file.open(path);
+            if (!file.is_open()) {
+                std::cerr << "Cannot open " << path << "\n";
+                return 1;
+            }
+        }
+        
+        MBomaHousingSystem system(false);
+        if (!system.isReady()) {
+            return 1;
+        }
+        
+        BatchRunner runner(system);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool valid = runner.run(path ? static_cast<std::istream&>(file) : std::cin, std::cout);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        runner.printSummary(std::cerr, elapsed);
+        return valid ? 0 : 2;
+    }
+    
+    int usage(const char* program) {
+        std::cerr << "Usage: " << program << " [--batch [FILE]] [--metrics-port PORT] [--metrics-file PATH]\n";
+        std::cerr << "  --batch [FILE]       Run JSON-lines commands from FILE (or stdin) and print JSON results\n";
+        std::cerr << "  --metrics-port PORT  Serve Prometheus metrics at http://" << DBConfig::METRICS_HOST
+                  << ":PORT/metrics\n";
+        std::cerr << "  --metrics-file PATH  Write Prometheus metrics to PATH every "
+                  << DBConfig::METRICS_FILE_INTERVAL_MS / 1000 << " s and on exit\n";
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    bool batch = false;
+    const char* batchPath = nullptr;
+    int metricsPort = 0;
+    std::string metricsFile;
+    
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--batch") == 0 && !batch) {
+            batch = true;
+            // Optional file; "-" (or none) is stdin
+            if (i + 1 < argc && std::strncmp(argv[i + 1], "--", 2) != 0) {
+                ++i;
+                batchPath = std::strcmp(argv[i], "-") != 0 ? argv[i] : nullptr;
+            }
+        } else if (std::strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            metricsPort = std::atoi(argv[++i]);
+            if (metricsPort <= 0 || metricsPort > 65535) {
+                return usage(argv[0]);
+            }
+        } else if (std::strcmp(argv[i], "--metrics-file") == 0 && i + 1 < argc) {
+            metricsFile = argv[++i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    
+    MetricsExporter exporter;
+    if (metricsPort > 0 && !exporter.listen(DBConfig::METRICS_HOST, metricsPort)) {
+        std::cerr << exporter.getLastError() << "\n";
+        return 1;
+    }
+    if (!metricsFile.empty()) {
+        exporter.writeTo(metricsFile);
+    }
+    if ((metricsPort > 0 || !metricsFile.empty()) && !exporter.start()) {
+        std::cerr << exporter.getLastError() << "\n";
+        return 1;
+    }
+    
+    int status = 0;
+    if (batch) {
+        status = runBatch(batchPath);
+    } else {
+        MBomaHousingSystem system;
+        system.run();
+    }
+    exporter.stop();
+    return status;
 }
@@ -0,0 +1,752 @@
+#include "../include/server/HousingApi.h"
+#include "../include/DBConnector.h"
+#include "../include/SyncService.h"
+#include "../include/ExpiryService.h"
+#include "../include/DBConfig.h"
+#include "../include/Json.h"
+#include "../include/Utils.h"
+#include "../include/Metrics.h"
+#include <openssl/rand.h>
+#include <cstdlib>
+#include <iterator>
+
+namespace {
+    // Search results returned when the request gives no limit, and the most it may ask for
+    const size_t DEFAULT_SEARCH_LIMIT = 50;
+    const size_t MAX_SEARCH_LIMIT = 500;
+
+    const size_t TOKEN_BYTES = 16;
+
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    MetricsHistogram* const requestLatency = metrics.histogram(
+        "mboma_http_request_seconds", "Time to handle an API request, excluding network I/O");
+    // Indexed by status / 100 - 1
+    MetricsCounter* const responseCounts[] = {
+        metrics.counter("mboma_http_responses_total", "API responses by status class", "code=\"1xx\""),
+        metrics.counter("mboma_http_responses_total", "API responses by status class", "code=\"2xx\""),
+        metrics.counter("mboma_http_responses_total", "API responses by status class", "code=\"3xx\""),
+        metrics.counter("mboma_http_responses_total", "API responses by status class", "code=\"4xx\""),
+        metrics.counter("mboma_http_responses_total", "API responses by status class", "code=\"5xx\"")
+    };
+    MetricsCounter* const loginsSucceeded = metrics.counter(
+        "mboma_logins_total", "Login attempts by outcome", "result=\"success\"");
+    MetricsCounter* const loginsFailed = metrics.counter(
+        "mboma_logins_total", "Login attempts by outcome", "result=\"failure\"");
+    // One series per way searchHouses can answer, shared with MBomaHousingSystem::findHouses
+    MetricsHistogram* searchHistogram(const std::string& path) {
+        return metrics.histogram("mboma_search_seconds", "Time to answer a house search", "path=\"" + path + "\"");
+    }
+    MetricsHistogram* const calendarSearchLatency = searchHistogram("calendar");
+    MetricsHistogram* const textSearchLatency = searchHistogram("text");
+    MetricsHistogram* const rentSearchLatency = searchHistogram("rent");
+    MetricsHistogram* const catalogSearchLatency = searchHistogram("catalog");
+
+    void sendError(HttpResponse& response, int status, const std::string& message) {
+        JsonWriter json;
+        json.beginObject().key("error").value(message).endObject();
+        response.status = status;
+        response.body = json.str();
+    }
+
+    std::vector<std::string> splitPath(const std::string& path) {
+        std::vector<std::string> segments;
+        size_t start = 1;
+        while (start <= path.size()) {
+            size_t end = path.find('/', start);
+            if (end == std::string::npos) {
+                end = path.size();
+            }
+            if (end > start) {
+                segments.push_back(path.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+        return segments;
+    }
+
+    bool parseId(const std::string& text, int& id) {
+        if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        id = std::atoi(text.c_str());
+        return true;
+    }
+
+    bool parseAmount(const std::string& text, double& value) {
+        char* end = nullptr;
+        value = std::strtod(text.c_str(), &end);
+        return !text.empty() && end && *end == '\0';
+    }
+
+    std::string field(const std::map<std::string, std::string>& fields, const char* name) {
+        std::map<std::string, std::string>::const_iterator it = fields.find(name);
+        return it == fields.end() ? "" : it->second;
+    }
+
+    std::string newToken() {
+        static const char HEX_DIGITS[] = "0123456789abcdef";
+        unsigned char bytes[TOKEN_BYTES];
+        if (RAND_bytes(bytes, sizeof(bytes)) != 1) {
+            return "";
+        }
+        std::string token;
+        for (size_t i = 0; i < sizeof(bytes); ++i) {
+            token += HEX_DIGITS[bytes[i] >> 4];
+            token += HEX_DIGITS[bytes[i] & 0x0F];
+        }
+        return token;
+    }
+
+    void writeHouse(JsonWriter& json, const House& house, const EntityStore& store) {
+        const Location* town = store.findTown(house.getLocationId());
+        json.beginObject()
+            .key("id").value(house.getId())
+            .key("type").value(house.getType())
+            .key("address").value(house.getAddress())
+            .key("town_id").value(house.getLocationId())
+            .key("town").value(town ? town->getName() : "Unknown")
+            .key("deposit_fee").value(house.getDepositFee())
+            .key("monthly_rent").value(house.getMonthlyRent())
+            .key("map_link").value(house.getMapLink())
+            .key("available").value(house.getAvailability())
+            .key("booked").value(house.getBookingStatus());
+        if (house.getBookingStatus()) {
+            json.key("booked_until").value(house.getBookedUntil());
+        }
+        if (house.hasCoordinates()) {
+            json.key("latitude").value(house.getLatitude(), 6)
+                .key("longitude").value(house.getLongitude(), 6);
+        }
+        json.endObject();
+    }
+
+    void writeLocation(JsonWriter& json, const Location& location) {
+        json.beginObject()
+            .key("id").value(location.getId())
+            .key("name").value(location.getName())
+            .endObject();
+    }
+}
+
+HousingApi::HousingApi() : db(nullptr), syncService(nullptr), expiryService(nullptr) {}
+
+HousingApi::~HousingApi() {
+    // Stop syncing and expiring before the connection they use goes away
+    delete syncService;
+    syncService = nullptr;
+    delete expiryService;
+    expiryService = nullptr;
+
+    if (db) {
+        db->disconnect();
+        delete db;
+        db = nullptr;
+    }
+}
+
+bool HousingApi::start() {
+    db = new DBConnector();
+    if (!db->connect(DBConfig::DB_HOST, DBConfig::DB_USER, DBConfig::DB_PASS, DBConfig::DB_NAME)) {
+        lastError = "Database connection failed: " + db->getLastError();
+        delete db;
+        db = nullptr;
+        return false;
+    }
+
+    // Started before the load, so later changes reach the store as patches
+    syncService = new SyncService(db);
+    if (!syncService->start()) {
+        delete syncService;
+        syncService = nullptr;
+    }
+
+    loadData();
+
+    expiryService = new ExpiryService(db);
+    if (!expiryService->start()) {
+        delete expiryService;
+        expiryService = nullptr;
+    }
+    return true;
+}
+
+void HousingApi::loadData() {
+    std::vector<Location> locations = db->loadCounties();
+    std::vector<Location> towns = db->loadAllTowns();
+    locations.insert(locations.end(), towns.begin(), towns.end());
+    store.setLocations(locations);
+
+    std::vector<House> houses;
+    db->loadAllHousesInto(std::back_inserter(houses));
+    store.setHouses(std::move(houses));
+
+    db->forEachCurrentBooking([this](Booking&& booking) {
+        store.scheduleBooking(booking);
+        return true;
+    });
+}
+
+void HousingApi::applyPending() {
+    {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        if (syncService) {
+            syncService->applyPending(store);
+        }
+        if (expiryService) {
+            expiryService->applyPending(store);
+        }
+    }
+    sweepSessions();
+}
+
+void HousingApi::sweepSessions() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point idleSince = now - std::chrono::seconds(DBConfig::SESSION_IDLE_TIMEOUT_SECONDS);
+
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    if (now < nextSessionSweep) {
+        return;
+    }
+    nextSessionSweep = now + std::chrono::seconds(DBConfig::SESSION_SWEEP_INTERVAL_SECONDS);
+    for (std::unordered_map<std::string, Session>::iterator it = sessions.begin(); it != sessions.end();) {
+        if (it->second.lastUsed < idleSince) {
+            it = sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::string HousingApi::getLastError() const {
+    return lastError;
+}
+
+void HousingApi::handle(const HttpRequest& request, HttpResponse& response) {
+    MetricsTimer timer(requestLatency);
+    std::vector<std::string> segments = splitPath(request.path);
+    const std::string& method = request.method;
+    int id = 0;
+    Session session;
+
+    if (segments.empty() || (segments.size() == 1 && segments[0] == "health")) {
+        if (method != "GET") {
+            sendError(response, 405, "Use GET");
+        } else {
+            health(response);
+        }
+    } else if (segments[0] == "metrics" && segments.size() == 1) {
+        if (method != "GET") {
+            sendError(response, 405, "Use GET");
+        } else {
+            exportMetrics(response);
+        }
+    } else if (segments[0] == "counties" && segments.size() == 1) {
+        if (method != "GET") {
+            sendError(response, 405, "Use GET");
+        } else {
+            listCounties(response);
+        }
+    } else if (segments[0] == "counties" && segments.size() == 3 && segments[2] == "towns" && parseId(segments[1], id)) {
+        if (method != "GET") {
+            sendError(response, 405, "Use GET");
+        } else {
+            listTowns(id, response);
+        }
+    } else if (segments[0] == "towns" && segments.size() == 3 && segments[2] == "houses" && parseId(segments[1], id)) {
+        if (method != "GET") {
+            sendError(response, 405, "Use GET");
+        } else {
+            listTownHouses(id, response);
+        }
+    } else if (segments[0] == "houses" && segments.size() <= 2) {
+        if (method != "GET") {
+            sendError(response, 405, "Use GET");
+        } else if (segments.size() == 2) {
+            getHouse(segments[1], response);
+        } else {
+            searchHouses(request, response);
+        }
+    } else if (segments[0] == "users" && segments.size() == 1) {
+        if (method != "POST") {
+            sendError(response, 405, "Use POST");
+        } else {
+            registerUser(request, response);
+        }
+    } else if (segments[0] == "sessions" && segments.size() == 1) {
+        if (method == "POST") {
+            login(request, response);
+        } else if (method == "DELETE") {
+            logout(request, response);
+        } else {
+            sendError(response, 405, "Use POST or DELETE");
+        }
+    } else if (segments[0] == "bookings" && segments.size() == 1) {
+        if (method != "GET" && method != "POST") {
+            sendError(response, 405, "Use GET or POST");
+        } else if (authenticate(request, session, response)) {
+            if (method == "GET") {
+                listBookings(session, response);
+            } else {
+                createBooking(session, request, response);
+            }
+        }
+    } else if (segments[0] == "payments" && segments.size() == 1) {
+        if (method != "POST") {
+            sendError(response, 405, "Use POST");
+        } else if (authenticate(request, session, response)) {
+            createPayment(session, request, response);
+        }
+    } else {
+        sendError(response, 404, "No such resource");
+    }
+
+    if (response.status >= 100 && response.status < 600) {
+        responseCounts[response.status / 100 - 1]->add();
+    }
+}
+
+bool HousingApi::authenticate(const HttpRequest& request, Session& session, HttpResponse& response) {
+    std::string authorization = request.header("authorization");
+    const std::string scheme = "Bearer ";
+    if (authorization.compare(0, scheme.size(), scheme) == 0) {
+        std::string token = authorization.substr(scheme.size());
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        std::unordered_map<std::string, Session>::iterator found = sessions.find(token);
+        // A session past its idle timeout is refused even before the sweep drops it
+        if (found != sessions.end() &&
+            now - found->second.lastUsed < std::chrono::seconds(DBConfig::SESSION_IDLE_TIMEOUT_SECONDS)) {
+            found->second.lastUsed = now;
+            session = found->second;
+            return true;
+        }
+    }
+    sendError(response, 401, "Log in first (POST /sessions) and send the token as a Bearer authorization");
+    return false;
+}
+
+bool HousingApi::readBody(const HttpRequest& request, std::map<std::string, std::string>& fields,
+                          HttpResponse& response) {
+    std::string error;
+    if (!parseJsonObject(request.body, fields, error)) {
+        sendError(response, 400, "Request body: " + error);
+        return false;
+    }
+    return true;
+}
+
+void HousingApi::openSession(const User& user, int status, HttpResponse& response) {
+    std::string token = newToken();
+    if (token.empty()) {
+        sendError(response, 500, "Could not create a session token");
+        return;
+    }
+
+    Session session;
+    session.userId = user.getId();
+    session.email = user.getEmail();
+    session.name = user.getName();
+    session.lastUsed = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        sessions[token] = session;
+    }
+
+    JsonWriter json;
+    json.beginObject()
+        .key("token").value(token)
+        .key("user_id").value(session.userId)
+        .key("name").value(session.name)
+        .endObject();
+    response.status = status;
+    response.body = json.str();
+}
+
+void HousingApi::health(HttpResponse& response) {
+    SnapshotCatalog::ReadGuard snapshot = store.snapshots().read();
+    JsonWriter json;
+    json.beginObject()
+        .key("status").value("ok")
+        .key("houses").value(static_cast<unsigned long long>(snapshot->houseCount()))
+        .key("version").value(snapshot->version())
+        .endObject();
+    response.body = json.str();
+}
+
+void HousingApi::exportMetrics(HttpResponse& response) {
+    response.contentType = "text/plain; version=0.0.4; charset=utf-8";
+    response.body = MetricsRegistry::instance().exportText();
+}
+
+void HousingApi::listCounties(HttpResponse& response) {
+    // Locations are loaded once at start and never change, so no lock
+    const std::vector<size_t>& counties = store.countiesInOrder();
+    JsonWriter json;
+    json.beginObject().key("counties").beginArray();
+    for (size_t i = 0; i < counties.size(); ++i) {
+        writeLocation(json, store.location(counties[i]));
+    }
+    json.endArray().endObject();
+    response.body = json.str();
+}
+
+void HousingApi::listTowns(int countyId, HttpResponse& response) {
+    if (!store.findCounty(countyId)) {
+        sendError(response, 404, "No such county");
+        return;
+    }
+    const std::vector<size_t>& towns = store.townsInCounty(countyId);
+    JsonWriter json;
+    json.beginObject().key("towns").beginArray();
+    for (size_t i = 0; i < towns.size(); ++i) {
+        writeLocation(json, store.location(towns[i]));
+    }
+    json.endArray().endObject();
+    response.body = json.str();
+}
+
+void HousingApi::listTownHouses(int townId, HttpResponse& response) {
+    if (!store.findTown(townId)) {
+        sendError(response, 404, "No such town");
+        return;
+    }
+
+    // Listed houses, booked or not, as on the console's town screen
+    SnapshotCatalog::ReadGuard snapshot = store.snapshots().read();
+    const std::vector<House>& houses = snapshot->town(townId);
+    JsonWriter json;
+    json.beginObject().key("houses").beginArray();
+    for (size_t i = 0; i < houses.size(); ++i) {
+        if (houses[i].getAvailability()) {
+            writeHouse(json, houses[i], store);
+        }
+    }
+    json.endArray().endObject();
+    response.body = json.str();
+}
+
+void HousingApi::getHouse(const std::string& houseId, HttpResponse& response) {
+    SnapshotCatalog::ReadGuard snapshot = store.snapshots().read();
+    const House* house = snapshot->findHouse(houseId);
+    if (!house) {
+        sendError(response, 404, "No such house");
+        return;
+    }
+    JsonWriter json;
+    writeHouse(json, *house, store);
+    response.body = json.str();
+}
+
+void HousingApi::searchHouses(const HttpRequest& request, HttpResponse& response) {
+    HouseCatalog::Filter filter;
+    std::string address;
+    std::string moveInText;
+    size_t limit = DEFAULT_SEARCH_LIMIT;
+
+    for (std::map<std::string, std::string>::const_iterator it = request.query.begin(); it != request.query.end(); ++it) {
+        const std::string& name = it->first;
+        const std::string& value = it->second;
+        bool ok = true;
+        if (name == "type") {
+            filter.type = value;
+        } else if (name == "address") {
+            address = value;
+        } else if (name == "town") {
+            ok = parseId(value, filter.townId);
+        } else if (name == "min_rent") {
+            ok = parseAmount(value, filter.minRent);
+        } else if (name == "max_rent") {
+            ok = parseAmount(value, filter.maxRent);
+        } else if (name == "move_in") {
+            long long seconds = 0;
+            ok = parseDateTime(value, seconds);
+            moveInText = value;
+        } else if (name == "limit") {
+            int requested = 0;
+            ok = parseId(value, requested) && requested > 0;
+            limit = static_cast<size_t>(requested) < MAX_SEARCH_LIMIT ? static_cast<size_t>(requested) : MAX_SEARCH_LIMIT;
+        } else {
+            sendError(response, 400, "Unknown search parameter: " + name);
+            return;
+        }
+        if (!ok) {
+            sendError(response, 400, "Bad value for " + name + ": " + value);
+            return;
+        }
+    }
+
+    std::vector<House> results;
+    bool truncated = false;
+    MetricsTimer timer(catalogSearchLatency);
+    if (!moveInText.empty()) {
+        timer.retarget(calendarSearchLatency);
+        // The availability calendar is not snapshot-safe; ask it under the store lock
+        long long moveIn = 0;
+        parseDateTime(moveInText, moveIn);
+        long long moveOut = moveIn + Booking::GRACE_PERIOD_DAYS * 24LL * 3600;
+        filter.availableOnly = true;
+
+        std::lock_guard<std::mutex> lock(storeMutex);
+        std::vector<size_t> slots = store.housesFree(moveIn, moveOut, filter);
+        for (size_t i = 0; i < slots.size(); ++i) {
+            const House& house = store.house(slots[i]);
+            if (!containsIgnoreCase(house.getAddress(), address)) {
+                continue;
+            }
+            if (results.size() == limit) {
+                truncated = true;
+                break;
+            }
+            results.push_back(house);
+        }
+    } else {
+        // Open houses, from the published snapshot without the store lock
+        EntityStore::SearchResult found = store.searchOpenHouses(filter, address, limit);
+        switch (found.path) {
+            case EntityStore::SEARCH_BY_TEXT:
+                timer.retarget(textSearchLatency);
+                break;
+            case EntityStore::SEARCH_BY_RENT:
+                timer.retarget(rentSearchLatency);
+                break;
+            default:
+                timer.retarget(catalogSearchLatency);
+                break;
+        }
+        results.swap(found.houses);
+        truncated = found.truncated;
+    }
+
+    JsonWriter json;
+    json.beginObject().key("houses").beginArray();
+    for (size_t i = 0; i < results.size(); ++i) {
+        writeHouse(json, results[i], store);
+    }
+    json.endArray().key("truncated").value(truncated).endObject();
+    response.body = json.str();
+}
+
+void HousingApi::registerUser(const HttpRequest& request, HttpResponse& response) {
+    std::map<std::string, std::string> fields;
+    if (!readBody(request, fields, response)) {
+        return;
+    }
+    std::string name = field(fields, "name");
+    std::string email = field(fields, "email");
+    std::string password = field(fields, "password");
+    if (name.empty() || email.find('@') == std::string::npos || password.empty()) {
+        sendError(response, 400, "name, email and password are required");
+        return;
+    }
+
+    User existing;
+    if (db->loadUserByEmail(email, existing)) {
+        sendError(response, 409, "An account with this email already exists");
+        return;
+    }
+    // The unique email key decides a race the check above cannot
+    User user(name, field(fields, "phone"), email, password);
+    bool emailTaken = false;
+    if (!db->registerUser(user, &emailTaken)) {
+        if (emailTaken) {
+            sendError(response, 409, "An account with this email already exists");
+        } else {
+            sendError(response, 503, "Failed to save the user, please try again");
+        }
+        return;
+    }
+    openSession(user, 201, response);
+}
+
+void HousingApi::login(const HttpRequest& request, HttpResponse& response) {
+    std::map<std::string, std::string> fields;
+    if (!readBody(request, fields, response)) {
+        return;
+    }
+    std::string email = field(fields, "email");
+    User user;
+    if (!db->loadUserByEmail(email, user) || !user.login(email, field(fields, "password"))) {
+        loginsFailed->add();
+        sendError(response, 401, "Invalid email or password");
+        return;
+    }
+    loginsSucceeded->add();
+    openSession(user, 201, response);
+}
+
+void HousingApi::logout(const HttpRequest& request, HttpResponse& response) {
+    Session session;
+    if (!authenticate(request, session, response)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        sessions.erase(request.header("authorization").substr(std::string("Bearer ").size()));
+    }
+    response.status = 204;
+    response.body.clear();
+}
+
+void HousingApi::listBookings(const Session& session, HttpResponse& response) {
+    // From the database, so bookings made through other servers show up too
+    std::vector<Booking> bookings = db->loadBookings(session.userId);
+
+    SnapshotCatalog::ReadGuard snapshot = store.snapshots().read();
+    JsonWriter json;
+    json.beginObject().key("bookings").beginArray();
+    for (size_t i = 0; i < bookings.size(); ++i) {
+        const Booking& booking = bookings[i];
+        json.beginObject()
+            .key("id").value(booking.getId())
+            .key("house_id").value(booking.getHouseId())
+            .key("booking_date").value(booking.getBookingDate())
+            .key("expiry_date").value(booking.getExpiryDate())
+            .key("paid").value(booking.getPaymentStatus());
+        const House* house = snapshot->findHouse(booking.getHouseId());
+        if (house) {
+            json.key("house");
+            writeHouse(json, *house, store);
+        }
+        json.endObject();
+    }
+    json.endArray().endObject();
+    response.body = json.str();
+}
+
+void HousingApi::createBooking(const Session& session, const HttpRequest& request, HttpResponse& response) {
+    std::map<std::string, std::string> fields;
+    if (!readBody(request, fields, response)) {
+        return;
+    }
+    std::string houseId = field(fields, "house_id");
+
+    int townId = 0;
+    double depositFee = 0.0;
+    {
+        SnapshotCatalog::ReadGuard snapshot = store.snapshots().read();
+        const House* house = snapshot->findHouse(houseId);
+        if (!house) {
+            sendError(response, 404, "No such house");
+            return;
+        }
+        if (!house->getAvailability()) {
+            sendError(response, 409, "This house is not listed for booking");
+            return;
+        }
+        if (house->getBookingStatus()) {
+            sendError(response, 409, "This house is already booked until " + house->getBookedUntil());
+            return;
+        }
+        townId = house->getLocationId();
+        depositFee = house->getDepositFee();
+    }
+
+    // Hold the house first, so racing requests cannot both go on to book it.
+    // The reservation table is safe to use alongside store changes, so no lock.
+    ReservationTable::Token hold = store.reservations().hold(houseId, DBConfig::RESERVATION_HOLD_SECONDS);
+    if (!hold) {
+        sendError(response, 409, "This house is being booked by someone else. Please try again shortly.");
+        return;
+    }
+
+    DBConnector::BookingResult result = db->bookHouse(session.userId, houseId, townId);
+    if (result.status == DBConnector::BOOKING_HOUSE_TAKEN) {
+        // Another session booked the house after it was listed
+        std::lock_guard<std::mutex> lock(storeMutex);
+        store.bookHouse(houseId, result.expiryDate);
+    } else if (result.status != DBConnector::BOOKING_CREATED) {
+        store.reservations().release(houseId, hold);
+    }
+    if (result.status == DBConnector::BOOKING_HOUSE_TAKEN) {
+        sendError(response, 409, "Sorry, this house has just been booked by someone else");
+        return;
+    }
+    if (result.status == DBConnector::BOOKING_HOUSE_NOT_FOUND) {
+        sendError(response, 404, "No such house");
+        return;
+    }
+    if (result.status != DBConnector::BOOKING_CREATED) {
+        sendError(response, 503, "Failed to save the booking, please try again");
+        return;
+    }
+
+    Booking booking(result.bookingId, session.userId, houseId, result.bookingDate, result.expiryDate, false);
+    {
+        // The hold becomes the booking
+        std::lock_guard<std::mutex> lock(storeMutex);
+        store.reservations().confirm(houseId, hold);
+        store.scheduleBooking(booking);
+        store.bookHouse(houseId, booking.getExpiryDate());
+    }
+    if (expiryService) {
+        expiryService->schedule(booking.getId(), booking.getExpiryDate());
+    }
+
+    JsonWriter json;
+    json.beginObject()
+        .key("id").value(booking.getId())
+        .key("house_id").value(houseId)
+        .key("booking_date").value(booking.getBookingDate())
+        .key("expiry_date").value(booking.getExpiryDate())
+        .key("amount_due").value(depositFee)
+        .endObject();
+    response.status = 201;
+    response.body = json.str();
+}
+
+void HousingApi::createPayment(const Session& session, const HttpRequest& request, HttpResponse& response) {
+    std::map<std::string, std::string> fields;
+    if (!readBody(request, fields, response)) {
+        return;
+    }
+    int bookingId = 0;
+    if (!parseId(field(fields, "booking_id"), bookingId)) {
+        sendError(response, 400, "booking_id is required");
+        return;
+    }
+
+    std::string method = field(fields, "method");
+    if (method.empty() || equalsIgnoreCase(method, "mpesa") || equalsIgnoreCase(method, "M-Pesa")) {
+        method = "M-Pesa";
+    } else if (equalsIgnoreCase(method, "bank") || equalsIgnoreCase(method, "Bank Transfer")) {
+        method = "Bank Transfer";
+    } else {
+        sendError(response, 400, "method must be \"M-Pesa\" or \"Bank Transfer\"");
+        return;
+    }
+
+    // Ownership and the already-paid check are decided in the database,
+    // in the same transaction that records the payment
+    DBConnector::PaymentResult result = db->payBooking(session.userId, bookingId, method);
+    switch (result.status) {
+        case DBConnector::PAYMENT_RECORDED:
+            break;
+        case DBConnector::PAYMENT_ALREADY_PAID:
+            sendError(response, 409, "This booking is already paid");
+            return;
+        case DBConnector::PAYMENT_BOOKING_NOT_FOUND:
+            sendError(response, 404, "No such booking");
+            return;
+        case DBConnector::PAYMENT_HOUSE_NOT_LISTED:
+            sendError(response, 404, "The booked house is no longer listed");
+            return;
+        default:
+            sendError(response, 503, "Failed to save the payment, please try again");
+            return;
+    }
+    {
+        // A paid house is taken off the listings, as on the console
+        std::lock_guard<std::mutex> lock(storeMutex);
+        store.setHouseAvailability(result.houseId, false);
+    }
+
+    JsonWriter json;
+    json.beginObject()
+        .key("receipt_number").value(result.receiptNumber)
+        .key("booking_id").value(bookingId)
+        .key("amount").value(result.amount)
+        .key("method").value(method)
+        .endObject();
+    response.status = 201;
+    response.body = json.str();
+}
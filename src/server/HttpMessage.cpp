@@ -0,0 +1,264 @@
+#include "../include/server/HttpMessage.h"
+#include "../include/Utils.h"
+#include <cstring>
+
+namespace {
+    int hexValue(char c) {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+
+    std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t");
+        if (first == std::string::npos) {
+            return "";
+        }
+        size_t last = text.find_last_not_of(" \t");
+        return text.substr(first, last - first + 1);
+    }
+
+    // Does a comma-separated header value list a token, e.g. "close"?
+    bool hasToken(const std::string& value, const char* token) {
+        std::string lower = toLowerCase(value);
+        size_t start = 0;
+        while (start <= lower.size()) {
+            size_t end = lower.find(',', start);
+            if (end == std::string::npos) {
+                end = lower.size();
+            }
+            if (trim(lower.substr(start, end - start)) == token) {
+                return true;
+            }
+            start = end + 1;
+        }
+        return false;
+    }
+
+    void parseQuery(const std::string& text, std::map<std::string, std::string>& query) {
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find('&', start);
+            if (end == std::string::npos) {
+                end = text.size();
+            }
+            std::string pair = text.substr(start, end - start);
+            if (!pair.empty()) {
+                size_t equals = pair.find('=');
+                if (equals == std::string::npos) {
+                    query[decodeQueryComponent(pair)] = "";
+                } else {
+                    query[decodeQueryComponent(pair.substr(0, equals))] = decodeQueryComponent(pair.substr(equals + 1));
+                }
+            }
+            start = end + 1;
+        }
+    }
+}
+
+std::string decodeQueryComponent(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '+') {
+            out += ' ';
+        } else if (text[i] == '%' && i + 2 < text.size() && hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+            out += static_cast<char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+            i += 2;
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+std::string HttpRequest::header(const std::string& name) const {
+    std::map<std::string, std::string>::const_iterator it = headers.find(name);
+    return it == headers.end() ? "" : it->second;
+}
+
+const char* HttpResponse::reason(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 505: return "HTTP Version Not Supported";
+        default: return "Unknown";
+    }
+}
+
+std::string HttpResponse::serialize(int minorVersion, bool keepAlive) const {
+    std::string out;
+    out.reserve(128 + body.size());
+    out += minorVersion == 0 ? "HTTP/1.0 " : "HTTP/1.1 ";
+    out += std::to_string(status);
+    out += ' ';
+    out += reason(status);
+    out += "\r\nContent-Type: ";
+    out += contentType;
+    out += "\r\nContent-Length: ";
+    out += std::to_string(body.size());
+
+    // 1.1 keeps the connection by default, 1.0 closes it by default
+    if (!keepAlive) {
+        out += "\r\nConnection: close";
+    } else if (minorVersion == 0) {
+        out += "\r\nConnection: keep-alive";
+    }
+    out += "\r\n\r\n";
+    out += body;
+    return out;
+}
+
+HttpParser::HttpParser(size_t maxHeaderBytes, size_t maxBodyBytes)
+    : maxHeaderBytes(maxHeaderBytes), maxBodyBytes(maxBodyBytes) {}
+
+HttpParser::Result HttpParser::parse(const char* data, size_t length, HttpRequest& request,
+                                     size_t& consumed, int& errorStatus) const {
+    // Blank lines before a request are allowed (RFC 9112 section 2.2)
+    size_t start = 0;
+    while (start + 1 < length && data[start] == '\r' && data[start + 1] == '\n') {
+        start += 2;
+    }
+
+    const char* end = nullptr;
+    size_t searchable = length - start < maxHeaderBytes ? length - start : maxHeaderBytes;
+    for (size_t i = start; i + 3 < start + searchable; ++i) {
+        if (data[i] == '\r' && data[i + 1] == '\n' && data[i + 2] == '\r' && data[i + 3] == '\n') {
+            end = data + i;
+            break;
+        }
+    }
+    if (!end) {
+        if (length - start >= maxHeaderBytes) {
+            errorStatus = 431;
+            return FAILED;
+        }
+        return INCOMPLETE;
+    }
+
+    std::string head(data + start, end);
+    size_t headerStart = head.find("\r\n");
+    std::string requestLine = head.substr(0, headerStart);
+
+    // METHOD SP target SP HTTP/1.x
+    size_t firstSpace = requestLine.find(' ');
+    size_t secondSpace = firstSpace == std::string::npos ? std::string::npos : requestLine.find(' ', firstSpace + 1);
+    if (secondSpace == std::string::npos || firstSpace == 0 || secondSpace == firstSpace + 1) {
+        errorStatus = 400;
+        return FAILED;
+    }
+    std::string version = requestLine.substr(secondSpace + 1);
+    if (version.compare(0, 5, "HTTP/") != 0) {
+        errorStatus = 400;
+        return FAILED;
+    }
+    if (version == "HTTP/1.1") {
+        request.minorVersion = 1;
+    } else if (version == "HTTP/1.0") {
+        request.minorVersion = 0;
+    } else {
+        errorStatus = 505;
+        return FAILED;
+    }
+    request.method = requestLine.substr(0, firstSpace);
+    std::string target = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+    if (target[0] != '/') {
+        errorStatus = 400;
+        return FAILED;
+    }
+    size_t question = target.find('?');
+    request.path = target.substr(0, question);
+    request.query.clear();
+    if (question != std::string::npos) {
+        parseQuery(target.substr(question + 1), request.query);
+    }
+
+    request.headers.clear();
+    size_t lineStart = headerStart == std::string::npos ? head.size() : headerStart + 2;
+    while (lineStart < head.size()) {
+        size_t lineEnd = head.find("\r\n", lineStart);
+        if (lineEnd == std::string::npos) {
+            lineEnd = head.size();
+        }
+        std::string line = head.substr(lineStart, lineEnd - lineStart);
+        size_t colon = line.find(':');
+        if (colon == std::string::npos || colon == 0 || line[0] == ' ' || line[0] == '\t' ||
+            line.find_first_of(" \t") < colon) {
+            // No obsolete line folding, no whitespace before the colon
+            errorStatus = 400;
+            return FAILED;
+        }
+        std::string name = toLowerCase(line.substr(0, colon));
+        std::string value = trim(line.substr(colon + 1));
+        std::map<std::string, std::string>::iterator existing = request.headers.find(name);
+        if (existing == request.headers.end()) {
+            request.headers[name] = value;
+        } else if (name == "content-length") {
+            // Differing lengths would let a proxy and us split the stream differently
+            if (existing->second != value) {
+                errorStatus = 400;
+                return FAILED;
+            }
+        } else {
+            existing->second += ", " + value;
+        }
+        lineStart = lineEnd + 2;
+    }
+
+    if (request.headers.count("transfer-encoding")) {
+        errorStatus = 501;
+        return FAILED;
+    }
+
+    size_t bodyLength = 0;
+    std::map<std::string, std::string>::const_iterator contentLength = request.headers.find("content-length");
+    if (contentLength != request.headers.end()) {
+        const std::string& digits = contentLength->second;
+        if (digits.empty() || digits.size() > 18 || digits.find_first_not_of("0123456789") != std::string::npos) {
+            errorStatus = 400;
+            return FAILED;
+        }
+        unsigned long long declared = std::stoull(digits);
+        if (declared > maxBodyBytes) {
+            errorStatus = 413;
+            return FAILED;
+        }
+        bodyLength = static_cast<size_t>(declared);
+    }
+
+    size_t headerBytes = (end + 4) - data;
+    if (length - headerBytes < bodyLength) {
+        return INCOMPLETE;
+    }
+    request.body.assign(data + headerBytes, bodyLength);
+
+    std::string connection = request.header("connection");
+    if (request.minorVersion == 1) {
+        request.keepAlive = !hasToken(connection, "close");
+    } else {
+        request.keepAlive = hasToken(connection, "keep-alive");
+    }
+
+    consumed = headerBytes + bodyLength;
+    return COMPLETE;
+}
@@ -0,0 +1,499 @@
+#include "../include/server/HttpServer.h"
+#include "../include/Json.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <map>
+
+namespace {
+    // epoll tags; connection IDs start above them
+    const unsigned long long LISTENER_TAG = 0;
+    const unsigned long long WAKE_TAG = 1;
+    const unsigned long long FIRST_CONNECTION_ID = 2;
+
+    const int MAX_EVENTS = 256;
+    const size_t READ_CHUNK = 65536;
+
+    std::string errorBody(int status) {
+        JsonWriter json;
+        json.beginObject().key("error").value(HttpResponse::reason(status)).endObject();
+        return json.str();
+    }
+}
+
+struct HttpServer::Connection {
+    int fd;
+    unsigned long long id;
+    std::string input;
+    std::string output;
+    size_t outputSent;
+    unsigned long long nextSequence;      // Given to the next parsed request
+    unsigned long long nextToWrite;       // Responses are written in sequence order
+    std::map<unsigned long long, std::string> ready;   // Finished out of order
+    bool closing;                         // No more requests are read
+    unsigned long long closeAfter;        // Close once this response is written
+    bool peerClosed;                      // Client shut down its side
+    unsigned int events;                  // Current epoll interest
+    std::chrono::steady_clock::time_point lastActive;
+
+    size_t inFlight() const { return static_cast<size_t>(nextSequence - nextToWrite); }
+};
+
+HttpServer::HttpServer(const Handler& handler, size_t workers, size_t maxPipeline, int idleTimeoutSeconds)
+    : handler(handler), workerCount(workers < 1 ? 1 : workers), maxPipeline(maxPipeline < 1 ? 1 : maxPipeline),
+      idleTimeoutSeconds(idleTimeoutSeconds),
+      parser(DBConfig::SERVER_MAX_HEADER_BYTES, DBConfig::SERVER_MAX_BODY_BYTES),
+      listenFd(-1), epollFd(-1), wakeFd(-1), acceptPaused(false), stopping(false),
+      nextConnectionId(FIRST_CONNECTION_ID), tickMs(0), workersStopping(false),
+      connectionCount(0), requestCount(0), rejectedCount(0) {}
+
+HttpServer::~HttpServer() {
+    while (!connections.empty()) {
+        closeConnection(connections.begin()->second);
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+    }
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+bool HttpServer::listen(const std::string& host, int port) {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<unsigned short>(port));
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        lastError = "Invalid listen address: " + host;
+        return false;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (epollFd < 0 || wakeFd < 0 || listenFd < 0) {
+        lastError = std::string("Failed to create sockets: ") + std::strerror(errno);
+        return false;
+    }
+
+    int enable = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0) {
+        lastError = "Failed to listen on " + host + ":" + std::to_string(port) + ": " + std::strerror(errno);
+        return false;
+    }
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_TAG;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) != 0) {
+        lastError = std::string("epoll_ctl failed: ") + std::strerror(errno);
+        return false;
+    }
+    event.data.u64 = LISTENER_TAG;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) != 0) {
+        lastError = std::string("epoll_ctl failed: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+void HttpServer::setTick(const std::function<void()>& function, int intervalMs) {
+    tick = function;
+    tickMs = intervalMs;
+}
+
+void HttpServer::stop() {
+    // Only an atomic store and a write(2): both are safe in a signal handler
+    stopping.store(true);
+    wake();
+}
+
+void HttpServer::wake() {
+    unsigned long long one = 1;
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void)written;   // A full counter already means "wake up"
+}
+
+HttpServer::Stats HttpServer::getStats() const {
+    Stats stats;
+    stats.connections = connectionCount.load();
+    stats.requests = requestCount.load();
+    stats.rejected = rejectedCount.load();
+    return stats;
+}
+
+std::string HttpServer::getLastError() const {
+    return lastError;
+}
+
+void HttpServer::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobReady.wait(lock, [this]() { return workersStopping || !jobs.empty(); });
+            if (workersStopping) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        HttpResponse response;
+        try {
+            handler(job.request, response);
+        } catch (const std::exception& e) {
+            response = HttpResponse();
+            response.status = 500;
+            response.body = errorBody(500);
+        }
+        ++requestCount;
+
+        Completion completion;
+        completion.connectionId = job.connectionId;
+        completion.sequence = job.sequence;
+        completion.bytes = response.serialize(job.request.minorVersion, job.request.keepAlive);
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            completions.push_back(std::move(completion));
+        }
+        wake();
+    }
+}
+
+bool HttpServer::run() {
+    if (epollFd < 0 || listenFd < 0) {
+        lastError = "listen() must succeed before run()";
+        return false;
+    }
+
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.push_back(std::thread(&HttpServer::workerLoop, this));
+    }
+
+    epoll_event events[MAX_EVENTS];
+    std::chrono::steady_clock::time_point nextTick = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point nextSweep = nextTick + std::chrono::seconds(1);
+    bool ok = true;
+
+    while (!stopping.load()) {
+        int timeoutMs = tickMs > 0 && tickMs < 1000 ? tickMs : 1000;
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, timeoutMs);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            lastError = std::string("epoll_wait failed: ") + std::strerror(errno);
+            ok = false;
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            unsigned long long tag = events[i].data.u64;
+            if (tag == LISTENER_TAG) {
+                acceptConnections();
+            } else if (tag == WAKE_TAG) {
+                unsigned long long counter;
+                ssize_t drained = read(wakeFd, &counter, sizeof(counter));
+                (void)drained;
+                takeCompletions();
+            } else {
+                std::unordered_map<unsigned long long, Connection*>::iterator found = connections.find(tag);
+                if (found == connections.end()) {
+                    continue;   // Closed earlier in this batch
+                }
+                Connection* connection = found->second;
+                if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                    // Both directions are gone; nothing more can be delivered
+                    closeConnection(connection);
+                } else if (events[i].events & EPOLLIN) {
+                    readConnection(connection);
+                } else {
+                    service(connection);
+                }
+            }
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (tick && now >= nextTick) {
+            tick();
+            nextTick = now + std::chrono::milliseconds(tickMs);
+        }
+        if (now >= nextSweep) {
+            closeIdleConnections();
+            nextSweep = now + std::chrono::seconds(1);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        workersStopping = true;
+        jobs.clear();
+    }
+    jobReady.notify_all();
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+    workers.clear();
+    completions.clear();
+
+    while (!connections.empty()) {
+        closeConnection(connections.begin()->second);
+    }
+    return ok;
+}
+
+void HttpServer::watchListener(bool watch) {
+    epoll_event event;
+    event.events = watch ? static_cast<uint32_t>(EPOLLIN) : 0;
+    event.data.u64 = LISTENER_TAG;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, listenFd, &event);
+    acceptPaused = !watch;
+}
+
+void HttpServer::acceptConnections() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EMFILE || errno == ENFILE) {
+                // Level-triggered: stop watching until a connection closes, or this spins
+                watchListener(false);
+            }
+            return;   // EAGAIN, or a connection that was reset before we took it
+        }
+
+        // Responses are small and often pipelined; do not hold them back
+        int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        Connection* connection = new Connection();
+        connection->fd = fd;
+        connection->id = nextConnectionId++;
+        connection->outputSent = 0;
+        connection->nextSequence = 0;
+        connection->nextToWrite = 0;
+        connection->closing = false;
+        connection->closeAfter = 0;
+        connection->peerClosed = false;
+        connection->events = EPOLLIN;
+        connection->lastActive = std::chrono::steady_clock::now();
+
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = connection->id;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            delete connection;
+            continue;
+        }
+        connections[connection->id] = connection;
+        ++connectionCount;
+    }
+}
+
+void HttpServer::readConnection(Connection* connection) {
+    char buffer[READ_CHUNK];
+    while (true) {
+        ssize_t received = recv(connection->fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            connection->input.append(buffer, static_cast<size_t>(received));
+            connection->lastActive = std::chrono::steady_clock::now();
+            if (static_cast<size_t>(received) < sizeof(buffer)) {
+                break;   // Drained; saves a recv that would only say EAGAIN
+            }
+            continue;
+        }
+        if (received == 0) {
+            connection->peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            closeConnection(connection);
+            return;
+        }
+        break;
+    }
+    service(connection);
+}
+
+bool HttpServer::service(Connection* connection) {
+    // Queue every whole request buffered, up to the pipeline limit
+    std::vector<Job> parsed;
+    while (!connection->closing && connection->inFlight() < maxPipeline && !connection->input.empty()) {
+        Job job;
+        size_t consumed = 0;
+        int errorStatus = 0;
+        HttpParser::Result result = parser.parse(connection->input.data(), connection->input.size(),
+                                                 job.request, consumed, errorStatus);
+        if (result == HttpParser::INCOMPLETE) {
+            break;
+        }
+
+        unsigned long long sequence = connection->nextSequence++;
+        if (result == HttpParser::FAILED) {
+            // The stream cannot be resynchronized; answer and close
+            HttpResponse response;
+            response.status = errorStatus;
+            response.body = errorBody(errorStatus);
+            connection->ready[sequence] = response.serialize(1, false);
+            connection->input.clear();
+            connection->closing = true;
+            connection->closeAfter = sequence;
+            ++rejectedCount;
+            break;
+        }
+
+        connection->input.erase(0, consumed);
+        if (!job.request.keepAlive) {
+            connection->closing = true;
+            connection->closeAfter = sequence;
+        }
+        job.connectionId = connection->id;
+        job.sequence = sequence;
+        parsed.push_back(std::move(job));
+    }
+    if (!parsed.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            for (size_t i = 0; i < parsed.size(); ++i) {
+                jobs.push_back(std::move(parsed[i]));
+            }
+        }
+        if (parsed.size() == 1) {
+            jobReady.notify_one();
+        } else {
+            jobReady.notify_all();
+        }
+    }
+
+    // Move finished responses to the output in request order
+    std::map<unsigned long long, std::string>::iterator next = connection->ready.begin();
+    while (next != connection->ready.end() && next->first == connection->nextToWrite) {
+        connection->output += next->second;
+        ++connection->nextToWrite;
+        connection->ready.erase(next++);
+    }
+
+    while (connection->outputSent < connection->output.size()) {
+        ssize_t sent = send(connection->fd, connection->output.data() + connection->outputSent,
+                            connection->output.size() - connection->outputSent, MSG_NOSIGNAL);
+        if (sent > 0) {
+            connection->outputSent += static_cast<size_t>(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        closeConnection(connection);
+        return false;
+    }
+    if (connection->outputSent == connection->output.size()) {
+        connection->output.clear();
+        connection->outputSent = 0;
+    }
+
+    bool flushed = connection->output.empty();
+    if (flushed && connection->closing && connection->nextToWrite > connection->closeAfter) {
+        closeConnection(connection);
+        return false;
+    }
+    if (flushed && connection->peerClosed && connection->inFlight() == 0) {
+        closeConnection(connection);
+        return false;
+    }
+
+    unsigned int wanted = 0;
+    if (!connection->closing && !connection->peerClosed && connection->inFlight() < maxPipeline) {
+        wanted |= EPOLLIN;
+    }
+    if (!flushed) {
+        wanted |= EPOLLOUT;
+    }
+    if (wanted != connection->events) {
+        epoll_event event;
+        event.events = wanted;
+        event.data.u64 = connection->id;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+        connection->events = wanted;
+    }
+    return true;
+}
+
+void HttpServer::takeCompletions() {
+    std::vector<Completion> finished;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        finished.swap(completions);
+    }
+
+    std::vector<unsigned long long> touched;
+    for (size_t i = 0; i < finished.size(); ++i) {
+        std::unordered_map<unsigned long long, Connection*>::iterator found =
+            connections.find(finished[i].connectionId);
+        if (found == connections.end()) {
+            continue;   // Client went away while its request was handled
+        }
+        found->second->ready[finished[i].sequence].swap(finished[i].bytes);
+        if (touched.empty() || touched.back() != finished[i].connectionId) {
+            touched.push_back(finished[i].connectionId);
+        }
+    }
+
+    for (size_t i = 0; i < touched.size(); ++i) {
+        std::unordered_map<unsigned long long, Connection*>::iterator found = connections.find(touched[i]);
+        if (found != connections.end()) {
+            service(found->second);
+        }
+    }
+}
+
+void HttpServer::closeConnection(Connection* connection) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+    close(connection->fd);
+    connections.erase(connection->id);
+    delete connection;
+
+    if (acceptPaused) {
+        watchListener(true);
+    }
+}
+
+void HttpServer::closeIdleConnections() {
+    if (idleTimeoutSeconds <= 0) {
+        return;
+    }
+    std::chrono::steady_clock::time_point cutoff =
+        std::chrono::steady_clock::now() - std::chrono::seconds(idleTimeoutSeconds);
+
+    std::vector<Connection*> idle;
+    for (std::unordered_map<unsigned long long, Connection*>::iterator it = connections.begin();
+         it != connections.end(); ++it) {
+        Connection* connection = it->second;
+        if (connection->inFlight() == 0 && connection->output.empty() && connection->lastActive < cutoff) {
+            idle.push_back(connection);
+        }
+    }
+    for (size_t i = 0; i < idle.size(); ++i) {
+        closeConnection(idle[i]);
+    }
+}
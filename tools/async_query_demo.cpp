@@ -0,0 +1,82 @@
+/**
+ * M-Boma async query demo
+ *
+ * Runs a burst of house loads and searches concurrently from one thread
+ * through AsyncDBConnector and reports how many were in flight at once.
+ *
+ * Usage:
+ *   async_query_demo [--queries N] [--connections C]
+ *
+ *   --queries N       Queries to run (default 200)
+ *   --connections C   Connections, i.e. most queries in flight (default DBConfig::ASYNC_CONNECTIONS)
+ */
+
+#include "async/AsyncDBConnector.h"
+#include "async/Reactor.h"
+#include "DBConfig.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    const int SAMPLE_TOWNS[] = { 100, 200, 300, 101, 102, 103, 104, 201, 202, 301, 401 };
+    const int SAMPLE_TOWN_COUNT = sizeof(SAMPLE_TOWNS) / sizeof(SAMPLE_TOWNS[0]);
+
+    size_t totalRows = 0;
+    int completed = 0;
+
+    Task<void> runQuery(AsyncDBConnector& db, int index) {
+        std::vector<House> houses;
+        if (index % 2 == 0) {
+            houses = co_await db.loadHouses(SAMPLE_TOWNS[(index / 2) % SAMPLE_TOWN_COUNT]);
+        } else {
+            houses = co_await db.searchHouses("", 0.0, 10000.0 * (1 + index % 50));
+        }
+        totalRows += houses.size();
+        ++completed;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int queries = 200;
+    size_t connections = DBConfig::ASYNC_CONNECTIONS;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--queries") == 0 && i + 1 < argc) {
+            queries = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--connections") == 0 && i + 1 < argc) {
+            connections = static_cast<size_t>(std::atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--queries N] [--connections C]\n";
+            return 1;
+        }
+    }
+
+    Reactor reactor;
+    AsyncDBConnector db(reactor);
+    if (!db.connect(DBConfig::DB_HOST, DBConfig::DB_USER, DBConfig::DB_PASS, DBConfig::DB_NAME, connections)) {
+        std::cerr << "Connection failed: " << db.getLastError() << "\n";
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < queries; ++i) {
+        reactor.spawn(runQuery(db, i));
+    }
+    if (!reactor.run()) {
+        std::cerr << "Reactor failed: " << reactor.getLastError() << "\n";
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << completed << " queries on " << connections << " connections in " << seconds << " s ("
+              << (seconds > 0 ? completed / seconds : 0) << " queries/s), " << totalRows << " rows\n";
+    std::cout << "peak queries in flight: " << db.getPeakInFlight() << "\n";
+    if (!db.getLastError().empty()) {
+        std::cout << "last error: " << db.getLastError() << "\n";
+    }
+
+    db.disconnect();
+    return 0;
+}
@@ -0,0 +1,1016 @@
+/**
+ * M-Boma synthetic dataset generator
+ *
+ * Writes counties, towns, users, houses, rental_cost, payment_details,
+ * bookings and payments at a chosen scale as tab-separated files, then
+ * loads them with LOAD DATA LOCAL INFILE (or multi-row INSERTs) over
+ * several connections at once.
+ *
+ * Distributions:
+ *   - The 47 Kenyan counties; towns are spread by county population and
+ *     the largest towns go to the most populous counties
+ *   - Houses per town, bookings per house and bookings per user follow
+ *     Zipf laws with exponent --skew (0 = uniform)
+ *   - House types by a fixed mix; rents log-normal around the type's
+ *     median, scaled by county and town price levels
+ *   - Coordinates scattered around each town centre (5% left unlocated)
+ *   - Bookings of a house never overlap. They cover the last --days days,
+ *     so the latest ones are still active; a --paid share is paid
+ *
+ * Every chunk of rows has its own random stream, so the output depends
+ * only on --seed, the sizes and the day it runs, not on --threads.
+ * Generated users all have the password "mboma123".
+ *
+ * Usage:
+ *   mboma-datagen [--houses N] [--users N] [--bookings N] [--towns N]
+ *                 [--skew S] [--days D] [--paid F] [--seed N] [--threads T]
+ *                 [--out DIR] [--no-load] [--insert] [--batch N] [--replace]
+ *
+ *   --houses N    Houses (default 200000)
+ *   --users N     Users (default 500000)
+ *   --bookings N  Bookings (default 1000000)
+ *   --towns N     Towns (default 1000)
+ *   --skew S      Zipf exponent for towns, houses and users (default 1.0)
+ *   --days D      Days of booking history (default 730)
+ *   --paid F      Fraction of bookings paid (default 0.6)
+ *   --seed N      Random seed (default 42)
+ *   --threads T   Generator threads and loader connections (default: CPU count)
+ *   --out DIR     Directory for the data files (default datagen)
+ *   --no-load     Only write the files
+ *   --insert      Load with multi-row INSERTs instead of LOAD DATA LOCAL INFILE
+ *   --batch N     Rows per INSERT (default 1000)
+ *   --replace     Delete the data already in the database first
+ *
+ * LOAD DATA LOCAL INFILE needs local_infile=1 on the server; use --insert
+ * where it is off.
+ */
+
+#include "Booking.h"
+#include "DBConfig.h"
+#include "Utils.h"
+#include <mysql/mysql.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+namespace {
+    const char* PASSWORD = "mboma123";
+
+    // Rows per generated file; fixed so the output does not depend on --threads
+    const size_t HOUSE_CHUNK = 50000;
+    const size_t USER_CHUNK = 100000;
+
+    const long long DAY = 24LL * 3600;
+    const long long BOOKING_LENGTH = Booking::GRACE_PERIOD_DAYS * DAY;
+    const long long MIN_SLOT = BOOKING_LENGTH + DAY;   // A booking and at least a day free after it
+
+    const double UNLOCATED_SHARE = 0.05;
+    const double MPESA_SHARE = 0.7;
+
+    // Random stream IDs, one per kind of chunk
+    enum Stream { STREAM_TOWNS = 1, STREAM_PLAN = 2, STREAM_USERS = 3, STREAM_HOUSES = 4 };
+
+    struct County {
+        const char* name;
+        double latitude;
+        double longitude;
+        double population;    // Millions (2019 census, rounded)
+        double priceLevel;    // Rent multiplier
+    };
+
+    const County COUNTIES[] = {
+        { "Mombasa", -4.04, 39.67, 1.21, 1.3 }, { "Kwale", -4.18, 39.46, 0.87, 0.8 },
+        { "Kilifi", -3.51, 39.91, 1.45, 0.9 }, { "Tana River", -1.50, 40.00, 0.32, 0.6 },
+        { "Lamu", -2.27, 40.90, 0.14, 0.9 }, { "Taita Taveta", -3.40, 38.56, 0.34, 0.7 },
+        { "Garissa", -0.45, 39.65, 0.84, 0.6 }, { "Wajir", 1.75, 40.06, 0.78, 0.5 },
+        { "Mandera", 3.94, 41.86, 0.87, 0.5 }, { "Marsabit", 2.33, 37.99, 0.46, 0.5 },
+        { "Isiolo", 0.35, 37.58, 0.27, 0.6 }, { "Meru", 0.05, 37.65, 1.55, 0.8 },
+        { "Tharaka-Nithi", -0.30, 37.90, 0.39, 0.6 }, { "Embu", -0.54, 37.46, 0.61, 0.7 },
+        { "Kitui", -1.37, 38.01, 1.14, 0.6 }, { "Machakos", -1.52, 37.26, 1.42, 0.9 },
+        { "Makueni", -1.80, 37.62, 0.99, 0.6 }, { "Nyandarua", -0.18, 36.52, 0.64, 0.6 },
+        { "Nyeri", -0.42, 36.95, 0.76, 0.8 }, { "Kirinyaga", -0.50, 37.28, 0.61, 0.7 },
+        { "Murang'a", -0.72, 37.15, 1.06, 0.7 }, { "Kiambu", -1.17, 36.83, 2.42, 1.2 },
+        { "Turkana", 3.12, 35.60, 0.93, 0.5 }, { "West Pokot", 1.62, 35.39, 0.62, 0.5 },
+        { "Samburu", 1.10, 36.70, 0.31, 0.5 }, { "Trans Nzoia", 1.02, 35.00, 0.99, 0.7 },
+        { "Uasin Gishu", 0.52, 35.27, 1.16, 0.9 }, { "Elgeyo-Marakwet", 0.80, 35.50, 0.45, 0.6 },
+        { "Nandi", 0.18, 35.13, 0.89, 0.6 }, { "Baringo", 0.47, 35.97, 0.67, 0.6 },
+        { "Laikipia", 0.36, 36.78, 0.52, 0.8 }, { "Nakuru", -0.30, 36.07, 2.16, 1.0 },
+        { "Narok", -1.08, 35.87, 1.16, 0.7 }, { "Kajiado", -1.85, 36.78, 1.12, 1.1 },
+        { "Kericho", -0.37, 35.28, 0.90, 0.7 }, { "Bomet", -0.78, 35.34, 0.88, 0.6 },
+        { "Kakamega", 0.28, 34.75, 1.87, 0.7 }, { "Vihiga", 0.05, 34.72, 0.59, 0.6 },
+        { "Bungoma", 0.56, 34.56, 1.67, 0.6 }, { "Busia", 0.46, 34.11, 0.89, 0.6 },
+        { "Siaya", 0.06, 34.29, 0.99, 0.6 }, { "Kisumu", -0.09, 34.77, 1.16, 1.0 },
+        { "Homa Bay", -0.53, 34.46, 1.13, 0.6 }, { "Migori", -1.06, 34.47, 1.12, 0.6 },
+        { "Kisii", -0.68, 34.77, 1.27, 0.7 }, { "Nyamira", -0.56, 34.94, 0.61, 0.6 },
+        { "Nairobi", -1.29, 36.82, 4.40, 1.8 }
+    };
+
+    struct HouseType {
+        const char* name;
+        double share;
+        double medianRent;    // KES per month at price level 1
+    };
+
+    const HouseType HOUSE_TYPES[] = {
+        { "Bedsitter", 0.22, 8000 }, { "Studio", 0.10, 12000 },
+        { "One Bedroom", 0.25, 15000 }, { "Two Bedroom", 0.20, 28000 },
+        { "Three Bedroom", 0.12, 45000 }, { "Bungalow", 0.06, 80000 },
+        { "Mansionette", 0.04, 150000 }, { "Villa", 0.01, 300000 }
+    };
+
+    const char* TOWN_HEADS[] = {
+        "Ki", "Ka", "Ma", "Mu", "Nya", "Ru", "Em", "Lo", "Na", "Ol", "Ga", "Ke", "Chu", "Bu", "Ndu", "Mwi"
+    };
+    const char* TOWN_TAILS[] = {
+        "ambu", "ruri", "theka", "kuyu", "kongo", "ngata", "sabit", "boni", "rongo", "mara",
+        "tito", "witu", "kasi", "nyeki", "gema", "lolo", "sumu", "thika", "ndani", "iru"
+    };
+    const char* STREETS[] = {
+        "Ngong", "Kenyatta", "Moi", "Uhuru", "Jogoo", "Thika", "Waiyaki", "Kiambu", "Langata",
+        "Oginga Odinga", "Ronald Ngala", "Haile Selassie", "Kimathi", "Tom Mboya", "Nyerere",
+        "Lumumba", "Biashara", "Mama Ngina", "Wangari Maathai", "Jomo Kenyatta"
+    };
+    const char* STREET_KINDS[] = { "Road", "Avenue", "Street", "Lane", "Close", "Drive" };
+    const char* FIRST_NAMES[] = {
+        "Wanjiku", "Achieng", "Njeri", "Akinyi", "Wambui", "Atieno", "Mumbua", "Chebet", "Nafula", "Zawadi",
+        "Kamau", "Otieno", "Mwangi", "Ochieng", "Kiprop", "Mutua", "Wafula", "Omondi", "Kipchoge", "Baraka",
+        "Grace", "Mercy", "Faith", "Joy", "Brian", "Kevin", "Dennis", "Allan", "John", "Peres"
+    };
+    const char* LAST_NAMES[] = {
+        "Kamau", "Otieno", "Mwangi", "Ochieng", "Kiprono", "Mutua", "Wafula", "Omondi", "Njoroge", "Kariuki",
+        "Onyango", "Kimani", "Wanyama", "Cheruiyot", "Maina", "Odhiambo", "Koech", "Muthoni", "Nyambura", "Barasa",
+        "Kachila", "Itibi", "Juma", "Owino", "Rotich", "Korir", "Musyoka", "Gitau", "Karanja", "Achola"
+    };
+
+    template <typename T, size_t N>
+    size_t countOf(const T (&)[N]) {
+        return N;
+    }
+
+    struct Options {
+        size_t houses;
+        size_t users;
+        size_t bookings;
+        size_t towns;
+        double skew;
+        int days;
+        double paidShare;
+        unsigned long long seed;
+        size_t threads;
+        std::string outDir;
+        bool load;
+        bool useInsert;
+        size_t batchRows;
+        bool replace;
+
+        Options() : houses(200000), users(500000), bookings(1000000), towns(1000), skew(1.0), days(730),
+                    paidShare(0.6), seed(42), threads(std::max(1u, std::thread::hardware_concurrency())),
+                    outDir("datagen"), load(true), useInsert(false), batchRows(1000), replace(false) {}
+    };
+
+    struct Town {
+        int id;
+        int countyId;
+        std::string name;
+        double latitude;
+        double longitude;
+        double priceLevel;
+        size_t firstHouse;    // Houses of a town have consecutive indexes
+        size_t houseCount;
+    };
+
+    // One generated file and the table columns it fills
+    struct DataFile {
+        int order;            // Load order; parents before children
+        std::string table;
+        std::string columns;
+        std::string path;
+        size_t rows;
+
+        bool operator<(const DataFile& other) const {
+            return order != other.order ? order < other.order : path < other.path;
+        }
+    };
+
+    const char* COLUMNS_COUNTY = "county_id, county_name";
+    const char* COLUMNS_TOWN = "town_id, town_name, county_id";
+    const char* COLUMNS_USER = "user_id, first_name, second_name, email, phone_number, password";
+    const char* COLUMNS_HOUSE = "town_id, house_id, house_type, house_address, map_link, deposit_fee, "
+                                "monthly_rent, is_available, is_booked, booked_until, latitude, longitude";
+    const char* COLUMNS_RENTAL_COST = "house_id, town_id, house_cartegory, deposit, monthly_rent";
+    const char* COLUMNS_PAYMENT_DETAILS = "house_id, town_id, house_type, bank_acount, m_pesa_till_no, owner_contacts";
+    const char* COLUMNS_BOOKING = "booking_id, user_id, house_id, town_id, booking_date, expiry_date, is_paid, status";
+    const char* COLUMNS_PAYMENT = "payment_id, booking_id, amount, payment_date, payment_method, receipt_number";
+
+    /**
+     * @brief Discrete Zipf distribution over ranks 0..n-1
+     */
+    class Zipf {
+    private:
+        std::vector<double> cdf;
+
+    public:
+        Zipf(size_t n, double exponent) : cdf(n) {
+            double sum = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+                cdf[i] = sum;
+            }
+        }
+
+        size_t operator()(std::mt19937_64& rng) const {
+            double u = std::uniform_real_distribution<double>(0.0, cdf.back())(rng);
+            size_t rank = std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+            return rank < cdf.size() ? rank : cdf.size() - 1;
+        }
+
+        double weight(size_t rank) const {
+            return rank == 0 ? cdf[0] : cdf[rank] - cdf[rank - 1];
+        }
+
+        double total() const {
+            return cdf.back();
+        }
+    };
+
+    // Independent, reproducible random stream for one chunk (splitmix64 seeding)
+    std::mt19937_64 streamFor(unsigned long long seed, Stream stream, unsigned long long chunk) {
+        unsigned long long z = seed + 0x9E3779B97F4A7C15ULL * (static_cast<unsigned long long>(stream) * 1000003ULL + chunk + 1);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return std::mt19937_64(z ^ (z >> 31));
+    }
+
+    // Seconds from parseDateTime back to "YYYY-MM-DD HH:MM:SS"
+    std::string formatTime(long long seconds) {
+        std::time_t time = static_cast<std::time_t>(seconds);
+        std::tm parts;
+        gmtime_r(&time, &parts);
+        char buffer[24];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &parts);
+        return buffer;
+    }
+
+    std::string houseId(size_t index) {
+        char buffer[24];
+        std::snprintf(buffer, sizeof(buffer), "H%07lu", static_cast<unsigned long>(index + 1));
+        return buffer;
+    }
+
+    std::string digits(std::mt19937_64& rng, int count) {
+        std::string text;
+        for (int i = 0; i < count; ++i) {
+            text += static_cast<char>('0' + rng() % 10);
+        }
+        return text;
+    }
+
+    std::string money(double amount) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.2f", amount);
+        return buffer;
+    }
+
+    std::string dataPath(const Options& options, const std::string& table, size_t chunk) {
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), "_%04lu.tsv", static_cast<unsigned long>(chunk));
+        return options.outDir + "/" + table + suffix;
+    }
+
+    // Split total into parts proportional to weights (largest remainder)
+    std::vector<size_t> apportion(size_t total, const std::vector<double>& weights) {
+        double sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+        std::vector<size_t> parts(weights.size());
+        std::vector<std::pair<double, size_t> > remainders;
+        size_t assigned = 0;
+        for (size_t i = 0; i < weights.size(); ++i) {
+            double exact = total * weights[i] / sum;
+            parts[i] = static_cast<size_t>(exact);
+            assigned += parts[i];
+            remainders.push_back(std::make_pair(exact - parts[i], i));
+        }
+        std::sort(remainders.rbegin(), remainders.rend());
+        for (size_t i = 0; assigned < total; ++i, ++assigned) {
+            ++parts[remainders[i % remainders.size()].second];
+        }
+        return parts;
+    }
+
+    /**
+     * @brief Place towns in counties, name them and share the houses out
+     */
+    std::vector<Town> planTowns(const Options& options) {
+        std::mt19937_64 rng = streamFor(options.seed, STREAM_TOWNS, 0);
+        std::vector<double> populations;
+        for (size_t c = 0; c < countOf(COUNTIES); ++c) {
+            populations.push_back(COUNTIES[c].population);
+        }
+        std::discrete_distribution<size_t> pickCounty(populations.begin(), populations.end());
+        std::normal_distribution<double> spread(0.0, 0.3);
+        std::lognormal_distribution<double> townLevel(0.0, 0.3);
+
+        std::vector<Town> towns;
+        std::vector<int> townsInCounty(countOf(COUNTIES), 0);
+        std::set<std::string> names;
+        std::vector<double> sizeKeys;
+        for (size_t t = 0; t < options.towns; ++t) {
+            size_t county = pickCounty(rng);
+            Town town;
+            town.countyId = static_cast<int>(county) + 1;
+            town.id = town.countyId * 10000 + ++townsInCounty[county];
+
+            std::string name = std::string(TOWN_HEADS[rng() % countOf(TOWN_HEADS)]) +
+                               TOWN_TAILS[rng() % countOf(TOWN_TAILS)];
+            std::string unique = name;
+            for (int n = 2; names.count(unique); ++n) {
+                unique = name + " " + std::to_string(n);
+            }
+            names.insert(unique);
+            town.name = unique;
+
+            town.latitude = COUNTIES[county].latitude + spread(rng);
+            town.longitude = COUNTIES[county].longitude + spread(rng);
+            town.priceLevel = COUNTIES[county].priceLevel * townLevel(rng);
+            town.firstHouse = 0;
+            town.houseCount = 0;
+            towns.push_back(town);
+
+            // Bigger counties tend to get the bigger towns
+            sizeKeys.push_back(COUNTIES[county].population * townLevel(rng));
+        }
+
+        // Zipf house shares by size rank; houses are numbered town by town
+        std::vector<size_t> bySize(towns.size());
+        for (size_t i = 0; i < bySize.size(); ++i) {
+            bySize[i] = i;
+        }
+        std::sort(bySize.begin(), bySize.end(), [&sizeKeys](size_t a, size_t b) { return sizeKeys[a] > sizeKeys[b]; });
+        std::vector<double> weights(towns.size());
+        for (size_t rank = 0; rank < bySize.size(); ++rank) {
+            weights[bySize[rank]] = 1.0 / std::pow(static_cast<double>(rank + 1), options.skew);
+        }
+        std::vector<size_t> counts = apportion(options.houses, weights);
+        size_t next = 0;
+        for (size_t t = 0; t < towns.size(); ++t) {
+            towns[t].firstHouse = next;
+            towns[t].houseCount = counts[t];
+            next += counts[t];
+        }
+        return towns;
+    }
+
+    /**
+     * @brief Decide how many bookings each house gets
+     *
+     * Each booking picks a house by Zipf popularity; a house that already
+     * has as many bookings as fit in the history window passes the booking
+     * on to the next less popular house with room.
+     */
+    std::vector<unsigned short> planBookings(const Options& options, size_t capacity) {
+        std::mt19937_64 rng = streamFor(options.seed, STREAM_PLAN, 0);
+        std::vector<size_t> houseOfRank(options.houses);
+        for (size_t i = 0; i < houseOfRank.size(); ++i) {
+            houseOfRank[i] = i;
+        }
+        std::shuffle(houseOfRank.begin(), houseOfRank.end(), rng);
+
+        // nextFree[r]: a rank >= r that may have room (path-compressed); houses.size() = none
+        std::vector<size_t> nextFree(options.houses + 1);
+        for (size_t i = 0; i < nextFree.size(); ++i) {
+            nextFree[i] = i;
+        }
+        std::vector<unsigned short> counts(options.houses, 0);
+        Zipf popularity(options.houses, options.skew);
+        for (size_t b = 0; b < options.bookings; ++b) {
+            size_t rank = popularity(rng);
+
+            // Find the first rank at or after this one with room, compressing the path
+            size_t root = rank;
+            while (nextFree[root] != root) {
+                root = nextFree[root];
+            }
+            while (nextFree[rank] != root) {
+                size_t up = nextFree[rank];
+                nextFree[rank] = root;
+                rank = up;
+            }
+            if (root == options.houses) {
+                // Past the least popular house; wrap to the most popular with room
+                root = 0;
+                while (nextFree[root] != root) {
+                    root = nextFree[root];
+                }
+            }
+
+            unsigned short& count = counts[houseOfRank[root]];
+            if (++count == capacity) {
+                nextFree[root] = root + 1;
+            }
+        }
+        return counts;
+    }
+
+    class LineWriter {
+    private:
+        std::ofstream out;
+        std::string line;
+        size_t rows;
+
+    public:
+        explicit LineWriter(const std::string& path) : out(path.c_str(), std::ios::binary | std::ios::trunc), rows(0) {}
+
+        bool isOpen() const { return out.is_open(); }
+        size_t rowCount() const { return rows; }
+
+        LineWriter& field(const std::string& value) {
+            if (!line.empty()) {
+                line += '\t';
+            }
+            line += value;
+            return *this;
+        }
+
+        LineWriter& field(long long value) {
+            return field(std::to_string(value));
+        }
+
+        LineWriter& null() {
+            return field("\\N");
+        }
+
+        void endRow() {
+            line += '\n';
+            out.write(line.data(), line.size());
+            line.clear();
+            ++rows;
+        }
+
+        bool close() {
+            out.close();
+            return !out.fail();
+        }
+    };
+
+    /**
+     * @brief Everything the generator threads share; read-only once built
+     */
+    struct Plan {
+        Options options;
+        long long now;
+        std::string passwordHash;
+        std::vector<Town> towns;
+        std::vector<unsigned short> bookingsPerHouse;
+        std::vector<unsigned long long> firstBookingOfChunk;
+        std::vector<unsigned int> userOfRank;
+        Zipf* userActivity;
+    };
+
+    bool writeUsers(const Plan& plan, size_t chunk, std::vector<DataFile>& files, std::string& error) {
+        std::mt19937_64 rng = streamFor(plan.options.seed, STREAM_USERS, chunk);
+        DataFile file = { 2, "user_info", COLUMNS_USER, dataPath(plan.options, "user_info", chunk), 0 };
+        LineWriter users(file.path);
+        if (!users.isOpen()) {
+            error = "Cannot write " + file.path;
+            return false;
+        }
+
+        size_t end = std::min(plan.options.users, (chunk + 1) * USER_CHUNK);
+        for (size_t index = chunk * USER_CHUNK; index < end; ++index) {
+            std::string first = FIRST_NAMES[rng() % countOf(FIRST_NAMES)];
+            std::string last = LAST_NAMES[rng() % countOf(LAST_NAMES)];
+            long long userId = static_cast<long long>(index) + 1;
+            std::string email = toLowerCase(first.substr(0, 1) + last) + std::to_string(userId) + "@mboma.ke";
+            users.field(userId).field(first).field(last).field(email)
+                 .field("07" + digits(rng, 8)).field(plan.passwordHash);
+            users.endRow();
+        }
+        file.rows = users.rowCount();
+        if (!users.close()) {
+            error = "Failed writing " + file.path;
+            return false;
+        }
+        files.push_back(file);
+        return true;
+    }
+
+    bool writeHouses(const Plan& plan, size_t chunk, std::vector<DataFile>& files, std::string& error) {
+        const Options& options = plan.options;
+        std::mt19937_64 rng = streamFor(options.seed, STREAM_HOUSES, chunk);
+
+        DataFile houseFile = { 3, "houses", COLUMNS_HOUSE, dataPath(options, "houses", chunk), 0 };
+        DataFile costFile = { 4, "rental_cost", COLUMNS_RENTAL_COST, dataPath(options, "rental_cost", chunk), 0 };
+        DataFile detailFile = { 4, "payment_details", COLUMNS_PAYMENT_DETAILS, dataPath(options, "payment_details", chunk), 0 };
+        DataFile bookingFile = { 5, "bookings", COLUMNS_BOOKING, dataPath(options, "bookings", chunk), 0 };
+        DataFile paymentFile = { 6, "payments", COLUMNS_PAYMENT, dataPath(options, "payments", chunk), 0 };
+        LineWriter houses(houseFile.path);
+        LineWriter costs(costFile.path);
+        LineWriter details(detailFile.path);
+        LineWriter bookings(bookingFile.path);
+        LineWriter payments(paymentFile.path);
+        if (!houses.isOpen() || !costs.isOpen() || !details.isOpen() || !bookings.isOpen() || !payments.isOpen()) {
+            error = "Cannot write the files of chunk " + std::to_string(chunk) + " in " + options.outDir;
+            return false;
+        }
+
+        std::vector<double> shares;
+        for (size_t t = 0; t < countOf(HOUSE_TYPES); ++t) {
+            shares.push_back(HOUSE_TYPES[t].share);
+        }
+        std::discrete_distribution<size_t> pickType(shares.begin(), shares.end());
+        std::lognormal_distribution<double> rentNoise(0.0, 0.25);
+        std::normal_distribution<double> scatter(0.0, 0.02);    // About 2 km
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+        // Slots end one booking length after now, so a house's last booking may still be running
+        long long windowEnd = plan.now + BOOKING_LENGTH;
+        long long windowStart = windowEnd - options.days * DAY;
+        unsigned long long bookingId = plan.firstBookingOfChunk[chunk];
+
+        size_t begin = chunk * HOUSE_CHUNK;
+        size_t end = std::min(options.houses, begin + HOUSE_CHUNK);
+        size_t townIndex = 0;
+        while (townIndex + 1 < plan.towns.size() &&
+               plan.towns[townIndex].firstHouse + plan.towns[townIndex].houseCount <= begin) {
+            ++townIndex;
+        }
+
+        for (size_t index = begin; index < end; ++index) {
+            while (index >= plan.towns[townIndex].firstHouse + plan.towns[townIndex].houseCount) {
+                ++townIndex;
+            }
+            const Town& town = plan.towns[townIndex];
+            std::string id = houseId(index);
+            const HouseType& type = HOUSE_TYPES[pickType(rng)];
+
+            double rent = std::max(3000.0, std::round(type.medianRent * town.priceLevel * rentNoise(rng) / 500.0) * 500.0);
+            double depositMonths = unit(rng);
+            double deposit = rent * (depositMonths < 0.3 ? 1 : depositMonths < 0.8 ? 2 : 3);
+
+            std::string address = std::string(STREETS[rng() % countOf(STREETS)]) + " " +
+                                  STREET_KINDS[rng() % countOf(STREET_KINDS)] + ", " + town.name + ", " +
+                                  type.name + " #" + id;
+            bool located = unit(rng) >= UNLOCATED_SHARE;
+            double latitude = town.latitude + scatter(rng);
+            double longitude = town.longitude + scatter(rng);
+            char coordinate[32];
+            std::string mapLink = "https://maps.google.com/?q=";
+            if (located) {
+                std::snprintf(coordinate, sizeof(coordinate), "%.6f,%.6f", latitude, longitude);
+                mapLink += coordinate;
+            } else {
+                std::string place = town.name;
+                std::replace(place.begin(), place.end(), ' ', '+');
+                mapLink += place + ",Kenya";
+            }
+
+            // Bookings: one per equal slot of the window, at a random time within it
+            unsigned short count = plan.bookingsPerHouse[index];
+            bool bookedNow = false;
+            bool paidNow = false;
+            long long bookedUntil = 0;
+            if (count > 0) {
+                long long slot = (windowEnd - windowStart) / count;
+                for (unsigned short b = 0; b < count; ++b, ++bookingId) {
+                    long long start = windowStart + b * slot +
+                        static_cast<long long>(unit(rng) * static_cast<double>(slot - MIN_SLOT));
+                    long long expiry = start + BOOKING_LENGTH;
+                    bool active = expiry > plan.now;
+                    bool paid = unit(rng) < options.paidShare;
+                    unsigned int userId = plan.userOfRank[(*plan.userActivity)(rng)];
+
+                    bookings.field(static_cast<long long>(bookingId)).field(static_cast<long long>(userId))
+                            .field(id).field(town.id).field(formatTime(start)).field(formatTime(expiry))
+                            .field(paid ? 1 : 0).field(active ? "active" : "expired");
+                    bookings.endRow();
+
+                    if (paid) {
+                        long long paidAt = start + static_cast<long long>(unit(rng) * 3 * DAY);
+                        payments.field(static_cast<long long>(bookingId)).field(static_cast<long long>(bookingId))
+                                .field(money(deposit)).field(formatTime(std::min(paidAt, plan.now)))
+                                .field(unit(rng) < MPESA_SHARE ? "M-Pesa" : "Bank Transfer")
+                                .field("RCPG" + std::to_string(bookingId));
+                        payments.endRow();
+                    }
+                    if (active) {
+                        bookedNow = true;
+                        paidNow = paid;
+                        bookedUntil = expiry;
+                    }
+                }
+            }
+
+            // A paid, current booking takes the house off the listings, as the app does
+            houses.field(town.id).field(id).field(type.name).field(address).field(mapLink)
+                  .field(money(deposit)).field(money(rent)).field(bookedNow && paidNow ? 0 : 1)
+                  .field(bookedNow ? 1 : 0);
+            if (bookedNow) {
+                houses.field(formatTime(bookedUntil));
+            } else {
+                houses.null();
+            }
+            if (located) {
+                std::snprintf(coordinate, sizeof(coordinate), "%.6f", latitude);
+                houses.field(coordinate);
+                std::snprintf(coordinate, sizeof(coordinate), "%.6f", longitude);
+                houses.field(coordinate);
+            } else {
+                houses.null().null();
+            }
+            houses.endRow();
+
+            costs.field(id).field(town.id).field(type.name)
+                 .field(static_cast<long long>(deposit)).field(static_cast<long long>(rent));
+            costs.endRow();
+
+            details.field(id).field(town.id).field(type.name).field("01" + digits(rng, 11))
+                   .field(digits(rng, 6)).field("07" + digits(rng, 8));
+            details.endRow();
+        }
+
+        houseFile.rows = houses.rowCount();
+        costFile.rows = costs.rowCount();
+        detailFile.rows = details.rowCount();
+        bookingFile.rows = bookings.rowCount();
+        paymentFile.rows = payments.rowCount();
+        if (!houses.close() || !costs.close() || !details.close() || !bookings.close() || !payments.close()) {
+            error = "Failed writing the files of chunk " + std::to_string(chunk);
+            return false;
+        }
+        files.push_back(houseFile);
+        files.push_back(costFile);
+        files.push_back(detailFile);
+        files.push_back(bookingFile);
+        files.push_back(paymentFile);
+        return true;
+    }
+
+    bool writeLocations(const Plan& plan, std::vector<DataFile>& files, std::string& error) {
+        DataFile countyFile = { 0, "county", COLUMNS_COUNTY, plan.options.outDir + "/county.tsv", 0 };
+        DataFile townFile = { 1, "town", COLUMNS_TOWN, plan.options.outDir + "/town.tsv", 0 };
+        LineWriter counties(countyFile.path);
+        LineWriter towns(townFile.path);
+        if (!counties.isOpen() || !towns.isOpen()) {
+            error = "Cannot write to " + plan.options.outDir;
+            return false;
+        }
+        for (size_t c = 0; c < countOf(COUNTIES); ++c) {
+            counties.field(static_cast<long long>(c + 1)).field(COUNTIES[c].name);
+            counties.endRow();
+        }
+        for (size_t t = 0; t < plan.towns.size(); ++t) {
+            towns.field(plan.towns[t].id).field(plan.towns[t].name).field(plan.towns[t].countyId);
+            towns.endRow();
+        }
+        countyFile.rows = counties.rowCount();
+        townFile.rows = towns.rowCount();
+        if (!counties.close() || !towns.close()) {
+            error = "Failed writing the location files";
+            return false;
+        }
+        files.push_back(countyFile);
+        files.push_back(townFile);
+        return true;
+    }
+
+    bool query(MYSQL* mysql, const std::string& sql, std::string& error) {
+        if (mysql_real_query(mysql, sql.c_str(), sql.length())) {
+            error = mysql_error(mysql);
+            return false;
+        }
+        // Drain any result so the connection stays usable
+        MYSQL_RES* result = mysql_store_result(mysql);
+        if (result) {
+            mysql_free_result(result);
+        }
+        return true;
+    }
+
+    MYSQL* openConnection(std::string& error) {
+        MYSQL* mysql = mysql_init(nullptr);
+        if (!mysql) {
+            error = "MySQL initialization failed";
+            return nullptr;
+        }
+        unsigned int enable = 1;
+        mysql_options(mysql, MYSQL_OPT_LOCAL_INFILE, &enable);
+        if (!mysql_real_connect(mysql, DBConfig::DB_HOST.c_str(), DBConfig::DB_USER.c_str(),
+                                DBConfig::DB_PASS.c_str(), DBConfig::DB_NAME.c_str(), 0, nullptr, 0)) {
+            error = mysql_error(mysql);
+            mysql_close(mysql);
+            return nullptr;
+        }
+
+        // Rows are generated consistent; skip the per-row checks while loading
+        if (!query(mysql, "SET foreign_key_checks = 0", error) || !query(mysql, "SET unique_checks = 0", error)) {
+            mysql_close(mysql);
+            return nullptr;
+        }
+        return mysql;
+    }
+
+    std::string escape(MYSQL* mysql, const std::string& text) {
+        std::string escaped(text.size() * 2 + 1, '\0');
+        unsigned long length = mysql_real_escape_string(mysql, &escaped[0], text.c_str(), text.size());
+        escaped.resize(length);
+        return escaped;
+    }
+
+    bool loadWithLoadData(MYSQL* mysql, const DataFile& file, std::string& error) {
+        std::string sql = "LOAD DATA LOCAL INFILE '" + escape(mysql, file.path) + "' INTO TABLE " + file.table +
+                          " FIELDS TERMINATED BY '\\t' LINES TERMINATED BY '\\n' (" + file.columns + ")";
+        return query(mysql, sql, error);
+    }
+
+    bool loadWithInserts(MYSQL* mysql, const DataFile& file, size_t batchRows, std::string& error) {
+        std::ifstream in(file.path.c_str());
+        if (!in.is_open()) {
+            error = "Cannot read " + file.path;
+            return false;
+        }
+        const std::string prefix = "INSERT INTO " + file.table + " (" + file.columns + ") VALUES ";
+        std::string sql;
+        size_t rows = 0;
+        std::string line;
+        if (!query(mysql, "START TRANSACTION", error)) {
+            return false;
+        }
+        while (std::getline(in, line)) {
+            sql += rows == 0 ? prefix : ",";
+            sql += '(';
+            size_t start = 0;
+            while (true) {
+                size_t tab = line.find('\t', start);
+                std::string value = line.substr(start, tab == std::string::npos ? std::string::npos : tab - start);
+                sql += value == "\\N" ? "NULL" : "'" + escape(mysql, value) + "'";
+                if (tab == std::string::npos) {
+                    break;
+                }
+                sql += ',';
+                start = tab + 1;
+            }
+            sql += ')';
+            if (++rows == batchRows) {
+                if (!query(mysql, sql, error)) {
+                    query(mysql, "ROLLBACK", error);
+                    return false;
+                }
+                sql.clear();
+                rows = 0;
+            }
+        }
+        if (rows > 0 && !query(mysql, sql, error)) {
+            query(mysql, "ROLLBACK", error);
+            return false;
+        }
+        return query(mysql, "COMMIT", error);
+    }
+
+    /**
+     * @brief Check the database is empty, or empty it with --replace
+     */
+    bool prepareDatabase(const Options& options, std::string& error) {
+        MYSQL* mysql = openConnection(error);
+        if (!mysql) {
+            return false;
+        }
+        bool ok = true;
+        if (options.replace) {
+            const char* tables[] = { "payments", "bookings", "payment_details", "rental_cost",
+                                     "houses", "town", "county", "user_info" };
+            for (size_t i = 0; ok && i < countOf(tables); ++i) {
+                ok = query(mysql, std::string("TRUNCATE TABLE ") + tables[i], error);
+            }
+        } else {
+            const char* sql = "SELECT (SELECT COUNT(*) FROM county) + (SELECT COUNT(*) FROM houses) + "
+                              "(SELECT COUNT(*) FROM user_info) + (SELECT COUNT(*) FROM bookings)";
+            ok = mysql_real_query(mysql, sql, std::strlen(sql)) == 0;
+            MYSQL_RES* result = ok ? mysql_store_result(mysql) : nullptr;
+            MYSQL_ROW row = result ? mysql_fetch_row(result) : nullptr;
+            if (!row) {
+                error = mysql_error(mysql);
+                ok = false;
+            } else if (row[0] && std::atoll(row[0]) > 0) {
+                error = "The database already has data; run with --replace to delete it first";
+                ok = false;
+            }
+            if (result) {
+                mysql_free_result(result);
+            }
+        }
+        mysql_close(mysql);
+        return ok;
+    }
+
+    bool parseOptions(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--houses" && hasValue) {
+                options.houses = std::strtoull(argv[++i], nullptr, 10);
+            } else if (arg == "--users" && hasValue) {
+                options.users = std::strtoull(argv[++i], nullptr, 10);
+            } else if (arg == "--bookings" && hasValue) {
+                options.bookings = std::strtoull(argv[++i], nullptr, 10);
+            } else if (arg == "--towns" && hasValue) {
+                options.towns = std::strtoull(argv[++i], nullptr, 10);
+            } else if (arg == "--skew" && hasValue) {
+                options.skew = std::atof(argv[++i]);
+            } else if (arg == "--days" && hasValue) {
+                options.days = std::atoi(argv[++i]);
+            } else if (arg == "--paid" && hasValue) {
+                options.paidShare = std::atof(argv[++i]);
+            } else if (arg == "--seed" && hasValue) {
+                options.seed = std::strtoull(argv[++i], nullptr, 10);
+            } else if (arg == "--threads" && hasValue) {
+                options.threads = std::strtoull(argv[++i], nullptr, 10);
+            } else if (arg == "--out" && hasValue) {
+                options.outDir = argv[++i];
+            } else if (arg == "--batch" && hasValue) {
+                options.batchRows = std::strtoull(argv[++i], nullptr, 10);
+            } else if (arg == "--no-load") {
+                options.load = false;
+            } else if (arg == "--insert") {
+                options.useInsert = true;
+            } else if (arg == "--replace") {
+                options.replace = true;
+            } else {
+                return false;
+            }
+        }
+        return options.houses > 0 && options.users > 0 && options.towns > 0 && options.threads > 0 &&
+               options.batchRows > 0 && options.skew >= 0 && options.paidShare >= 0 && options.paidShare <= 1 &&
+               options.days >= 2 * Booking::GRACE_PERIOD_DAYS && options.users < 4000000000ULL;
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--houses N] [--users N] [--bookings N] [--towns N]\n"
+                  << "       [--skew S] [--days D] [--paid F] [--seed N] [--threads T]\n"
+                  << "       [--out DIR] [--no-load] [--insert] [--batch N] [--replace]\n"
+                  << "--days must be at least " << 2 * Booking::GRACE_PERIOD_DAYS << "\n";
+        return 1;
+    }
+
+    // Each house fits this many non-overlapping bookings in the window
+    size_t capacity = std::min<size_t>(static_cast<size_t>(options.days * DAY / MIN_SLOT), 65535);
+    if (options.bookings > options.houses * capacity) {
+        std::cerr << options.houses << " houses hold at most " << options.houses * capacity
+                  << " bookings in " << options.days << " days; add houses or days\n";
+        return 1;
+    }
+    if (mkdir(options.outDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "Cannot create " << options.outDir << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    std::string error;
+    if (options.load && !prepareDatabase(options, error)) {
+        std::cerr << "Database: " << error << "\n";
+        return 1;
+    }
+
+    // Plan on one thread: towns, bookings per house, user activity
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Plan plan;
+    plan.options = options;
+    parseDateTime(getCurrentDateTime(), plan.now);
+    plan.now -= plan.now % DAY;    // Midnight, so reruns on the same day match
+    plan.passwordHash = hashPassword(PASSWORD);
+    plan.towns = planTowns(options);
+    plan.bookingsPerHouse = planBookings(options, capacity);
+
+    size_t houseChunks = (options.houses + HOUSE_CHUNK - 1) / HOUSE_CHUNK;
+    size_t userChunks = (options.users + USER_CHUNK - 1) / USER_CHUNK;
+    unsigned long long nextBooking = 1;
+    for (size_t chunk = 0; chunk < houseChunks; ++chunk) {
+        plan.firstBookingOfChunk.push_back(nextBooking);
+        size_t end = std::min(options.houses, (chunk + 1) * HOUSE_CHUNK);
+        for (size_t index = chunk * HOUSE_CHUNK; index < end; ++index) {
+            nextBooking += plan.bookingsPerHouse[index];
+        }
+    }
+
+    std::mt19937_64 userRng = streamFor(options.seed, STREAM_PLAN, 1);
+    plan.userOfRank.resize(options.users);
+    for (size_t i = 0; i < plan.userOfRank.size(); ++i) {
+        plan.userOfRank[i] = static_cast<unsigned int>(i + 1);
+    }
+    std::shuffle(plan.userOfRank.begin(), plan.userOfRank.end(), userRng);
+    Zipf userActivity(options.users, options.skew);
+    plan.userActivity = &userActivity;
+    std::cout << "Planned " << options.towns << " towns and " << options.bookings << " bookings in "
+              << std::fixed << std::setprecision(2) << secondsSince(start) << " s\n";
+
+    // Generate the chunks in parallel
+    start = std::chrono::steady_clock::now();
+    std::vector<DataFile> files;
+    if (!writeLocations(plan, files, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::atomic<size_t> nextJob(0);
+    std::mutex resultMutex;
+    std::vector<std::thread> threads;
+    size_t jobs = userChunks + houseChunks;
+    for (size_t t = 0; t < std::min(options.threads, jobs); ++t) {
+        threads.push_back(std::thread([&]() {
+            for (size_t job = nextJob++; job < jobs; job = nextJob++) {
+                std::vector<DataFile> written;
+                std::string jobError;
+                bool ok = job < userChunks ? writeUsers(plan, job, written, jobError)
+                                           : writeHouses(plan, job - userChunks, written, jobError);
+                std::lock_guard<std::mutex> lock(resultMutex);
+                if (!ok) {
+                    error = jobError;
+                }
+                files.insert(files.end(), written.begin(), written.end());
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    threads.clear();
+    if (!error.empty()) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::sort(files.begin(), files.end());
+
+    size_t totalRows = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        totalRows += files[i].rows;
+    }
+    double generateSeconds = secondsSince(start);
+    std::cout << "Wrote " << totalRows << " rows in " << files.size() << " files to " << options.outDir << " in "
+              << generateSeconds << " s (" << std::setprecision(0) << totalRows / std::max(generateSeconds, 1e-9)
+              << " rows/s)\n" << std::setprecision(2);
+    if (!options.load) {
+        return 0;
+    }
+
+    // Load the files over several connections; foreign key checks are off, so order is free
+    start = std::chrono::steady_clock::now();
+    std::atomic<size_t> nextFile(0);
+    std::atomic<size_t> loadedRows(0);
+    for (size_t t = 0; t < std::min(options.threads, files.size()); ++t) {
+        threads.push_back(std::thread([&]() {
+            std::string loadError;
+            MYSQL* mysql = openConnection(loadError);
+            if (mysql) {
+                for (size_t index = nextFile++; index < files.size(); index = nextFile++) {
+                    bool ok = options.useInsert ? loadWithInserts(mysql, files[index], options.batchRows, loadError)
+                                                : loadWithLoadData(mysql, files[index], loadError);
+                    if (!ok) {
+                        loadError = files[index].path + ": " + loadError;
+                        break;
+                    }
+                    loadedRows += files[index].rows;
+                }
+                mysql_close(mysql);
+                mysql_thread_end();
+            }
+            if (!loadError.empty()) {
+                std::lock_guard<std::mutex> lock(resultMutex);
+                error = loadError;
+                nextFile = files.size();   // Stop the other loaders
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    if (!error.empty()) {
+        std::cerr << "Load failed: " << error << "\n";
+        return 1;
+    }
+
+    double loadSeconds = secondsSince(start);
+    std::cout << "Loaded " << loadedRows << " rows with " << (options.useInsert ? "multi-row INSERT" : "LOAD DATA")
+              << " in " << loadSeconds << " s (" << std::setprecision(0)
+              << loadedRows / std::max(loadSeconds, 1e-9) << " rows/s)\n";
+    std::cout << "Generated users log in with their email and the password \"" << PASSWORD << "\"\n";
+    return 0;
+}
@@ -0,0 +1,526 @@
+/**
+ * M-Boma load generator
+ *
+ * Simulates tenants using one deployment: scenarios arrive at a fixed
+ * average rate (Poisson, open loop) whether or not earlier ones have
+ * finished, and a pool of worker threads runs them through one shared
+ * DBConnector, as the console and API server do. Each scenario is done as
+ * one of the --users tenants read from the database:
+ *
+ *   login    load the user by email, check the password, load their bookings
+ *   browse   counties, then the towns of one, then the houses of one town
+ *   search   houses by type and rent band, in one town or everywhere
+ *   book     the houses of a town, then book_house on one that is open
+ *   pay      book as above, then record the payment of the deposit
+ *
+ * Every database call is timed into an HDR histogram per operation
+ * (service time). Scenarios are timed from their scheduled arrival, so
+ * time spent waiting for a free worker or connection counts too and an
+ * overloaded deployment shows up in the percentiles rather than as a
+ * lower request rate. Only arrivals after --warmup are counted.
+ *
+ * Bookings made by the run are real. Load a throwaway dataset first, e.g.
+ * with mboma-datagen, whose users all have the password "mboma123".
+ *
+ * Usage:
+ *   mboma-loadgen [--rate R] [--threads T] [--duration S] [--warmup S]
+ *                 [--users N] [--password P] [--mix SPEC] [--seed N] [--json FILE]
+ *
+ *   --rate R       Scenarios started per second (default 50)
+ *   --threads T    Worker threads, the most scenarios in progress (default 64)
+ *   --duration S   Seconds measured (default 60)
+ *   --warmup S     Seconds run before measuring (default 5)
+ *   --users N      Tenants read from user_info (default 1000)
+ *   --password P   Password of those tenants (default mboma123)
+ *   --mix SPEC     Scenario weights (default login=20,browse=35,search=30,book=10,pay=5)
+ *   --seed N       Random seed for arrivals and choices (default 42)
+ *   --json FILE    Also write the results as JSON
+ *
+ * Exits with status 2 if any scenario failed with a database error.
+ */
+
+#include "DBConnector.h"
+#include "DBConfig.h"
+#include "HdrHistogram.h"
+#include "Json.h"
+#include "Utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    const long long HIGHEST_MICROS = 120LL * 1000 * 1000;   // Latencies above two minutes are clamped
+    const double SATURATION_LAG_MS = 100.0;                  // p99 start lag that means too few workers
+
+    enum Scenario { SCENARIO_LOGIN, SCENARIO_BROWSE, SCENARIO_SEARCH, SCENARIO_BOOK, SCENARIO_PAY, SCENARIO_COUNT };
+    const char* SCENARIO_NAMES[SCENARIO_COUNT] = { "login", "browse", "search", "book", "pay" };
+
+    enum Operation { OP_LOGIN, OP_COUNTIES, OP_TOWNS, OP_HOUSES, OP_SEARCH, OP_BOOK, OP_PAY, OP_COUNT };
+    const char* OPERATION_NAMES[OP_COUNT] = { "login", "counties", "towns", "houses", "search", "book", "pay" };
+
+    const char* SEARCH_TYPES[] = { "Bedsitter", "Studio", "One Bedroom", "Two Bedroom", "Bungalow", "Mansionette" };
+    const size_t SEARCH_TYPE_COUNT = sizeof(SEARCH_TYPES) / sizeof(SEARCH_TYPES[0]);
+
+    enum Outcome { OUTCOME_OK, OUTCOME_REJECTED, OUTCOME_ERROR };
+
+    struct Tenant {
+        int id;
+        std::string email;
+    };
+
+    /**
+     * @brief Latencies and outcome counts of one operation or scenario
+     */
+    struct Series {
+        HdrHistogram micros;
+        unsigned long long rejected;    // Normal refusals, e.g. the house was taken first
+        unsigned long long errors;
+
+        Series() : micros(HIGHEST_MICROS), rejected(0), errors(0) {}
+    };
+
+    /**
+     * @brief Everything the workers share
+     */
+    struct Run {
+        DBConnector* db;
+        std::string password;
+        std::vector<Tenant> tenants;
+        std::vector<Location> counties;
+        std::vector<Location> towns;
+
+        // Arrival schedule, drawn in order under scheduleMutex
+        std::mutex scheduleMutex;
+        std::mt19937_64 scheduleRng;
+        std::exponential_distribution<double> gap;
+        std::discrete_distribution<int> pickScenario;
+        double nextArrival;             // Seconds after start
+        double warmupSeconds;
+        double endSeconds;
+        Clock::time_point start;
+
+        // Results, merged under resultsMutex
+        std::mutex resultsMutex;
+        Series operations[OP_COUNT];
+        Series scenarios[SCENARIO_COUNT];
+        HdrHistogram startLag;          // Scheduled arrival to start of work
+
+        Run() : db(nullptr), nextArrival(0.0), warmupSeconds(0.0), endSeconds(0.0), startLag(HIGHEST_MICROS) {}
+    };
+
+    long long microsBetween(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+    }
+
+    /**
+     * @brief Latencies one worker collects for one scenario, merged afterwards
+     */
+    struct Timings {
+        std::vector<std::pair<Operation, long long> > micros;
+        std::vector<std::pair<Operation, Outcome> > outcomes;
+
+        template <typename Call>
+        void time(Operation op, Call call) {
+            Clock::time_point begin = Clock::now();
+            Outcome outcome = call();
+            micros.push_back(std::make_pair(op, microsBetween(begin, Clock::now())));
+            outcomes.push_back(std::make_pair(op, outcome));
+        }
+    };
+
+    template <typename T>
+    const T& pick(const std::vector<T>& items, std::mt19937_64& rng) {
+        return items[rng() % items.size()];
+    }
+
+    // The houses of a random town, then one of them that is open for booking
+    Outcome findOpenHouse(Run& run, std::mt19937_64& rng, Timings& timings, std::vector<House>& houses,
+                          size_t& chosen) {
+        int townId = pick(run.towns, rng).getId();
+        timings.time(OP_HOUSES, [&]() {
+            houses = run.db->loadHouses(townId);
+            return OUTCOME_OK;
+        });
+        std::vector<size_t> open;
+        for (size_t i = 0; i < houses.size(); ++i) {
+            if (houses[i].getAvailability() && !houses[i].getBookingStatus()) {
+                open.push_back(i);
+            }
+        }
+        if (open.empty()) {
+            return OUTCOME_REJECTED;
+        }
+        chosen = pick(open, rng);
+        return OUTCOME_OK;
+    }
+
+    Outcome runScenario(Run& run, Scenario scenario, const Tenant& tenant, std::mt19937_64& rng, Timings& timings) {
+        DBConnector& db = *run.db;
+        switch (scenario) {
+            case SCENARIO_LOGIN: {
+                Outcome outcome = OUTCOME_OK;
+                timings.time(OP_LOGIN, [&]() -> Outcome {
+                    User user;
+                    if (!db.loadUserByEmail(tenant.email, user)) {
+                        return outcome = OUTCOME_ERROR;
+                    }
+                    if (!user.login(tenant.email, run.password)) {
+                        return outcome = OUTCOME_REJECTED;
+                    }
+                    db.loadBookings(user.getId());
+                    return OUTCOME_OK;
+                });
+                return outcome;
+            }
+            case SCENARIO_BROWSE: {
+                std::vector<Location> counties;
+                std::vector<Location> towns;
+                timings.time(OP_COUNTIES, [&]() {
+                    counties = db.loadCounties();
+                    return counties.empty() ? OUTCOME_ERROR : OUTCOME_OK;
+                });
+                if (counties.empty()) {
+                    return OUTCOME_ERROR;
+                }
+                int countyId = pick(counties, rng).getId();
+                timings.time(OP_TOWNS, [&]() {
+                    towns = db.loadTowns(countyId);
+                    return OUTCOME_OK;
+                });
+                if (!towns.empty()) {
+                    int townId = pick(towns, rng).getId();
+                    timings.time(OP_HOUSES, [&]() {
+                        db.loadHouses(townId);
+                        return OUTCOME_OK;
+                    });
+                }
+                return OUTCOME_OK;
+            }
+            case SCENARIO_SEARCH: {
+                std::string type = SEARCH_TYPES[rng() % SEARCH_TYPE_COUNT];
+                double minRent = 5000.0 * (1 + rng() % 10);
+                int townId = rng() % 2 ? pick(run.towns, rng).getId() : -1;
+                timings.time(OP_SEARCH, [&]() {
+                    db.searchHouses(type, minRent, minRent * 2, townId);
+                    return OUTCOME_OK;
+                });
+                return OUTCOME_OK;
+            }
+            case SCENARIO_BOOK:
+            case SCENARIO_PAY: {
+                std::vector<House> houses;
+                size_t chosen = 0;
+                Outcome outcome = findOpenHouse(run, rng, timings, houses, chosen);
+                if (outcome != OUTCOME_OK) {
+                    return outcome;
+                }
+                const House& house = houses[chosen];
+                DBConnector::BookingResult booking;
+                timings.time(OP_BOOK, [&]() -> Outcome {
+                    booking = db.bookHouse(tenant.id, house.getId(), house.getLocationId());
+                    switch (booking.status) {
+                        case DBConnector::BOOKING_CREATED:
+                            return OUTCOME_OK;
+                        case DBConnector::BOOKING_HOUSE_TAKEN:
+                        case DBConnector::BOOKING_HOUSE_NOT_FOUND:
+                            return OUTCOME_REJECTED;
+                        default:
+                            return OUTCOME_ERROR;
+                    }
+                });
+                if (booking.status != DBConnector::BOOKING_CREATED) {
+                    return booking.status == DBConnector::BOOKING_FAILED ? OUTCOME_ERROR : OUTCOME_REJECTED;
+                }
+                if (scenario == SCENARIO_PAY) {
+                    const char* method = rng() % 10 < 7 ? "M-Pesa" : "Bank Transfer";
+                    timings.time(OP_PAY, [&]() {
+                        return db.recordPayment(tenant.id, booking.bookingId, house.getDepositFee(), method).empty()
+                            ? OUTCOME_ERROR : OUTCOME_OK;
+                    });
+                    if (timings.outcomes.back().second != OUTCOME_OK) {
+                        return OUTCOME_ERROR;
+                    }
+                }
+                return OUTCOME_OK;
+            }
+            default:
+                return OUTCOME_ERROR;
+        }
+    }
+
+    void count(Series& series, Outcome outcome) {
+        if (outcome == OUTCOME_REJECTED) {
+            ++series.rejected;
+        } else if (outcome == OUTCOME_ERROR) {
+            ++series.errors;
+        }
+    }
+
+    void worker(Run& run, unsigned long long seed) {
+        std::mt19937_64 rng(seed);
+        while (true) {
+            double arrival;
+            Scenario scenario;
+            size_t tenant;
+            {
+                std::lock_guard<std::mutex> lock(run.scheduleMutex);
+                arrival = run.nextArrival;
+                if (arrival >= run.endSeconds) {
+                    return;
+                }
+                scenario = static_cast<Scenario>(run.pickScenario(run.scheduleRng));
+                tenant = run.scheduleRng() % run.tenants.size();
+                run.nextArrival += run.gap(run.scheduleRng);
+            }
+
+            Clock::time_point scheduled = run.start + std::chrono::microseconds(static_cast<long long>(arrival * 1e6));
+            std::this_thread::sleep_until(scheduled);
+            Clock::time_point begin = Clock::now();
+
+            Timings timings;
+            Outcome outcome = runScenario(run, scenario, run.tenants[tenant], rng, timings);
+            Clock::time_point end = Clock::now();
+
+            if (arrival < run.warmupSeconds) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(run.resultsMutex);
+            for (size_t i = 0; i < timings.micros.size(); ++i) {
+                Series& series = run.operations[timings.micros[i].first];
+                series.micros.record(timings.micros[i].second);
+                count(series, timings.outcomes[i].second);
+            }
+            run.scenarios[scenario].micros.record(microsBetween(scheduled, end));
+            count(run.scenarios[scenario], outcome);
+            run.startLag.record(microsBetween(scheduled, begin));
+        }
+    }
+
+    bool parseMix(const std::string& spec, std::vector<double>& weights) {
+        weights.assign(SCENARIO_COUNT, 0.0);
+        std::stringstream items(spec);
+        std::string item;
+        while (std::getline(items, item, ',')) {
+            size_t equals = item.find('=');
+            if (equals == std::string::npos) {
+                return false;
+            }
+            std::string name = item.substr(0, equals);
+            int scenario = 0;
+            while (scenario < SCENARIO_COUNT && name != SCENARIO_NAMES[scenario]) {
+                ++scenario;
+            }
+            if (scenario == SCENARIO_COUNT) {
+                return false;
+            }
+            weights[scenario] = std::atof(item.c_str() + equals + 1);
+            if (weights[scenario] < 0) {
+                return false;
+            }
+        }
+        double total = 0.0;
+        for (size_t i = 0; i < weights.size(); ++i) {
+            total += weights[i];
+        }
+        return total > 0;
+    }
+
+    void printHeader() {
+        std::cout << std::left << std::setw(10) << "" << std::right << std::setw(9) << "count"
+                  << std::setw(9) << "per s" << std::setw(9) << "rejected" << std::setw(8) << "errors"
+                  << std::setw(9) << "mean ms" << std::setw(9) << "p50" << std::setw(9) << "p90"
+                  << std::setw(9) << "p99" << std::setw(9) << "p99.9" << std::setw(9) << "max" << "\n";
+    }
+
+    void printSeries(const char* name, const Series& series, double seconds) {
+        const HdrHistogram& h = series.micros;
+        std::cout << std::left << std::setw(10) << name << std::right << std::setw(9) << h.count()
+                  << std::fixed << std::setprecision(1) << std::setw(9) << h.count() / seconds
+                  << std::setw(9) << series.rejected << std::setw(8) << series.errors
+                  << std::setprecision(2) << std::setw(9) << h.mean() / 1000.0
+                  << std::setw(9) << h.valueAtPercentile(50) / 1000.0
+                  << std::setw(9) << h.valueAtPercentile(90) / 1000.0
+                  << std::setw(9) << h.valueAtPercentile(99) / 1000.0
+                  << std::setw(9) << h.valueAtPercentile(99.9) / 1000.0
+                  << std::setw(9) << h.max() / 1000.0 << "\n";
+    }
+
+    void writeSeries(JsonWriter& json, const char* name, const Series& series, double seconds) {
+        const HdrHistogram& h = series.micros;
+        json.beginObject()
+            .key("name").value(name)
+            .key("count").value(h.count())
+            .key("per_second").value(h.count() / seconds)
+            .key("rejected").value(series.rejected)
+            .key("errors").value(series.errors)
+            .key("mean_ms").value(h.mean() / 1000.0, 3)
+            .key("p50_ms").value(h.valueAtPercentile(50) / 1000.0, 3)
+            .key("p90_ms").value(h.valueAtPercentile(90) / 1000.0, 3)
+            .key("p99_ms").value(h.valueAtPercentile(99) / 1000.0, 3)
+            .key("p999_ms").value(h.valueAtPercentile(99.9) / 1000.0, 3)
+            .key("max_ms").value(h.max() / 1000.0, 3)
+            .endObject();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    double rate = 50.0;
+    size_t threads = 64;
+    double duration = 60.0;
+    double warmup = 5.0;
+    size_t userCount = 1000;
+    std::string password = "mboma123";
+    std::string mix = "login=20,browse=35,search=30,book=10,pay=5";
+    unsigned long long seed = 42;
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            rate = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<size_t>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            duration = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--users") == 0 && i + 1 < argc) {
+            userCount = static_cast<size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--password") == 0 && i + 1 < argc) {
+            password = argv[++i];
+        } else if (std::strcmp(argv[i], "--mix") == 0 && i + 1 < argc) {
+            mix = argv[++i];
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--rate R] [--threads T] [--duration S] [--warmup S]\n"
+                      << "       [--users N] [--password P] [--mix SPEC] [--seed N] [--json FILE]\n";
+            return 1;
+        }
+    }
+    std::vector<double> weights;
+    if (rate <= 0 || threads == 0 || duration <= 0 || warmup < 0 || userCount == 0 || !parseMix(mix, weights)) {
+        std::cerr << "Rate, threads, duration and users must be positive, and --mix must look like "
+                     "login=20,browse=35,search=30,book=10,pay=5\n";
+        return 1;
+    }
+
+    DBConnector db;
+    if (!db.connect(DBConfig::DB_HOST, DBConfig::DB_USER, DBConfig::DB_PASS, DBConfig::DB_NAME)) {
+        std::cerr << "Database: " << db.getLastError() << "\n";
+        return 1;
+    }
+
+    Run run;
+    run.db = &db;
+    run.password = password;
+    db.forEachUser([&run, userCount](User&& user) {
+        Tenant tenant = { user.getId(), user.getEmail() };
+        run.tenants.push_back(tenant);
+        return run.tenants.size() < userCount;
+    });
+    run.counties = db.loadCounties();
+    run.towns = db.loadAllTowns();
+    if (run.tenants.empty() || run.counties.empty() || run.towns.empty()) {
+        std::cerr << "The database needs users, counties and towns; load a dataset with mboma-datagen first\n";
+        return 1;
+    }
+
+    run.scheduleRng.seed(seed);
+    run.gap = std::exponential_distribution<double>(rate);
+    run.pickScenario = std::discrete_distribution<int>(weights.begin(), weights.end());
+    run.warmupSeconds = warmup;
+    run.endSeconds = warmup + duration;
+
+    std::cout << "Offering " << rate << " scenarios/s from " << run.tenants.size() << " tenants over "
+              << threads << " workers and " << DBConfig::POOL_MAX_SIZE << " connections for "
+              << warmup << " + " << duration << " s (" << mix << ")\n";
+    run.start = Clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.push_back(std::thread(worker, std::ref(run), seed * 1000003ULL + t + 1));
+    }
+    for (size_t t = 0; t < workers.size(); ++t) {
+        workers[t].join();
+    }
+    // Scenarios still running at the end finish late; measure to the last one
+    double measured = std::max(duration, std::chrono::duration<double>(Clock::now() - run.start).count() - warmup);
+
+    std::cout << "\nOperations (service time, ms):\n";
+    printHeader();
+    for (int op = 0; op < OP_COUNT; ++op) {
+        if (run.operations[op].micros.count()) {
+            printSeries(OPERATION_NAMES[op], run.operations[op], measured);
+        }
+    }
+    std::cout << "\nScenarios (from scheduled arrival, ms):\n";
+    printHeader();
+    Series all;
+    for (int scenario = 0; scenario < SCENARIO_COUNT; ++scenario) {
+        if (run.scenarios[scenario].micros.count()) {
+            printSeries(SCENARIO_NAMES[scenario], run.scenarios[scenario], measured);
+            all.micros.add(run.scenarios[scenario].micros);
+            all.rejected += run.scenarios[scenario].rejected;
+            all.errors += run.scenarios[scenario].errors;
+        }
+    }
+    printSeries("all", all, measured);
+
+    ConnectionPool::Stats pool = db.getPoolStats();
+    double lagP99 = run.startLag.valueAtPercentile(99) / 1000.0;
+    std::cout << "\nStart lag p99 " << std::setprecision(2) << lagP99 << " ms; pool waits " << pool.waits
+              << " of " << pool.acquisitions << " checkouts, longest " << pool.maxWaitMicros / 1000.0
+              << " ms, " << pool.timeouts << " timeouts\n";
+    if (lagP99 > SATURATION_LAG_MS) {
+        std::cout << "Scenarios waited for a free worker; raise --threads to measure the deployment "
+                     "rather than the load generator\n";
+    }
+
+    if (!jsonPath.empty()) {
+        JsonWriter json;
+        json.beginObject()
+            .key("rate").value(rate)
+            .key("threads").value(static_cast<unsigned long long>(threads))
+            .key("duration_s").value(measured)
+            .key("tenants").value(static_cast<unsigned long long>(run.tenants.size()))
+            .key("mix").value(mix)
+            .key("start_lag_p99_ms").value(lagP99, 3)
+            .key("operations").beginArray();
+        for (int op = 0; op < OP_COUNT; ++op) {
+            if (run.operations[op].micros.count()) {
+                writeSeries(json, OPERATION_NAMES[op], run.operations[op], measured);
+            }
+        }
+        json.endArray().key("scenarios").beginArray();
+        for (int scenario = 0; scenario < SCENARIO_COUNT; ++scenario) {
+            if (run.scenarios[scenario].micros.count()) {
+                writeSeries(json, SCENARIO_NAMES[scenario], run.scenarios[scenario], measured);
+            }
+        }
+        writeSeries(json, "all", all, measured);
+        json.endArray().endObject();
+
+        std::ofstream out(jsonPath.c_str(), std::ios::trunc);
+        out << json.str() << "\n";
+        if (!out) {
+            std::cerr << "Cannot write " << jsonPath << "\n";
+            return 1;
+        }
+    }
+    return all.errors ? 2 : 0;
+}
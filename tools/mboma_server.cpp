@@ -0,0 +1,90 @@
+/**
+ * M-Boma HTTP API server
+ *
+ * Serves browsing, search, booking, payment and my-bookings as JSON over
+ * HTTP/1.1; see HousingApi.h for the routes. Stops cleanly on Ctrl+C.
+ *
+ * Usage:
+ *   mboma-server [--host H] [--port P] [--workers W]
+ *
+ *   --host H      Address to bind (default 127.0.0.1)
+ *   --port P      Port (default DBConfig::SERVER_PORT)
+ *   --workers W   Request handler threads (default DBConfig::SERVER_WORKERS)
+ *
+ * Example:
+ *   curl 'http://127.0.0.1:8080/houses?town=100&max_rent=600000'
+ */
+
+#include "server/HousingApi.h"
+#include "server/HttpServer.h"
+#include "DBConfig.h"
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    HttpServer* runningServer = nullptr;
+
+    void onSignal(int) {
+        if (runningServer) {
+            runningServer->stop();
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string host = "127.0.0.1";
+    int port = DBConfig::SERVER_PORT;
+    size_t workers = DBConfig::SERVER_WORKERS;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            host = argv[++i];
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = static_cast<size_t>(std::atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--host H] [--port P] [--workers W]\n";
+            return 1;
+        }
+    }
+    if (port <= 0 || port > 65535 || workers == 0) {
+        std::cerr << "Port must be 1-65535 and workers at least 1\n";
+        return 1;
+    }
+
+    HousingApi api;
+    if (!api.start()) {
+        std::cerr << api.getLastError() << "\n";
+        return 1;
+    }
+
+    HttpServer server([&api](const HttpRequest& request, HttpResponse& response) {
+        api.handle(request, response);
+    }, workers);
+    if (!server.listen(host, port)) {
+        std::cerr << server.getLastError() << "\n";
+        return 1;
+    }
+    server.setTick([&api]() { api.applyPending(); }, DBConfig::SERVER_TICK_MS);
+
+    runningServer = &server;
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "M-Boma API listening on http://" << host << ":" << port
+              << " with " << workers << " workers\n";
+    bool ok = server.run();
+    runningServer = nullptr;
+    if (!ok) {
+        std::cerr << server.getLastError() << "\n";
+    }
+
+    HttpServer::Stats stats = server.getStats();
+    std::cout << "Served " << stats.requests << " requests on " << stats.connections
+              << " connections (" << stats.rejected << " rejected)\n";
+    return ok ? 0 : 1;
+}